@@ -12,56 +12,219 @@
 
 #include "buffer/buffer_pool_manager_instance.h"
 
+#include <algorithm>
+#include <new>
+
+#include "common/exception.h"
 #include "common/macros.h"
 
 namespace bustub {
 
 BufferPoolManagerInstance::BufferPoolManagerInstance(size_t pool_size, DiskManager *disk_manager,
-                                                     LogManager *log_manager)
-    : BufferPoolManagerInstance(pool_size, 1, 0, disk_manager, log_manager) {}
+                                                     LogManager *log_manager, ReplacerType replacer_type)
+    : BufferPoolManagerInstance(pool_size, 1, 0, disk_manager, log_manager, replacer_type) {}
 
 BufferPoolManagerInstance::BufferPoolManagerInstance(size_t pool_size, uint32_t num_instances, uint32_t instance_index,
-                                                     DiskManager *disk_manager, LogManager *log_manager)
+                                                     DiskManager *disk_manager, LogManager *log_manager,
+                                                     ReplacerType replacer_type)
     : pool_size_(pool_size),
       num_instances_(num_instances),
       instance_index_(instance_index),
       next_page_id_(instance_index),
+      frame_arena_(pool_size, buffer_pool_huge_pages),
       disk_manager_(disk_manager),
-      log_manager_(log_manager) {
+      log_manager_(log_manager),
+      page_table_(pool_size) {
   BUSTUB_ASSERT(num_instances > 0, "If BPI is not part of a pool, then the pool size should just be 1");
   BUSTUB_ASSERT(
       instance_index < num_instances,
       "BPI index cannot be greater than the number of BPIs in the pool. In non-parallel case, index should just be 1.");
-  // We allocate a consecutive memory space for the buffer pool.
-  pages_ = new Page[pool_size_];
-  replacer_ = new LRUReplacer(pool_size);
+  // We allocate a consecutive memory space for the buffer pool. The page book-keeping is kept apart from the frame
+  // data, which comes from the arena.
+  pages_ = static_cast<Page *>(::operator new[](pool_size_ * sizeof(Page)));
+  for (size_t i = 0; i < pool_size_; ++i) {
+    new (&pages_[i]) Page(frame_arena_.GetFrame(static_cast<frame_id_t>(i)));
+  }
+  switch (replacer_type) {
+    case ReplacerType::TWO_QUEUE:
+      replacer_ = new TwoQueueReplacer(pool_size);
+      break;
+    case ReplacerType::LRU_K:
+      replacer_ = new LRUKReplacer(pool_size);
+      break;
+    case ReplacerType::LRU:
+    default:
+      replacer_ = new LRUReplacer(pool_size);
+      break;
+  }
 
   // Initially, every page is in the free list.
   for (size_t i = 0; i < pool_size_; ++i) {
+    pages_[i].pin_count_ = PIN_COUNT_EVICTING;
     free_list_.emplace_back(static_cast<int>(i));
   }
+
+  cleaner_thread_ = std::thread(&BufferPoolManagerInstance::RunPageCleaner, this);
+  prefetch_thread_ = std::thread(&BufferPoolManagerInstance::RunPrefetcher, this);
 }
 
 BufferPoolManagerInstance::~BufferPoolManagerInstance() {
-  delete[] pages_;
+  {
+    std::scoped_lock lock(cleaner_latch_);
+    cleaner_running_ = false;
+  }
+  cleaner_cv_.notify_one();
+  cleaner_thread_.join();
+  {
+    std::scoped_lock lock(prefetch_latch_);
+    prefetcher_running_ = false;
+  }
+  prefetch_cv_.notify_one();
+  prefetch_thread_.join();
+  for (size_t i = 0; i < pool_size_; ++i) {
+    pages_[i].~Page();
+  }
+  ::operator delete[](pages_);
   delete replacer_;
 }
 
 bool BufferPoolManagerInstance::FlushPgImp(page_id_t page_id) {
   // Make sure you call DiskManager::WritePage!
-  if (page_table_.find(page_id) != page_table_.end()) {
-    frame_id_t frame_id = page_table_[page_id];
-    FlushPg(page_id);
-    pages_[frame_id].is_dirty_ = false;
-    return true;
+  frame_id_t frame_id;
+  Page *page;
+  {
+    std::scoped_lock lock(latch_);
+    if (!page_table_.Find(page_id, &frame_id)) {
+      return false;
+    }
+    page = &pages_[frame_id];
+    if (page->pin_count_++ == 0) {
+      replacer_->Pin(frame_id);
+    }
   }
-  return false;
+  // The write is checksummed in place, so nobody may change the page until it is done. The read latch is only taken
+  // once the instance latch is released, as a writer may hold the page latch while it waits for the instance latch.
+  page->RLatch();
+  if (FlushPg(frame_id)) {
+    page->rec_lsn_ = INVALID_LSN;
+  }
+  page->RUnlatch();
+  if (page->pin_count_.fetch_sub(1) == 1) {
+    replacer_->Unpin(frame_id);
+  }
+  return true;
 }
 
 void BufferPoolManagerInstance::FlushAllPgsImp() {
   // You can do it!
-  for (auto &tuple : page_table_) {
-    FlushPgImp(tuple.first);
+  std::vector<Page *> pages;
+  CollectDirtyPages(&pages);
+  std::sort(pages.begin(), pages.end(), [](Page *a, Page *b) { return a->page_id_ < b->page_id_; });
+  WriteSortedPages(disk_manager_, log_manager_, pages.begin(), pages.end());
+  disk_manager_->SyncPages();
+  ReleaseDirtyPages(pages);
+}
+
+void BufferPoolManagerInstance::CollectDirtyPages(std::vector<Page *> *pages) {
+  // Eviction and deletion only happen under the latch, so every resident page can be pinned directly. A writer that
+  // changes a page before it is written marks it dirty again.
+  std::scoped_lock lock(latch_);
+  for (size_t i = 0; i < pool_size_; i++) {
+    Page *page = &pages_[i];
+    if (page->page_id_ == INVALID_PAGE_ID || !page->IsDirty()) {
+      continue;
+    }
+    if (page->pin_count_++ == 0) {
+      replacer_->Pin(static_cast<frame_id_t>(i));
+    }
+    if (page->is_dirty_.exchange(false)) {
+      num_dirty_frames_--;
+    }
+    pages->push_back(page);
+  }
+}
+
+void BufferPoolManagerInstance::ReleaseDirtyPages(const std::vector<Page *> &pages) {
+  for (Page *page : pages) {
+    if (page->pin_count_.fetch_sub(1) == 1) {
+      replacer_->Unpin(static_cast<frame_id_t>(page - pages_));
+    }
+  }
+}
+
+void BufferPoolManagerInstance::GetDirtyPageTable(std::vector<std::pair<page_id_t, lsn_t>> *dirty_page_table) {
+  for (size_t i = 0; i < pool_size_; i++) {
+    auto frame_id = static_cast<frame_id_t>(i);
+    Page *page = &pages_[frame_id];
+    page_id_t page_id = page->page_id_;
+    if (page_id == INVALID_PAGE_ID || !TryPin(frame_id, page_id)) {
+      continue;
+    }
+    // Writers log a change and set the page LSN under the write latch, and the page cleaner writes under the read
+    // latch, so neither is half done once we hold the write latch.
+    page->WLatch();
+    lsn_t rec_lsn = page->rec_lsn_;
+    page->WUnlatch();
+    if (rec_lsn != INVALID_LSN) {
+      dirty_page_table->emplace_back(page_id, rec_lsn);
+    }
+    if (page->pin_count_.fetch_sub(1) == 1) {
+      replacer_->Unpin(frame_id);
+    }
+  }
+  // Frames that could not be pinned may be in the middle of an eviction, which writes back under the latch.
+  std::scoped_lock lock(latch_);
+}
+
+void BufferPoolManagerInstance::FlushCheckpointPages(const std::vector<page_id_t> &page_ids) {
+  std::vector<page_id_t> sorted_page_ids(page_ids);
+  std::sort(sorted_page_ids.begin(), sorted_page_ids.end());
+  for (page_id_t page_id : sorted_page_ids) {
+    frame_id_t frame_id;
+    if (!page_table_.Find(page_id, &frame_id) || !TryPin(frame_id, page_id)) {
+      continue;
+    }
+    Page *page = &pages_[frame_id];
+    page->RLatch();
+    if (page->rec_lsn_ != INVALID_LSN) {
+      if (page->is_dirty_.exchange(false)) {
+        num_dirty_frames_--;
+      }
+      WritePage(page);
+      page->rec_lsn_ = INVALID_LSN;
+    }
+    page->RUnlatch();
+    if (page->pin_count_.fetch_sub(1) == 1) {
+      replacer_->Unpin(frame_id);
+    }
+  }
+}
+
+void BufferPoolManagerInstance::WriteSortedPages(DiskManager *disk_manager, LogManager *log_manager,
+                                                 std::vector<Page *>::const_iterator begin,
+                                                 std::vector<Page *>::const_iterator end) {
+  std::vector<char *> run;
+  while (begin != end) {
+    // The pages of a run are read latched for its write, as they are checksummed in place. Only the first latch is
+    // waited for: a writer may hold the latch of a later page while it waits for one we hold, so a page whose latch
+    // is taken starts the next run instead.
+    auto run_begin = begin;
+    page_id_t first_page_id = (*begin)->GetPageId();
+    (*begin)->RLatch();
+    lsn_t max_lsn = LoggedLSN(*begin);
+    run.assign(1, (*begin)->GetData());
+    for (++begin; begin != end && (*begin)->GetPageId() == first_page_id + static_cast<page_id_t>(run.size()) &&
+                  (*begin)->TryRLatch();
+         ++begin) {
+      max_lsn = std::max(max_lsn, LoggedLSN(*begin));
+      run.push_back((*begin)->GetData());
+    }
+    ForceLog(log_manager, max_lsn);
+    disk_manager->WritePages(first_page_id, run.data(), run.size());
+    for (auto iter = run_begin; iter != begin; ++iter) {
+      (*iter)->rec_lsn_ = INVALID_LSN;
+      (*iter)->RUnlatch();
+    }
   }
 }
 
@@ -71,18 +234,22 @@ Page *BufferPoolManagerInstance::NewPgImp(page_id_t *page_id) {
   // 2.   Pick a victim page P from either the free list or the replacer. Always pick from the free list first.
   // 3.   Update P's metadata, zero out memory and add P to the page table.
   // 4.   Set the page ID output parameter. Return a pointer to P.
+  std::scoped_lock lock(latch_);
   frame_id_t frame_id = FindReplacedPage();
   if (frame_id == -1) {
     return nullptr;
   }
-  pages_[frame_id].page_id_ = AllocatePage();
-  // TODO ++??????????
-  pages_[frame_id].pin_count_++;
-  pages_[frame_id].is_dirty_ = false;
-  *page_id = pages_[frame_id].page_id_;
-  page_table_[*page_id] = frame_id;
-  memset(pages_[frame_id].GetData(), 0, PAGE_SIZE);
-  return &pages_[frame_id];
+  Page *page = &pages_[frame_id];
+  *page_id = AllocatePage();
+  page->page_id_ = *page_id;
+  page->is_dirty_ = false;
+  memset(page->GetData(), 0, PAGE_SIZE);
+  // Clear the eviction mark and take the caller's pin in one step, so concurrent speculative pins are preserved.
+  page->pin_count_ += 1 - PIN_COUNT_EVICTING;
+  page_table_.Insert(*page_id, frame_id);
+  replacer_->RecordLoad(frame_id, *page_id);
+  replacer_->Pin(frame_id);
+  return page;
 }
 
 Page *BufferPoolManagerInstance::FetchPgImp(page_id_t page_id) {
@@ -94,25 +261,43 @@ Page *BufferPoolManagerInstance::FetchPgImp(page_id_t page_id) {
   // 3.     Delete R from the page table and insert P.
   // 4.     Update P's metadata, read in the page content from disk, and then return a pointer to P.
   frame_id_t frame_id;
-  if (page_table_.find(page_id) != page_table_.end()) {
-    frame_id = page_table_[page_id];
-    replacer_->Pin(frame_id);
-    pages_[frame_id].pin_count_++;
+  if (page_table_.Find(page_id, &frame_id) && TryPin(frame_id, page_id)) {
     return &pages_[frame_id];
-  } else {
-    frame_id = FindReplacedPage();
-    if (frame_id == -1) {
-      return nullptr;
-    } else {
+  }
+
+  std::scoped_lock lock(latch_);
+  if (page_table_.Find(page_id, &frame_id)) {
+    // Nobody can evict a resident page while we hold the latch, so a plain pin is enough here.
+    Page *page = &pages_[frame_id];
+    if (page->pin_count_++ == 0) {
       replacer_->Pin(frame_id);
-      pages_[frame_id].pin_count_++;
-      pages_[frame_id].page_id_ = page_id;
-      pages_[frame_id].is_dirty_ = false;
-      disk_manager_->ReadPage(page_id, pages_[frame_id].GetData());
-      page_table_[page_id] = frame_id;
-      return &pages_[frame_id];
     }
+    return page;
+  }
+
+  // A read-ahead of the page may still be under way. What it reads can be overtaken by changes made through this
+  // fetch, so it must not be published.
+  prefetching_.erase(page_id);
+  frame_id = FindReplacedPage();
+  if (frame_id == -1) {
+    return nullptr;
   }
+  Page *page = &pages_[frame_id];
+  page->page_id_ = page_id;
+  page->is_dirty_ = false;
+  try {
+    disk_manager_->ReadPage(page_id, page->GetData());
+  } catch (const CorruptedPageException &) {
+    // The frame is still marked as being evicted, so it can go straight back to the free list.
+    page->page_id_ = INVALID_PAGE_ID;
+    free_list_.emplace_back(frame_id);
+    throw;
+  }
+  page->pin_count_ += 1 - PIN_COUNT_EVICTING;
+  page_table_.Insert(page_id, frame_id);
+  replacer_->RecordLoad(frame_id, page_id);
+  replacer_->Pin(frame_id);
+  return page;
 }
 
 bool BufferPoolManagerInstance::DeletePgImp(page_id_t page_id) {
@@ -121,39 +306,64 @@ bool BufferPoolManagerInstance::DeletePgImp(page_id_t page_id) {
   // 1.   If P does not exist, return true.
   // 2.   If P exists, but has a non-zero pin-count, return false. Someone is using the page.
   // 3.   Otherwise, P can be deleted. Remove P from the page table, reset its metadata and return it to the free list.
-  if (page_table_.find(page_id) != page_table_.end()) {
-    frame_id_t frame_id = page_table_[page_id];
-    if (pages_[frame_id].GetPinCount() > 0) {
+  std::scoped_lock lock(latch_);
+  {
+    std::scoped_lock queue_lock(prefetch_latch_);
+    prefetch_queue_.erase(std::remove(prefetch_queue_.begin(), prefetch_queue_.end(), page_id), prefetch_queue_.end());
+  }
+  prefetching_.erase(page_id);
+  frame_id_t frame_id;
+  if (!page_table_.Find(page_id, &frame_id)) {
+    return true;
+  }
+  Page *page = &pages_[frame_id];
+  int pin_count = 0;
+  while (!page->pin_count_.compare_exchange_strong(pin_count, PIN_COUNT_EVICTING)) {
+    // As in FindReplacedPage, a pin the page cleaner holds does not mean the page is in use.
+    if (cleaning_frame_ != frame_id) {
       return false;
     }
-    memset(pages_[frame_id].GetData(), 0, PAGE_SIZE);
-    pages_[frame_id].pin_count_ = 0;
-    pages_[frame_id].page_id_ = INVALID_PAGE_ID;
-    pages_[frame_id].is_dirty_ = false;
-    free_list_.emplace_back(frame_id);
-    page_table_.erase(page_id);
-    return true;
-  } else {
-    return true;
+    pin_count = 0;
+    std::this_thread::yield();
   }
+  page_table_.Remove(page_id);
+  replacer_->Pin(frame_id);
+  DeallocatePage(page_id);
+  memset(page->GetData(), 0, PAGE_SIZE);
+  page->page_id_ = INVALID_PAGE_ID;
+  page->rec_lsn_ = INVALID_LSN;
+  if (page->is_dirty_.exchange(false)) {
+    num_dirty_frames_--;
+  }
+  free_list_.emplace_back(frame_id);
+  return true;
 }
 
 bool BufferPoolManagerInstance::UnpinPgImp(page_id_t page_id, bool is_dirty) {
-  if (page_table_.find(page_id) != page_table_.end()) {
-    frame_id_t frame_id = page_table_[page_id];
-    if (pages_[frame_id].GetPinCount() == 0) {
+  frame_id_t frame_id;
+  if (!page_table_.Find(page_id, &frame_id) || pages_[frame_id].page_id_ != page_id) {
+    // A latch-free lookup can miss while the page table is being updated, so only trust a miss made under the latch.
+    std::scoped_lock lock(latch_);
+    if (!page_table_.Find(page_id, &frame_id)) {
       return false;
     }
-    pages_[frame_id].is_dirty_ = is_dirty;
-    if (--pages_[frame_id].pin_count_ == 0) {
-      replacer_->Unpin(frame_id);
-      if (is_dirty) {
-        FlushPg(page_id);
-      }
+  }
+  Page *page = &pages_[frame_id];
+  if (is_dirty) {
+    MarkDirty(page);
+  }
+  int pin_count = page->pin_count_;
+  do {
+    if (pin_count <= 0) {
+      return false;
     }
-    return true;
+  } while (!page->pin_count_.compare_exchange_weak(pin_count, pin_count - 1));
+
+  if (pin_count == 1) {
+    // Dirty pages are left to the page cleaner (or to eviction) instead of being written back here.
+    replacer_->Unpin(frame_id);
   }
-  return false;
+  return true;
 }
 
 page_id_t BufferPoolManagerInstance::AllocatePage() {
@@ -167,6 +377,23 @@ void BufferPoolManagerInstance::ValidatePageId(const page_id_t page_id) const {
   assert(page_id % num_instances_ == instance_index_);  // allocated pages mod back to this BPI
 }
 
+bool BufferPoolManagerInstance::TryPin(frame_id_t frame_id, page_id_t page_id) {
+  Page *page = &pages_[frame_id];
+  int pin_count = page->pin_count_.fetch_add(1);
+  if (pin_count >= 0 && page->page_id_ == page_id) {
+    if (pin_count == 0) {
+      replacer_->Pin(frame_id);
+    }
+    return true;
+  }
+  // The frame was evicted or reused under us. Drop the speculative pin; if that leaves a resident page unpinned,
+  // hand the frame back to the replacer since an evictor may have skipped it while our pin was visible.
+  if (page->pin_count_.fetch_sub(1) == 1) {
+    replacer_->Unpin(frame_id);
+  }
+  return false;
+}
+
 frame_id_t BufferPoolManagerInstance::FindReplacedPage() {
   frame_id_t frame_id;
   if (!free_list_.empty()) {
@@ -174,21 +401,237 @@ frame_id_t BufferPoolManagerInstance::FindReplacedPage() {
     free_list_.pop_front();
     return frame_id;
   }
-  if (replacer_->Victim(&frame_id)) {
-    page_id_t page_id = pages_[frame_id].GetPageId();
-    FlushPg(page_id);
-    pages_[frame_id].is_dirty_ = false;
-    page_table_.erase(page_id);
-    return frame_id;
+  while (true) {
+    while (replacer_->Victim(&frame_id)) {
+      Page *page = &pages_[frame_id];
+      // A latch-free fetch or the page cleaner may have pinned the frame after the replacer chose it. Skip it; the
+      // frame re-enters the replacer when its pin count drops back to zero.
+      int pin_count = 0;
+      if (!page->pin_count_.compare_exchange_strong(pin_count, PIN_COUNT_EVICTING)) {
+        continue;
+      }
+      page_table_.Remove(page->page_id_);
+      if (FlushPg(frame_id)) {
+        num_inline_writebacks_++;
+        cleaner_cv_.notify_one();
+      }
+      page->rec_lsn_ = INVALID_LSN;
+      return frame_id;
+    }
+    // The cleaner only pins a frame for the length of one write, so a frame it holds is not really in use. Wait for it
+    // to come back rather than report that every frame is pinned.
+    if (cleaning_frame_ == -1) {
+      return -1;
+    }
+    std::this_thread::yield();
+  }
+}
+
+bool BufferPoolManagerInstance::FlushPg(frame_id_t frame_id) {
+  Page *page = &pages_[frame_id];
+  if (!page->is_dirty_.exchange(false)) {
+    return false;
   }
-  return -1;
+  num_dirty_frames_--;
+  WritePage(page);
+  return true;
 }
 
-void BufferPoolManagerInstance::FlushPg(page_id_t page_id) {
-  frame_id_t frame_id = page_table_[page_id];
-  if (pages_[frame_id].IsDirty()) {
-    disk_manager_->WritePage(page_id, pages_[frame_id].GetData());
+void BufferPoolManagerInstance::WritePage(Page *page) {
+  ForceLog(log_manager_, LoggedLSN(page));
+  disk_manager_->WritePage(page->page_id_, page->GetData());
+}
+
+lsn_t BufferPoolManagerInstance::LoggedLSN(Page *page) {
+  // Only pages with a recLSN have logged changes; other kinds of pages may keep anything where the LSN would be.
+  return page->rec_lsn_ != INVALID_LSN ? page->GetLSN() : INVALID_LSN;
+}
+
+void BufferPoolManagerInstance::ForceLog(LogManager *log_manager, lsn_t lsn) {
+  if (log_manager != nullptr && lsn != INVALID_LSN && lsn > log_manager->GetPersistentLSN()) {
+    log_manager->Flush(lsn);
+  }
+}
+
+void BufferPoolManagerInstance::MarkDirty(Page *page) {
+  if (!page->is_dirty_.exchange(true)) {
+    num_dirty_frames_++;
+    if (AboveDirtyRatio()) {
+      cleaner_cv_.notify_one();
+    }
+  }
+}
+
+bool BufferPoolManagerInstance::AboveDirtyRatio() const {
+  return static_cast<double>(num_dirty_frames_) > page_cleaner_dirty_ratio * static_cast<double>(pool_size_);
+}
+
+void BufferPoolManagerInstance::RunPageCleaner() {
+  size_t clock_hand = 0;
+  while (cleaner_running_) {
+    {
+      std::unique_lock lock(cleaner_latch_);
+      cleaner_cv_.wait_for(lock, page_cleaner_interval, [&] { return !cleaner_running_ || AboveDirtyRatio(); });
+    }
+    // Sweep at most once around the pool per wakeup, stopping as soon as we are back under the mark.
+    for (size_t i = 0; i < pool_size_ && cleaner_running_ && AboveDirtyRatio(); i++) {
+      if (CleanFrame(static_cast<frame_id_t>(clock_hand))) {
+        num_cleaned_pages_++;
+      }
+      clock_hand = (clock_hand + 1) % pool_size_;
+    }
+  }
+}
+
+void BufferPoolManagerInstance::PrefetchPages(const std::vector<page_id_t> &page_ids) {
+  {
+    std::scoped_lock lock(prefetch_latch_);
+    // Hints are cheap to drop; never queue more than the pool could hold anyway.
+    for (page_id_t page_id : page_ids) {
+      if (prefetch_queue_.size() >= pool_size_) {
+        break;
+      }
+      ValidatePageId(page_id);
+      prefetch_queue_.push_back(page_id);
+    }
+  }
+  prefetch_cv_.notify_one();
+}
+
+void BufferPoolManagerInstance::RunPrefetcher() {
+  while (true) {
+    {
+      std::unique_lock lock(prefetch_latch_);
+      prefetch_cv_.wait(lock, [&] { return !prefetcher_running_ || !prefetch_queue_.empty(); });
+      if (!prefetcher_running_) {
+        return;
+      }
+    }
+    LoadPages();
+  }
+}
+
+void BufferPoolManagerInstance::LoadPages() {
+  std::vector<std::pair<page_id_t, frame_id_t>> claimed;
+  {
+    page_id_t num_disk_pages = disk_manager_->GetNumPages();
+    std::scoped_lock lock(latch_);
+    // The queue is taken over under latch_, so that DeletePg finds each of its pages either still queued or in
+    // prefetching_.
+    std::vector<page_id_t> page_ids;
+    {
+      std::scoped_lock queue_lock(prefetch_latch_);
+      page_ids.assign(prefetch_queue_.begin(), prefetch_queue_.end());
+      prefetch_queue_.clear();
+    }
+    frame_id_t frame_id;
+    for (page_id_t page_id : page_ids) {
+      // Pages that were never written have nothing to read ahead; they may not even be allocated yet.
+      if (page_id >= num_disk_pages || page_table_.Find(page_id, &frame_id) || prefetching_.count(page_id) > 0) {
+        continue;
+      }
+      frame_id = FindReplacedPage();
+      if (frame_id == -1) {
+        break;
+      }
+      pages_[frame_id].page_id_ = INVALID_PAGE_ID;
+      prefetching_.insert(page_id);
+      claimed.emplace_back(page_id, frame_id);
+    }
+  }
+  if (claimed.empty()) {
+    return;
+  }
+
+  // The claimed frames are neither in the page table nor in the replacer, so nobody else touches them while we read.
+  // Each run of consecutive pages is one request whose completion publishes its frames right away, so the scan can
+  // use the first pages while the rest are still being read.
+  std::sort(claimed.begin(), claimed.end());
+  std::vector<DiskRequest> requests;
+  size_t pending_requests = 0;
+  std::mutex pending_latch;
+  std::condition_variable pending_cv;
+  for (size_t begin = 0; begin < claimed.size();) {
+    size_t end = begin;
+    DiskRequest request{false, claimed[begin].first, {}, nullptr};
+    do {
+      request.pages_data_.push_back(pages_[claimed[end].second].GetData());
+      end++;
+    } while (end < claimed.size() && claimed[end].first == claimed[end - 1].first + 1);
+    request.callback_ = [&, begin, end] {
+      {
+        std::scoped_lock lock(latch_);
+        for (size_t i = begin; i < end; i++) {
+          PublishPrefetchedPage(claimed[i].first, claimed[i].second);
+        }
+      }
+      std::scoped_lock lock(pending_latch);
+      if (--pending_requests == 0) {
+        pending_cv.notify_one();
+      }
+    };
+    requests.push_back(std::move(request));
+    begin = end;
+  }
+
+  // Wait for the whole batch, so that the prefetcher never has more reads outstanding than one batch.
+  std::unique_lock lock(pending_latch);
+  pending_requests = requests.size();
+  lock.unlock();
+  disk_manager_->SubmitRequests(&requests);
+  lock.lock();
+  pending_cv.wait(lock, [&] { return pending_requests == 0; });
+}
+
+void BufferPoolManagerInstance::PublishPrefetchedPage(page_id_t page_id, frame_id_t frame_id) {
+  Page *page = &pages_[frame_id];
+  if (prefetching_.erase(page_id) == 0) {
+    // A fetch or a delete of the page came in while we were reading it, so what we read may be out of date.
+    free_list_.emplace_back(frame_id);
+    return;
+  }
+  if (!DiskManager::VerifyPage(page_id, page->GetData())) {
+    // Leave it to the fetch that needs the page to read it again and report the corruption.
+    free_list_.emplace_back(frame_id);
+    return;
+  }
+  page->page_id_ = page_id;
+  page->is_dirty_ = false;
+  // Make the frame evictable before it becomes visible: a latch-free pin that follows calls replacer_->Pin, which
+  // must not be overtaken by our Unpin.
+  replacer_->RecordLoad(frame_id, page_id);
+  replacer_->Unpin(frame_id);
+  page->pin_count_ -= PIN_COUNT_EVICTING;
+  page_table_.Insert(page_id, frame_id);
+  num_prefetched_pages_++;
+}
+
+bool BufferPoolManagerInstance::CleanFrame(frame_id_t frame_id) {
+  Page *page = &pages_[frame_id];
+  if (!page->IsDirty() || page->pin_count_ != 0) {
+    return false;
+  }
+  // Hold a pin while writing so the frame cannot be evicted under us, and the read latch so nobody modifies it. A page
+  // whose latch a writer holds is being changed anyway. It is passed over instead of waited for, since an eviction may
+  // be waiting for us while holding the instance latch that the writer needs next.
+  page_id_t page_id = page->page_id_;
+  cleaning_frame_ = frame_id;
+  int pin_count = page->pin_count_.fetch_add(1);
+  bool cleaned = false;
+  if (pin_count == 0 && page->page_id_ == page_id && page->TryRLatch()) {
+    if (page->IsDirty()) {
+      // Nobody is changing the page, so what we write holds every change so far.
+      cleaned = FlushPg(frame_id);
+      page->rec_lsn_ = INVALID_LSN;
+    }
+    page->RUnlatch();
+  }
+  // An evictor may have skipped the frame while our pin was visible, so hand it back to the replacer.
+  if (page->pin_count_.fetch_sub(1) == 1) {
+    replacer_->Unpin(frame_id);
   }
+  cleaning_frame_ = -1;
+  return cleaned;
 }
 
 }  // namespace bustub
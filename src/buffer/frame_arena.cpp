@@ -0,0 +1,57 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// frame_arena.cpp
+//
+// Identification: src/buffer/frame_arena.cpp
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "buffer/frame_arena.h"
+
+#include <sys/mman.h>
+#include <algorithm>
+
+#include "common/exception.h"
+
+namespace bustub {
+
+namespace {
+constexpr size_t HUGE_PAGE_SIZE = 2 << 20;
+}  // namespace
+
+FrameArena::FrameArena(size_t num_frames, bool huge_pages) {
+  // mmap rejects empty mappings, so even an empty pool maps one frame.
+  size_ = std::max<size_t>(num_frames, 1) * PAGE_SIZE;
+  void *data = MAP_FAILED;
+#ifdef MAP_HUGETLB
+  if (huge_pages) {
+    // Explicit huge pages need the mapping size rounded up, and fail unless the administrator reserved some.
+    size_t huge_size = (size_ + HUGE_PAGE_SIZE - 1) / HUGE_PAGE_SIZE * HUGE_PAGE_SIZE;
+    data = mmap(nullptr, huge_size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+    if (data != MAP_FAILED) {
+      size_ = huge_size;
+      uses_huge_pages_ = true;
+    }
+  }
+#endif
+  if (data == MAP_FAILED) {
+    data = mmap(nullptr, size_, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (data == MAP_FAILED) {
+      throw Exception(ExceptionType::OUT_OF_MEMORY, "can't map buffer pool frames");
+    }
+#ifdef MADV_HUGEPAGE
+    if (huge_pages) {
+      madvise(data, size_, MADV_HUGEPAGE);
+    }
+#endif
+  }
+  data_ = static_cast<char *>(data);
+}
+
+FrameArena::~FrameArena() { munmap(data_, size_); }
+
+}  // namespace bustub
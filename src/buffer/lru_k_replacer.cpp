@@ -0,0 +1,136 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// lru_k_replacer.cpp
+//
+// Identification: src/buffer/lru_k_replacer.cpp
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "buffer/lru_k_replacer.h"
+
+#include <algorithm>
+#include <tuple>
+
+#include "common/macros.h"
+
+namespace bustub {
+
+LRUKReplacer::LRUKReplacer(size_t num_pages, size_t k, uint64_t correlated_period)
+    : k_(k),
+      correlated_period_(correlated_period),
+      history_(num_pages * k),
+      history_count_(num_pages),
+      last_reference_(num_pages),
+      evictable_(num_pages) {
+  BUSTUB_ASSERT(k > 0, "LRU-K needs to track at least one reference");
+}
+
+LRUKReplacer::~LRUKReplacer() = default;
+
+bool LRUKReplacer::Victim(frame_id_t *frame_id) {
+  std::scoped_lock lock(latch_);
+  if (evictable_frames_.empty()) {
+    return false;
+  }
+  // Prefer frames outside their correlated period, and then the key order. A frame is inside its correlated period if
+  // its next reference would still be part of its last burst.
+  auto victim = evictable_frames_.begin();
+  for (auto iter = victim; iter != evictable_frames_.end(); ++iter) {
+    if (!IsCorrelated(std::get<frame_id_t>(*iter), current_timestamp_ + 1)) {
+      victim = iter;
+      break;
+    }
+  }
+  *frame_id = std::get<frame_id_t>(*victim);
+  evictable_frames_.erase(victim);
+  evictable_[*frame_id] = false;
+  size_--;
+  ResetHistory(*frame_id);
+  return true;
+}
+
+void LRUKReplacer::Pin(frame_id_t frame_id) {
+  std::scoped_lock lock(latch_);
+  if (evictable_[frame_id]) {
+    evictable_frames_.erase(Key(frame_id));
+    evictable_[frame_id] = false;
+    size_--;
+  }
+  RecordAccess(frame_id);
+}
+
+void LRUKReplacer::Unpin(frame_id_t frame_id) {
+  std::scoped_lock lock(latch_);
+  if (evictable_[frame_id]) {
+    if (history_count_[frame_id] != 0) {
+      return;
+    }
+    evictable_frames_.erase(Key(frame_id));
+  } else {
+    evictable_[frame_id] = true;
+    size_++;
+  }
+  if (history_count_[frame_id] == 0) {
+    // The frame was never pinned through us, so its first unpin is its first reference.
+    RecordAccess(frame_id);
+  }
+  evictable_frames_.insert(Key(frame_id));
+}
+
+size_t LRUKReplacer::Size() {
+  std::scoped_lock lock(latch_);
+  return size_;
+}
+
+void LRUKReplacer::RecordLoad(frame_id_t frame_id, page_id_t page_id) {
+  std::scoped_lock lock(latch_);
+  if (evictable_[frame_id]) {
+    evictable_frames_.erase(Key(frame_id));
+    ResetHistory(frame_id);
+    evictable_frames_.insert(Key(frame_id));
+  } else {
+    ResetHistory(frame_id);
+  }
+}
+
+LRUKReplacer::FrameKey LRUKReplacer::Key(frame_id_t frame_id) {
+  // The oldest recorded reference is the K-th most recent one for a finite distance.
+  size_t count = history_count_[frame_id];
+  return {count == k_, count == 0 ? 0 : History(frame_id, count - 1), frame_id};
+}
+
+void LRUKReplacer::RecordAccess(frame_id_t frame_id) {
+  uint64_t now = ++current_timestamp_;
+  size_t count = history_count_[frame_id];
+  if (count > 0 && IsCorrelated(frame_id, now)) {
+    // Part of the same burst: only extend it.
+    last_reference_[frame_id] = now;
+    return;
+  }
+  if (count > 0) {
+    // Close the previous burst. Shifting the older references by its length makes a burst count as a single
+    // reference at its start, as in the original LRU-K algorithm.
+    uint64_t burst = last_reference_[frame_id] - History(frame_id, 0);
+    for (size_t i = std::min(count, k_ - 1); i > 0; i--) {
+      History(frame_id, i) = History(frame_id, i - 1) + burst;
+    }
+  }
+  History(frame_id, 0) = now;
+  history_count_[frame_id] = std::min(count + 1, k_);
+  last_reference_[frame_id] = now;
+}
+
+bool LRUKReplacer::IsCorrelated(frame_id_t frame_id, uint64_t time) const {
+  return time - last_reference_[frame_id] <= correlated_period_;
+}
+
+void LRUKReplacer::ResetHistory(frame_id_t frame_id) {
+  history_count_[frame_id] = 0;
+  last_reference_[frame_id] = 0;
+}
+
+}  // namespace bustub
@@ -19,7 +19,7 @@ LRUReplacer::LRUReplacer(size_t num_pages) { max_size = num_pages; }
 LRUReplacer::~LRUReplacer() = default;
 
 bool LRUReplacer::Victim(frame_id_t *frame_id) {
-  latch.lock();
+  std::scoped_lock lock(latch);
   if (l.empty()) {
     return false;
   }
@@ -27,31 +27,30 @@ bool LRUReplacer::Victim(frame_id_t *frame_id) {
   *frame_id = id;
   l.pop_back();
   mmap.erase(id);
-  latch.unlock();
   return true;
 }
 
 void LRUReplacer::Pin(frame_id_t frame_id) {
-  latch.lock();
-  if (mmap.find(frame_id) != mmap.end()) {
-    l.erase(mmap[frame_id]);
-    mmap.erase(frame_id);
+  std::scoped_lock lock(latch);
+  auto iter = mmap.find(frame_id);
+  if (iter != mmap.end()) {
+    l.erase(iter->second);
+    mmap.erase(iter);
   }
-  latch.unlock();
 }
 
 void LRUReplacer::Unpin(frame_id_t frame_id) {
-  latch.lock();
+  std::scoped_lock lock(latch);
   if (mmap.find(frame_id) != mmap.end()) {
-    latch.unlock();
     return;
-  } else {
-    l.push_front(frame_id);
-    mmap[frame_id] = l.begin();
   }
-  latch.unlock();
+  l.push_front(frame_id);
+  mmap[frame_id] = l.begin();
 }
 
-size_t LRUReplacer::Size() { return mmap.size(); }
+size_t LRUReplacer::Size() {
+  std::scoped_lock lock(latch);
+  return mmap.size();
+}
 
 }  // namespace bustub
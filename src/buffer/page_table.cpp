@@ -0,0 +1,108 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// page_table.cpp
+//
+// Identification: src/buffer/page_table.cpp
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "buffer/page_table.h"
+
+namespace bustub {
+
+PageTable::PageTable(size_t num_frames) {
+  // Keep the load factor at or below 1/2 so that probe sequences stay short.
+  capacity_ = 1;
+  while (capacity_ < num_frames * 2) {
+    capacity_ <<= 1;
+  }
+  mask_ = capacity_ - 1;
+  slots_ = std::make_unique<Slot[]>(capacity_);
+}
+
+bool PageTable::Find(page_id_t page_id, frame_id_t *frame_id) const {
+  size_t index = HomeSlot(page_id);
+  for (size_t probes = 0; probes < capacity_; probes++) {
+    const Slot &slot = slots_[index];
+    uint64_t version;
+    page_id_t key;
+    frame_id_t value;
+    do {
+      version = slot.version_.load(std::memory_order_acquire);
+      key = slot.page_id_.load(std::memory_order_relaxed);
+      value = slot.frame_id_.load(std::memory_order_relaxed);
+      std::atomic_thread_fence(std::memory_order_acquire);
+    } while ((version & 1) != 0 || version != slot.version_.load(std::memory_order_relaxed));
+
+    if (key == page_id) {
+      *frame_id = value;
+      return true;
+    }
+    if (key == INVALID_PAGE_ID) {
+      return false;
+    }
+    index = (index + 1) & mask_;
+  }
+  return false;
+}
+
+void PageTable::Insert(page_id_t page_id, frame_id_t frame_id) {
+  size_t index = HomeSlot(page_id);
+  for (size_t probes = 0; probes < capacity_; probes++) {
+    page_id_t key = slots_[index].page_id_.load(std::memory_order_relaxed);
+    if (key == INVALID_PAGE_ID || key == page_id) {
+      WriteSlot(index, page_id, frame_id);
+      return;
+    }
+    index = (index + 1) & mask_;
+  }
+  UNREACHABLE("page table is full");
+}
+
+bool PageTable::Remove(page_id_t page_id) {
+  size_t hole = HomeSlot(page_id);
+  for (size_t probes = 0;; probes++) {
+    page_id_t key = slots_[hole].page_id_.load(std::memory_order_relaxed);
+    if (key == page_id) {
+      break;
+    }
+    if (key == INVALID_PAGE_ID || probes == capacity_) {
+      return false;
+    }
+    hole = (hole + 1) & mask_;
+  }
+
+  // Backward-shift the rest of the cluster so that lookups never need tombstones. An entry may move into the hole
+  // only if the hole lies between its home slot and its current slot.
+  size_t next = (hole + 1) & mask_;
+  while (true) {
+    page_id_t key = slots_[next].page_id_.load(std::memory_order_relaxed);
+    if (key == INVALID_PAGE_ID) {
+      break;
+    }
+    size_t home = HomeSlot(key);
+    if (((next - home) & mask_) >= ((next - hole) & mask_)) {
+      WriteSlot(hole, key, slots_[next].frame_id_.load(std::memory_order_relaxed));
+      hole = next;
+    }
+    next = (next + 1) & mask_;
+  }
+  WriteSlot(hole, INVALID_PAGE_ID, -1);
+  return true;
+}
+
+void PageTable::WriteSlot(size_t index, page_id_t page_id, frame_id_t frame_id) {
+  Slot &slot = slots_[index];
+  uint64_t version = slot.version_.load(std::memory_order_relaxed);
+  slot.version_.store(version + 1, std::memory_order_relaxed);
+  std::atomic_thread_fence(std::memory_order_release);
+  slot.page_id_.store(page_id, std::memory_order_relaxed);
+  slot.frame_id_.store(frame_id, std::memory_order_relaxed);
+  slot.version_.store(version + 2, std::memory_order_release);
+}
+
+}  // namespace bustub
@@ -12,19 +12,26 @@
 
 #include "buffer/parallel_buffer_pool_manager.h"
 
+#include <algorithm>
+#include <thread>  // NOLINT
+
 namespace bustub {
 
 ParallelBufferPoolManager::ParallelBufferPoolManager(size_t num_instances, size_t pool_size, DiskManager *disk_manager,
-                                                     LogManager *log_manager)
-    : pool_size(pool_size), bpmis{num_instances} {
+                                                     LogManager *log_manager, ReplacerType replacer_type)
+    : pool_size(pool_size), disk_manager_(disk_manager), log_manager_(log_manager), bpmis{num_instances} {
   // Allocate and create individual BufferPoolManagerInstances
   for (size_t i = 0; i < num_instances; i++) {
-    bpmis[i] = new BufferPoolManagerInstance(pool_size, num_instances, i, disk_manager, log_manager);
+    bpmis[i] = new BufferPoolManagerInstance(pool_size, num_instances, i, disk_manager, log_manager, replacer_type);
   }
 }
 
 // Update constructor to destruct all BufferPoolManagerInstances and deallocate any associated memory
-ParallelBufferPoolManager::~ParallelBufferPoolManager() = default;
+ParallelBufferPoolManager::~ParallelBufferPoolManager() {
+  for (auto *bpmi : bpmis) {
+    delete bpmi;
+  }
+}
 
 size_t ParallelBufferPoolManager::GetPoolSize() {
   // Get size of all BufferPoolManagerInstances
@@ -36,6 +43,40 @@ BufferPoolManager *ParallelBufferPoolManager::GetBufferPoolManager(page_id_t pag
   return bpmis[page_id % bpmis.size()];
 }
 
+void ParallelBufferPoolManager::PrefetchPages(const std::vector<page_id_t> &page_ids) {
+  std::vector<std::vector<page_id_t>> instance_page_ids(bpmis.size());
+  for (page_id_t page_id : page_ids) {
+    instance_page_ids[page_id % bpmis.size()].push_back(page_id);
+  }
+  for (size_t i = 0; i < bpmis.size(); i++) {
+    if (!instance_page_ids[i].empty()) {
+      bpmis[i]->PrefetchPages(instance_page_ids[i]);
+    }
+  }
+}
+
+void ParallelBufferPoolManager::GetDirtyPageTable(std::vector<std::pair<page_id_t, lsn_t>> *dirty_page_table) {
+  for (auto *bpmi : bpmis) {
+    bpmi->GetDirtyPageTable(dirty_page_table);
+  }
+}
+
+void ParallelBufferPoolManager::FlushCheckpointPages(const std::vector<page_id_t> &page_ids) {
+  std::vector<std::vector<page_id_t>> instance_page_ids(bpmis.size());
+  for (page_id_t page_id : page_ids) {
+    instance_page_ids[page_id % bpmis.size()].push_back(page_id);
+  }
+  std::vector<std::thread> threads;
+  for (size_t i = 0; i < bpmis.size(); i++) {
+    if (!instance_page_ids[i].empty()) {
+      threads.emplace_back([&, i] { bpmis[i]->FlushCheckpointPages(instance_page_ids[i]); });
+    }
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+}
+
 Page *ParallelBufferPoolManager::FetchPgImp(page_id_t page_id) {
   // Fetch page for page_id from responsible BufferPoolManagerInstance
   return GetBufferPoolManager(page_id)->FetchPage(page_id);
@@ -78,8 +119,42 @@ bool ParallelBufferPoolManager::DeletePgImp(page_id_t page_id) {
 
 void ParallelBufferPoolManager::FlushAllPgsImp() {
   // flush all pages from all BufferPoolManagerInstances
-  for (size_t i = 0; i < bpmis.size(); i++) {
-    bpmis[i]->FlushAllPages();
+  size_t num_instances = bpmis.size();
+  std::vector<std::vector<Page *>> collected(num_instances);
+  std::vector<std::thread> threads;
+  for (size_t i = 0; i < num_instances; i++) {
+    threads.emplace_back([&, i] { bpmis[i]->CollectDirtyPages(&collected[i]); });
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+  threads.clear();
+
+  std::vector<Page *> pages;
+  for (const auto &instance_pages : collected) {
+    pages.insert(pages.end(), instance_pages.begin(), instance_pages.end());
+  }
+  std::sort(pages.begin(), pages.end(), [](Page *a, Page *b) { return a->GetPageId() < b->GetPageId(); });
+
+  // Split the batch into one chunk per instance, moving each boundary forward so that no run is cut in two.
+  size_t chunk_size = (pages.size() + num_instances - 1) / num_instances;
+  auto chunk_begin = pages.cbegin();
+  while (chunk_begin != pages.cend()) {
+    auto chunk_end = chunk_begin + std::min<size_t>(chunk_size, pages.cend() - chunk_begin);
+    while (chunk_end != pages.cend() && (*chunk_end)->GetPageId() == (*(chunk_end - 1))->GetPageId() + 1) {
+      ++chunk_end;
+    }
+    threads.emplace_back(BufferPoolManagerInstance::WriteSortedPages, disk_manager_, log_manager_, chunk_begin,
+                         chunk_end);
+    chunk_begin = chunk_end;
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+  disk_manager_->SyncPages();
+
+  for (size_t i = 0; i < num_instances; i++) {
+    bpmis[i]->ReleaseDirtyPages(collected[i]);
   }
 }
 
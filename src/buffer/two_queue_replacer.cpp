@@ -0,0 +1,153 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// two_queue_replacer.cpp
+//
+// Identification: src/buffer/two_queue_replacer.cpp
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "buffer/two_queue_replacer.h"
+
+#include <algorithm>
+
+namespace bustub {
+
+TwoQueueReplacer::TwoQueueReplacer(size_t num_pages)
+    : a1in_target_(std::max<size_t>(1, num_pages / 4)),
+      a1out_capacity_(std::max<size_t>(1, num_pages / 2)),
+      frames_(num_pages) {}
+
+TwoQueueReplacer::~TwoQueueReplacer() = default;
+
+bool TwoQueueReplacer::Victim(frame_id_t *frame_id) {
+  std::scoped_lock lock(latch_);
+  frame_id_t victim = -1;
+  // Probation pages go first once A1in has grown past its share, so the protected set survives long scans.
+  if (a1in_.size() > a1in_target_ || am_evictable_ == 0) {
+    victim = OldestEvictable(a1in_);
+  }
+  if (victim == -1) {
+    victim = OldestEvictable(am_);
+  }
+  if (victim == -1) {
+    return false;
+  }
+
+  FrameEntry &entry = frames_[victim];
+  if (entry.queue_ == QueueType::A1IN) {
+    RememberGhost(entry.page_id_);
+  }
+  Dequeue(victim);
+  entry.evictable_ = false;
+  entry.page_id_ = INVALID_PAGE_ID;
+  *frame_id = victim;
+  return true;
+}
+
+void TwoQueueReplacer::Pin(frame_id_t frame_id) {
+  std::scoped_lock lock(latch_);
+  FrameEntry &entry = frames_[frame_id];
+  if (!entry.evictable_) {
+    return;
+  }
+  entry.evictable_ = false;
+  if (entry.queue_ == QueueType::A1IN) {
+    a1in_evictable_--;
+  } else if (entry.queue_ == QueueType::AM) {
+    am_evictable_--;
+  }
+}
+
+void TwoQueueReplacer::Unpin(frame_id_t frame_id) {
+  std::scoped_lock lock(latch_);
+  FrameEntry &entry = frames_[frame_id];
+  if (entry.queue_ == QueueType::NONE) {
+    // Nobody told us about this frame's page, so treat it as a fresh load.
+    Enqueue(frame_id, QueueType::A1IN);
+  }
+  if (entry.evictable_) {
+    return;
+  }
+  entry.evictable_ = true;
+  if (entry.queue_ == QueueType::A1IN) {
+    // A1in is FIFO: correlated references keep the page's original position.
+    a1in_evictable_++;
+  } else {
+    am_evictable_++;
+    Enqueue(frame_id, QueueType::AM);
+  }
+}
+
+size_t TwoQueueReplacer::Size() {
+  std::scoped_lock lock(latch_);
+  return a1in_evictable_ + am_evictable_;
+}
+
+void TwoQueueReplacer::RecordLoad(frame_id_t frame_id, page_id_t page_id) {
+  std::scoped_lock lock(latch_);
+  FrameEntry &entry = frames_[frame_id];
+  Dequeue(frame_id);
+  entry.evictable_ = false;
+  entry.page_id_ = page_id;
+
+  auto ghost = a1out_map_.find(page_id);
+  if (ghost != a1out_map_.end()) {
+    a1out_.erase(ghost->second);
+    a1out_map_.erase(ghost);
+    Enqueue(frame_id, QueueType::AM);
+  } else {
+    Enqueue(frame_id, QueueType::A1IN);
+  }
+}
+
+void TwoQueueReplacer::Enqueue(frame_id_t frame_id, QueueType queue) {
+  Dequeue(frame_id);
+  FrameEntry &entry = frames_[frame_id];
+  std::list<frame_id_t> &list = queue == QueueType::A1IN ? a1in_ : am_;
+  list.push_front(frame_id);
+  entry.position_ = list.begin();
+  entry.queue_ = queue;
+  if (entry.evictable_) {
+    (queue == QueueType::A1IN ? a1in_evictable_ : am_evictable_)++;
+  }
+}
+
+void TwoQueueReplacer::Dequeue(frame_id_t frame_id) {
+  FrameEntry &entry = frames_[frame_id];
+  if (entry.queue_ == QueueType::NONE) {
+    return;
+  }
+  bool in_a1in = entry.queue_ == QueueType::A1IN;
+  (in_a1in ? a1in_ : am_).erase(entry.position_);
+  if (entry.evictable_) {
+    (in_a1in ? a1in_evictable_ : am_evictable_)--;
+  }
+  entry.queue_ = QueueType::NONE;
+}
+
+frame_id_t TwoQueueReplacer::OldestEvictable(const std::list<frame_id_t> &queue) const {
+  for (auto iter = queue.rbegin(); iter != queue.rend(); ++iter) {
+    if (frames_[*iter].evictable_) {
+      return *iter;
+    }
+  }
+  return -1;
+}
+
+void TwoQueueReplacer::RememberGhost(page_id_t page_id) {
+  if (page_id == INVALID_PAGE_ID || a1out_map_.count(page_id) > 0) {
+    return;
+  }
+  a1out_.push_front(page_id);
+  a1out_map_[page_id] = a1out_.begin();
+  if (a1out_.size() > a1out_capacity_) {
+    a1out_map_.erase(a1out_.back());
+    a1out_.pop_back();
+  }
+}
+
+}  // namespace bustub
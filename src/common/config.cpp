@@ -20,4 +20,14 @@ std::chrono::duration<int64_t> log_timeout = std::chrono::seconds(1);
 
 std::chrono::milliseconds cycle_detection_interval = std::chrono::milliseconds(50);
 
+std::chrono::milliseconds page_cleaner_interval = std::chrono::milliseconds(10);
+
+std::atomic<double> page_cleaner_dirty_ratio(0.25);
+
+std::atomic<bool> buffer_pool_huge_pages(false);
+
+std::atomic<size_t> table_scan_prefetch_window(32);
+
+std::atomic<bool> log_compression(false);
+
 }  // namespace bustub
@@ -0,0 +1,146 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// crc32c.cpp
+//
+// Identification: src/common/util/crc32c.cpp
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "common/util/crc32c.h"
+
+#include <array>
+#include <cstring>
+
+#ifdef __SSE4_2__
+#include <nmmintrin.h>
+#endif
+
+namespace bustub {
+
+namespace {
+/** The Castagnoli polynomial, bit-reversed. */
+constexpr uint32_t POLYNOMIAL = 0x82f63b78;
+
+#ifdef __SSE4_2__
+/**
+ * The crc32 instruction has a latency of three cycles but can start one every cycle, so long inputs are checksummed
+ * as three interleaved streams of STREAM_SIZE bytes whose checksums are then combined.
+ */
+constexpr size_t STREAM_SIZE = 256;
+
+using Gf2Matrix = std::array<uint32_t, 32>;
+
+constexpr uint32_t Gf2MatrixTimes(const Gf2Matrix &matrix, uint32_t vector) {
+  uint32_t sum = 0;
+  for (int i = 0; vector != 0; i++, vector >>= 1) {
+    if ((vector & 1) != 0) {
+      sum ^= matrix[i];
+    }
+  }
+  return sum;
+}
+
+constexpr Gf2Matrix Gf2MatrixSquare(const Gf2Matrix &matrix) {
+  Gf2Matrix square{};
+  for (int i = 0; i < 32; i++) {
+    square[i] = Gf2MatrixTimes(matrix, matrix[i]);
+  }
+  return square;
+}
+
+/**
+ * Tables that advance a checksum register over size zero bytes, one table per byte of the register, so that the
+ * checksum of a stream can be moved past the streams after it. size must be a power of two.
+ */
+constexpr std::array<std::array<uint32_t, 256>, 4> MakeShiftTables(size_t size) {
+  // The operator for one zero bit, squared until it covers size bytes.
+  Gf2Matrix op{};
+  op[0] = POLYNOMIAL;
+  for (int i = 1; i < 32; i++) {
+    op[i] = uint32_t{1} << (i - 1);
+  }
+  for (size_t bits = 1; bits < 8 * size; bits *= 2) {
+    op = Gf2MatrixSquare(op);
+  }
+  std::array<std::array<uint32_t, 256>, 4> tables{};
+  for (uint32_t i = 0; i < 256; i++) {
+    for (int byte = 0; byte < 4; byte++) {
+      tables[byte][i] = Gf2MatrixTimes(op, i << (8 * byte));
+    }
+  }
+  return tables;
+}
+
+constexpr std::array<std::array<uint32_t, 256>, 4> STREAM_SHIFT = MakeShiftTables(STREAM_SIZE);
+
+inline uint32_t ShiftStream(uint32_t crc) {
+  return STREAM_SHIFT[0][crc & 0xff] ^ STREAM_SHIFT[1][(crc >> 8) & 0xff] ^ STREAM_SHIFT[2][(crc >> 16) & 0xff] ^
+         STREAM_SHIFT[3][crc >> 24];
+}
+
+inline uint64_t Read64(const char *p) {
+  uint64_t value;
+  memcpy(&value, p, sizeof(value));
+  return value;
+}
+#else
+constexpr std::array<uint32_t, 256> MakeTable() {
+  std::array<uint32_t, 256> table{};
+  for (uint32_t i = 0; i < 256; i++) {
+    uint32_t crc = i;
+    for (int bit = 0; bit < 8; bit++) {
+      crc = (crc >> 1) ^ ((crc & 1) != 0 ? POLYNOMIAL : 0);
+    }
+    table[i] = crc;
+  }
+  return table;
+}
+
+constexpr std::array<uint32_t, 256> TABLE = MakeTable();
+#endif
+}  // namespace
+
+uint32_t Crc32c::Extend(uint32_t crc, const char *data, size_t size) {
+  crc = ~crc;
+#ifdef __SSE4_2__
+  uint64_t crc64 = crc;
+  for (; size >= 3 * STREAM_SIZE; data += 3 * STREAM_SIZE, size -= 3 * STREAM_SIZE) {
+    // The checksum registers of the second and third streams start at zero; only the first carries crc.
+    uint64_t crc1 = 0;
+    uint64_t crc2 = 0;
+    for (size_t i = 0; i < STREAM_SIZE; i += sizeof(uint64_t)) {
+      crc64 = _mm_crc32_u64(crc64, Read64(data + i));
+      crc1 = _mm_crc32_u64(crc1, Read64(data + STREAM_SIZE + i));
+      crc2 = _mm_crc32_u64(crc2, Read64(data + 2 * STREAM_SIZE + i));
+    }
+    crc64 = ShiftStream(static_cast<uint32_t>(crc64)) ^ crc1;
+    crc64 = ShiftStream(static_cast<uint32_t>(crc64)) ^ crc2;
+  }
+  for (; size >= sizeof(uint64_t); data += sizeof(uint64_t), size -= sizeof(uint64_t)) {
+    crc64 = _mm_crc32_u64(crc64, Read64(data));
+  }
+  crc = static_cast<uint32_t>(crc64);
+  for (; size > 0; data++, size--) {
+    crc = _mm_crc32_u8(crc, static_cast<uint8_t>(*data));
+  }
+#else
+  for (; size > 0; data++, size--) {
+    crc = (crc >> 8) ^ TABLE[(crc ^ static_cast<uint8_t>(*data)) & 0xff];
+  }
+#endif
+  return ~crc;
+}
+
+bool Crc32c::IsHardwareAccelerated() {
+#ifdef __SSE4_2__
+  return true;
+#else
+  return false;
+#endif
+}
+
+}  // namespace bustub
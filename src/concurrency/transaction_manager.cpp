@@ -30,6 +30,14 @@ Transaction *TransactionManager::Begin(Transaction *txn, IsolationLevel isolatio
   if (txn == nullptr) {
     txn = new Transaction(next_txn_id_++, isolation_level);
   }
+
+  if (enable_logging) {
+    std::scoped_lock lock(logged_txns_latch_);
+    LogRecord log_record(txn->GetTransactionId(), txn->GetPrevLSN(), LogRecordType::BEGIN);
+    lsn_t lsn = log_manager_->AppendLogRecord(&log_record);
+    txn->SetPrevLSN(lsn);
+    logged_txns_[txn->GetTransactionId()] = {txn, lsn};
+  }
   txn_map_mutex.lock();
   txn_map[txn->GetTransactionId()] = txn;
   txn_map_mutex.unlock();
@@ -52,6 +60,15 @@ void TransactionManager::Commit(Transaction *txn) {
   }
   write_set->clear();
 
+  if (enable_logging) {
+    // Group commit: wait until the commit record is durable, together with whatever other commits join the same flush.
+    LogRecord log_record(txn->GetTransactionId(), txn->GetPrevLSN(), LogRecordType::COMMIT);
+    lsn_t lsn = log_manager_->AppendLogRecord(&log_record);
+    txn->SetPrevLSN(lsn);
+    log_manager_->Flush(lsn);
+  }
+  ForgetLoggedTransaction(txn);
+
   // Release all the locks.
   ReleaseLocks(txn);
   // Release the global transaction latch.
@@ -102,6 +119,12 @@ void TransactionManager::Abort(Transaction *txn) {
   table_write_set->clear();
   index_write_set->clear();
 
+  if (enable_logging) {
+    LogRecord log_record(txn->GetTransactionId(), txn->GetPrevLSN(), LogRecordType::ABORT);
+    txn->SetPrevLSN(log_manager_->AppendLogRecord(&log_record));
+  }
+  ForgetLoggedTransaction(txn);
+
   // Release all the locks.
   ReleaseLocks(txn);
   // Release the global transaction latch.
@@ -112,4 +135,21 @@ void TransactionManager::BlockAllTransactions() { global_txn_latch_.WLock(); }
 
 void TransactionManager::ResumeTransactions() { global_txn_latch_.WUnlock(); }
 
+void TransactionManager::ForgetLoggedTransaction(Transaction *txn) {
+  std::scoped_lock lock(logged_txns_latch_);
+  logged_txns_.erase(txn->GetTransactionId());
+}
+
+lsn_t TransactionManager::GetActiveTransactionTable(std::vector<std::pair<txn_id_t, lsn_t>> *active_txns) {
+  std::scoped_lock lock(logged_txns_latch_);
+  lsn_t oldest_begin_lsn = INVALID_LSN;
+  for (const auto &[txn_id, entry] : logged_txns_) {
+    active_txns->emplace_back(txn_id, entry.first->GetPrevLSN());
+    if (oldest_begin_lsn == INVALID_LSN || entry.second < oldest_begin_lsn) {
+      oldest_begin_lsn = entry.second;
+    }
+  }
+  return oldest_begin_lsn;
+}
+
 }  // namespace bustub
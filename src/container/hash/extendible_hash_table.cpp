@@ -10,8 +10,12 @@
 //
 //===----------------------------------------------------------------------===//
 
+#include <algorithm>
 #include <iostream>
 #include <string>
+#include <thread>  // NOLINT
+#include <unordered_map>
+#include <unordered_set>
 #include <utility>
 #include <vector>
 
@@ -22,34 +26,27 @@
 
 namespace bustub {
 
-// reinterpret_cast 没看懂
 template <typename KeyType, typename ValueType, typename KeyComparator>
 HASH_TABLE_TYPE::ExtendibleHashTable(const std::string &name, BufferPoolManager *buffer_pool_manager,
                                      const KeyComparator &comparator, HashFunction<KeyType> hash_fn)
     : buffer_pool_manager_(buffer_pool_manager), comparator_(comparator), hash_fn_(std::move(hash_fn)) {
-  //  implement me!
-  //  directory_page
-  auto dir_page = buffer_pool_manager_->NewPage(&directory_page_id_);
+  // the table starts out as one bucket, behind one directory page of depth 0, behind a header page of depth 0
+  auto header_page = NewTablePage(&header_page_id_);
+  page_id_t dir_page_id;
+  auto dir_page = NewTablePage(&dir_page_id);
+  page_id_t bucket_page_id;
+  NewTablePage(&bucket_page_id);
+
+  auto header_page_data = reinterpret_cast<HashTableDirectoryPage *>(header_page->GetData());
+  header_page_data->SetPageId(header_page_id_);
+  header_page_data->SetBucketPageId(0, dir_page_id);
   auto dir_page_data = reinterpret_cast<HashTableDirectoryPage *>(dir_page->GetData());
+  dir_page_data->SetPageId(dir_page_id);
+  dir_page_data->SetBucketPageId(0, bucket_page_id);
 
-  page_id_t bucket_0_page_id;
-  page_id_t bucket_1_page_id;
-  buffer_pool_manager_->NewPage(&bucket_0_page_id);
-  buffer_pool_manager_->NewPage(&bucket_1_page_id);
-
-  dir_page_data->SetBucketPageId(0, bucket_0_page_id);
-  dir_page_data->SetLocalDepth(0, 1);
-  dir_page_data->SetBucketPageId(1, bucket_1_page_id);
-  dir_page_data->SetLocalDepth(1, 1);
-
-  dir_page_data->IncrGlobalDepth();
-  dir_page_data->SetPageId(directory_page_id_);
-
-  buffer_pool_manager_->UnpinPage(directory_page_id_, true);
-
-  // 为什么是false？
-  buffer_pool_manager_->UnpinPage(bucket_0_page_id, false);
-  buffer_pool_manager_->UnpinPage(bucket_1_page_id, false);
+  buffer_pool_manager_->UnpinPage(header_page_id_, true);
+  buffer_pool_manager_->UnpinPage(dir_page_id, true);
+  buffer_pool_manager_->UnpinPage(bucket_page_id, true);
 }
 
 /*****************************************************************************
@@ -78,14 +75,54 @@ inline uint32_t HASH_TABLE_TYPE::KeyToPageId(KeyType key, HashTableDirectoryPage
 }
 
 template <typename KeyType, typename ValueType, typename KeyComparator>
-HashTableDirectoryPage *HASH_TABLE_TYPE::FetchDirectoryPage() {
-  return reinterpret_cast<HashTableDirectoryPage *>(buffer_pool_manager_->FetchPage(directory_page_id_)->GetData());
+inline uint32_t HASH_TABLE_TYPE::KeyToHeaderIndex(KeyType key, HashTableDirectoryPage *header_page) {
+  uint32_t hash = Hash(key);
+  // bit i of the index is bit 31 - i of the hash, so that a new header bit tells apart the keys of a directory page
+  uint32_t index = 0;
+  for (uint32_t i = 0; i < header_page->GetGlobalDepth(); i++) {
+    index |= ((hash >> (31 - i)) & 1) << i;
+  }
+  return index;
+}
+
+template <typename KeyType, typename ValueType, typename KeyComparator>
+Page *HASH_TABLE_TYPE::FetchTablePage(page_id_t page_id) {
+  auto page = buffer_pool_manager_->FetchPage(page_id);
+  if (page == nullptr) {
+    throw Exception(ExceptionType::OUT_OF_MEMORY, "cannot fetch a hash table page");
+  }
+  return page;
+}
+
+template <typename KeyType, typename ValueType, typename KeyComparator>
+Page *HASH_TABLE_TYPE::NewTablePage(page_id_t *page_id) {
+  auto page = buffer_pool_manager_->NewPage(page_id);
+  if (page == nullptr) {
+    throw Exception(ExceptionType::OUT_OF_MEMORY, "cannot allocate a hash table page");
+  }
+  return page;
+}
+
+template <typename KeyType, typename ValueType, typename KeyComparator>
+std::pair<Page *, HashTableDirectoryPage *> HASH_TABLE_TYPE::FetchDirectoryPage(const KeyType &key, bool exclusive) {
+  auto header_page = FetchTablePage(header_page_id_);
+  header_page->RLatch();
+  auto header_page_data = reinterpret_cast<HashTableDirectoryPage *>(header_page->GetData());
+  auto dir_page_id = header_page_data->GetBucketPageId(KeyToHeaderIndex(key, header_page_data));
+  auto dir_page = FetchTablePage(dir_page_id);
+  if (exclusive) {
+    dir_page->WLatch();
+  } else {
+    dir_page->RLatch();
+  }
+  header_page->RUnlatch();
+  buffer_pool_manager_->UnpinPage(header_page_id_, false);
+  return {dir_page, reinterpret_cast<HashTableDirectoryPage *>(dir_page->GetData())};
 }
 
-// reinterpret_cast 没看懂
 template <typename KeyType, typename ValueType, typename KeyComparator>
 std::pair<Page *, HASH_TABLE_BUCKET_TYPE *> HASH_TABLE_TYPE::FetchBucketPage(page_id_t bucket_page_id) {
-  auto bucket_page = buffer_pool_manager_->FetchPage(bucket_page_id);
+  auto bucket_page = FetchTablePage(bucket_page_id);
   auto bucket_page_data = reinterpret_cast<HASH_TABLE_BUCKET_TYPE *>(bucket_page->GetData());
   return std::pair<Page *, HASH_TABLE_BUCKET_TYPE *>(bucket_page, bucket_page_data);
 }
@@ -100,18 +137,16 @@ uint32_t HASH_TABLE_TYPE::Pow(uint32_t base, uint32_t power) const {
  *****************************************************************************/
 template <typename KeyType, typename ValueType, typename KeyComparator>
 bool HASH_TABLE_TYPE::GetValue(Transaction *transaction, const KeyType &key, std::vector<ValueType> *result) {
-  table_latch_.RLock();
-
-  auto dir_page_data = FetchDirectoryPage();
+  auto [dir_page, dir_page_data] = FetchDirectoryPage(key, false);
   auto bucket_page_id = KeyToPageId(key, dir_page_data);
   auto [bucket_page, bucket_page_data] = FetchBucketPage(bucket_page_id);
   bucket_page->RLatch();
+  dir_page->RUnlatch();
+  buffer_pool_manager_->UnpinPage(dir_page_data->GetPageId(), false);
+
   auto success = bucket_page_data->GetValue(key, comparator_, result);
-  buffer_pool_manager_->UnpinPage(bucket_page_id, false);
-  buffer_pool_manager_->UnpinPage(directory_page_id_, false);
   bucket_page->RUnlatch();
-
-  table_latch_.RUnlock();
+  buffer_pool_manager_->UnpinPage(bucket_page_id, false);
   return success;
 }
 
@@ -120,99 +155,179 @@ bool HASH_TABLE_TYPE::GetValue(Transaction *transaction, const KeyType &key, std
  *****************************************************************************/
 template <typename KeyType, typename ValueType, typename KeyComparator>
 bool HASH_TABLE_TYPE::Insert(Transaction *transaction, const KeyType &key, const ValueType &value) {
-  table_latch_.RLock();
-
-  auto dir_page_data = FetchDirectoryPage();
+  auto [dir_page, dir_page_data] = FetchDirectoryPage(key, false);
   auto bucket_page_id = KeyToPageId(key, dir_page_data);
   auto [bucket_page, bucket_page_data] = FetchBucketPage(bucket_page_id);
-
   bucket_page->WLatch();
+  dir_page->RUnlatch();
+  buffer_pool_manager_->UnpinPage(dir_page_data->GetPageId(), false);
 
   if (bucket_page_data->IsFull()) {
-    buffer_pool_manager_->UnpinPage(bucket_page_id, false);
-    buffer_pool_manager_->UnpinPage(directory_page_id_, false);
     bucket_page->WUnlatch();
-    table_latch_.RUnlock();
+    buffer_pool_manager_->UnpinPage(bucket_page_id, false);
     return SplitInsert(transaction, key, value);
   }
   auto success = bucket_page_data->Insert(key, value, comparator_);
-  buffer_pool_manager_->UnpinPage(bucket_page_id, success);
-  buffer_pool_manager_->UnpinPage(directory_page_id_, false);
   bucket_page->WUnlatch();
-  table_latch_.RUnlock();
+  buffer_pool_manager_->UnpinPage(bucket_page_id, success);
   return success;
 }
 
 template <typename KeyType, typename ValueType, typename KeyComparator>
 bool HASH_TABLE_TYPE::SplitInsert(Transaction *transaction, const KeyType &key, const ValueType &value) {
-  table_latch_.WLock();
-
-  auto success = false;
-  auto inserted = false;
-  auto is_growing = false;
-  auto dir_page_data = FetchDirectoryPage();
-
-  // insert the key-value pair into the corresponding bucket.
-  // If the bucket is full, split until it is successfully inserted into the bucket.
-  while (!inserted) {
-    auto old_global_depth = dir_page_data->GetGlobalDepth();
+  // split the key's bucket until the key fits, which may take a few rounds if its entries share hash bits
+  while (true) {
+    auto [dir_page, dir_page_data] = FetchDirectoryPage(key, true);
     auto bucket_idx = KeyToDirectoryIndex(key, dir_page_data);
-    auto bucket_page_id = KeyToPageId(key, dir_page_data);
+    auto bucket_page_id = dir_page_data->GetBucketPageId(bucket_idx);
     auto [bucket_page, bucket_page_data] = FetchBucketPage(bucket_page_id);
     bucket_page->WLatch();
 
-    if (bucket_page_data->IsFull()) {
-      // first check whether we need to grow the directory
-      if (dir_page_data->GetLocalDepth(bucket_idx) == dir_page_data->GetGlobalDepth()) {
-        is_growing = true;
-        dir_page_data->IncrGlobalDepth();
+    auto done = true;
+    auto success = false;
+    auto split = false;
+    if (!bucket_page_data->IsFull()) {
+      // another thread split or emptied the bucket in the meantime
+      success = bucket_page_data->Insert(key, value, comparator_);
+    } else {
+      std::vector<ValueType> values;
+      bucket_page_data->GetValue(key, comparator_, &values);
+      if (std::find(values.begin(), values.end(), value) == values.end()) {
+        done = false;
+        if (dir_page_data->GetLocalDepth(bucket_idx) < DIRECTORY_MAX_DEPTH) {
+          SplitBucket(dir_page_data, bucket_idx, bucket_page_data);
+          split = true;
+        }
       }
+    }
+    bucket_page->WUnlatch();
+    buffer_pool_manager_->UnpinPage(bucket_page_id, success || split);
+    dir_page->WUnlatch();
+    buffer_pool_manager_->UnpinPage(dir_page_data->GetPageId(), split);
+
+    if (done) {
+      return success;
+    }
+    // the bucket uses every bit of its directory page, so the directory page has to split first
+    if (!split && !SplitDirectory(key)) {
+      return false;
+    }
+  }
+}
+
+template <typename KeyType, typename ValueType, typename KeyComparator>
+void HASH_TABLE_TYPE::SplitBucket(HashTableDirectoryPage *dir_page, uint32_t bucket_idx,
+                                  HASH_TABLE_BUCKET_TYPE *bucket_page) {
+  if (dir_page->GetLocalDepth(bucket_idx) == dir_page->GetGlobalDepth()) {
+    dir_page->IncrGlobalDepth();
+  }
+  uint32_t local_depth = dir_page->GetLocalDepth(bucket_idx);
+  uint32_t high_bit = 1U << local_depth;
+
+  // the split image is out of reach of other threads until the directory page points to it
+  page_id_t image_page_id;
+  auto image_page_data = reinterpret_cast<HASH_TABLE_BUCKET_TYPE *>(NewTablePage(&image_page_id)->GetData());
+  for (uint32_t i = 0; i < BUCKET_ARRAY_SIZE; i++) {
+    if (bucket_page->IsReadable(i) && (Hash(bucket_page->KeyAt(i)) & high_bit) != 0) {
+      image_page_data->Insert(bucket_page->KeyAt(i), bucket_page->ValueAt(i), comparator_);
+      bucket_page->RemoveAt(i);
+    }
+  }
+  buffer_pool_manager_->UnpinPage(image_page_id, true);
 
-      // second find the bucket pair, and update them
-      dir_page_data->IncrLocalDepth(bucket_idx);
-      auto split_bucket_idx = dir_page_data->GetSplitImageIndex(bucket_idx);
-      page_id_t split_page_id;
-      auto split_page_data =
-          reinterpret_cast<HASH_TABLE_BUCKET_TYPE *>(buffer_pool_manager_->NewPage(&split_page_id)->GetData());
-      dir_page_data->SetBucketPageId(split_bucket_idx, split_page_id);
-      dir_page_data->SetLocalDepth(split_bucket_idx, dir_page_data->GetLocalDepth(bucket_idx));
-
-      // rehash all key-value pairs in the bucket pair
-      uint32_t num_read = 0;
-      uint32_t num_readable = bucket_page_data->NumReadable();
-
-      while (num_read != num_readable) {
-        auto k = bucket_page_data->KeyAt(num_read);
-        auto which_bucket = Hash(k) & (Pow(2, dir_page_data->GetLocalDepth(bucket_idx)) - 1);
-        if ((which_bucket ^ split_bucket_idx) == 0) {
-          auto v = bucket_page_data->ValueAt(num_read);
-          bucket_page_data->Remove(k, v, comparator_);
-          split_page_data->Insert(k, v, comparator_);
+  // every slot that shared the bucket now tells its half apart by one more bit
+  for (uint32_t i = bucket_idx & (high_bit - 1); i < dir_page->Size(); i += high_bit) {
+    dir_page->SetLocalDepth(i, local_depth + 1);
+    if ((i & high_bit) != 0) {
+      dir_page->SetBucketPageId(i, image_page_id);
+    }
+  }
+}
+
+template <typename KeyType, typename ValueType, typename KeyComparator>
+bool HASH_TABLE_TYPE::SplitDirectory(const KeyType &key) {
+  auto header_page = FetchTablePage(header_page_id_);
+  header_page->WLatch();
+  auto header_page_data = reinterpret_cast<HashTableDirectoryPage *>(header_page->GetData());
+  auto dir_idx = KeyToHeaderIndex(key, header_page_data);
+  auto dir_page_id = header_page_data->GetBucketPageId(dir_idx);
+  auto dir_page = FetchTablePage(dir_page_id);
+  dir_page->WLatch();
+  auto dir_page_data = reinterpret_cast<HashTableDirectoryPage *>(dir_page->GetData());
+
+  // another thread may have split the directory page, or made room in the bucket, in the meantime
+  auto bucket_page_id = KeyToPageId(key, dir_page_data);
+  auto [bucket_page, bucket_page_data] = FetchBucketPage(bucket_page_id);
+  bucket_page->RLatch();
+  auto full = bucket_page_data->IsFull() &&
+              dir_page_data->GetLocalDepth(KeyToDirectoryIndex(key, dir_page_data)) == DIRECTORY_MAX_DEPTH;
+  bucket_page->RUnlatch();
+  buffer_pool_manager_->UnpinPage(bucket_page_id, false);
+
+  auto success = true;
+  auto split = false;
+  if (full) {
+    if (header_page_data->GetLocalDepth(dir_idx) < header_page_data->GetGlobalDepth()) {
+      split = true;
+    } else if (header_page_data->GetGlobalDepth() < DIRECTORY_MAX_DEPTH) {
+      header_page_data->IncrGlobalDepth();
+      split = true;
+    } else {
+      success = false;
+    }
+  }
+
+  if (split) {
+    uint32_t header_depth = header_page_data->GetLocalDepth(dir_idx);
+    // the keys that move have hash bit 31 - header_depth set, which KeyToHeaderIndex maps to index bit header_depth
+    uint32_t hash_bit = 1U << (31 - header_depth);
+    uint32_t high_bit = 1U << header_depth;
+
+    page_id_t image_dir_page_id;
+    auto image_dir_page = NewTablePage(&image_dir_page_id);
+    auto image_dir_page_data = reinterpret_cast<HashTableDirectoryPage *>(image_dir_page->GetData());
+    image_dir_page_data->SetPageId(image_dir_page_id);
+    while (image_dir_page_data->GetGlobalDepth() < dir_page_data->GetGlobalDepth()) {
+      image_dir_page_data->IncrGlobalDepth();
+    }
+
+    // each bucket splits into a bucket of the image directory page, which keeps the same slots and local depths
+    std::unordered_map<page_id_t, page_id_t> image_bucket_page_ids;
+    for (uint32_t i = 0; i < dir_page_data->Size(); i++) {
+      auto old_page_id = dir_page_data->GetBucketPageId(i);
+      auto [it, inserted] = image_bucket_page_ids.try_emplace(old_page_id, INVALID_PAGE_ID);
+      if (inserted) {
+        auto [old_page, old_page_data] = FetchBucketPage(old_page_id);
+        auto image_page_data = reinterpret_cast<HASH_TABLE_BUCKET_TYPE *>(NewTablePage(&it->second)->GetData());
+        // threads that reached the bucket before the directory page was latched may still be in it
+        old_page->WLatch();
+        for (uint32_t j = 0; j < BUCKET_ARRAY_SIZE; j++) {
+          if (old_page_data->IsReadable(j) && (Hash(old_page_data->KeyAt(j)) & hash_bit) != 0) {
+            image_page_data->Insert(old_page_data->KeyAt(j), old_page_data->ValueAt(j), comparator_);
+            old_page_data->RemoveAt(j);
+          }
         }
-        num_read++;
+        old_page->WUnlatch();
+        buffer_pool_manager_->UnpinPage(old_page_id, true);
+        buffer_pool_manager_->UnpinPage(it->second, true);
       }
-      buffer_pool_manager_->UnpinPage(split_page_id, true);
-      // redirect the reset of the buckets.
-      //! for more info, see VerifyIntegrity().
-      for (uint32_t i = Pow(2, old_global_depth); i < dir_page_data->Size(); i++) {
-        if (i == split_bucket_idx) {
-          continue;
-        }
-        uint32_t redirect_bucket_idx = i & (Pow(2, old_global_depth) - 1);
-        dir_page_data->SetBucketPageId(i, dir_page_data->GetBucketPageId(redirect_bucket_idx));
-        dir_page_data->SetLocalDepth(i, dir_page_data->GetLocalDepth(redirect_bucket_idx));
+      image_dir_page_data->SetBucketPageId(i, it->second);
+      image_dir_page_data->SetLocalDepth(i, dir_page_data->GetLocalDepth(i));
+    }
+    buffer_pool_manager_->UnpinPage(image_dir_page_id, true);
+
+    for (uint32_t i = dir_idx & (high_bit - 1); i < header_page_data->Size(); i += high_bit) {
+      header_page_data->SetLocalDepth(i, header_depth + 1);
+      if ((i & high_bit) != 0) {
+        header_page_data->SetBucketPageId(i, image_dir_page_id);
       }
-    } else {
-      // the bucket is not full, so we can insert the key-value directly.
-      success = bucket_page_data->Insert(key, value, comparator_);
-      inserted = true;
     }
-    buffer_pool_manager_->UnpinPage(bucket_page_id, true);
-    bucket_page->WUnlatch();
   }
-  buffer_pool_manager_->UnpinPage(directory_page_id_, is_growing);
 
-  table_latch_.WUnlock();
+  dir_page->WUnlatch();
+  buffer_pool_manager_->UnpinPage(dir_page_id, split);
+  header_page->WUnlatch();
+  buffer_pool_manager_->UnpinPage(header_page_id_, split);
   return success;
 }
 
@@ -221,28 +336,21 @@ bool HASH_TABLE_TYPE::SplitInsert(Transaction *transaction, const KeyType &key,
  *****************************************************************************/
 template <typename KeyType, typename ValueType, typename KeyComparator>
 bool HASH_TABLE_TYPE::Remove(Transaction *transaction, const KeyType &key, const ValueType &value) {
-  table_latch_.RLock();
-
-  auto dir_page_data = FetchDirectoryPage();
+  auto [dir_page, dir_page_data] = FetchDirectoryPage(key, false);
   auto bucket_page_id = KeyToPageId(key, dir_page_data);
   auto [bucket_page, bucket_page_data] = FetchBucketPage(bucket_page_id);
-
   bucket_page->WLatch();
+  dir_page->RUnlatch();
+  buffer_pool_manager_->UnpinPage(dir_page_data->GetPageId(), false);
+
   auto success = bucket_page_data->Remove(key, value, comparator_);
+  auto empty = success && bucket_page_data->IsEmpty();
+  bucket_page->WUnlatch();
+  buffer_pool_manager_->UnpinPage(bucket_page_id, success);
 
-  if (success && bucket_page_data->IsEmpty()) {
-    buffer_pool_manager_->UnpinPage(bucket_page_id, success);
-    buffer_pool_manager_->UnpinPage(directory_page_id_, false);
-    bucket_page->WUnlatch();
-    table_latch_.RUnlock();
+  if (empty) {
     Merge(transaction, key, value);
-    return success;
   }
-  buffer_pool_manager_->UnpinPage(bucket_page_id, success);
-  buffer_pool_manager_->UnpinPage(directory_page_id_, false);
-  bucket_page->WUnlatch();
-
-  table_latch_.RUnlock();
   return success;
 }
 
@@ -251,46 +359,43 @@ bool HASH_TABLE_TYPE::Remove(Transaction *transaction, const KeyType &key, const
  *****************************************************************************/
 template <typename KeyType, typename ValueType, typename KeyComparator>
 void HASH_TABLE_TYPE::Merge(Transaction *transaction, const KeyType &key, const ValueType &value) {
-  table_latch_.WLock();
-
-  auto dir_page_data = FetchDirectoryPage();
-  for (uint32_t i = 0;; i++) {
-    if (i >= dir_page_data->Size()) {
-      break;
+  auto [dir_page, dir_page_data] = FetchDirectoryPage(key, true);
+  auto bucket_idx = KeyToDirectoryIndex(key, dir_page_data);
+  uint32_t local_depth = dir_page_data->GetLocalDepth(bucket_idx);
+
+  auto merged = false;
+  auto bucket_page_id = INVALID_PAGE_ID;
+  if (local_depth > 0) {
+    auto image_idx = dir_page_data->GetSplitImageIndex(bucket_idx);
+    if (dir_page_data->GetLocalDepth(image_idx) == local_depth) {
+      bucket_page_id = dir_page_data->GetBucketPageId(bucket_idx);
+      auto [bucket_page, bucket_page_data] = FetchBucketPage(bucket_page_id);
+      bucket_page->RLatch();
+      merged = bucket_page_data->IsEmpty();
+      bucket_page->RUnlatch();
+      buffer_pool_manager_->UnpinPage(bucket_page_id, false);
     }
-    auto old_local_depth = dir_page_data->GetLocalDepth(i);
-    auto bucket_page_id = dir_page_data->GetBucketPageId(i);
-    auto [bucket_page, bucket_page_data] = FetchBucketPage(bucket_page_id);
-    bucket_page->RLatch();
-    if (old_local_depth > 1 && bucket_page_data->IsEmpty()) {
-      auto split_bucket_idx = dir_page_data->GetSplitImageIndex(i);
-      if (dir_page_data->GetLocalDepth(split_bucket_idx) == old_local_depth) {
-        dir_page_data->DecrLocalDepth(split_bucket_idx);
-        dir_page_data->DecrLocalDepth(i);
-        dir_page_data->SetBucketPageId(i, dir_page_data->GetBucketPageId(split_bucket_idx));
-        auto new_bucket_page_id = dir_page_data->GetBucketPageId(i);
-
-        for (uint32_t j = 0; j < dir_page_data->Size(); j++) {
-          if (j == i || j == split_bucket_idx) {
-            continue;
-          }
-          auto cur_bucket_page_id = dir_page_data->GetBucketPageId(j);
-          if (cur_bucket_page_id == bucket_page_id || cur_bucket_page_id == new_bucket_page_id) {
-            dir_page_data->SetBucketPageId(j, new_bucket_page_id);
-            dir_page_data->SetLocalDepth(j, dir_page_data->GetLocalDepth(i));
-          }
-        }
+    if (merged) {
+      // every slot of the empty bucket, and of its image, now points to the image
+      auto image_page_id = dir_page_data->GetBucketPageId(image_idx);
+      uint32_t high_bit = 1U << (local_depth - 1);
+      for (uint32_t i = bucket_idx & (high_bit - 1); i < dir_page_data->Size(); i += high_bit) {
+        dir_page_data->SetBucketPageId(i, image_page_id);
+        dir_page_data->SetLocalDepth(i, local_depth - 1);
       }
-      if (dir_page_data->CanShrink()) {
+      while (dir_page_data->CanShrink()) {
         dir_page_data->DecrGlobalDepth();
       }
     }
-    bucket_page->RUnlatch();
-    buffer_pool_manager_->UnpinPage(bucket_page_id, false);
   }
-  buffer_pool_manager_->UnpinPage(directory_page_id_, true);
+  dir_page->WUnlatch();
+  buffer_pool_manager_->UnpinPage(dir_page_data->GetPageId(), merged);
 
-  table_latch_.WUnlock();
+  // Threads pin and latch a bucket before they let go of the directory page, so nobody can get to the empty bucket
+  // any more. The ones that got to it before may only have yet to unpin it.
+  while (merged && !buffer_pool_manager_->DeletePage(bucket_page_id)) {
+    std::this_thread::yield();
+  }
 }
 
 /*****************************************************************************
@@ -298,11 +403,22 @@ void HASH_TABLE_TYPE::Merge(Transaction *transaction, const KeyType &key, const
  *****************************************************************************/
 template <typename KeyType, typename ValueType, typename KeyComparator>
 uint32_t HASH_TABLE_TYPE::GetGlobalDepth() {
-  table_latch_.RLock();
-  HashTableDirectoryPage *dir_page = FetchDirectoryPage();
-  uint32_t global_depth = dir_page->GetGlobalDepth();
-  assert(buffer_pool_manager_->UnpinPage(directory_page_id_, false, nullptr));
-  table_latch_.RUnlock();
+  // the depth of the deepest directory page, counting the header bits that lead to it
+  auto header_page = FetchTablePage(header_page_id_);
+  header_page->RLatch();
+  auto header_page_data = reinterpret_cast<HashTableDirectoryPage *>(header_page->GetData());
+  uint32_t global_depth = 0;
+  for (uint32_t i = 0; i < header_page_data->Size(); i++) {
+    auto dir_page_id = header_page_data->GetBucketPageId(i);
+    auto dir_page = FetchTablePage(dir_page_id);
+    dir_page->RLatch();
+    auto dir_page_data = reinterpret_cast<HashTableDirectoryPage *>(dir_page->GetData());
+    global_depth = std::max(global_depth, header_page_data->GetLocalDepth(i) + dir_page_data->GetGlobalDepth());
+    dir_page->RUnlatch();
+    buffer_pool_manager_->UnpinPage(dir_page_id, false);
+  }
+  header_page->RUnlatch();
+  buffer_pool_manager_->UnpinPage(header_page_id_, false);
   return global_depth;
 }
 
@@ -311,11 +427,24 @@ uint32_t HASH_TABLE_TYPE::GetGlobalDepth() {
  *****************************************************************************/
 template <typename KeyType, typename ValueType, typename KeyComparator>
 void HASH_TABLE_TYPE::VerifyIntegrity() {
-  table_latch_.RLock();
-  HashTableDirectoryPage *dir_page = FetchDirectoryPage();
-  dir_page->VerifyIntegrity();
-  assert(buffer_pool_manager_->UnpinPage(directory_page_id_, false, nullptr));
-  table_latch_.RUnlock();
+  auto header_page = FetchTablePage(header_page_id_);
+  header_page->RLatch();
+  auto header_page_data = reinterpret_cast<HashTableDirectoryPage *>(header_page->GetData());
+  header_page_data->VerifyIntegrity();
+  std::unordered_set<page_id_t> dir_page_ids;
+  for (uint32_t i = 0; i < header_page_data->Size(); i++) {
+    auto dir_page_id = header_page_data->GetBucketPageId(i);
+    if (!dir_page_ids.insert(dir_page_id).second) {
+      continue;
+    }
+    auto dir_page = FetchTablePage(dir_page_id);
+    dir_page->RLatch();
+    reinterpret_cast<HashTableDirectoryPage *>(dir_page->GetData())->VerifyIntegrity();
+    dir_page->RUnlatch();
+    buffer_pool_manager_->UnpinPage(dir_page_id, false);
+  }
+  header_page->RUnlatch();
+  buffer_pool_manager_->UnpinPage(header_page_id_, false);
 }
 
 /*****************************************************************************
@@ -10,7 +10,9 @@
 //
 //===----------------------------------------------------------------------===//
 
+#include <algorithm>
 #include <iostream>
+#include <optional>
 #include <string>
 #include <utility>
 #include <vector>
@@ -22,25 +24,332 @@
 
 namespace bustub {
 
+namespace {
+
+/**
+ * Walks the probe sequence of a bucket through one block array. The block of the bucket the walk starts at stays
+ * latched until the walk is destroyed, and so does the block the walk is in; the blocks in between are released as
+ * the walk leaves them.
+ */
+template <typename KeyType, typename ValueType, typename KeyComparator>
+class Probe {
+ public:
+  Probe(BufferPoolManager *buffer_pool_manager, HashTableHeaderPage *header, size_t bucket, bool exclusive)
+      : buffer_pool_manager_(buffer_pool_manager),
+        header_(header),
+        exclusive_(exclusive),
+        bucket_(bucket),
+        size_(header->GetSize()) {
+    home_page_ = Latch(bucket_ / BLOCK_ARRAY_SIZE);
+    page_ = home_page_;
+  }
+
+  ~Probe() {
+    if (page_ != home_page_) {
+      Release(page_);
+    }
+    Release(home_page_);
+  }
+
+  DISALLOW_COPY_AND_MOVE(Probe);
+
+  /** @return whether the walk ran off the end of the block array */
+  bool IsEnd() const { return bucket_ >= size_; }
+
+  size_t Bucket() const { return bucket_; }
+  bool IsOccupied() const { return Block()->IsOccupied(bucket_ % BLOCK_ARRAY_SIZE); }
+  bool IsReadable() const { return Block()->IsReadable(bucket_ % BLOCK_ARRAY_SIZE); }
+  KeyType KeyAt() const { return Block()->KeyAt(bucket_ % BLOCK_ARRAY_SIZE); }
+  ValueType ValueAt() const { return Block()->ValueAt(bucket_ % BLOCK_ARRAY_SIZE); }
+  bool Claim(const KeyType &key, const ValueType &value) {
+    return Block()->Insert(bucket_ % BLOCK_ARRAY_SIZE, key, value);
+  }
+  void Remove() { Block()->Remove(bucket_ % BLOCK_ARRAY_SIZE); }
+
+  void Next() {
+    bucket_++;
+    if (bucket_ % BLOCK_ARRAY_SIZE == 0 && bucket_ < size_) {
+      if (page_ != home_page_) {
+        Release(page_);
+      }
+      page_ = Latch(bucket_ / BLOCK_ARRAY_SIZE);
+    }
+  }
+
+  /**
+   * Walks on to the bucket that holds a pair, or to the end of the sequence: the first bucket never occupied, or the
+   * end of the block array.
+   *
+   * @return whether the pair was found
+   */
+  bool Seek(const KeyType &key, const ValueType &value, const KeyComparator &comparator) {
+    for (; !IsEnd() && IsOccupied(); Next()) {
+      if (IsReadable() && comparator(key, KeyAt()) == 0 && value == ValueAt()) {
+        return true;
+      }
+    }
+    return false;
+  }
+
+  /** Walks to the end of the sequence, collecting the values of key on the way. */
+  void Collect(const KeyType &key, const KeyComparator &comparator, std::vector<ValueType> *result) {
+    for (; !IsEnd() && IsOccupied(); Next()) {
+      if (IsReadable() && comparator(key, KeyAt()) == 0) {
+        result->emplace_back(ValueAt());
+      }
+    }
+  }
+
+ private:
+  HASH_TABLE_BLOCK_TYPE *Block() const { return reinterpret_cast<HASH_TABLE_BLOCK_TYPE *>(page_->GetData()); }
+
+  Page *Latch(size_t block_index) {
+    Page *page = buffer_pool_manager_->FetchPage(header_->GetBlockPageId(block_index));
+    if (page == nullptr) {
+      throw Exception(ExceptionType::OUT_OF_MEMORY, "cannot fetch a hash table block page");
+    }
+    if (exclusive_) {
+      page->WLatch();
+    } else {
+      page->RLatch();
+    }
+    return page;
+  }
+
+  void Release(Page *page) {
+    if (exclusive_) {
+      page->WUnlatch();
+    } else {
+      page->RUnlatch();
+    }
+    buffer_pool_manager_->UnpinPage(page->GetPageId(), exclusive_);
+  }
+
+  BufferPoolManager *buffer_pool_manager_;
+  HashTableHeaderPage *header_;
+  bool exclusive_;
+  size_t bucket_;
+  size_t size_;
+  Page *home_page_;
+  Page *page_;
+};
+
+}  // namespace
+
 template <typename KeyType, typename ValueType, typename KeyComparator>
 HASH_TABLE_TYPE::LinearProbeHashTable(const std::string &name, BufferPoolManager *buffer_pool_manager,
                                       const KeyComparator &comparator, size_t num_buckets,
                                       HashFunction<KeyType> hash_fn)
-    : buffer_pool_manager_(buffer_pool_manager), comparator_(comparator), hash_fn_(std::move(hash_fn)) {}
+    : buffer_pool_manager_(buffer_pool_manager), comparator_(comparator), hash_fn_(std::move(hash_fn)) {
+  header_page_id_ = NewBlockArray(num_buckets);
+  auto header_page = FetchTablePage(header_page_id_);
+  num_buckets_ = reinterpret_cast<HashTableHeaderPage *>(header_page->GetData())->GetSize();
+  buffer_pool_manager_->UnpinPage(header_page_id_, false);
+}
+
+/*****************************************************************************
+ * HELPERS
+ *****************************************************************************/
+template <typename KeyType, typename ValueType, typename KeyComparator>
+size_t HASH_TABLE_TYPE::HomeBucket(const KeyType &key, HashTableHeaderPage *header) {
+  return hash_fn_.GetHash(key) % header->GetSize();
+}
+
+template <typename KeyType, typename ValueType, typename KeyComparator>
+Page *HASH_TABLE_TYPE::FetchTablePage(page_id_t page_id) {
+  auto page = buffer_pool_manager_->FetchPage(page_id);
+  if (page == nullptr) {
+    throw Exception(ExceptionType::OUT_OF_MEMORY, "cannot fetch a hash table page");
+  }
+  return page;
+}
+
+template <typename KeyType, typename ValueType, typename KeyComparator>
+Page *HASH_TABLE_TYPE::NewTablePage(page_id_t *page_id) {
+  auto page = buffer_pool_manager_->NewPage(page_id);
+  if (page == nullptr) {
+    throw Exception(ExceptionType::OUT_OF_MEMORY, "cannot allocate a hash table page");
+  }
+  return page;
+}
+
+template <typename KeyType, typename ValueType, typename KeyComparator>
+page_id_t HASH_TABLE_TYPE::NewBlockArray(size_t num_buckets) {
+  size_t num_blocks = std::clamp<size_t>((num_buckets + BLOCK_ARRAY_SIZE - 1) / BLOCK_ARRAY_SIZE, 1,
+                                         HashTableHeaderPage::MaxNumBlocks());
+  page_id_t header_page_id;
+  auto header = reinterpret_cast<HashTableHeaderPage *>(NewTablePage(&header_page_id)->GetData());
+  header->SetPageId(header_page_id);
+  header->SetSize(num_blocks * BLOCK_ARRAY_SIZE);
+  for (size_t i = 0; i < num_blocks; i++) {
+    page_id_t block_page_id;
+    NewTablePage(&block_page_id);
+    buffer_pool_manager_->UnpinPage(block_page_id, true);
+    header->AddBlockPageId(block_page_id);
+  }
+  buffer_pool_manager_->UnpinPage(header_page_id, true);
+  return header_page_id;
+}
+
+template <typename KeyType, typename ValueType, typename KeyComparator>
+void HASH_TABLE_TYPE::DeleteBlockArray(page_id_t header_page_id) {
+  auto header = reinterpret_cast<HashTableHeaderPage *>(FetchTablePage(header_page_id)->GetData());
+  std::vector<page_id_t> block_page_ids;
+  for (size_t i = 0; i < header->NumBlocks(); i++) {
+    block_page_ids.push_back(header->GetBlockPageId(i));
+  }
+  buffer_pool_manager_->UnpinPage(header_page_id, false);
+  for (auto block_page_id : block_page_ids) {
+    buffer_pool_manager_->DeletePage(block_page_id);
+  }
+  buffer_pool_manager_->DeletePage(header_page_id);
+}
 
 /*****************************************************************************
  * SEARCH
  *****************************************************************************/
 template <typename KeyType, typename ValueType, typename KeyComparator>
 bool HASH_TABLE_TYPE::GetValue(Transaction *transaction, const KeyType &key, std::vector<ValueType> *result) {
-  return false;
+  table_latch_.RLock();
+  auto header = reinterpret_cast<HashTableHeaderPage *>(FetchTablePage(header_page_id_)->GetData());
+  HashTableHeaderPage *old_header = nullptr;
+  if (old_header_page_id_ != INVALID_PAGE_ID) {
+    old_header = reinterpret_cast<HashTableHeaderPage *>(FetchTablePage(old_header_page_id_)->GetData());
+  }
+  {
+    // the key's home block in the old array stays latched, so that its pairs cannot migrate in between the two walks
+    std::optional<Probe<KeyType, ValueType, KeyComparator>> old_probe;
+    if (old_header != nullptr) {
+      old_probe.emplace(buffer_pool_manager_, old_header, HomeBucket(key, old_header), false);
+      old_probe->Collect(key, comparator_, result);
+    }
+    Probe<KeyType, ValueType, KeyComparator> probe(buffer_pool_manager_, header, HomeBucket(key, header), false);
+    probe.Collect(key, comparator_, result);
+  }
+  if (old_header != nullptr) {
+    buffer_pool_manager_->UnpinPage(old_header_page_id_, false);
+  }
+  buffer_pool_manager_->UnpinPage(header_page_id_, false);
+  table_latch_.RUnlock();
+  return !result->empty();
 }
+
 /*****************************************************************************
  * INSERTION
  *****************************************************************************/
 template <typename KeyType, typename ValueType, typename KeyComparator>
 bool HASH_TABLE_TYPE::Insert(Transaction *transaction, const KeyType &key, const ValueType &value) {
-  return false;
+  while (true) {
+    table_latch_.RLock();
+    for (size_t i = 0; i < MIGRATE_BLOCKS_PER_OPERATION && MigrateBlock(); i++) {
+    }
+    auto header = reinterpret_cast<HashTableHeaderPage *>(FetchTablePage(header_page_id_)->GetData());
+    HashTableHeaderPage *old_header = nullptr;
+    if (old_header_page_id_ != INVALID_PAGE_ID) {
+      old_header = reinterpret_cast<HashTableHeaderPage *>(FetchTablePage(old_header_page_id_)->GetData());
+    }
+    auto duplicate = false;
+    auto inserted = false;
+    {
+      std::optional<Probe<KeyType, ValueType, KeyComparator>> old_probe;
+      if (old_header != nullptr) {
+        old_probe.emplace(buffer_pool_manager_, old_header, HomeBucket(key, old_header), true);
+        duplicate = old_probe->Seek(key, value, comparator_);
+      }
+      if (!duplicate) {
+        Probe<KeyType, ValueType, KeyComparator> probe(buffer_pool_manager_, header, HomeBucket(key, header), true);
+        duplicate = probe.Seek(key, value, comparator_);
+        // the walk stopped at the first bucket never occupied, which no other thread can claim while it is latched
+        inserted = !duplicate && !probe.IsEnd() && probe.Claim(key, value);
+      }
+    }
+    if (inserted) {
+      num_occupied_++;
+      num_pairs_++;
+    }
+    auto size = num_buckets_;
+    auto header_page_id = header_page_id_;
+    auto grow = inserted && old_header == nullptr && 2 * num_occupied_ > size;
+    // Removes leave tombstones behind, which only moving the pairs to a new block array clears. When they take up most
+    // of the occupied buckets, the table is rehashed at its size instead of growing.
+    auto rehash = 2 * num_pairs_ < num_occupied_;
+    auto finish = old_header != nullptr && migrated_blocks_ == old_num_blocks_;
+    if (old_header != nullptr) {
+      buffer_pool_manager_->UnpinPage(old_header_page_id_, false);
+    }
+    buffer_pool_manager_->UnpinPage(header_page_id_, false);
+    table_latch_.RUnlock();
+
+    if (finish) {
+      FinishResize();
+    }
+    if (grow && rehash) {
+      Rebuild(size, header_page_id);
+    } else if (grow) {
+      Resize(size);
+    }
+    if (inserted || duplicate) {
+      return inserted;
+    }
+    // the probe sequence ran off the end of the block array, which has to be rebuilt or grow for the pair to fit
+    if (rehash) {
+      Rebuild(size, header_page_id);
+      continue;
+    }
+    Resize(size);
+    if (GetSize() <= size) {
+      return false;
+    }
+  }
+}
+
+template <typename KeyType, typename ValueType, typename KeyComparator>
+bool HASH_TABLE_TYPE::MigrateBlock() {
+  if (old_header_page_id_ == INVALID_PAGE_ID) {
+    return false;
+  }
+  size_t block_index = next_migrate_block_++;
+  if (block_index >= old_num_blocks_) {
+    return false;
+  }
+  auto header = reinterpret_cast<HashTableHeaderPage *>(FetchTablePage(header_page_id_)->GetData());
+  auto old_header = reinterpret_cast<HashTableHeaderPage *>(FetchTablePage(old_header_page_id_)->GetData());
+  {
+    // The block is the home block of every pair that moves, so no other operation on their keys runs meanwhile. Their
+    // probe sequences start in the block and may go on past its end, up to the first bucket never occupied.
+    Probe<KeyType, ValueType, KeyComparator> old_probe(buffer_pool_manager_, old_header,
+                                                       block_index * BLOCK_ARRAY_SIZE, true);
+    size_t block_end = (block_index + 1) * BLOCK_ARRAY_SIZE;
+    for (; !old_probe.IsEnd(); old_probe.Next()) {
+      if (!old_probe.IsOccupied()) {
+        if (old_probe.Bucket() >= block_end) {
+          break;
+        }
+        continue;
+      }
+      if (!old_probe.IsReadable()) {
+        continue;
+      }
+      auto key = old_probe.KeyAt();
+      if (HomeBucket(key, old_header) / BLOCK_ARRAY_SIZE != block_index) {
+        continue;
+      }
+      Probe<KeyType, ValueType, KeyComparator> probe(buffer_pool_manager_, header, HomeBucket(key, header), true);
+      while (!probe.IsEnd() && !probe.Claim(key, old_probe.ValueAt())) {
+        probe.Next();
+      }
+      if (probe.IsEnd()) {
+        // the new array is at most about a quarter full, which makes this next to impossible
+        throw Exception(ExceptionType::OUT_OF_RANGE, "no room to migrate a pair into the resized hash table");
+      }
+      num_occupied_++;
+      old_probe.Remove();
+    }
+  }
+  buffer_pool_manager_->UnpinPage(old_header_page_id_, false);
+  buffer_pool_manager_->UnpinPage(header_page_id_, false);
+  migrated_blocks_++;
+  return true;
 }
 
 /*****************************************************************************
@@ -48,21 +357,125 @@ bool HASH_TABLE_TYPE::Insert(Transaction *transaction, const KeyType &key, const
  *****************************************************************************/
 template <typename KeyType, typename ValueType, typename KeyComparator>
 bool HASH_TABLE_TYPE::Remove(Transaction *transaction, const KeyType &key, const ValueType &value) {
-  return false;
+  table_latch_.RLock();
+  for (size_t i = 0; i < MIGRATE_BLOCKS_PER_OPERATION && MigrateBlock(); i++) {
+  }
+  auto header = reinterpret_cast<HashTableHeaderPage *>(FetchTablePage(header_page_id_)->GetData());
+  HashTableHeaderPage *old_header = nullptr;
+  if (old_header_page_id_ != INVALID_PAGE_ID) {
+    old_header = reinterpret_cast<HashTableHeaderPage *>(FetchTablePage(old_header_page_id_)->GetData());
+  }
+  auto removed = false;
+  {
+    std::optional<Probe<KeyType, ValueType, KeyComparator>> old_probe;
+    if (old_header != nullptr) {
+      old_probe.emplace(buffer_pool_manager_, old_header, HomeBucket(key, old_header), true);
+      if (old_probe->Seek(key, value, comparator_)) {
+        old_probe->Remove();
+        removed = true;
+      }
+    }
+    if (!removed) {
+      Probe<KeyType, ValueType, KeyComparator> probe(buffer_pool_manager_, header, HomeBucket(key, header), true);
+      if (probe.Seek(key, value, comparator_)) {
+        probe.Remove();
+        removed = true;
+      }
+    }
+  }
+  if (removed) {
+    num_pairs_--;
+  }
+  auto finish = old_header != nullptr && migrated_blocks_ == old_num_blocks_;
+  if (old_header != nullptr) {
+    buffer_pool_manager_->UnpinPage(old_header_page_id_, false);
+  }
+  buffer_pool_manager_->UnpinPage(header_page_id_, false);
+  table_latch_.RUnlock();
+
+  if (finish) {
+    FinishResize();
+  }
+  return removed;
 }
 
 /*****************************************************************************
  * RESIZE
  *****************************************************************************/
 template <typename KeyType, typename ValueType, typename KeyComparator>
-void HASH_TABLE_TYPE::Resize(size_t initial_size) {}
+void HASH_TABLE_TYPE::Resize(size_t initial_size) {
+  size_t num_buckets = std::min(2 * initial_size, HashTableHeaderPage::MaxNumBlocks() * BLOCK_ARRAY_SIZE);
+  table_latch_.RLock();
+  auto header_page_id = header_page_id_;
+  auto size = num_buckets_;
+  table_latch_.RUnlock();
+  if (num_buckets > size) {
+    Rebuild(num_buckets, header_page_id);
+  }
+}
+
+template <typename KeyType, typename ValueType, typename KeyComparator>
+void HASH_TABLE_TYPE::Rebuild(size_t num_buckets, page_id_t from_header_page_id) {
+  // the table has at most two block arrays, so a resize in progress has to finish first
+  table_latch_.RLock();
+  while (MigrateBlock()) {
+  }
+  auto replaced = header_page_id_ != from_header_page_id;
+  table_latch_.RUnlock();
+  FinishResize();
+
+  if (replaced) {
+    return;
+  }
+  // the new array is allocated before the latch is taken, which only has to be held to swap it in
+  page_id_t header_page_id = NewBlockArray(num_buckets);
+  auto header_page = FetchTablePage(header_page_id);
+  size_t size = reinterpret_cast<HashTableHeaderPage *>(header_page->GetData())->GetSize();
+  buffer_pool_manager_->UnpinPage(header_page_id, false);
+
+  table_latch_.WLock();
+  if (old_header_page_id_ == INVALID_PAGE_ID && header_page_id_ == from_header_page_id) {
+    auto old_header_page = FetchTablePage(header_page_id_);
+    old_num_blocks_ = reinterpret_cast<HashTableHeaderPage *>(old_header_page->GetData())->NumBlocks();
+    buffer_pool_manager_->UnpinPage(header_page_id_, false);
+    old_header_page_id_ = header_page_id_;
+    header_page_id_ = header_page_id;
+    num_buckets_ = size;
+    num_occupied_ = 0;
+    next_migrate_block_ = 0;
+    migrated_blocks_ = 0;
+    header_page_id = INVALID_PAGE_ID;
+  }
+  table_latch_.WUnlock();
+  // another thread resized or rebuilt the table in the meantime
+  if (header_page_id != INVALID_PAGE_ID) {
+    DeleteBlockArray(header_page_id);
+  }
+}
+
+template <typename KeyType, typename ValueType, typename KeyComparator>
+void HASH_TABLE_TYPE::FinishResize() {
+  page_id_t old_header_page_id = INVALID_PAGE_ID;
+  table_latch_.WLock();
+  if (old_header_page_id_ != INVALID_PAGE_ID && migrated_blocks_ == old_num_blocks_) {
+    old_header_page_id = old_header_page_id_;
+    old_header_page_id_ = INVALID_PAGE_ID;
+  }
+  table_latch_.WUnlock();
+  if (old_header_page_id != INVALID_PAGE_ID) {
+    DeleteBlockArray(old_header_page_id);
+  }
+}
 
 /*****************************************************************************
  * GETSIZE
  *****************************************************************************/
 template <typename KeyType, typename ValueType, typename KeyComparator>
 size_t HASH_TABLE_TYPE::GetSize() {
-  return 0;
+  table_latch_.RLock();
+  size_t size = num_buckets_;
+  table_latch_.RUnlock();
+  return size;
 }
 
 template class LinearProbeHashTable<int, int, IntComparator>;
@@ -11,8 +11,10 @@
 //===----------------------------------------------------------------------===//
 
 #include "execution/executors/hash_join_executor.h"
+
+#include <cstring>
+
 #include "execution/expressions/abstract_expression.h"
-#include "execution/expressions/column_value_expression.h"
 
 namespace bustub {
 
@@ -22,70 +24,199 @@ HashJoinExecutor::HashJoinExecutor(ExecutorContext *exec_ctx, const HashJoinPlan
     : AbstractExecutor(exec_ctx),
       plan_(plan),
       left_child_executor_(std::move(left_child)),
-      right_child_executor_(std::move(right_child)) {
+      right_child_executor_(std::move(right_child)) {}
+
+HashJoinExecutor::~HashJoinExecutor() {
+  {
+    std::lock_guard<std::mutex> guard(workers_latch_);
+    stop_workers_ = true;
+  }
+  workers_cv_.notify_all();
+  for (auto &worker : workers_) {
+    worker.join();
+  }
+}
+
+hash_t HashJoinExecutor::HashKey(const Value &key) {
+  // HashValue barely touches the high bits for small integers, so the bits are mixed as by MurmurHash3's fmix64.
+  hash_t hash = HashUtil::HashValue(&key);
+  hash ^= hash >> 33;
+  hash *= 0xff51afd7ed558ccdULL;
+  hash ^= hash >> 33;
+  hash *= 0xc4ceb9fe1a85ec53ULL;
+  hash ^= hash >> 33;
+  return hash;
+}
+
+void HashJoinExecutor::ParallelFor(size_t num_tasks, const std::function<void(size_t)> &task) {
+  {
+    std::lock_guard<std::mutex> guard(workers_latch_);
+    task_ = &task;
+    num_tasks_ = num_tasks;
+    next_task_ = 0;
+    busy_workers_ = workers_.size();
+    round_++;
+  }
+  workers_cv_.notify_all();
+  RunTasks();
+  // The task lives on the caller's stack, so every worker must be done with it.
+  std::unique_lock<std::mutex> lock(workers_latch_);
+  done_cv_.wait(lock, [this] { return busy_workers_ == 0; });
+  task_ = nullptr;
+}
+
+void HashJoinExecutor::RunWorker() {
+  // The workers are started before the first ParallelFor, which they may only get to see once it is under way.
+  uint64_t round = 0;
+  std::unique_lock<std::mutex> lock(workers_latch_);
+  while (true) {
+    workers_cv_.wait(lock, [&] { return stop_workers_ || round_ != round; });
+    if (stop_workers_) {
+      return;
+    }
+    round = round_;
+    lock.unlock();
+    RunTasks();
+    lock.lock();
+    if (--busy_workers_ == 0) {
+      done_cv_.notify_one();
+    }
+  }
+}
+
+void HashJoinExecutor::RunTasks() {
+  for (size_t i = next_task_++; i < num_tasks_; i = next_task_++) {
+    (*task_)(i);
+  }
+}
+
+void HashJoinExecutor::BuildPartition(Partition *partition) {
+  size_t num_buckets = 1;
+  while (num_buckets < partition->rows_.size()) {
+    num_buckets <<= 1;
+  }
+  partition->buckets_.assign(num_buckets, NO_ROW);
+  // the low bits of the hash pick the bucket, as the high ones already picked the partition
+  for (size_t i = 0; i < partition->rows_.size(); i++) {
+    size_t &head = partition->buckets_[partition->rows_[i].hash_ & (num_buckets - 1)];
+    partition->rows_[i].next_ = head;
+    head = i;
+  }
+}
+
+void HashJoinExecutor::Init() {
+  for (size_t i = workers_.size(); i + 1 < static_cast<size_t>(HASH_JOIN_THREADS); i++) {
+    workers_.emplace_back(&HashJoinExecutor::RunWorker, this);
+  }
   left_child_executor_->Init();
   right_child_executor_->Init();
+  right_exhausted_ = false;
+  partitions_.assign(NUM_PARTITIONS, Partition());
+  probe_rows_.assign(NUM_PARTITIONS, {});
+  output_.assign(NUM_PARTITIONS, {});
+  output_partition_ = NUM_PARTITIONS;
+  output_index_ = 0;
+
+  const Schema *left_schema = plan_->GetLeftPlan()->OutputSchema();
   Tuple left_tuple;
   RID left_rid;
   while (left_child_executor_->Next(&left_tuple, &left_rid)) {
-    Value key_value = plan_->LeftJoinKeyExpression()->Evaluate(&left_tuple, plan_->GetLeftPlan()->OutputSchema());
-    auto left_col_count = plan_->GetLeftPlan()->OutputSchema()->GetColumnCount();
-    std::vector<Value> values;
-    values.reserve(left_col_count);
-    for (uint32_t i = 0; i < left_col_count; i++) {
-      values.push_back(left_tuple.GetValue(plan_->GetLeftPlan()->OutputSchema(), i));
+    Value key = plan_->LeftJoinKeyExpression()->Evaluate(&left_tuple, left_schema);
+    if (key.IsNull()) {
+      // null joins with nothing
+      continue;
     }
-    HashJoinKey key{key_value};
-    if (hash_table_.count(key) > 0) {
-      hash_table_[key].push_back(std::move(values));
-    } else {
-      // C++11新特性，{}可用来初始化vector
-      // hash_table_[key] = {values};
-      // 外面的{}是pair对，内部的{}是初始化vector
-      hash_table_.insert({key, {values}});
-      // pair与make_pair https://www.thinbug.com/q/41325199
-      // hash_table_.insert(std::pair<HashJoinKey, std::vector<std::vector<Value>>>(key, {values}));
+    hash_t hash = HashKey(key);
+    Partition &partition = partitions_[PartitionOf(hash)];
+    size_t offset = partition.arena_.size();
+    partition.arena_.resize(offset + sizeof(uint32_t) + left_tuple.GetLength());
+    left_tuple.SerializeTo(partition.arena_.data() + offset);
+    partition.rows_.push_back({hash, offset, NO_ROW});
+  }
+  ParallelFor(NUM_PARTITIONS, [this](size_t i) { BuildPartition(&partitions_[i]); });
+}
+
+void HashJoinExecutor::ProbePartition(const Partition &partition, const std::vector<ProbeRow> &probe_rows,
+                                      std::vector<Tuple> *output) const {
+  if (partition.rows_.empty()) {
+    return;
+  }
+  const Schema *left_schema = plan_->GetLeftPlan()->OutputSchema();
+  const Schema *right_schema = plan_->GetRightPlan()->OutputSchema();
+  const Schema *output_schema = plan_->OutputSchema();
+  size_t bucket_mask = partition.buckets_.size() - 1;
+  std::vector<Value> values;
+  values.reserve(output_schema->GetColumnCount());
+  for (const auto &probe_row : probe_rows) {
+    const Tuple &right_tuple = probe_tuples_[probe_row.tuple_idx_];
+    for (size_t i = partition.buckets_[probe_row.hash_ & bucket_mask]; i != NO_ROW; i = partition.rows_[i].next_) {
+      const BuildRow &row = partition.rows_[i];
+      if (row.hash_ != probe_row.hash_) {
+        continue;
+      }
+      const char *storage = partition.arena_.data() + row.offset_;
+      uint32_t size;
+      memcpy(&size, storage, sizeof(uint32_t));
+      // reads the left tuple in the arena instead of copying it out
+      const Tuple left_tuple(storage + sizeof(uint32_t), size);
+      if (plan_->LeftJoinKeyExpression()->Evaluate(&left_tuple, left_schema).CompareEquals(probe_row.key_) !=
+          CmpBool::CmpTrue) {
+        continue;
+      }
+      values.clear();
+      for (const auto &column : output_schema->GetColumns()) {
+        values.push_back(column.GetExpr()->EvaluateJoin(&left_tuple, left_schema, &right_tuple, right_schema));
+      }
+      output->emplace_back(values, output_schema);
     }
   }
 }
 
-void HashJoinExecutor::Init() {
-  left_child_executor_->Init();
-  right_child_executor_->Init();
-  bucket_index_ = 0;
-  bucket_list_ = {};
+bool HashJoinExecutor::ProbeNextBatch() {
+  const Schema *right_schema = plan_->GetRightPlan()->OutputSchema();
+  probe_tuples_.clear();
+  for (auto &probe_rows : probe_rows_) {
+    probe_rows.clear();
+  }
+  Tuple right_tuple;
+  RID right_rid;
+  while (!right_exhausted_ && probe_tuples_.size() < HASH_JOIN_PROBE_BATCH_SIZE) {
+    if (!right_child_executor_->Next(&right_tuple, &right_rid)) {
+      right_exhausted_ = true;
+      break;
+    }
+    Value key = plan_->RightJoinKeyExpression()->Evaluate(&right_tuple, right_schema);
+    if (key.IsNull()) {
+      continue;
+    }
+    hash_t hash = HashKey(key);
+    probe_rows_[PartitionOf(hash)].push_back({hash, probe_tuples_.size(), key});
+    probe_tuples_.push_back(right_tuple);
+  }
+  if (probe_tuples_.empty()) {
+    return false;
+  }
+  ParallelFor(NUM_PARTITIONS, [this](size_t i) {
+    output_[i].clear();
+    ProbePartition(partitions_[i], probe_rows_[i], &output_[i]);
+  });
+  output_partition_ = 0;
+  output_index_ = 0;
+  return true;
 }
 
 bool HashJoinExecutor::Next(Tuple *tuple, RID *rid) {
-  bool right_over = true;
-  if (bucket_index_ == bucket_list_.size()) {
-    // 上一个bucket_list遍历完了，获取新的bucket_list
-    while (right_child_executor_->Next(tuple, rid)) {
-      Value key_value = plan_->RightJoinKeyExpression()->Evaluate(tuple, plan_->GetRightPlan()->OutputSchema());
-      HashJoinKey key{key_value};
-      if (hash_table_.count(key) > 0) {
-        bucket_index_ = 0;
-        bucket_list_ = hash_table_[key];
-        right_over = false;
-        break;
+  while (true) {
+    for (; output_partition_ < NUM_PARTITIONS; output_partition_++, output_index_ = 0) {
+      if (output_index_ < output_[output_partition_].size()) {
+        *tuple = output_[output_partition_][output_index_++];
+        return true;
       }
     }
-    if (right_over) {
+    if (!ProbeNextBatch()) {
       return false;
     }
   }
-  std::vector<Value> values;
-  values.reserve(plan_->OutputSchema()->GetColumnCount());
-  for (auto column : plan_->OutputSchema()->GetColumns()) {
-    auto column_expr = reinterpret_cast<const ColumnValueExpression *>(column.GetExpr());
-    if (column_expr->GetTupleIdx() == 0) {
-      values.push_back(bucket_list_[bucket_index_][column_expr->GetColIdx()]);
-    } else {
-      values.push_back(tuple->GetValue(plan_->GetRightPlan()->OutputSchema(), column_expr->GetColIdx()));
-    }
-  }
-  *tuple = Tuple(values, plan_->OutputSchema());
-  bucket_index_++;
-  return true;
 }
+
 }  // namespace bustub
@@ -11,12 +11,321 @@
 //===----------------------------------------------------------------------===//
 #include "execution/executors/index_scan_executor.h"
 
+#include <algorithm>
+#include <optional>
+
+#include "common/config.h"
+#include "common/exception.h"
+#include "concurrency/lock_manager.h"
+#include "concurrency/transaction.h"
+#include "execution/expressions/column_value_expression.h"
+#include "execution/expressions/constant_value_expression.h"
+#include "execution/expressions/logic_expression.h"
+#include "storage/index/b_plus_tree_index.h"
+
 namespace bustub {
+
+namespace {
+
+CmpBool Compare(const Value &lhs, ComparisonType comp_type, const Value &rhs) {
+  switch (comp_type) {
+    case ComparisonType::Equal:
+      return lhs.CompareEquals(rhs);
+    case ComparisonType::NotEqual:
+      return lhs.CompareNotEquals(rhs);
+    case ComparisonType::LessThan:
+      return lhs.CompareLessThan(rhs);
+    case ComparisonType::LessThanOrEqual:
+      return lhs.CompareLessThanEquals(rhs);
+    case ComparisonType::GreaterThan:
+      return lhs.CompareGreaterThan(rhs);
+    case ComparisonType::GreaterThanOrEqual:
+      return lhs.CompareGreaterThanEquals(rhs);
+    default:
+      BUSTUB_ASSERT(false, "Unsupported comparison type.");
+  }
+}
+
+/** @return the comparison with its sides swapped, so that (a comp b) is (b Flip(comp) a) */
+ComparisonType Flip(ComparisonType comp_type) {
+  switch (comp_type) {
+    case ComparisonType::LessThan:
+      return ComparisonType::GreaterThan;
+    case ComparisonType::LessThanOrEqual:
+      return ComparisonType::GreaterThanOrEqual;
+    case ComparisonType::GreaterThan:
+      return ComparisonType::LessThan;
+    case ComparisonType::GreaterThanOrEqual:
+      return ComparisonType::LessThanOrEqual;
+    default:
+      return comp_type;
+  }
+}
+
+}  // namespace
+
+template <size_t KeySize>
+class IndexScanExecutor::TreeCursor : public IndexScanExecutor::Cursor {
+ public:
+  using KeyType = GenericKey<KeySize>;
+  using TreeIndex = BPlusTreeIndex<KeyType, RID, GenericComparator<KeySize>>;
+
+  TreeCursor(TreeIndex *index, bool reverse, const std::vector<KeyBound> &lower_bounds,
+             const std::vector<KeyBound> &upper_bounds)
+      : key_schema_(index->GetKeySchema()), comparator_(key_schema_), reverse_(reverse) {
+    // Of several bounds on the same end, the tightest one wins.
+    for (const auto &bound : lower_bounds) {
+      KeyType key = MakeKey(bound);
+      if (!lower_.has_value() || comparator_(key, *lower_) > 0) {
+        lower_ = key;
+      }
+    }
+    for (const auto &bound : upper_bounds) {
+      KeyType key = MakeKey(bound);
+      if (!upper_.has_value() || comparator_(key, *upper_) < 0) {
+        upper_ = key;
+      }
+    }
+    if (reverse_) {
+      iterator_ = upper_.has_value() ? index->GetReverseBeginIterator(*upper_) : index->GetReverseBeginIterator();
+    } else {
+      iterator_ = lower_.has_value() ? index->GetBeginIterator(*lower_) : index->GetBeginIterator();
+    }
+  }
+
+  bool IsEnd() override {
+    if (iterator_.IsEnd()) {
+      return true;
+    }
+    // The walk starts at one bound and stops as soon as it passes the other.
+    const KeyType &key = (*iterator_).first;
+    return reverse_ ? lower_.has_value() && comparator_(key, *lower_) < 0
+                    : upper_.has_value() && comparator_(key, *upper_) > 0;
+  }
+
+  RID GetRID() override { return (*iterator_).second; }
+
+  Value GetKeyValue(uint32_t key_column) override { return (*iterator_).first.ToValue(key_schema_, key_column); }
+
+  void Advance() override {
+    if (reverse_) {
+      --iterator_;
+    } else {
+      ++iterator_;
+    }
+  }
+
+ private:
+  KeyType MakeKey(const KeyBound &bound) const {
+    KeyType key;
+    key.SetFromPrefix(bound.values_, key_schema_, bound.fill_);
+    return key;
+  }
+
+  Schema *key_schema_;
+  GenericComparator<KeySize> comparator_;
+  bool reverse_;
+  std::optional<KeyType> lower_;
+  std::optional<KeyType> upper_;
+  IndexIterator<KeyType, RID, GenericComparator<KeySize>> iterator_;
+};
+
 IndexScanExecutor::IndexScanExecutor(ExecutorContext *exec_ctx, const IndexScanPlanNode *plan)
-    : AbstractExecutor(exec_ctx) {}
+    : AbstractExecutor(exec_ctx), plan_(plan) {
+  index_info_ = exec_ctx->GetCatalog()->GetIndex(plan->GetIndexOid());
+  table_info_ = exec_ctx->GetCatalog()->GetTable(index_info_->table_name_);
+  out_schema_idx_.reserve(plan_->OutputSchema()->GetColumnCount());
+  for (uint32_t i = 0; i < plan_->OutputSchema()->GetColumnCount(); i++) {
+    auto column_name = plan->OutputSchema()->GetColumn(i).GetName();
+    out_schema_idx_.push_back(table_info_->schema_.GetColIdx(column_name));
+  }
+
+  if (plan_->GetPredicate() != nullptr) {
+    SplitPredicate(plan_->GetPredicate());
+  }
+  DeriveBounds();
+
+  const auto &key_attrs = index_info_->index_->GetKeyAttrs();
+  index_only_ = residual_predicates_.empty();
+  for (uint32_t i = 0; index_only_ && i < out_schema_idx_.size(); i++) {
+    auto key_attr = std::find(key_attrs.begin(), key_attrs.end(), out_schema_idx_[i]);
+    index_only_ = key_attr != key_attrs.end();
+    out_key_idx_.push_back(static_cast<uint32_t>(key_attr - key_attrs.begin()));
+  }
+  if (!index_only_) {
+    out_key_idx_.clear();
+  }
+}
+
+/*
+ * Sort the conjuncts of predicate into comparisons of a key column with a
+ * constant, which are checked on the key, and the rest
+ */
+void IndexScanExecutor::SplitPredicate(const AbstractExpression *predicate) {
+  if (const auto *logic = dynamic_cast<const LogicExpression *>(predicate);
+      logic != nullptr && logic->GetLogicType() == LogicType::And) {
+    SplitPredicate(logic->GetChildAt(0));
+    SplitPredicate(logic->GetChildAt(1));
+    return;
+  }
+  if (const auto *comparison = dynamic_cast<const ComparisonExpression *>(predicate); comparison != nullptr) {
+    ComparisonType comp_type = comparison->GetComparisonType();
+    const auto *column = dynamic_cast<const ColumnValueExpression *>(comparison->GetChildAt(0));
+    const auto *constant = dynamic_cast<const ConstantValueExpression *>(comparison->GetChildAt(1));
+    if (column == nullptr && constant == nullptr) {
+      column = dynamic_cast<const ColumnValueExpression *>(comparison->GetChildAt(1));
+      constant = dynamic_cast<const ConstantValueExpression *>(comparison->GetChildAt(0));
+      comp_type = Flip(comp_type);
+    }
+    if (column != nullptr && constant != nullptr && column->GetTupleIdx() == 0) {
+      const auto &key_attrs = index_info_->index_->GetKeyAttrs();
+      auto key_attr = std::find(key_attrs.begin(), key_attrs.end(), column->GetColIdx());
+      if (key_attr != key_attrs.end()) {
+        auto key_column = static_cast<uint32_t>(key_attr - key_attrs.begin());
+        key_predicates_.push_back({key_column, comp_type, constant->Evaluate(nullptr, nullptr)});
+        return;
+      }
+    }
+  }
+  residual_predicates_.push_back(predicate);
+}
+
+/*
+ * Turn the key predicates into bounds on the keys to walk: the equalities on
+ * leading key columns fix a prefix, and the comparisons on the column after
+ * them bound it further. Only constants of the column's own type can be
+ * encoded into a key; the others are left to be checked on the key.
+ */
+void IndexScanExecutor::DeriveBounds() {
+  const Schema &key_schema = index_info_->key_schema_;
+  auto usable = [&key_schema](const KeyPredicate &predicate) {
+    return !predicate.value_.IsNull() &&
+           predicate.value_.GetTypeId() == key_schema.GetColumn(predicate.key_column_).GetType();
+  };
+
+  std::vector<Value> prefix;
+  for (uint32_t key_column = 0; key_column < key_schema.GetColumnCount(); key_column++) {
+    auto equal = std::find_if(key_predicates_.begin(), key_predicates_.end(), [&](const KeyPredicate &predicate) {
+      return predicate.key_column_ == key_column && predicate.comp_type_ == ComparisonType::Equal && usable(predicate);
+    });
+    if (equal != key_predicates_.end()) {
+      prefix.push_back(equal->value_);
+      continue;
+    }
+    for (const auto &predicate : key_predicates_) {
+      if (predicate.key_column_ != key_column || !usable(predicate)) {
+        continue;
+      }
+      std::vector<Value> values = prefix;
+      values.push_back(predicate.value_);
+      switch (predicate.comp_type_) {
+        case ComparisonType::GreaterThan:
+          lower_bounds_.push_back({std::move(values), 0xFF});
+          break;
+        case ComparisonType::GreaterThanOrEqual:
+          lower_bounds_.push_back({std::move(values), 0});
+          break;
+        case ComparisonType::LessThan:
+          upper_bounds_.push_back({std::move(values), 0});
+          break;
+        case ComparisonType::LessThanOrEqual:
+          upper_bounds_.push_back({std::move(values), 0xFF});
+          break;
+        default:
+          break;
+      }
+    }
+    break;
+  }
+  if (!prefix.empty()) {
+    lower_bounds_.push_back({prefix, 0});
+    upper_bounds_.push_back({prefix, 0xFF});
+  }
+}
+
+template <size_t KeySize>
+std::unique_ptr<IndexScanExecutor::Cursor> IndexScanExecutor::MakeCursor() const {
+  auto *index = dynamic_cast<typename TreeCursor<KeySize>::TreeIndex *>(index_info_->index_.get());
+  if (index == nullptr) {
+    throw Exception(ExceptionType::INVALID, "index scan needs a B+ tree index");
+  }
+  return std::make_unique<TreeCursor<KeySize>>(index, plan_->IsReverse(), lower_bounds_, upper_bounds_);
+}
+
+void IndexScanExecutor::Init() {
+  switch (index_info_->key_size_) {
+    case 4:
+      cursor_ = MakeCursor<4>();
+      break;
+    case 8:
+      cursor_ = MakeCursor<8>();
+      break;
+    case 16:
+      cursor_ = MakeCursor<16>();
+      break;
+    case 32:
+      cursor_ = MakeCursor<32>();
+      break;
+    case 64:
+      cursor_ = MakeCursor<64>();
+      break;
+    default:
+      throw Exception(ExceptionType::INVALID, "index scan needs a B+ tree index");
+  }
+}
 
-void IndexScanExecutor::Init() {}
+bool IndexScanExecutor::MatchesKey() const {
+  return std::all_of(key_predicates_.begin(), key_predicates_.end(), [this](const KeyPredicate &predicate) {
+    return Compare(cursor_->GetKeyValue(predicate.key_column_), predicate.comp_type_, predicate.value_) ==
+           CmpBool::CmpTrue;
+  });
+}
 
-bool IndexScanExecutor::Next(Tuple *tuple, RID *rid) { return false; }
+bool IndexScanExecutor::Next(Tuple *tuple, RID *rid) {
+  for (; !cursor_->IsEnd(); cursor_->Advance()) {
+    // The key rules out most tuples without a trip to the table heap.
+    if (!MatchesKey()) {
+      continue;
+    }
+    if (index_only_) {
+      *rid = cursor_->GetRID();
+      // The tuple is not read, but it is locked as TableHeap::GetTuple would.
+      auto *txn = exec_ctx_->GetTransaction();
+      if (enable_logging && !txn->IsSharedLocked(*rid) && !txn->IsExclusiveLocked(*rid) &&
+          !exec_ctx_->GetLockManager()->LockShared(txn, *rid)) {
+        continue;
+      }
+      std::vector<Value> values;
+      values.reserve(out_key_idx_.size());
+      for (auto i : out_key_idx_) {
+        values.push_back(cursor_->GetKeyValue(i));
+      }
+      *tuple = Tuple(values, plan_->OutputSchema());
+      cursor_->Advance();
+      return true;
+    }
+    Tuple table_tuple;
+    if (!table_info_->table_->GetTuple(cursor_->GetRID(), &table_tuple, exec_ctx_->GetTransaction())) {
+      continue;
+    }
+    bool matches = std::all_of(
+        residual_predicates_.begin(), residual_predicates_.end(), [&](const AbstractExpression *predicate) {
+          return predicate->Evaluate(&table_tuple, &table_info_->schema_).GetAs<bool>();
+        });
+    if (!matches) {
+      continue;
+    }
+    std::vector<Value> values;
+    values.reserve(out_schema_idx_.size());
+    for (auto i : out_schema_idx_) {
+      values.push_back(table_tuple.GetValue(&table_info_->schema_, i));
+    }
+    *tuple = Tuple(values, plan_->OutputSchema());
+    *rid = table_tuple.GetRid();
+    cursor_->Advance();
+    return true;
+  }
+  return false;
+}
 
 }  // namespace bustub
@@ -24,10 +24,12 @@ void LimitExecutor::Init() {
 }
 
 bool LimitExecutor::Next(Tuple *tuple, RID *rid) {
-  if (child_executor_->Next(tuple, rid) && cnt_++ < plan_->GetLimit()) {
-    return true;
+  // Check the count first, so that a child such as an index scan is not asked for a row past the limit
+  if (cnt_ >= plan_->GetLimit() || !child_executor_->Next(tuple, rid)) {
+    return false;
   }
-  return false;
+  cnt_++;
+  return true;
 }
 
 }  // namespace bustub
@@ -15,6 +15,8 @@
 #include <list>
 #include <mutex>  // NOLINT
 #include <unordered_map>
+#include <utility>
+#include <vector>
 
 #include "buffer/lru_replacer.h"
 #include "recovery/log_manager.h"
@@ -87,6 +89,28 @@ class BufferPoolManager {
   /** @return size of the buffer pool */
   virtual size_t GetPoolSize() = 0;
 
+  /**
+   * Hint that the given pages will be fetched soon. The buffer pool may load them in the background without pinning
+   * them, or ignore the hint altogether.
+   * @param page_ids ids of the pages to read ahead
+   */
+  virtual void PrefetchPages(const std::vector<page_id_t> &page_ids) {}
+
+  /**
+   * Collect the dirty page table for a fuzzy checkpoint: every resident page that may hold logged changes that are not
+   * on disk, with its recLSN. Pages are latched one at a time, just long enough to read their recLSN.
+   * @param[out] dirty_page_table (page id, recLSN) pairs are appended here
+   */
+  virtual void GetDirtyPageTable(std::vector<std::pair<page_id_t, lsn_t>> *dirty_page_table) = 0;
+
+  /**
+   * Write back pages for a checkpoint. Each page is written under its read latch once the log up to its LSN is on disk,
+   * so only writers of that one page wait. Pages that were written back or evicted meanwhile are skipped. Nothing is
+   * forced to stable storage.
+   * @param page_ids ids of the pages to write
+   */
+  virtual void FlushCheckpointPages(const std::vector<page_id_t> &page_ids) = 0;
+
  protected:
   /**
    * Grading function. Do not modify!
@@ -105,6 +129,7 @@ class BufferPoolManager {
    * Fetch the requested page from the buffer pool.
    * @param page_id id of page to be fetched
    * @return the requested page
+   * @throws CorruptedPageException if the page had to be read and does not match its checksum
    */
   virtual Page *FetchPgImp(page_id_t page_id) = 0;
 
@@ -12,12 +12,22 @@
 
 #pragma once
 
+#include <climits>
+#include <condition_variable>  // NOLINT
+#include <deque>
 #include <list>
-#include <mutex>  // NOLINT
-#include <unordered_map>
+#include <mutex>   // NOLINT
+#include <thread>  // NOLINT
+#include <unordered_set>
+#include <utility>
+#include <vector>
 
 #include "buffer/buffer_pool_manager.h"
+#include "buffer/frame_arena.h"
+#include "buffer/lru_k_replacer.h"
 #include "buffer/lru_replacer.h"
+#include "buffer/page_table.h"
+#include "buffer/two_queue_replacer.h"
 #include "recovery/log_manager.h"
 #include "storage/disk/disk_manager.h"
 #include "storage/page/page.h"
@@ -34,8 +44,10 @@ class BufferPoolManagerInstance : public BufferPoolManager {
    * @param pool_size the size of the buffer pool
    * @param disk_manager the disk manager
    * @param log_manager the log manager (for testing only: nullptr = disable logging)
+   * @param replacer_type the replacement policy used to pick victim frames
    */
-  BufferPoolManagerInstance(size_t pool_size, DiskManager *disk_manager, LogManager *log_manager = nullptr);
+  BufferPoolManagerInstance(size_t pool_size, DiskManager *disk_manager, LogManager *log_manager = nullptr,
+                            ReplacerType replacer_type = ReplacerType::LRU);
   /**
    * Creates a new BufferPoolManagerInstance.
    * @param pool_size the size of the buffer pool
@@ -43,9 +55,11 @@ class BufferPoolManagerInstance : public BufferPoolManager {
    * @param instance_index index of this BPI in the parallel BPM
    * @param disk_manager the disk manager
    * @param log_manager the log manager (for testing only: nullptr = disable logging)
+   * @param replacer_type the replacement policy used to pick victim frames
    */
   BufferPoolManagerInstance(size_t pool_size, uint32_t num_instances, uint32_t instance_index,
-                            DiskManager *disk_manager, LogManager *log_manager = nullptr);
+                            DiskManager *disk_manager, LogManager *log_manager = nullptr,
+                            ReplacerType replacer_type = ReplacerType::LRU);
 
   /**
    * Destroys an existing BufferPoolManagerInstance.
@@ -58,6 +72,60 @@ class BufferPoolManagerInstance : public BufferPoolManager {
   /** @return pointer to all the pages in the buffer pool */
   Page *GetPages() { return pages_; }
 
+  /**
+   * Queue pages for the background prefetcher. Pages that are already resident or not on disk are skipped,
+   * and the prefetcher only takes frames from the free list or the replacer, never waiting for one.
+   * @param page_ids ids of the pages to read ahead, all owned by this instance
+   */
+  void PrefetchPages(const std::vector<page_id_t> &page_ids) override;
+
+  /**
+   * Collect the recLSN of every resident page that has one. Each page is write latched while its recLSN is read, so
+   * that a change logged before the call is never missed, and evictions that were under way have finished on return.
+   * @param[out] dirty_page_table (page id, recLSN) pairs are appended here
+   */
+  void GetDirtyPageTable(std::vector<std::pair<page_id_t, lsn_t>> *dirty_page_table) override;
+
+  /**
+   * Write back the given pages, if still resident with a recLSN, one at a time under their read latch.
+   * @param page_ids ids of the pages to write, all owned by this instance
+   */
+  void FlushCheckpointPages(const std::vector<page_id_t> &page_ids) override;
+
+  /** @return the number of pages the prefetcher loaded */
+  uint64_t GetNumPrefetchedPages() const { return num_prefetched_pages_; }
+
+  /** @return the number of dirty pages the background cleaner wrote back */
+  uint64_t GetNumCleanedPages() const { return num_cleaned_pages_; }
+
+  /** @return the number of dirty victims that had to be written back on the eviction path */
+  uint64_t GetNumInlineWritebacks() const { return num_inline_writebacks_; }
+
+  /**
+   * Pin every dirty page in the pool and clear its dirty flag, so that the caller can write the pages back in one
+   * batch. The pins keep the pages resident until ReleaseDirtyPages() is called.
+   * @param[out] pages the collected pages are appended here
+   */
+  void CollectDirtyPages(std::vector<Page *> *pages);
+
+  /**
+   * Drop the pins taken by CollectDirtyPages().
+   * @param pages pages collected from this instance
+   */
+  void ReleaseDirtyPages(const std::vector<Page *> &pages);
+
+  /**
+   * Write back a batch of pages sorted by page id, each under its read latch. Pages with consecutive ids are
+   * coalesced into a single vectored write, before which the log is forced up to their highest page LSN. The pages are
+   * not forced to stable storage.
+   * @param disk_manager the disk manager to write through
+   * @param log_manager the log manager, or nullptr if logging is disabled
+   * @param begin first page of the batch
+   * @param end one past the last page of the batch
+   */
+  static void WriteSortedPages(DiskManager *disk_manager, LogManager *log_manager,
+                               std::vector<Page *>::const_iterator begin, std::vector<Page *>::const_iterator end);
+
  protected:
   /**
    * Fetch the requested page from the buffer pool.
@@ -96,7 +164,8 @@ class BufferPoolManagerInstance : public BufferPoolManager {
   bool DeletePgImp(page_id_t page_id) override;
 
   /**
-   * Flushes all the pages in the buffer pool to disk.
+   * Flushes all the pages in the buffer pool to disk. Dirty pages are written in page id order, runs of adjacent
+   * pages are coalesced, and the disk is synced once at the end.
    */
   void FlushAllPgsImp() override;
 
@@ -121,10 +190,77 @@ class BufferPoolManagerInstance : public BufferPoolManager {
    */
   void ValidatePageId(page_id_t page_id) const;
 
-  void FlushPg(page_id_t page_id);
+  /**
+   * Try to pin a resident page without holding the instance latch.
+   * @param frame_id frame that the page table mapped the page to
+   * @param page_id id of the page the caller expects in the frame
+   * @return true if the frame still holds the page and is now pinned, false otherwise
+   */
+  bool TryPin(frame_id_t frame_id, page_id_t page_id);
+
+  /**
+   * Write the page held in the frame back to disk if it is dirty. The caller must hold the page's read latch, or be
+   * evicting the page, so that nobody changes it between its checksum and its write.
+   * @return true if the page was dirty and has been written
+   */
+  bool FlushPg(frame_id_t frame_id);
+  /**
+   * Write a page back to disk. Every single-page write goes through here, so that write-ahead logging holds on each
+   * path: the log is forced up to the page LSN before the page is written.
+   */
+  void WritePage(Page *page);
+  /** @return the LSN of the last logged change in the page, or INVALID_LSN if it has none since it was written */
+  static lsn_t LoggedLSN(Page *page);
+  /** Wait until the log is on disk up to lsn, unless logging is disabled or lsn is INVALID_LSN. */
+  static void ForceLog(LogManager *log_manager, lsn_t lsn);
+
+  /** Mark the page held in a frame dirty, waking the page cleaner if the pool crosses its dirty-ratio mark. */
+  void MarkDirty(Page *page);
+
+  /** @return true if more than page_cleaner_dirty_ratio of the pool is dirty */
+  bool AboveDirtyRatio() const;
+
+  /**
+   * Body of the background page cleaner. It sweeps the frames like a clock hand and writes back unpinned dirty pages
+   * while the pool is above its dirty-ratio mark, so that the replacer mostly finds clean victims.
+   */
+  void RunPageCleaner();
+
+  /**
+   * Write back one frame if it holds an unpinned dirty page, without the instance latch.
+   * @return true if a page was written
+   */
+  bool CleanFrame(frame_id_t frame_id);
+
+  /** Body of the background prefetcher, which loads the pages queued by PrefetchPages(). */
+  void RunPrefetcher();
+
+  /**
+   * Load the queued pages without pinning them. The queue is taken and frames are claimed under the latch, and one
+   * asynchronous read is submitted per run of consecutive ids. Each read's completion publishes its frames. Returns
+   * once the whole batch has completed.
+   */
+  void LoadPages();
+
+  /**
+   * Make a frame that the prefetcher read a page into visible, unpinned and evictable, or return it to the free list
+   * if a fetch or a delete of the same page invalidated the read in the meantime. Must hold latch_.
+   */
+  void PublishPrefetchedPage(page_id_t page_id, frame_id_t frame_id);
 
+  /**
+   * Pick a frame from the free list or the replacer, evicting its page if necessary. Must hold latch_.
+   * @return the claimed frame, whose pin count is PIN_COUNT_EVICTING, or -1 if every frame is pinned
+   */
   frame_id_t FindReplacedPage();
 
+  /**
+   * Pin count of a frame that is on the free list or being evicted. Latch-free pinners that observe a negative count
+   * back off and retry under the latch; the value is far enough below zero that their transient increments never
+   * make it look pinned.
+   */
+  static constexpr int PIN_COUNT_EVICTING = INT_MIN / 2;
+
   /** Number of pages in the buffer pool. */
   const size_t pool_size_;
   /** How many instances are in the parallel BPM (if present, otherwise just 1 BPI) */
@@ -134,19 +270,50 @@ class BufferPoolManagerInstance : public BufferPoolManager {
   /** Each BPI maintains its own counter for page_ids to hand out, must ensure they mod back to its instance_index_ */
   std::atomic<page_id_t> next_page_id_ = instance_index_;
 
-  /** Array of buffer pool pages. */
+  /** Frame data of all pages, aligned for direct I/O. */
+  FrameArena frame_arena_;
+  /** Array of buffer pool pages. Their data points into frame_arena_. */
   Page *pages_;
   /** Pointer to the disk manager. */
   DiskManager *disk_manager_ __attribute__((__unused__));
   /** Pointer to the log manager. */
-  LogManager *log_manager_ __attribute__((__unused__));
-  /** Page table for keeping track of buffer pool pages. */
-  std::unordered_map<page_id_t, frame_id_t> page_table_;
+  LogManager *log_manager_;
+  /** Page table for keeping track of buffer pool pages. Lookups are latch-free, updates require latch_. */
+  PageTable page_table_;
   /** Replacer to find unpinned pages for replacement. */
   Replacer *replacer_;
   /** List of free pages. */
   std::list<frame_id_t> free_list_;
-  /** This latch protects shared data structures. We recommend updating this comment to describe what it protects. */
+  /** Number of frames whose page is dirty. */
+  std::atomic<size_t> num_dirty_frames_{0};
+  /** Pages written back by the page cleaner. */
+  std::atomic<uint64_t> num_cleaned_pages_{0};
+  /** Dirty victims written back synchronously by FindReplacedPage. */
+  std::atomic<uint64_t> num_inline_writebacks_{0};
+  /** Background page cleaner; cleaner_latch_ and cleaner_cv_ only serve to sleep and wake it. */
+  std::thread cleaner_thread_;
+  std::atomic<bool> cleaner_running_{true};
+  std::mutex cleaner_latch_;
+  std::condition_variable cleaner_cv_;
+  /** Frame the page cleaner has pinned to write back, or -1. Eviction waits for it instead of giving up. */
+  std::atomic<frame_id_t> cleaning_frame_{-1};
+  /** Pages loaded by the prefetcher. */
+  std::atomic<uint64_t> num_prefetched_pages_{0};
+  /**
+   * Background prefetcher and the queue of page ids it has yet to load, protected by prefetch_latch_. Whoever holds
+   * both latches takes latch_ first.
+   */
+  std::thread prefetch_thread_;
+  bool prefetcher_running_{true};
+  std::deque<page_id_t> prefetch_queue_;
+  /** Pages being read ahead. FetchPg and DeletePg remove their page to invalidate the read. Protected by latch_. */
+  std::unordered_set<page_id_t> prefetching_;
+  std::mutex prefetch_latch_;
+  std::condition_variable prefetch_cv_;
+  /**
+   * This latch serializes page table updates, the free list and every change of a frame's resident page. Pinning and
+   * unpinning a page that is already resident does not take it.
+   */
   std::mutex latch_;
 };
 }  // namespace bustub
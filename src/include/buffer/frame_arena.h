@@ -0,0 +1,55 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// frame_arena.h
+//
+// Identification: src/include/buffer/frame_arena.h
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <cstddef>
+
+#include "common/config.h"
+
+namespace bustub {
+
+/**
+ * FrameArena holds the data of every frame of a buffer pool in one anonymous mapping. Each frame starts on a
+ * PAGE_SIZE boundary, which O_DIRECT I/O requires of its buffers.
+ *
+ * With huge pages requested the arena first tries explicit huge pages (MAP_HUGETLB), then falls back to normal pages
+ * with a transparent huge page hint, so that a large pool needs fewer TLB entries either way.
+ */
+class FrameArena {
+ public:
+  /**
+   * Map the arena. The memory starts out zeroed.
+   * @param num_frames number of PAGE_SIZE frames
+   * @param huge_pages true to back the arena with huge pages if possible
+   * @throws Exception if the memory cannot be mapped
+   */
+  FrameArena(size_t num_frames, bool huge_pages);
+
+  ~FrameArena();
+
+  FrameArena(const FrameArena &) = delete;
+  FrameArena &operator=(const FrameArena &) = delete;
+
+  /** @return the data of a frame */
+  inline char *GetFrame(frame_id_t frame_id) { return data_ + static_cast<size_t>(frame_id) * PAGE_SIZE; }
+
+  /** @return true if the arena is backed by explicit huge pages */
+  bool UsesHugePages() const { return uses_huge_pages_; }
+
+ private:
+  char *data_;
+  size_t size_;
+  bool uses_huge_pages_{false};
+};
+
+}  // namespace bustub
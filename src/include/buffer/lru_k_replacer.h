@@ -0,0 +1,104 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// lru_k_replacer.h
+//
+// Identification: src/include/buffer/lru_k_replacer.h
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <mutex>  // NOLINT
+#include <set>
+#include <tuple>
+#include <vector>
+
+#include "buffer/replacer.h"
+#include "common/config.h"
+
+namespace bustub {
+
+/**
+ * LRUKReplacer implements the LRU-K replacement policy.
+ *
+ * The victim is the evictable frame with the largest backward K-distance, i.e. the longest time since its K-th most
+ * recent reference. Frames with fewer than K references have an infinite distance and are evicted first, the one with
+ * the oldest reference first. Time is a logical clock that advances on every reference the replacer sees.
+ *
+ * References that arrive within the correlated reference period of the previous one (for example the FetchPage /
+ * UnpinPage pairs of a single B+ tree traversal, or a scan revisiting its page per tuple) count as one reference, so
+ * bursts do not look like reuse. A frame is not chosen as a victim while it is still inside its correlated period
+ * unless no other frame can be evicted.
+ *
+ * The evictable frames are kept ordered by K-distance, so a victim is found in O(log n). Frames inside their correlated
+ * period are skipped on the way; as the clock ticks once per reference, there are at most correlated_period of them.
+ * The rest of the bookkeeping lives in flat arrays indexed by frame id that are sized once in the constructor.
+ */
+class LRUKReplacer : public Replacer {
+ public:
+  /**
+   * Create a new LRUKReplacer.
+   * @param num_pages the maximum number of pages the LRUKReplacer will be required to store
+   * @param k the number of references tracked per frame
+   * @param correlated_period references closer together than this many clock ticks are treated as correlated
+   */
+  explicit LRUKReplacer(size_t num_pages, size_t k = LRUK_REPLACER_K,
+                        uint64_t correlated_period = LRUK_CORRELATED_REFERENCE_PERIOD);
+
+  /**
+   * Destroys the LRUKReplacer.
+   */
+  ~LRUKReplacer() override;
+
+  bool Victim(frame_id_t *frame_id) override;
+
+  void Pin(frame_id_t frame_id) override;
+
+  void Unpin(frame_id_t frame_id) override;
+
+  size_t Size() override;
+
+  void RecordLoad(frame_id_t frame_id, page_id_t page_id) override;
+
+ private:
+  /** (infinite distance first, oldest recorded reference, frame id): the order in which frames are evicted */
+  using FrameKey = std::tuple<bool, uint64_t, frame_id_t>;
+
+  /** @return the key of a frame by its current history */
+  FrameKey Key(frame_id_t frame_id);
+
+  /** Record a reference to a frame at the current logical time. */
+  void RecordAccess(frame_id_t frame_id);
+
+  /** @return true if a reference at time would be correlated with the frame's last reference */
+  bool IsCorrelated(frame_id_t frame_id, uint64_t time) const;
+
+  /** Forget every reference of a frame. */
+  void ResetHistory(frame_id_t frame_id);
+
+  /** @return the reference time slot i (0 = most recent) of a frame */
+  inline uint64_t &History(frame_id_t frame_id, size_t i) { return history_[frame_id * k_ + i]; }
+
+  std::mutex latch_;
+  const size_t k_;
+  const uint64_t correlated_period_;
+  /** Logical clock, advanced on every reference. */
+  uint64_t current_timestamp_{0};
+  /** Number of evictable frames. */
+  size_t size_{0};
+  /** num_pages x k reference times; slot 0 of each frame holds its most recent uncorrelated reference. */
+  std::vector<uint64_t> history_;
+  /** Number of valid history slots per frame, at most k. */
+  std::vector<size_t> history_count_;
+  /** Time of the very last reference per frame, including correlated ones. */
+  std::vector<uint64_t> last_reference_;
+  std::vector<bool> evictable_;
+  /** The keys of the evictable frames. A frame's history only changes while its key is out of the set. */
+  std::set<FrameKey> evictable_frames_;
+};
+
+}  // namespace bustub
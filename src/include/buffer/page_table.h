@@ -0,0 +1,91 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// page_table.h
+//
+// Identification: src/include/buffer/page_table.h
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <atomic>
+#include <memory>
+
+#include "common/config.h"
+#include "common/macros.h"
+
+namespace bustub {
+
+/**
+ * PageTable maps resident page ids to the frames that hold them.
+ *
+ * The table uses open addressing with linear probing. Every slot carries a version counter that works like a
+ * seqlock: writers make it odd while they modify the slot and even again when they are done, and readers retry a
+ * slot whose version changed underneath them. This makes Find() completely latch-free.
+ *
+ * Writers (Insert/Remove) must be serialized by the caller; the buffer pool does this with its instance latch.
+ * Because Remove() backward-shifts entries to keep probe sequences short, a concurrent Find() may spuriously miss an
+ * entry that is being moved. Callers treat a latch-free miss as a hint and repeat the lookup under their latch.
+ */
+class PageTable {
+ public:
+  /**
+   * Create a new PageTable.
+   * @param num_frames the maximum number of entries the table will ever hold at once
+   */
+  explicit PageTable(size_t num_frames);
+
+  ~PageTable() = default;
+
+  DISALLOW_COPY_AND_MOVE(PageTable);
+
+  /**
+   * Look up the frame of a resident page without taking any latch.
+   * @param page_id id of the page to look up
+   * @param[out] frame_id frame holding the page, if found
+   * @return true if the page was found, false otherwise
+   */
+  bool Find(page_id_t page_id, frame_id_t *frame_id) const;
+
+  /**
+   * Insert a mapping for a page that is not in the table yet. Callers must serialize writers.
+   * @param page_id id of the page
+   * @param frame_id frame holding the page
+   */
+  void Insert(page_id_t page_id, frame_id_t frame_id);
+
+  /**
+   * Remove the mapping of a page. Callers must serialize writers.
+   * @param page_id id of the page
+   * @return true if the page was in the table, false otherwise
+   */
+  bool Remove(page_id_t page_id);
+
+ private:
+  struct Slot {
+    /** Even when the slot is stable, odd while a writer is modifying it. */
+    std::atomic<uint64_t> version_{0};
+    std::atomic<page_id_t> page_id_{INVALID_PAGE_ID};
+    std::atomic<frame_id_t> frame_id_{-1};
+  };
+
+  /** @return the home slot of a page id */
+  inline size_t HomeSlot(page_id_t page_id) const {
+    // Fibonacci hashing spreads the strided page ids of a parallel BPM instance across the table.
+    return (static_cast<uint32_t>(page_id) * 2654435769U) & mask_;
+  }
+
+  /** Overwrite one slot, bumping its version around the update. */
+  void WriteSlot(size_t index, page_id_t page_id, frame_id_t frame_id);
+
+  /** Number of slots, always a power of two. */
+  size_t capacity_;
+  size_t mask_;
+  std::unique_ptr<Slot[]> slots_;
+};
+
+}  // namespace bustub
@@ -28,9 +28,10 @@ class ParallelBufferPoolManager : public BufferPoolManager {
    * @param pool_size the pool size of each BufferPoolManagerInstance
    * @param disk_manager the disk manager
    * @param log_manager the log manager (for testing only: nullptr = disable logging)
+   * @param replacer_type the replacement policy of every BufferPoolManagerInstance
    */
   ParallelBufferPoolManager(size_t num_instances, size_t pool_size, DiskManager *disk_manager,
-                            LogManager *log_manager = nullptr);
+                            LogManager *log_manager = nullptr, ReplacerType replacer_type = ReplacerType::LRU);
 
   /**
    * Destroys an existing ParallelBufferPoolManager.
@@ -40,6 +41,24 @@ class ParallelBufferPoolManager : public BufferPoolManager {
   /** @return size of the buffer pool */
   size_t GetPoolSize() override;
 
+  /**
+   * Forward read-ahead hints to the instances that own the pages.
+   * @param page_ids ids of the pages to read ahead
+   */
+  void PrefetchPages(const std::vector<page_id_t> &page_ids) override;
+
+  /**
+   * Collect the dirty page tables of all instances.
+   * @param[out] dirty_page_table (page id, recLSN) pairs are appended here
+   */
+  void GetDirtyPageTable(std::vector<std::pair<page_id_t, lsn_t>> *dirty_page_table) override;
+
+  /**
+   * Hand each instance the checkpoint pages it owns; the instances write them in parallel.
+   * @param page_ids ids of the pages to write
+   */
+  void FlushCheckpointPages(const std::vector<page_id_t> &page_ids) override;
+
  protected:
   /**
    * @param page_id id of page
@@ -84,13 +103,17 @@ class ParallelBufferPoolManager : public BufferPoolManager {
   bool DeletePgImp(page_id_t page_id) override;
 
   /**
-   * Flushes all the pages in the buffer pool to disk.
+   * Flushes all the pages in the buffer pool to disk. Page ids are striped across the instances, so the dirty pages
+   * of all instances are merged into one sorted batch before adjacent pages are coalesced; the batch is then written
+   * by one thread per instance and the disk is synced once.
    */
   void FlushAllPgsImp() override;
 
 private:
   size_t pool_size;
   uint32_t last_alloc_index_{0};
+  DiskManager *disk_manager_;
+  LogManager *log_manager_;
   std::vector<BufferPoolManagerInstance*> bpmis;
 };
 }  // namespace bustub
@@ -16,6 +16,9 @@
 
 namespace bustub {
 
+/** The replacement policies a BufferPoolManagerInstance can be built with. */
+enum class ReplacerType { LRU, TWO_QUEUE, LRU_K };
+
 /**
  * Replacer is an abstract class that tracks page usage.
  */
@@ -45,6 +48,14 @@ class Replacer {
 
   /** @return the number of elements in the replacer that can be victimized */
   virtual size_t Size() = 0;
+
+  /**
+   * Records that a page was just loaded into a frame. Policies that remember evicted pages use this to recognize
+   * pages that come back soon after eviction; others can ignore it.
+   * @param frame_id the id of the frame the page was loaded into
+   * @param page_id the id of the page that was loaded
+   */
+  virtual void RecordLoad(frame_id_t frame_id, page_id_t page_id) {}
 };
 
 }  // namespace bustub
@@ -0,0 +1,95 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// two_queue_replacer.h
+//
+// Identification: src/include/buffer/two_queue_replacer.h
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <list>
+#include <mutex>  // NOLINT
+#include <unordered_map>
+#include <vector>
+
+#include "buffer/replacer.h"
+#include "common/config.h"
+
+namespace bustub {
+
+/**
+ * TwoQueueReplacer implements the 2Q replacement policy, which keeps sequential scans from flushing the hot set.
+ *
+ * Pages enter a FIFO probation queue (A1in) when they are loaded. References while a page is on probation are treated
+ * as correlated and do not promote it. When a page leaves A1in its id is remembered in a ghost queue (A1out); if it
+ * is loaded again while still remembered, it goes straight to the protected LRU queue (Am). A scan therefore only
+ * ever churns A1in, while pages that are genuinely reused accumulate in Am.
+ */
+class TwoQueueReplacer : public Replacer {
+ public:
+  /**
+   * Create a new TwoQueueReplacer.
+   * @param num_pages the maximum number of pages the TwoQueueReplacer will be required to store
+   */
+  explicit TwoQueueReplacer(size_t num_pages);
+
+  /**
+   * Destroys the TwoQueueReplacer.
+   */
+  ~TwoQueueReplacer() override;
+
+  bool Victim(frame_id_t *frame_id) override;
+
+  void Pin(frame_id_t frame_id) override;
+
+  void Unpin(frame_id_t frame_id) override;
+
+  size_t Size() override;
+
+  void RecordLoad(frame_id_t frame_id, page_id_t page_id) override;
+
+ private:
+  enum class QueueType { NONE, A1IN, AM };
+
+  struct FrameEntry {
+    QueueType queue_{QueueType::NONE};
+    bool evictable_{false};
+    page_id_t page_id_{INVALID_PAGE_ID};
+    std::list<frame_id_t>::iterator position_;
+  };
+
+  /** Put a frame at the head of a queue, taking it out of whatever queue it was in. */
+  void Enqueue(frame_id_t frame_id, QueueType queue);
+
+  /** Take a frame out of its queue. */
+  void Dequeue(frame_id_t frame_id);
+
+  /** @return the oldest evictable frame of a queue, or -1 if every frame in it is pinned */
+  frame_id_t OldestEvictable(const std::list<frame_id_t> &queue) const;
+
+  /** Remember an evicted probation page so that a quick re-load is recognized as reuse. */
+  void RememberGhost(page_id_t page_id);
+
+  std::mutex latch_;
+  /** Number of frames, pinned or not, that A1in may hold before it becomes the preferred victim source. */
+  size_t a1in_target_;
+  /** Number of page ids remembered in A1out. */
+  size_t a1out_capacity_;
+  /** Per-frame bookkeeping, indexed by frame id. */
+  std::vector<FrameEntry> frames_;
+  /** Probation FIFO and protected LRU; both have their most recent frame at the front. */
+  std::list<frame_id_t> a1in_;
+  std::list<frame_id_t> am_;
+  size_t a1in_evictable_{0};
+  size_t am_evictable_{0};
+  /** Ghost FIFO of page ids recently evicted from A1in, most recent at the front. */
+  std::list<page_id_t> a1out_;
+  std::unordered_map<page_id_t, std::list<page_id_t>::iterator> a1out_map_;
+};
+
+}  // namespace bustub
@@ -20,7 +20,9 @@
 
 #include "buffer/buffer_pool_manager.h"
 #include "catalog/schema.h"
+#include "common/util/external_sorter.h"
 #include "container/hash/hash_function.h"
+#include "storage/index/b_plus_tree_index.h"
 #include "storage/index/extendible_hash_table_index.h"
 #include "storage/index/index.h"
 #include "storage/table/table_heap.h"
@@ -192,18 +194,7 @@ class Catalog {
   IndexInfo *CreateIndex(Transaction *txn, const std::string &index_name, const std::string &table_name,
                          const Schema &schema, const Schema &key_schema, const std::vector<uint32_t> &key_attrs,
                          std::size_t keysize, HashFunction<KeyType> hash_function) {
-    // Reject the creation request for nonexistent table
-    if (table_names_.find(table_name) == table_names_.end()) {
-      return NULL_INDEX_INFO;
-    }
-
-    // If the table exists, an entry for the table should already be present in index_names_
-    BUSTUB_ASSERT((index_names_.find(table_name) != index_names_.end()), "Broken Invariant");
-
-    // Determine if the requested index already exists for this table
-    auto &table_indexes = index_names_.find(table_name)->second;
-    if (table_indexes.find(index_name) != table_indexes.end()) {
-      // The requested index already exists for this table
+    if (!CanCreateIndex(index_name, table_name)) {
       return NULL_INDEX_INFO;
     }
 
@@ -224,19 +215,72 @@ class Catalog {
       index->InsertEntry(tuple->KeyFromTuple(schema, key_schema, key_attrs), tuple->GetRid(), txn);
     }
 
-    // Get the next OID for the new index
-    const auto index_oid = next_index_oid_.fetch_add(1);
+    return AddIndex(std::move(index), index_name, table_name, key_schema, keysize);
+  }
 
-    // Construct index information; IndexInfo takes ownership of the Index itself
-    auto index_info =
-        std::make_unique<IndexInfo>(key_schema, index_name, std::move(index), index_oid, table_name, keysize);
-    auto *tmp = index_info.get();
+  /**
+   * Create a new B+ tree index, bulk load it with the existing data of the table and return its metadata.
+   *
+   * The keys of the table are sorted first, with an external sort that buffers at most INDEX_BUILD_SORT_MEMORY
+   * bytes of them at a time, so that the tree can be built bottom-up with each page written once, instead of through
+   * one insert and the splits it causes per tuple. As with inserts, only the first of the tuples sharing a key (in
+   * RID order) is indexed.
+   *
+   * @param txn The transaction in which the table is being created
+   * @param index_name The name of the new index
+   * @param table_name The name of the table
+   * @param schema The schema of the table
+   * @param key_schema The schema of the key
+   * @param key_attrs Key attributes
+   * @param keysize Size of the key
+   * @param fill_factor The fraction of each page the bulk load fills, leaving the rest for later inserts
+   * @return A (non-owning) pointer to the metadata of the new index
+   */
+  template <class KeyType, class ValueType, class KeyComparator>
+  IndexInfo *CreateBPlusTreeIndex(Transaction *txn, const std::string &index_name, const std::string &table_name,
+                                  const Schema &schema, const Schema &key_schema,
+                                  const std::vector<uint32_t> &key_attrs, std::size_t keysize,
+                                  double fill_factor = 1.0) {
+    if (!CanCreateIndex(index_name, table_name)) {
+      return NULL_INDEX_INFO;
+    }
 
-    // Update internal tracking
-    indexes_.emplace(index_oid, std::move(index_info));
-    table_indexes.emplace(index_name, index_oid);
+    auto meta = std::make_unique<IndexMetadata>(index_name, table_name, &schema, key_attrs);
+    auto index = std::make_unique<BPlusTreeIndex<KeyType, ValueType, KeyComparator>>(std::move(meta), bpm_);
+
+    // Sort the keys of all tuples in the table heap
+    struct Entry {
+      KeyType key_;
+      ValueType value_;
+    };
+    KeyComparator comparator(index->GetKeySchema());
+    auto less = [&comparator](const Entry &a, const Entry &b) {
+      int order = comparator(a.key_, b.key_);
+      return order < 0 || (order == 0 && a.value_.Get() < b.value_.Get());
+    };
+    ExternalSorter<Entry, decltype(less)> sorter(INDEX_BUILD_SORT_MEMORY, less);
+    auto *heap = GetTable(table_name)->table_.get();
+    for (auto tuple = heap->Begin(txn); tuple != heap->End(); ++tuple) {
+      Entry entry;
+      entry.key_.SetFromKey(tuple->KeyFromTuple(schema, key_schema, key_attrs), &key_schema);
+      entry.value_ = tuple->GetRid();
+      sorter.Add(entry);
+    }
 
-    return tmp;
+    // Build the index from the sorted keys
+    index->BulkLoad(
+        [&sorter](KeyType *key, ValueType *value) {
+          Entry entry;
+          if (!sorter.Next(&entry)) {
+            return false;
+          }
+          *key = entry.key_;
+          *value = entry.value_;
+          return true;
+        },
+        fill_factor);
+
+    return AddIndex(std::move(index), index_name, table_name, key_schema, keysize);
   }
 
   /**
@@ -323,6 +367,52 @@ class Catalog {
   }
 
  private:
+  /**
+   * Check that an index can be created.
+   * @param index_name The name of the new index
+   * @param table_name The name of the table
+   * @return false if the table does not exist or already has an index of that name
+   */
+  bool CanCreateIndex(const std::string &index_name, const std::string &table_name) {
+    // Reject the creation request for nonexistent table
+    if (table_names_.find(table_name) == table_names_.end()) {
+      return false;
+    }
+
+    // If the table exists, an entry for the table should already be present in index_names_
+    BUSTUB_ASSERT((index_names_.find(table_name) != index_names_.end()), "Broken Invariant");
+
+    // Determine if the requested index already exists for this table
+    auto &table_indexes = index_names_.find(table_name)->second;
+    return table_indexes.find(index_name) == table_indexes.end();
+  }
+
+  /**
+   * Add a new, populated index to the catalog.
+   * @param index An owning pointer to the index
+   * @param index_name The name of the index
+   * @param table_name The name of the table
+   * @param key_schema The schema of the key
+   * @param keysize Size of the key
+   * @return A (non-owning) pointer to the metadata of the index
+   */
+  IndexInfo *AddIndex(std::unique_ptr<Index> &&index, const std::string &index_name, const std::string &table_name,
+                      const Schema &key_schema, std::size_t keysize) {
+    // Get the next OID for the new index
+    const auto index_oid = next_index_oid_.fetch_add(1);
+
+    // Construct index information; IndexInfo takes ownership of the Index itself
+    auto index_info =
+        std::make_unique<IndexInfo>(key_schema, index_name, std::move(index), index_oid, table_name, keysize);
+    auto *tmp = index_info.get();
+
+    // Update internal tracking
+    indexes_.emplace(index_oid, std::move(index_info));
+    index_names_.find(table_name)->second.emplace(index_name, index_oid);
+
+    return tmp;
+  }
+
   [[maybe_unused]] BufferPoolManager *bpm_;
   [[maybe_unused]] LockManager *lock_manager_;
   [[maybe_unused]] LogManager *log_manager_;
@@ -23,11 +23,11 @@ namespace bustub {
 
 class BustubInstance {
  public:
-  explicit BustubInstance(const std::string &db_file_name) {
+  explicit BustubInstance(const std::string &db_file_name, int64_t log_segment_size = LOG_SEGMENT_SIZE) {
     enable_logging = false;
 
     // storage related
-    disk_manager_ = new DiskManager(db_file_name);
+    disk_manager_ = new DiskManager(db_file_name, DiskBackendType::IO_URING, false, log_segment_size);
 
     // log related
     log_manager_ = new LogManager(disk_manager_);
@@ -39,7 +39,8 @@ class BustubInstance {
     transaction_manager_ = new TransactionManager(lock_manager_, log_manager_);
 
     // checkpoints
-    checkpoint_manager_ = new CheckpointManager(transaction_manager_, log_manager_, buffer_pool_manager_);
+    checkpoint_manager_ =
+        new CheckpointManager(transaction_manager_, log_manager_, buffer_pool_manager_, disk_manager_);
   }
 
   ~BustubInstance() {
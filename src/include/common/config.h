@@ -14,6 +14,7 @@
 
 #include <atomic>
 #include <chrono>  // NOLINT
+#include <cstddef>
 #include <cstdint>
 
 namespace bustub {
@@ -27,14 +28,42 @@ extern std::atomic<bool> enable_logging;
 /** If ENABLE_LOGGING is true, the log should be flushed to disk every LOG_TIMEOUT. */
 extern std::chrono::duration<int64_t> log_timeout;
 
+/** The page cleaner of each buffer pool instance checks the dirty ratio every PAGE_CLEANER_INTERVAL milliseconds. */
+extern std::chrono::milliseconds page_cleaner_interval;
+
+/** The page cleaner writes back unpinned dirty frames while more than this fraction of the pool is dirty. */
+extern std::atomic<double> page_cleaner_dirty_ratio;
+
+/** True if buffer pools should back their frames with huge pages where the system allows it. */
+extern std::atomic<bool> buffer_pool_huge_pages;
+
+/** A table scan asks the buffer pool to read ahead this many pages past the page it moves to; 0 disables it. */
+extern std::atomic<size_t> table_scan_prefetch_window;
+
+/** True if the log manager compresses each log buffer it writes, whenever that makes it smaller. */
+extern std::atomic<bool> log_compression;
+
 static constexpr int INVALID_PAGE_ID = -1;                                    // invalid page id
 static constexpr int INVALID_TXN_ID = -1;                                     // invalid transaction id
 static constexpr int INVALID_LSN = -1;                                        // invalid log sequence number
 static constexpr int HEADER_PAGE_ID = 0;                                      // the header page id
 static constexpr int PAGE_SIZE = 4096;                                        // size of a data page in byte
+static constexpr int PAGE_CHECKSUM_SIZE = 4;                                  // checksum at the end of every page
 static constexpr int BUFFER_POOL_SIZE = 10;                                   // size of buffer pool
 static constexpr int LOG_BUFFER_SIZE = ((BUFFER_POOL_SIZE + 1) * PAGE_SIZE);  // size of a log buffer in byte
 static constexpr int BUCKET_SIZE = 50;                                        // size of extendible hash bucket
+static constexpr int LRUK_REPLACER_K = 2;                                     // lookback window for lru-k replacer
+static constexpr int LRUK_CORRELATED_REFERENCE_PERIOD = 4;                    // lru-k correlated reference period
+static constexpr int POSIX_DISK_BACKEND_THREADS = 4;                          // async i/o threads of posix backend
+static constexpr int IO_URING_QUEUE_DEPTH = 128;                              // max in-flight io_uring operations
+static constexpr int LOG_RECOVERY_THREADS = 4;                                // redo and undo worker threads
+static constexpr int LOG_RECOVERY_READ_SIZE = 1 << 20;                        // log bytes read ahead at a time by redo
+static constexpr int64_t LOG_SEGMENT_SIZE = 1 << 22;                          // log bytes per log segment file
+static constexpr size_t LOG_MAX_SPARE_SEGMENTS = 4;                           // recycled log segments kept for reuse
+static constexpr size_t INDEX_BUILD_SORT_MEMORY = 64 << 20;                   // index build key bytes sorted in memory
+static constexpr int HASH_JOIN_THREADS = 4;                                   // hash join build and probe threads
+static constexpr int HASH_JOIN_PARTITION_BITS = 4;                            // hash bits picking a hash join partition
+static constexpr size_t HASH_JOIN_PROBE_BATCH_SIZE = 1024;                    // probe tuples partitioned at a time
 
 using frame_id_t = int32_t;    // frame id type
 using page_id_t = int32_t;     // page id type
@@ -0,0 +1,42 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// crc32c.h
+//
+// Identification: src/include/common/util/crc32c.h
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace bustub {
+
+/**
+ * Crc32c computes the CRC-32C (Castagnoli) checksum, with the SSE4.2 crc32 instruction where the build targets it and
+ * a lookup table otherwise. Both produce the same values.
+ */
+class Crc32c {
+ public:
+  /**
+   * Continue a checksum over more bytes.
+   * @param crc the checksum of the bytes before data, or 0 to start a new one
+   * @param data the bytes to add
+   * @param size number of bytes at data
+   * @return the checksum of all bytes so far
+   */
+  static uint32_t Extend(uint32_t crc, const char *data, size_t size);
+
+  /** @return the checksum of size bytes at data */
+  static inline uint32_t Value(const char *data, size_t size) { return Extend(0, data, size); }
+
+  /** @return true if Extend uses the crc32 instruction */
+  static bool IsHardwareAccelerated();
+};
+
+}  // namespace bustub
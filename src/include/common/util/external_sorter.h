@@ -0,0 +1,181 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// external_sorter.h
+//
+// Identification: src/include/common/util/external_sorter.h
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <algorithm>
+#include <cstdio>
+#include <functional>
+#include <queue>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "common/exception.h"
+#include "common/macros.h"
+
+namespace bustub {
+
+/**
+ * ExternalSorter sorts more items than fit in memory.
+ *
+ * Items are collected into a run of at most memory_budget bytes, which is sorted and spilled to a temporary file
+ * whenever it fills up. Once all items are added, Next() reads them back in order, merging the spilled runs through
+ * read buffers that share the same budget. Input that fits in the budget is sorted in memory and never written.
+ *
+ * Runs are spilled byte for byte, so T must be trivially copyable.
+ */
+template <typename T, typename Less = std::less<T>>
+class ExternalSorter {
+  static_assert(std::is_trivially_copyable_v<T>, "ExternalSorter spills items byte for byte");
+
+ public:
+  /**
+   * Create a new external sorter.
+   * @param memory_budget the bytes of items kept in memory at a time
+   * @param less the order to sort items in
+   */
+  explicit ExternalSorter(size_t memory_budget, Less less = Less())
+      : run_size_(std::max<size_t>(memory_budget / sizeof(T), 1)), less_(std::move(less)) {}
+
+  ~ExternalSorter() {
+    for (auto &run : runs_) {
+      fclose(run.file_);
+    }
+  }
+
+  DISALLOW_COPY_AND_MOVE(ExternalSorter);
+
+  /** Add an item to sort. Items can only be added until the first call to Next(). */
+  void Add(const T &item) {
+    // The run is allocated at its full size once, rather than grown to up to twice the budget.
+    if (items_.capacity() < run_size_) {
+      items_.reserve(run_size_);
+    }
+    items_.push_back(item);
+    if (items_.size() == run_size_) {
+      Spill();
+    }
+  }
+
+  /**
+   * Read the next item in sorted order.
+   * @param[out] item the next item
+   * @return false if all items have been read
+   */
+  bool Next(T *item) {
+    if (!finished_) {
+      Finish();
+    }
+    if (runs_.empty()) {
+      if (next_ == items_.size()) {
+        return false;
+      }
+      *item = items_[next_++];
+      return true;
+    }
+
+    if (heap_.empty()) {
+      return false;
+    }
+    size_t run_index = heap_.top().second;
+    *item = heap_.top().first;
+    heap_.pop();
+    T run_item;
+    if (ReadRun(&runs_[run_index], &run_item)) {
+      heap_.emplace(run_item, run_index);
+    }
+    return true;
+  }
+
+  /** @return the number of runs spilled to disk */
+  size_t GetNumSpilledRuns() const { return runs_.size(); }
+
+ private:
+  /** A sorted run in a temporary file, read back through a buffer of its items. */
+  struct Run {
+    FILE *file_;
+    std::vector<T> buffer_;
+    size_t next_{0};
+  };
+
+  /** Sort the collected items and write them out as a new run. */
+  void Spill() {
+    std::sort(items_.begin(), items_.end(), less_);
+    FILE *file = tmpfile();
+    if (file == nullptr) {
+      throw Exception(ExceptionType::OUT_OF_MEMORY, "cannot create a file to spill a sorted run to");
+    }
+    runs_.push_back({file, {}});
+    if (fwrite(items_.data(), sizeof(T), items_.size(), file) != items_.size()) {
+      throw Exception(ExceptionType::OUT_OF_MEMORY, "cannot spill a sorted run");
+    }
+    items_.clear();
+  }
+
+  /** Sort the last run, spilling it as well if any run was, and set up the merge of the runs. */
+  void Finish() {
+    finished_ = true;
+    if (runs_.empty()) {
+      std::sort(items_.begin(), items_.end(), less_);
+      return;
+    }
+    if (!items_.empty()) {
+      Spill();
+    }
+    items_.shrink_to_fit();
+
+    size_t buffer_size = std::max<size_t>(run_size_ / runs_.size(), 1);
+    for (size_t i = 0; i < runs_.size(); i++) {
+      rewind(runs_[i].file_);
+      runs_[i].buffer_.reserve(buffer_size);
+      T item;
+      if (ReadRun(&runs_[i], &item)) {
+        heap_.emplace(item, i);
+      }
+    }
+  }
+
+  /** @return false if the run has no items left */
+  bool ReadRun(Run *run, T *item) {
+    if (run->next_ == run->buffer_.size()) {
+      run->buffer_.resize(run->buffer_.capacity());
+      run->buffer_.resize(fread(run->buffer_.data(), sizeof(T), run->buffer_.size(), run->file_));
+      run->next_ = 0;
+      if (run->buffer_.empty()) {
+        return false;
+      }
+    }
+    *item = run->buffer_[run->next_++];
+    return true;
+  }
+
+  /** Orders the merge heap so that its top is the least item. */
+  struct HeapLess {
+    const Less *less_;
+    bool operator()(const std::pair<T, size_t> &a, const std::pair<T, size_t> &b) const {
+      return (*less_)(b.first, a.first);
+    }
+  };
+
+  const size_t run_size_;
+  Less less_;
+  /** The run being collected, and once finished, the items if none were spilled. */
+  std::vector<T> items_;
+  std::vector<Run> runs_;
+  bool finished_{false};
+  size_t next_{0};
+  /** The next item of each spilled run that has one left, with the index of the run. */
+  std::priority_queue<std::pair<T, size_t>, std::vector<std::pair<T, size_t>>, HeapLess> heap_{HeapLess{&less_}};
+};
+
+}  // namespace bustub
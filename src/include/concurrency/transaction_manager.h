@@ -13,9 +13,12 @@
 #pragma once
 
 #include <atomic>
+#include <mutex>  // NOLINT
 #include <shared_mutex>
 #include <unordered_map>
 #include <unordered_set>
+#include <utility>
+#include <vector>
 
 #include "common/config.h"
 #include "concurrency/lock_manager.h"
@@ -83,6 +86,14 @@ class TransactionManager {
   /** Resumes all transactions, used for checkpointing. */
   void ResumeTransactions();
 
+  /**
+   * Snapshot the active transaction table for a fuzzy checkpoint: the transactions that have logged BEGIN but neither
+   * COMMIT nor ABORT yet.
+   * @param[out] active_txns the id of each such transaction and the LSN of its last record
+   * @return the LSN of the oldest BEGIN record among them, or INVALID_LSN if there are none
+   */
+  lsn_t GetActiveTransactionTable(std::vector<std::pair<txn_id_t, lsn_t>> *active_txns);
+
  private:
   /**
    * Releases all the locks held by the given transaction.
@@ -101,12 +112,20 @@ class TransactionManager {
     }
   }
 
+  /** Drop a finished transaction from logged_txns_; it must have logged COMMIT or ABORT already, if anything. */
+  void ForgetLoggedTransaction(Transaction *txn);
+
   std::atomic<txn_id_t> next_txn_id_{0};
   LockManager *lock_manager_ __attribute__((__unused__));
-  LogManager *log_manager_ __attribute__((__unused__));
+  LogManager *log_manager_;
 
   /** The global transaction latch is used for checkpointing. */
   ReaderWriterLatch global_txn_latch_;
+
+  /** Transactions that logged BEGIN but not yet COMMIT or ABORT, with the LSN of their BEGIN record. */
+  std::unordered_map<txn_id_t, std::pair<Transaction *, lsn_t>> logged_txns_;
+  /** Protects logged_txns_. BEGIN records are appended under it, so a checkpoint sees both the record and the entry. */
+  std::mutex logged_txns_latch_;
 };
 
 }  // namespace bustub
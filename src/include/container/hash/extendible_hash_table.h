@@ -14,6 +14,7 @@
 
 #include <queue>
 #include <string>
+#include <utility>
 #include <vector>
 #include <cmath>
 
@@ -31,6 +32,14 @@ namespace bustub {
  * Implementation of extendible hash table that is backed by a buffer pool
  * manager. Non-unique keys are supported. Supports insert and delete. The
  * table grows/shrinks dynamically as buckets become full/empty.
+ *
+ * The directory is spread over directory pages, which a header page points to.
+ * Directory pages are indexed by the low bits of the hash and the header page
+ * by the high bits, so once a directory page is at DIRECTORY_MAX_DEPTH it is
+ * split in two, the same way a full bucket is. There is no table-wide latch:
+ * page latches are taken header, then directory, then bucket, and each is
+ * released once the next one is held, so a split only blocks the directory
+ * page it changes.
  */
 template <typename KeyType, typename ValueType, typename KeyComparator>
 class ExtendibleHashTable {
@@ -123,11 +132,44 @@ class ExtendibleHashTable {
   inline uint32_t KeyToPageId(KeyType key, HashTableDirectoryPage *dir_page);
 
   /**
-   * Fetches the directory page from the buffer pool manager.
+   * Maps a key to a slot of the header page, by the bits of its hash from the
+   * most significant one down, so that they are independent of the bits that
+   * index directory pages.
    *
-   * @return a pointer to the directory page
+   * @param key the key to use for lookup
+   * @param header_page the header page to use for lookup of its global depth
+   * @return the header slot
+   */
+  inline uint32_t KeyToHeaderIndex(KeyType key, HashTableDirectoryPage *header_page);
+
+  /**
+   * Fetches a page of the table from the buffer pool manager.
+   *
+   * @param page_id the page_id to fetch
+   * @return the pinned page
+   * @throws Exception OUT_OF_MEMORY if every frame is pinned
+   */
+  Page *FetchTablePage(page_id_t page_id);
+
+  /**
+   * Allocates a page for the table from the buffer pool manager.
+   *
+   * @param[out] page_id the page_id of the new page
+   * @return the pinned page, zeroed
+   * @throws Exception OUT_OF_MEMORY if every frame is pinned
+   */
+  Page *NewTablePage(page_id_t *page_id);
+
+  /**
+   * Fetches and latches the directory page that covers a key. The header page
+   * stays latched until the directory page is, so the key cannot move to
+   * another directory page in between.
+   *
+   * @param key the key for lookup
+   * @param exclusive whether to write latch the directory page, rather than read latch it
+   * @return the pinned and latched directory page
    */
-  HashTableDirectoryPage *FetchDirectoryPage();
+  std::pair<Page *, HashTableDirectoryPage *> FetchDirectoryPage(const KeyType &key, bool exclusive);
 
   /**
    * Fetches the a bucket page from the buffer pool manager using the bucket's page_id.
@@ -147,6 +189,26 @@ class ExtendibleHashTable {
    */
   bool SplitInsert(Transaction *transaction, const KeyType &key, const ValueType &value);
 
+  /**
+   * Splits a full bucket in two by the next bit of the hash, growing the
+   * directory page if the bucket already uses all of its bits.
+   *
+   * @param dir_page the write latched directory page that points to the bucket
+   * @param bucket_idx a directory index of the bucket
+   * @param bucket_page the write latched bucket
+   */
+  void SplitBucket(HashTableDirectoryPage *dir_page, uint32_t bucket_idx, HASH_TABLE_BUCKET_TYPE *bucket_page);
+
+  /**
+   * Splits the directory page that covers a key in two by the next high bit of
+   * the hash, together with each of its buckets. This is called by SplitInsert
+   * once the key's bucket is full and uses every bit of the directory page.
+   *
+   * @param key the key that did not fit
+   * @return false if the header page is out of slots, true otherwise
+   */
+  bool SplitDirectory(const KeyType &key);
+
   /**
    * Optionally merges an empty bucket into it's pair.  This is called by Remove,
    * if Remove makes a bucket empty.
@@ -156,6 +218,8 @@ class ExtendibleHashTable {
    * 2. The bucket has local depth 0.
    * 3. The bucket's local depth doesn't match its split image's local depth.
    *
+   * Only buckets are merged; a directory page, once split, stays split.
+   *
    * @param transaction a pointer to the current transaction
    * @param key the key that was removed
    * @param value the value that was removed
@@ -168,12 +232,9 @@ class ExtendibleHashTable {
   uint32_t Pow(uint32_t base, uint32_t power) const;
 
   // member variables
-  page_id_t directory_page_id_;
+  page_id_t header_page_id_;
   BufferPoolManager *buffer_pool_manager_;
   KeyComparator comparator_;
-
-  // Readers includes inserts and removes, writers are splits and merges
-  ReaderWriterLatch table_latch_;
   HashFunction<KeyType> hash_fn_;
 };
 
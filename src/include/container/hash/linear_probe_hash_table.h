@@ -12,6 +12,7 @@
 
 #pragma once
 
+#include <atomic>
 #include <queue>
 #include <string>
 #include <vector>
@@ -31,7 +32,19 @@ namespace bustub {
 /**
  * Implementation of linear probing hash table that is backed by a buffer pool
  * manager. Non-unique keys are supported. Supports insert and delete. The
- * table dynamically grows once full.
+ * table dynamically grows once half its buckets are occupied. Removed pairs
+ * leave tombstones, so if those make up most of the occupied buckets, the
+ * table is rehashed at its size instead.
+ *
+ * A resize does not rehash the table at once. The new block array is put in
+ * front of the old one, inserts go to the new array and lookups check both,
+ * and each insert or remove moves the pairs of a few old blocks over, until
+ * the old array is empty and is dropped.
+ *
+ * Probe sequences do not wrap around the end of a block array; a pair whose
+ * sequence runs off the end makes the table grow. The block of a key's home
+ * bucket stays latched while an operation on the key walks the sequence, and
+ * blocks are latched in increasing order, the old array's before the new.
  */
 template <typename KeyType, typename ValueType, typename KeyComparator>
 class LinearProbeHashTable : public HashTable<KeyType, ValueType, KeyComparator> {
@@ -75,7 +88,9 @@ class LinearProbeHashTable : public HashTable<KeyType, ValueType, KeyComparator>
   bool GetValue(Transaction *transaction, const KeyType &key, std::vector<ValueType> *result) override;
 
   /**
-   * Resizes the table to at least twice the initial size provided.
+   * Resizes the table to at least twice the initial size provided, up to the
+   * number of blocks a header page holds. A resize still in progress is
+   * finished first. The pairs move over to the new size incrementally.
    * @param initial_size the initial size of the hash table
    */
   void Resize(size_t initial_size);
@@ -87,16 +102,87 @@ class LinearProbeHashTable : public HashTable<KeyType, ValueType, KeyComparator>
   size_t GetSize();
 
  private:
+  /** The number of old blocks that each insert or remove moves over to the new block array during a resize. */
+  static constexpr size_t MIGRATE_BLOCKS_PER_OPERATION = 2;
+
+  /**
+   * @return the bucket a key hashes to in the block array of a header page
+   */
+  size_t HomeBucket(const KeyType &key, HashTableHeaderPage *header);
+
+  /**
+   * Fetches a page of the table from the buffer pool manager.
+   *
+   * @throws Exception OUT_OF_MEMORY if every frame is pinned
+   */
+  Page *FetchTablePage(page_id_t page_id);
+
+  /**
+   * Allocates a page for the table from the buffer pool manager.
+   *
+   * @throws Exception OUT_OF_MEMORY if every frame is pinned
+   */
+  Page *NewTablePage(page_id_t *page_id);
+
+  /**
+   * Allocates a block array of at least num_buckets buckets, up to what a header page holds.
+   *
+   * @return the page id of the header page of the array
+   */
+  page_id_t NewBlockArray(size_t num_buckets);
+
+  /**
+   * Deletes a block array that no operation can reach any more.
+   */
+  void DeleteBlockArray(page_id_t header_page_id);
+
+  /**
+   * Moves the pairs over to a new block array of num_buckets buckets, which
+   * drops the tombstones of the current one. A resize still in progress is
+   * finished first.
+   * @param num_buckets the number of buckets of the new block array
+   * @param from_header_page_id the block array to replace; nothing is done
+   * if another thread has replaced it already
+   */
+  void Rebuild(size_t num_buckets, page_id_t from_header_page_id);
+
+  /**
+   * Moves the pairs whose home bucket is in the next unclaimed block of the old
+   * block array over to the new one. Called with table_latch_ read locked.
+   *
+   * @return false if there was no old block left to claim
+   */
+  bool MigrateBlock();
+
+  /**
+   * Drops the old block array, if every one of its blocks has been migrated.
+   */
+  void FinishResize();
+
   // member variable
   page_id_t header_page_id_;
   BufferPoolManager *buffer_pool_manager_;
   KeyComparator comparator_;
 
-  // Readers includes inserts and removes, writer is only resize
+  // Readers includes inserts, removes and migrations, writer only swaps the block arrays in and out
   ReaderWriterLatch table_latch_;
 
   // Hash function
   HashFunction<KeyType> hash_fn_;
+
+  // The number of buckets of the block array at header_page_id_
+  size_t num_buckets_;
+  // The number of occupied buckets, tombstones included, of the block array at header_page_id_
+  std::atomic<size_t> num_occupied_{0};
+  // The number of pairs in the table, in either block array
+  std::atomic<size_t> num_pairs_{0};
+
+  // The block array being migrated into the one at header_page_id_, or INVALID_PAGE_ID outside a resize
+  page_id_t old_header_page_id_{INVALID_PAGE_ID};
+  size_t old_num_blocks_{0};
+  // The next old block to migrate, and the number of old blocks migrated
+  std::atomic<size_t> next_migrate_block_{0};
+  std::atomic<size_t> migrated_blocks_{0};
 };
 
 }  // namespace bustub
@@ -12,11 +12,16 @@
 
 #pragma once
 
+#include <atomic>
+#include <condition_variable>  // NOLINT
+#include <functional>
 #include <memory>
-#include <unordered_map>
+#include <mutex>  // NOLINT
+#include <thread>  // NOLINT
 #include <utility>
 #include <vector>
 
+#include "common/config.h"
 #include "common/util/hash_util.h"
 #include "execution/executor_context.h"
 #include "execution/executors/abstract_executor.h"
@@ -25,26 +30,15 @@
 
 namespace bustub {
 
-struct HashJoinKey {
-  Value key_;
-
-  bool operator==(const HashJoinKey &other) const { return key_.CompareEquals(other.key_) == CmpBool::CmpTrue; }
-};
-}  // namespace bustub
-
-namespace std {
-
-template <>
-struct hash<bustub::HashJoinKey> {
-  // 通过给定key，调用bustub::HashUtil::HashValue得到hash值
-  std::size_t operator()(const bustub::HashJoinKey &key) const { return bustub::HashUtil::HashValue(&key.key_); }
-};
-}  // namespace std
-
-namespace bustub {
-
 /**
- * HashJoinExecutor executes a nested-loop JOIN on two tables.
+ * HashJoinExecutor executes a radix-partitioned hash JOIN on two tables.
+ *
+ * Both sides are split into 2^HASH_JOIN_PARTITION_BITS partitions by the top bits of the hash of their join key, so
+ * that each partition can be worked on by one thread without latches. Init drains the left child into the partitions
+ * and builds the hash table of every partition on worker threads. Next pulls the right child a batch at a time,
+ * partitions the batch, and probes the partitions on worker threads. The children themselves are driven by the
+ * calling thread only. The worker threads are started by the first Init and wait for work until the executor is
+ * destroyed.
  */
 class HashJoinExecutor : public AbstractExecutor {
  public:
@@ -58,7 +52,10 @@ class HashJoinExecutor : public AbstractExecutor {
   HashJoinExecutor(ExecutorContext *exec_ctx, const HashJoinPlanNode *plan,
                    std::unique_ptr<AbstractExecutor> &&left_child, std::unique_ptr<AbstractExecutor> &&right_child);
 
-  /** Initialize the join */
+  /** Stops the worker threads */
+  ~HashJoinExecutor() override;
+
+  /** Initialize the join, building the hash tables from the left child */
   void Init() override;
 
   /**
@@ -73,20 +70,90 @@ class HashJoinExecutor : public AbstractExecutor {
   const Schema *GetOutputSchema() override { return plan_->OutputSchema(); };
 
  private:
-  /** The NestedLoopJoin plan node to be executed. */
+  static constexpr size_t NUM_PARTITIONS = size_t{1} << HASH_JOIN_PARTITION_BITS;
+  static constexpr size_t NO_ROW = static_cast<size_t>(-1);
+
+  /** A left tuple in the arena of its partition, chained to the next tuple in the same bucket. */
+  struct BuildRow {
+    hash_t hash_;
+    /** offset of the tuple in the arena, where its length is followed by its data as in Tuple::SerializeTo */
+    size_t offset_;
+    size_t next_;
+  };
+
+  /** The left tuples of one partition and the hash table over them. */
+  struct Partition {
+    std::vector<char> arena_;
+    std::vector<BuildRow> rows_;
+    /** first row of each bucket, or NO_ROW; a power of two in size */
+    std::vector<size_t> buckets_;
+  };
+
+  /** A right tuple of the current probe batch. */
+  struct ProbeRow {
+    hash_t hash_;
+    size_t tuple_idx_;
+    Value key_;
+  };
+
+  /** @return the hash of a join key, with its bits mixed well enough to pick both a partition and a bucket */
+  static hash_t HashKey(const Value &key);
+
+  /** @return the partition of a hashed key */
+  static size_t PartitionOf(hash_t hash) { return hash >> (sizeof(hash_t) * 8 - HASH_JOIN_PARTITION_BITS); }
+
+  /** Runs task(i) for every i in [0, num_tasks) on the worker threads and the calling thread. */
+  void ParallelFor(size_t num_tasks, const std::function<void(size_t)> &task);
+
+  /** Body of a worker thread: takes part in every ParallelFor until the executor is destroyed. */
+  void RunWorker();
+
+  /** Runs the tasks of the current ParallelFor that no thread has taken yet. */
+  void RunTasks();
+
+  /** Chains the rows of a partition into its buckets. */
+  static void BuildPartition(Partition *partition);
+
+  /** Matches the probe rows of one partition against its left tuples, appending the joined tuples to output. */
+  void ProbePartition(const Partition &partition, const std::vector<ProbeRow> &probe_rows,
+                      std::vector<Tuple> *output) const;
+
+  /** Joins the next batch of right tuples into output_. @return false if the right child is exhausted */
+  bool ProbeNextBatch();
+
+  /** The HashJoin plan node to be executed. */
   const HashJoinPlanNode *plan_;
   /** The left child executor to obtain value from */
   std::unique_ptr<AbstractExecutor> left_child_executor_;
   /** The right child executor to obtain value from */
   std::unique_ptr<AbstractExecutor> right_child_executor_;
-  /** Hash table */
-  std::unordered_map<HashJoinKey, std::vector<std::vector<Value>>> hash_table_;
-  // assume hash table has directory and bucket
-  // 若一个hash值，对应多个元组，因为next要一个一个取，所以缓存这个hash表给定key值对应的溢出列list
-  // 然后通过bucket_index来一个一个读取
-  std::vector<std::vector<Value>> bucket_list_;
-
-  size_t bucket_index_;
+  /** Whether the right child has returned its last tuple */
+  bool right_exhausted_{false};
+  /** The left side of the join, partitioned by join key */
+  std::vector<Partition> partitions_;
+  /** The right tuples of the current probe batch, and their rows by partition */
+  std::vector<Tuple> probe_tuples_;
+  std::vector<std::vector<ProbeRow>> probe_rows_;
+  /** The joined tuples of the current probe batch, by partition, and the next one to be returned */
+  std::vector<std::vector<Tuple>> output_;
+  size_t output_partition_{0};
+  size_t output_index_{0};
+
+  /** The worker threads, HASH_JOIN_THREADS - 1 of them as the calling thread takes part too */
+  std::vector<std::thread> workers_;
+  /** Protects the fields below; workers_cv_ wakes the workers for a new ParallelFor, done_cv_ its caller */
+  std::mutex workers_latch_;
+  std::condition_variable workers_cv_;
+  std::condition_variable done_cv_;
+  bool stop_workers_{false};
+  /** The current ParallelFor, counted so that a worker takes part in each one once */
+  uint64_t round_{0};
+  const std::function<void(size_t)> *task_{nullptr};
+  size_t num_tasks_{0};
+  /** The workers that have not finished the current ParallelFor yet */
+  size_t busy_workers_{0};
+  /** The next task of the current ParallelFor to be taken, by any thread */
+  std::atomic<size_t> next_task_{0};
 };
 
 }  // namespace bustub
@@ -12,18 +12,30 @@
 
 #pragma once
 
+#include <memory>
 #include <vector>
 
 #include "common/rid.h"
 #include "execution/executor_context.h"
 #include "execution/executors/abstract_executor.h"
+#include "execution/expressions/comparison_expression.h"
 #include "execution/plans/index_scan_plan.h"
 #include "storage/table/tuple.h"
 
 namespace bustub {
 
 /**
- * IndexScanExecutor executes an index scan over a table.
+ * IndexScanExecutor executes an index scan over a table, returning its tuples in the order of a B+ tree index on it,
+ * ascending or, for a reverse plan, descending. The scan fetches each tuple from the table heap as its index entry is
+ * reached, so a limit above it stops the walk early.
+ *
+ * The conjuncts of the predicate that compare a key column with a constant are pushed into the index. Equalities on
+ * the leading key columns and the bounds on the column after them limit the range of keys walked, and every such
+ * comparison is checked on the key, so that only the tuples of matching keys are fetched. The rest of the predicate
+ * is evaluated on the fetched tuple.
+ *
+ * When the index covers the scan, i.e. every output column is a key column and the whole predicate is checked on the
+ * key, the output is built from the key and the table heap is not read at all.
  */
 
 class IndexScanExecutor : public AbstractExecutor {
@@ -42,7 +54,64 @@ class IndexScanExecutor : public AbstractExecutor {
   bool Next(Tuple *tuple, RID *rid) override;
 
  private:
+  /** A comparison of a key column with a constant, checked on the index key. */
+  struct KeyPredicate {
+    uint32_t key_column_;
+    ComparisonType comp_type_;
+    Value value_;
+  };
+
+  /** One end of the range of keys to walk, built with GenericKey::SetFromPrefix. */
+  struct KeyBound {
+    std::vector<Value> values_;
+    uint8_t fill_;
+  };
+
+  /** Walks the entries of the index within the bounds, hiding the key size the tree is instantiated with. */
+  class Cursor {
+   public:
+    virtual ~Cursor() = default;
+    /** @return true once the walk has gone past the last entry in the bounds */
+    virtual bool IsEnd() = 0;
+    virtual RID GetRID() = 0;
+    /** @return the value of a column of the current key */
+    virtual Value GetKeyValue(uint32_t key_column) = 0;
+    virtual void Advance() = 0;
+  };
+
+  template <size_t KeySize>
+  class TreeCursor;
+
+  template <size_t KeySize>
+  std::unique_ptr<Cursor> MakeCursor() const;
+
+  void SplitPredicate(const AbstractExpression *predicate);
+
+  void DeriveBounds();
+
+  bool MatchesKey() const;
+
   /** The index scan plan node to be executed. */
   const IndexScanPlanNode *plan_;
+
+  IndexInfo *index_info_{Catalog::NULL_INDEX_INFO};
+
+  TableInfo *table_info_{Catalog::NULL_TABLE_INFO};
+
+  std::unique_ptr<Cursor> cursor_;
+
+  std::vector<KeyPredicate> key_predicates_;
+  /** The conjuncts of the predicate that are evaluated on the table tuple */
+  std::vector<const AbstractExpression *> residual_predicates_;
+
+  std::vector<KeyBound> lower_bounds_;
+
+  std::vector<KeyBound> upper_bounds_;
+  /** The idx of each column of the out schema in the origin schema */
+  std::vector<uint32_t> out_schema_idx_;
+  /** The idx of each column of the out schema in the key schema, if the index covers the scan */
+  std::vector<uint32_t> out_key_idx_;
+  /** Whether the output is built from the keys alone */
+  bool index_only_{false};
 };
 }  // namespace bustub
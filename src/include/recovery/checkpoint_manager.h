@@ -12,6 +12,8 @@
 
 #pragma once
 
+#include <thread>  // NOLINT
+
 #include "buffer/buffer_pool_manager.h"
 #include "concurrency/transaction_manager.h"
 #include "recovery/log_manager.h"
@@ -19,25 +21,40 @@
 namespace bustub {
 
 /**
- * CheckpointManager creates consistent checkpoints by blocking all other transactions temporarily.
+ * CheckpointManager takes fuzzy checkpoints, which never block transactions.
+ *
+ * BeginCheckpoint logs BEGIN_CHECKPOINT, snapshots the active transaction table and the dirty page table into an
+ * END_CHECKPOINT record, and starts writing the dirty pages back in the background. EndCheckpoint waits for the pages
+ * and points the master record at the END_CHECKPOINT record. Recovery then starts redo from the oldest recLSN in the
+ * dirty page table instead of the head of the log, and the log segments before where it starts reading are recycled.
  */
 class CheckpointManager {
  public:
   CheckpointManager(TransactionManager *transaction_manager, LogManager *log_manager,
-                    BufferPoolManager *buffer_pool_manager)
+                    BufferPoolManager *buffer_pool_manager, DiskManager *disk_manager)
       : transaction_manager_(transaction_manager),
         log_manager_(log_manager),
-        buffer_pool_manager_(buffer_pool_manager) {}
+        buffer_pool_manager_(buffer_pool_manager),
+        disk_manager_(disk_manager) {}
 
-  ~CheckpointManager() = default;
+  ~CheckpointManager();
 
   void BeginCheckpoint();
   void EndCheckpoint();
 
  private:
-  TransactionManager *transaction_manager_ __attribute__((__unused__));
-  LogManager *log_manager_ __attribute__((__unused__));
-  BufferPoolManager *buffer_pool_manager_ __attribute__((__unused__));
+  TransactionManager *transaction_manager_;
+  LogManager *log_manager_;
+  BufferPoolManager *buffer_pool_manager_;
+  DiskManager *disk_manager_;
+
+  /** Writes back the pages of the checkpoint in progress. */
+  std::thread flush_thread_;
+  /** LSN of the END_CHECKPOINT record of the checkpoint in progress, and the log offset to look for it from. */
+  lsn_t checkpoint_lsn_{INVALID_LSN};
+  int64_t checkpoint_offset_{-1};
+  /** Log offset at which recovery from the checkpoint in progress starts reading. */
+  int64_t read_offset_{0};
 };
 
 }  // namespace bustub
@@ -0,0 +1,65 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// log_compression.h
+//
+// Identification: src/include/recovery/log_compression.h
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <cstdint>
+
+namespace bustub {
+
+/**
+ * LogCompression turns a log buffer into a compressed log block and back.
+ *
+ * A block is a header followed by the buffer compressed in the LZ4 block format: literal runs and back references of
+ * at least four bytes into the previous 64KB, found with a hash table over four-byte sequences.
+ *
+ *-------------------------------------------------------------
+ * | LOG_BLOCK_MARKER | compressed_size | raw_size | data... |
+ *-------------------------------------------------------------
+ * The marker is negative, so a block is never mistaken for a log record, whose size comes first.
+ */
+class LogCompression {
+ public:
+  static constexpr int32_t LOG_BLOCK_MARKER = -1;
+  static constexpr int LOG_BLOCK_HEADER_SIZE = 12;
+
+  /**
+   * Compress a log buffer into a block.
+   * @param data the log buffer
+   * @param size size of the log buffer
+   * @param[out] block output, with room for size bytes
+   * @return the size of the block, or 0 if it would not be smaller than the buffer
+   */
+  static int CompressBlock(const char *data, int size, char *block);
+
+  /** @return true if the bytes at data start a compressed block */
+  static bool IsBlock(const char *data, int available);
+
+  /**
+   * Decompress a block.
+   * @param block the block, which IsBlock() accepted
+   * @param available number of bytes available at block
+   * @param[out] data output, with room for the largest log buffer
+   * @param[out] size size of the decompressed log buffer
+   * @return the size of the block, 0 if fewer than that are available, or -1 if the block is corrupt
+   */
+  static int DecompressBlock(const char *block, int available, char *data, int *size);
+
+ private:
+  /** @return compressed size, or 0 if the output does not fit into capacity bytes */
+  static int Compress(const char *src, int size, char *dst, int capacity);
+
+  /** @return false unless src decompresses to exactly size bytes */
+  static bool Decompress(const char *src, int src_size, char *dst, int size);
+};
+
+}  // namespace bustub
@@ -14,8 +14,10 @@
 
 #include <algorithm>
 #include <condition_variable>  // NOLINT
-#include <future>              // NOLINT
+#include <deque>
+#include <future>  // NOLINT
 #include <mutex>               // NOLINT
+#include <thread>              // NOLINT
 
 #include "recovery/log_record.h"
 #include "storage/disk/disk_manager.h"
@@ -25,20 +27,33 @@ namespace bustub {
 /**
  * LogManager maintains a separate thread that is awakened whenever the log buffer is full or whenever a timeout
  * happens. When the thread is awakened, the log buffer's content is written into the disk log file.
+ *
+ * Appenders never take a latch on the fast path: a single atomic fetch-add on reservation_ hands out both the LSN and
+ * the space of a record in the log buffer, so LSNs follow the order of the records in the log. The appender whose
+ * reservation overflows the buffer seals it and wakes the flush thread; later appenders wait for the swap. The flush
+ * thread swaps log_buffer_ and flush_buffer_ once every reserved record is copied, then writes and syncs the sealed
+ * buffer while appenders fill the other one. Committers that wait in Flush while a write is in progress are all made
+ * durable by the next one, which is what turns many commits into one fsync. With log_compression on, the flush thread
+ * writes a buffer as a compressed LogCompression block instead whenever the block is smaller.
  */
 class LogManager {
  public:
-  explicit LogManager(DiskManager *disk_manager)
-      : next_lsn_(0), persistent_lsn_(INVALID_LSN), disk_manager_(disk_manager) {
+  explicit LogManager(DiskManager *disk_manager) : persistent_lsn_(INVALID_LSN), disk_manager_(disk_manager) {
     log_buffer_ = new char[LOG_BUFFER_SIZE];
     flush_buffer_ = new char[LOG_BUFFER_SIZE];
+    compress_buffer_ = new char[LOG_BUFFER_SIZE];
+    log_file_size_ = disk_manager->GetLogSize();
+    buffer_offsets_.emplace_back(0, log_file_size_);
   }
 
   ~LogManager() {
+    StopFlushThread();
     delete[] log_buffer_;
     delete[] flush_buffer_;
+    delete[] compress_buffer_;
     log_buffer_ = nullptr;
     flush_buffer_ = nullptr;
+    compress_buffer_ = nullptr;
   }
 
   void RunFlushThread();
@@ -46,29 +61,94 @@ class LogManager {
 
   lsn_t AppendLogRecord(LogRecord *log_record);
 
-  inline lsn_t GetNextLSN() { return next_lsn_; }
+  /**
+   * Block until every log record up to and including lsn is on disk. The flush thread is woken to write the log buffer
+   * right away rather than at the next timeout. Returns immediately if the flush thread is not running.
+   * @param lsn the LSN that must become persistent
+   */
+  void Flush(lsn_t lsn);
+
+  /**
+   * Find where to start reading the log file to see a record. The log manager remembers where each log buffer it wrote
+   * starts, so the offset is that of the buffer holding the record, or of an earlier one. A compressed buffer starts
+   * where its block does. Waits for the log buffer being written, if the record is in the one after it.
+   * @param lsn LSN of the record, which must not be older than the LSN last passed to TrimLogOffsets()
+   * @return an offset in the log file at or before the record
+   */
+  int64_t GetLogOffset(lsn_t lsn);
+
+  /**
+   * Forget where the log buffers before the one holding lsn start, since GetLogOffset() will not be asked for them.
+   * @param lsn the oldest LSN that may still be looked up
+   */
+  void TrimLogOffsets(lsn_t lsn);
+
+  /** @return the LSN the next record will get; may run ahead while a full buffer is being swapped */
+  inline lsn_t GetNextLSN() { return static_cast<lsn_t>(reservation_.load() >> RESERVATION_LSN_SHIFT); }
   inline lsn_t GetPersistentLSN() { return persistent_lsn_; }
   inline void SetPersistentLSN(lsn_t lsn) { persistent_lsn_ = lsn; }
   inline char *GetLogBuffer() { return log_buffer_; }
 
  private:
-  // TODO(students): you may add your own member variables
+  /** reservation_ keeps the next LSN in its upper half and the bytes reserved in log_buffer_ in its lower half. */
+  static constexpr int RESERVATION_LSN_SHIFT = 32;
+  static constexpr uint64_t RESERVATION_OFFSET_MASK = (uint64_t{1} << RESERVATION_LSN_SHIFT) - 1;
 
-  /** The atomic counter which records the next log sequence number. */
-  std::atomic<lsn_t> next_lsn_;
+  /** Serialize a record, whose LSN is already set, into buf. */
+  static void SerializeLogRecord(const LogRecord &log_record, char *buf);
+
+  /** Body of the flush thread. */
+  void FlushLoop();
+
+  /** Record that the buffer was sealed by the reservation that returned state. Must hold latch_. */
+  void SealLogBuffer(uint64_t state);
+
+  /** Remember that log_buffer_ starts at offset in the log file, -1 while unknown. Must hold latch_. */
+  void AddLogOffset(lsn_t first_lsn, int64_t offset);
+
+  /** At most this many log buffer offsets are kept; beyond that, every other one is dropped. */
+  static constexpr size_t MAX_LOG_OFFSETS = 4096;
+
+  /** Packed next LSN and reserved bytes of log_buffer_, advanced with fetch-add by every appender. */
+  std::atomic<uint64_t> reservation_{0};
+  /** Bytes of log_buffer_ whose records are completely copied. */
+  std::atomic<uint64_t> filled_{0};
   /** The log records before and including the persistent lsn have been written to disk. */
   std::atomic<lsn_t> persistent_lsn_;
 
   char *log_buffer_;
   char *flush_buffer_;
+  /** Receives flush_buffer_ compressed into a block; the two are swapped if the block is written instead. */
+  char *compress_buffer_;
 
+  /** Protects the fields below and the buffer swap. */
   std::mutex latch_;
 
-  std::thread *flush_thread_ __attribute__((__unused__));
-
+  /**
+   * The first LSN and the log file offset of each log buffer written since the last trim, including log_buffer_. The
+   * offset of log_buffer_ is -1 while the buffer before it is written, since compression decides where it ends.
+   */
+  std::deque<std::pair<lsn_t, int64_t>> buffer_offsets_;
+  /** Bytes written to the log. */
+  int64_t log_file_size_;
+
+  std::thread *flush_thread_{nullptr};
+  bool running_{false};
+  /** A committer is waiting in Flush. */
+  bool flush_requested_{false};
+  /** log_buffer_ takes no more records; sealed_size_ bytes with the LSNs below sealed_next_lsn_ are to be written. */
+  bool sealed_{false};
+  uint64_t sealed_size_{0};
+  lsn_t sealed_next_lsn_{0};
+
+  /** Wakes the flush thread. */
   std::condition_variable cv_;
+  /** Signalled when a sealed buffer has been swapped out and appenders can reserve again. */
+  std::condition_variable swap_cv_;
+  /** Signalled when persistent_lsn_ advances and the offset of log_buffer_ is known. */
+  std::condition_variable flush_cv_;
 
-  DiskManager *disk_manager_ __attribute__((__unused__));
+  DiskManager *disk_manager_;
 };
 
 }  // namespace bustub
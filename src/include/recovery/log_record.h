@@ -13,7 +13,10 @@
 #pragma once
 
 #include <cassert>
+#include <cstdint>
 #include <string>
+#include <utility>
+#include <vector>
 
 #include "common/config.h"
 #include "storage/table/tuple.h"
@@ -32,6 +35,12 @@ enum class LogRecordType {
   ABORT,
   /** Creating a new page in the table heap. */
   NEWPAGE,
+  /** Start of a fuzzy checkpoint. */
+  BEGIN_CHECKPOINT,
+  /** End of a fuzzy checkpoint, carrying the active transaction table and the dirty page table. */
+  END_CHECKPOINT,
+  /** An UPDATE that keeps the size of the tuple, logged as the byte ranges that changed. */
+  UPDATE_DELTA,
 };
 
 /**
@@ -53,10 +62,19 @@ enum class LogRecordType {
  *-----------------------------------------------------------------------------------
  * | HEADER | tuple_rid | tuple_size | old_tuple_data | tuple_size | new_tuple_data |
  *-----------------------------------------------------------------------------------
+ * For update delta type log record, each range holds the old and then the new bytes at offset in the tuple
+ *------------------------------------------------------------------------------
+ * | HEADER | tuple_rid | tuple_size | range_count | (offset, length, old, new)* |
+ *------------------------------------------------------------------------------
  * For new page type log record
  *--------------------------
  * | HEADER | prev_page_id |
  *--------------------------
+ * For end checkpoint type log record (begin checkpoint has just the HEADER)
+ *----------------------------------------------------------------------------------------------------------------
+ * | HEADER | begin_lsn | redo_lsn | redo_offset | txn_count | (txn_id, last_lsn)* | page_count | (page_id, rec_lsn)* |
+ *----------------------------------------------------------------------------------------------------------------
+ * A count of -1 means that the table did not fit into the record and was left out.
  */
 class LogRecord {
   friend class LogManager;
@@ -85,17 +103,16 @@ class LogRecord {
     size_ = HEADER_SIZE + sizeof(RID) + sizeof(int32_t) + tuple.GetLength();
   }
 
-  // constructor for UPDATE type
+  // constructor for UPDATE type; becomes UPDATE_DELTA if logging only the changed bytes is smaller
   LogRecord(txn_id_t txn_id, lsn_t prev_lsn, LogRecordType log_record_type, const RID &update_rid,
             const Tuple &old_tuple, const Tuple &new_tuple)
-      : txn_id_(txn_id),
-        prev_lsn_(prev_lsn),
-        log_record_type_(log_record_type),
-        update_rid_(update_rid),
-        old_tuple_(old_tuple),
-        new_tuple_(new_tuple) {
+      : txn_id_(txn_id), prev_lsn_(prev_lsn), log_record_type_(log_record_type), update_rid_(update_rid) {
     // calculate log record size
     size_ = HEADER_SIZE + sizeof(RID) + old_tuple.GetLength() + new_tuple.GetLength() + 2 * sizeof(int32_t);
+    if (log_record_type != LogRecordType::UPDATE || !MakeUpdateDelta(old_tuple, new_tuple)) {
+      old_tuple_ = old_tuple;
+      new_tuple_ = new_tuple;
+    }
   }
 
   // constructor for NEWPAGE type
@@ -110,6 +127,27 @@ class LogRecord {
     size_ = HEADER_SIZE + sizeof(page_id_t) * 2;
   }
 
+  // constructor for END_CHECKPOINT type
+  LogRecord(lsn_t begin_lsn, lsn_t redo_lsn, int64_t redo_offset, std::vector<std::pair<txn_id_t, lsn_t>> active_txns,
+            std::vector<std::pair<page_id_t, lsn_t>> dirty_pages)
+      : log_record_type_(LogRecordType::END_CHECKPOINT),
+        checkpoint_begin_lsn_(begin_lsn),
+        redo_lsn_(redo_lsn),
+        redo_offset_(redo_offset),
+        active_txns_(std::move(active_txns)),
+        dirty_pages_(std::move(dirty_pages)),
+        has_checkpoint_tables_(true) {
+    size_ = HEADER_SIZE + sizeof(lsn_t) * 2 + sizeof(int64_t) + sizeof(int32_t) * 2 +
+            (active_txns_.size() + dirty_pages_.size()) * CHECKPOINT_ENTRY_SIZE;
+    if (size_ > LOG_BUFFER_SIZE) {
+      // Both tables only narrow down what redo looks at, so recovery is still correct without them.
+      active_txns_.clear();
+      dirty_pages_.clear();
+      has_checkpoint_tables_ = false;
+      size_ = HEADER_SIZE + sizeof(lsn_t) * 2 + sizeof(int64_t) + sizeof(int32_t) * 2;
+    }
+  }
+
   ~LogRecord() = default;
 
   inline Tuple &GetDeleteTuple() { return delete_tuple_; }
@@ -126,8 +164,24 @@ class LogRecord {
 
   inline RID &GetUpdateRID() { return update_rid_; }
 
+  /** @return the (offset, length) ranges of the tuple that an UPDATE_DELTA record changes */
+  inline std::vector<std::pair<uint16_t, uint16_t>> &GetUpdateRanges() { return update_ranges_; }
+
   inline page_id_t GetNewPageRecord() { return prev_page_id_; }
 
+  inline lsn_t GetCheckpointBeginLSN() { return checkpoint_begin_lsn_; }
+
+  inline lsn_t GetRedoLSN() { return redo_lsn_; }
+
+  inline int64_t GetRedoOffset() { return redo_offset_; }
+
+  inline std::vector<std::pair<txn_id_t, lsn_t>> &GetActiveTxns() { return active_txns_; }
+
+  inline std::vector<std::pair<page_id_t, lsn_t>> &GetDirtyPages() { return dirty_pages_; }
+
+  /** @return false if the checkpoint tables were too large to be logged */
+  inline bool HasCheckpointTables() { return has_checkpoint_tables_; }
+
   inline int32_t GetSize() { return size_; }
 
   inline lsn_t GetLSN() { return lsn_; }
@@ -168,15 +222,78 @@ class LogRecord {
   RID insert_rid_;
   Tuple insert_tuple_;
 
-  // case3: for update operation
+  // case3: for update operation; a delta keeps the old and new bytes of each changed range, concatenated in order
   RID update_rid_;
   Tuple old_tuple_;
   Tuple new_tuple_;
+  uint32_t update_tuple_size_{0};
+  std::vector<std::pair<uint16_t, uint16_t>> update_ranges_;
+  std::string update_old_bytes_;
+  std::string update_new_bytes_;
 
   // case4: for new page operation
   page_id_t prev_page_id_{INVALID_PAGE_ID};
   page_id_t page_id_{INVALID_PAGE_ID};
+
+  // case5: for end checkpoint; redo reads the log from redo_offset_ and replays the records from redo_lsn_ on
+  lsn_t checkpoint_begin_lsn_{INVALID_LSN};
+  lsn_t redo_lsn_{INVALID_LSN};
+  int64_t redo_offset_{0};
+  std::vector<std::pair<txn_id_t, lsn_t>> active_txns_;
+  std::vector<std::pair<page_id_t, lsn_t>> dirty_pages_;
+  bool has_checkpoint_tables_{false};
+
   static const int HEADER_SIZE = 20;
+  static const int CHECKPOINT_ENTRY_SIZE = 8;
+  /** Bytes of an update range besides its data: offset and length. */
+  static const int UPDATE_RANGE_HEADER_SIZE = 4;
+  /** Unchanged runs up to this long between two changed ranges cost less to log than starting a new range. */
+  static const int UPDATE_RANGE_MAX_GAP = UPDATE_RANGE_HEADER_SIZE / 2;
+
+  /**
+   * Turn an UPDATE into an UPDATE_DELTA holding the byte ranges that differ between the tuples.
+   * @return false, leaving the record unchanged, if the tuple sizes differ or the delta is not smaller
+   */
+  bool MakeUpdateDelta(const Tuple &old_tuple, const Tuple &new_tuple) {
+    uint32_t length = old_tuple.GetLength();
+    if (length != new_tuple.GetLength() || length > UINT16_MAX) {
+      return false;
+    }
+    const char *old_data = old_tuple.GetData();
+    const char *new_data = new_tuple.GetData();
+    std::vector<std::pair<uint16_t, uint16_t>> ranges;
+    uint32_t delta_size = HEADER_SIZE + sizeof(RID) + 2 * sizeof(int32_t);
+    uint32_t full_size = size_;
+    for (uint32_t i = 0; i < length; i++) {
+      if (old_data[i] == new_data[i]) {
+        continue;
+      }
+      uint32_t end = i + 1;
+      for (uint32_t same = 0; end + same < length && same <= UPDATE_RANGE_MAX_GAP;) {
+        if (old_data[end + same] == new_data[end + same]) {
+          same++;
+        } else {
+          end += same + 1;
+          same = 0;
+        }
+      }
+      ranges.emplace_back(i, end - i);
+      delta_size += UPDATE_RANGE_HEADER_SIZE + 2 * (end - i);
+      if (delta_size >= full_size) {
+        return false;
+      }
+      i = end;
+    }
+    log_record_type_ = LogRecordType::UPDATE_DELTA;
+    size_ = delta_size;
+    update_tuple_size_ = length;
+    for (const auto &[offset, range_length] : ranges) {
+      update_old_bytes_.append(old_data + offset, range_length);
+      update_new_bytes_.append(new_data + offset, range_length);
+    }
+    update_ranges_ = std::move(ranges);
+    return true;
+  }
 };  // namespace bustub
 
 }  // namespace bustub
@@ -13,8 +13,13 @@
 #pragma once
 
 #include <algorithm>
+#include <condition_variable>  // NOLINT
+#include <deque>
+#include <functional>
+#include <memory>
 #include <mutex>  // NOLINT
 #include <unordered_map>
+#include <vector>
 
 #include "buffer/buffer_pool_manager.h"
 #include "concurrency/lock_manager.h"
@@ -24,34 +29,133 @@ namespace bustub {
 
 /**
  * Read log file from disk, redo and undo.
+ *
+ * Redo reads the log sequentially in LOG_RECOVERY_READ_SIZE chunks, reading the next chunk in the background while
+ * the current one is parsed. Records are partitioned by the page they change across worker threads, so the records of
+ * one page are replayed in log order by a single thread and no page latches are needed. Undo rolls back the loser
+ * transactions in parallel, one transaction at a time per thread.
+ *
+ * If the master record points to a fuzzy checkpoint, the log is read from where the checkpoint says and redo starts at
+ * the oldest recLSN in its dirty page table rather than at the head of the log.
+ *
+ * The log may interleave plain log buffers with compressed LogCompression blocks, which are decompressed as they are
+ * read.
  */
 class LogRecovery {
  public:
-  LogRecovery(DiskManager *disk_manager, BufferPoolManager *buffer_pool_manager)
-      : disk_manager_(disk_manager), buffer_pool_manager_(buffer_pool_manager), offset_(0) {
-    log_buffer_ = new char[LOG_BUFFER_SIZE];
+  LogRecovery(DiskManager *disk_manager, BufferPoolManager *buffer_pool_manager,
+              size_t num_threads = LOG_RECOVERY_THREADS)
+      : disk_manager_(disk_manager),
+        buffer_pool_manager_(buffer_pool_manager),
+        num_threads_(std::max<size_t>(num_threads, 1)),
+        offset_(0) {
+    // Room for one chunk, preceded by the unparsed tail of the previous chunk, which is shorter than a record.
+    log_buffer_ = new char[LOG_BUFFER_SIZE + LOG_RECOVERY_READ_SIZE];
+    read_ahead_buffer_ = new char[LOG_BUFFER_SIZE + LOG_RECOVERY_READ_SIZE];
+    block_buffer_ = new char[LOG_BUFFER_SIZE];
   }
 
   ~LogRecovery() {
     delete[] log_buffer_;
+    delete[] read_ahead_buffer_;
+    delete[] block_buffer_;
     log_buffer_ = nullptr;
+    read_ahead_buffer_ = nullptr;
+    block_buffer_ = nullptr;
   }
 
   void Redo();
   void Undo();
-  bool DeserializeLogRecord(const char *data, LogRecord *log_record);
+
+  /**
+   * Deserialize one log record.
+   * @param data the serialized record
+   * @param size number of bytes available at data
+   * @param[out] log_record the record
+   * @return false if data does not hold a complete record, e.g. at the end of the log
+   */
+  bool DeserializeLogRecord(const char *data, int size, LogRecord *log_record);
+
+  /**
+   * Read the END_CHECKPOINT record that the master record points to.
+   * @param[out] checkpoint the record
+   * @return false if there is no complete checkpoint
+   */
+  bool ReadCheckpoint(LogRecord *checkpoint);
 
  private:
-  DiskManager *disk_manager_ __attribute__((__unused__));
-  BufferPoolManager *buffer_pool_manager_ __attribute__((__unused__));
+  /** Where a record is in the log file. */
+  struct LogPosition {
+    /** Offset of the record, or of the compressed block holding it. */
+    int64_t offset_;
+    /** Offset of the record in the decompressed block, or -1 if it is not compressed. */
+    int block_offset_;
+  };
+
+  /** Buffers for reading single records, which keep the block last decompressed. */
+  struct LogReadBuffer {
+    std::unique_ptr<char[]> data_{new char[LOG_BUFFER_SIZE]};
+    std::unique_ptr<char[]> block_{new char[LOG_BUFFER_SIZE]};
+    /** Log offset of the block in block_, and its decompressed size. */
+    int64_t block_offset_{-1};
+    int block_size_{0};
+  };
+
+  /** The part of a record that changes one page. */
+  struct RedoTask {
+    page_id_t page_id_;
+    LogRecord log_record_;
+  };
+
+  /** A redo worker and the batches of records it still has to replay. */
+  struct RedoWorker {
+    std::mutex latch_;
+    /** Signalled when a batch is added or taken, or when no more batches will come. */
+    std::condition_variable cv_;
+    std::deque<std::vector<RedoTask>> batches_;
+    bool done_{false};
+  };
+
+  /** @return the pages a record changes; NEWPAGE changes both the new page and its predecessor */
+  static std::vector<page_id_t> GetChangedPages(LogRecord *log_record);
+
+  /** Replay the part of a record that changes page_id, unless the page already reflects it. */
+  void RedoLogRecord(LogRecord *log_record, page_id_t page_id);
+
+  /** Roll back one change of a loser transaction. */
+  void UndoLogRecord(LogRecord *log_record);
+
+  /** Apply the ranges of an UPDATE_DELTA record to a copy of the tuple, taking the old bytes if undo is set. */
+  static bool ApplyUpdateDelta(const LogRecord &log_record, bool undo, Tuple *tuple);
+
+  /** Read the record at position in the log file. */
+  bool ReadLogRecord(const LogPosition &position, LogReadBuffer *buf, LogRecord *log_record);
+
+  /**
+   * Read the log from offset to its end, in LOG_RECOVERY_READ_SIZE chunks read ahead in the background, and pass each
+   * record to visit, which returns false to stop the scan.
+   * @return the log file offset after the last complete record or block
+   */
+  int64_t ScanLog(int64_t offset, const std::function<bool(LogRecord *, const LogPosition &)> &visit);
+
+  /** Body of a redo worker thread. */
+  void RunRedoWorker(RedoWorker *worker);
+
+  DiskManager *disk_manager_;
+  BufferPoolManager *buffer_pool_manager_;
+  size_t num_threads_;
 
   /** Maintain active transactions and its corresponding latest lsn. */
   std::unordered_map<txn_id_t, lsn_t> active_txn_;
-  /** Mapping the log sequence number to log file offset for undos. */
-  std::unordered_map<lsn_t, int> lsn_mapping_;
+  /** Mapping the log sequence number to log file position for undos. */
+  std::unordered_map<lsn_t, LogPosition> lsn_mapping_;
 
-  int offset_ __attribute__((__unused__));
+  /** Log offset of the first byte in log_buffer_ that has not been parsed. */
+  int64_t offset_;
   char *log_buffer_;
+  char *read_ahead_buffer_;
+  /** The compressed block being scanned, decompressed. */
+  char *block_buffer_;
 };
 
 }  // namespace bustub
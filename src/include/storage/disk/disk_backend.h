@@ -0,0 +1,85 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// disk_backend.h
+//
+// Identification: src/include/storage/disk/disk_backend.h
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <functional>
+#include <vector>
+
+#include "common/config.h"
+
+namespace bustub {
+
+/** The ways a DiskManager can perform page I/O on the database file. */
+enum class DiskBackendType {
+  /** One std::fstream behind a latch; every access is a seek followed by a read or write. */
+  STREAM,
+  /** Positional reads and writes on a raw descriptor, with a pool of I/O threads for asynchronous requests. */
+  POSIX,
+  /** POSIX for synchronous I/O, plus an io_uring submission queue for asynchronous requests. */
+  IO_URING
+};
+
+/**
+ * An asynchronous page I/O request covering a run of pages with consecutive ids.
+ */
+struct DiskRequest {
+  /** True to write the pages, false to read them. */
+  bool is_write_;
+  /** Id of the first page of the run. */
+  page_id_t page_id_;
+  /** One PAGE_SIZE buffer per page of the run. They must stay valid until the callback runs. */
+  std::vector<char *> pages_data_;
+  /** Invoked exactly once when the whole run has been transferred, possibly on a backend thread. */
+  std::function<void()> callback_;
+};
+
+/**
+ * DiskBackend performs page I/O on the database file for the DiskManager. Synchronous calls may be issued from any
+ * number of threads. I/O errors are logged, as DiskManager always did; reads past the end of the file are tolerated.
+ */
+class DiskBackend {
+ public:
+  virtual ~DiskBackend() = default;
+
+  /** Read a run of pages with consecutive ids. */
+  virtual void ReadPages(page_id_t page_id, char *const *pages_data, size_t num_pages) = 0;
+
+  /** Write a run of pages with consecutive ids. */
+  virtual void WritePages(page_id_t page_id, const char *const *pages_data, size_t num_pages) = 0;
+
+  /** Force every write issued so far to stable storage. */
+  virtual void Sync() = 0;
+
+  /** @return the number of pages the database file currently holds */
+  virtual page_id_t GetNumPages() = 0;
+
+  /**
+   * Start a batch of requests. The default implementation performs them one after another before returning, invoking
+   * each callback on the calling thread.
+   */
+  virtual void Submit(std::vector<DiskRequest> *requests) {
+    for (auto &request : *requests) {
+      if (request.is_write_) {
+        WritePages(request.page_id_, request.pages_data_.data(), request.pages_data_.size());
+      } else {
+        ReadPages(request.page_id_, request.pages_data_.data(), request.pages_data_.size());
+      }
+      request.callback_();
+    }
+  }
+
+  /** Wait for every submitted request to complete, then release the database file. */
+  virtual void ShutDown() = 0;
+};
+
+}  // namespace bustub
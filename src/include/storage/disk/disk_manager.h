@@ -13,28 +13,46 @@
 #pragma once
 
 #include <atomic>
-#include <fstream>
 #include <future>  // NOLINT
-#include <mutex>   // NOLINT
+#include <map>
+#include <memory>
+#include <mutex>  // NOLINT
 #include <string>
+#include <vector>
 
 #include "common/config.h"
+#include "storage/disk/disk_backend.h"
 
 namespace bustub {
 
 /**
  * DiskManager takes care of the allocation and deallocation of pages within a database. It performs the reading and
  * writing of pages to and from disk, providing a logical file layer within the context of a database management system.
+ *
+ * The log is one stream of bytes addressed by 64-bit offsets and stored in fixed-size segment files named
+ * <db>.log.<segment number>. The file <db>.log records the segment size. Each segment is zero-filled before records
+ * are written to it, in the background while the previous segment fills up, so syncing a log write never allocates
+ * blocks. Segments holding only records older than the last checkpoint are recycled as the next ones.
+ *
+ * The last PAGE_CHECKSUM_SIZE bytes of every page hold a CRC-32C of the rest of the page, seeded with the page id so
+ * that a page written to the wrong place is caught too. Writes fill it in, and reads check it and throw
+ * CorruptedPageException on a mismatch. A page of zeros, which is what a page that was never written reads as, passes.
  */
 class DiskManager {
  public:
   /**
    * Creates a new disk manager that writes to the specified database file.
    * @param db_file the file name of the database file to write to
+   * @param backend_type how pages are read and written; if io_uring is unavailable, IO_URING falls back to POSIX with
+   * direct_io and to STREAM without
+   * @param direct_io true to bypass the OS page cache with O_DIRECT, which the buffer pool already caches for; only
+   * the POSIX and IO_URING backends support it
+   * @param log_segment_size bytes of log records per log segment file; an existing log keeps its own
    */
-  explicit DiskManager(const std::string &db_file);
+  explicit DiskManager(const std::string &db_file, DiskBackendType backend_type = DiskBackendType::IO_URING,
+                       bool direct_io = false, int64_t log_segment_size = LOG_SEGMENT_SIZE);
 
-  ~DiskManager() = default;
+  ~DiskManager();
 
   /**
    * Shut down the disk manager and close all the file resources.
@@ -44,32 +62,95 @@ class DiskManager {
   /**
    * Write a page to the database file.
    * @param page_id id of the page
-   * @param page_data raw page data
+   * @param page_data raw page data; its checksum is filled in
    */
-  void WritePage(page_id_t page_id, const char *page_data);
+  void WritePage(page_id_t page_id, char *page_data);
+
+  /**
+   * Write a run of pages with consecutive ids using vectored writes. The pages are not forced to stable storage;
+   * call SyncPages() once the whole batch has been written.
+   * @param page_id id of the first page of the run
+   * @param pages_data raw data of each page in the run; their checksums are filled in
+   * @param num_pages number of pages in the run
+   */
+  void WritePages(page_id_t page_id, char *const *pages_data, size_t num_pages);
+
+  /**
+   * Force all pages written so far to stable storage.
+   */
+  void SyncPages();
+
+  /**
+   * Read a run of pages with consecutive ids using vectored reads. Pages past the end of the file are zeroed.
+   * @param page_id id of the first page of the run
+   * @param pages_data output buffer of each page in the run
+   * @param num_pages number of pages in the run
+   * @param verify false to skip checking the checksums, e.g. for a bulk scan that checks the pages some other way
+   * @throws CorruptedPageException if verify is set and a page does not match its checksum
+   */
+  void ReadPages(page_id_t page_id, char *const *pages_data, size_t num_pages, bool verify = true);
+
+  /**
+   * Start asynchronous reads and writes of page runs. Each request's callback runs once it completes, possibly on a
+   * backend thread and possibly before this call returns; callbacks must not wait for other disk I/O. Checksums are
+   * filled in before writes, but reads are not verified, since a callback cannot throw; use VerifyPage().
+   * @param requests the requests to start; they are moved from
+   */
+  void SubmitRequests(std::vector<DiskRequest> *requests);
 
   /**
    * Read a page from the database file.
    * @param page_id id of the page
    * @param[out] page_data output buffer
+   * @param verify false to skip checking the checksum
+   * @throws CorruptedPageException if verify is set and the page does not match its checksum
    */
-  void ReadPage(page_id_t page_id, char *page_data);
+  void ReadPage(page_id_t page_id, char *page_data, bool verify = true);
+
+  /** @return true if the page read from disk matches its checksum or is all zeros */
+  static bool VerifyPage(page_id_t page_id, const char *page_data);
 
   /**
-   * Flush the entire log buffer into disk.
+   * Append the entire log buffer to the log and sync it to disk.
    * @param log_data raw log data
    * @param size size of log entry
    */
   void WriteLog(char *log_data, int size);
 
   /**
-   * Read a log entry from the log file.
+   * Read a log entry from the log. Bytes past the end of the log read as zeros.
    * @param[out] log_data output buffer
    * @param size size of the log entry
-   * @param offset offset of the log entry in the file
-   * @return true if the read was successful, false otherwise
+   * @param offset offset of the log entry in the log
+   * @return true if the read was successful, false if offset is past the end of the log or was recycled
+   */
+  bool ReadLog(char *log_data, int size, int64_t offset);
+
+  /** @return the size of the log in bytes, including the recycled segments at its head */
+  int64_t GetLogSize();
+
+  /** @return the offset of the first log byte that has not been recycled */
+  int64_t GetLogStart();
+
+  /**
+   * Recycle the log segments that hold only bytes before offset, so that they are reused for the end of the log. At
+   * most LOG_MAX_SPARE_SEGMENTS are kept for reuse; the others are deleted.
+   * @param offset the oldest log offset that may still be read
+   */
+  void RecycleLogSegments(int64_t offset);
+
+  /**
+   * Durably record where the last complete checkpoint is, replacing the previous master record atomically.
+   * @param offset offset in the log at or before the END_CHECKPOINT record, where a log buffer starts
+   * @param lsn LSN of the END_CHECKPOINT record
+   */
+  void WriteMasterRecord(int64_t offset, lsn_t lsn);
+
+  /**
+   * Read the location last passed to WriteMasterRecord().
+   * @return false if the log has no checkpoint
    */
-  bool ReadLog(char *log_data, int size, int offset);
+  bool ReadMasterRecord(int64_t *offset, lsn_t *lsn);
 
   /** @return the number of disk flushes */
   int GetNumFlushes() const;
@@ -80,6 +161,12 @@ class DiskManager {
   /** @return the number of disk writes */
   int GetNumWrites() const;
 
+  /** @return the number of page reads */
+  int GetNumReads() const;
+
+  /** @return the number of pages the database file currently holds */
+  page_id_t GetNumPages();
+
   /**
    * Sets the future which is used to check for non-blocking flushes.
    * @param f the non-blocking flush check
@@ -90,19 +177,64 @@ class DiskManager {
   inline bool HasFlushLogFuture() { return flush_log_f_ != nullptr; }
 
  private:
-  int GetFileSize(const std::string &file_name);
-  // stream to write log file
-  std::fstream log_io_;
+  /** Offset of the checksum in a page. */
+  static constexpr int OFFSET_PAGE_CHECKSUM = PAGE_SIZE - PAGE_CHECKSUM_SIZE;
+
+  /** @return the checksum of the page without its checksum field */
+  static uint32_t ComputePageChecksum(page_id_t page_id, const char *page_data);
+
+  /** Fill in the checksum of a page about to be written. */
+  static void StampPage(page_id_t page_id, char *page_data);
+
+  /** Each log segment file starts with its segment number and the number of log bytes written to it. */
+  static constexpr int LOG_SEGMENT_HEADER_SIZE = 2 * sizeof(int64_t);
+
+  /** Find the segments of an existing log and where it ends, or start a new log if there is none. */
+  void OpenLog();
+
+  /** Wait for the segment being prepared and close the open segments. */
+  void CloseLog();
+
+  /** @return the name of the file holding the log bytes from segment * log_segment_size_ on */
+  std::string GetLogSegmentName(int64_t segment) const;
+
+  /**
+   * Open a log segment file. Must hold log_latch_.
+   * @param create true to prepare the segment if it does not exist yet
+   * @return its descriptor, or -1 if it does not exist
+   */
+  int OpenLogSegment(int64_t segment, bool create);
+
+  /** @return a recycled segment file to reuse, or an empty name if there is none. Must hold log_latch_. */
+  std::string TakeSpareLogSegment();
+
+  /** Zero-fill the spare file, or a new one if there is none, under a temporary name and move it into place. */
+  void PrepareLogSegment(int64_t segment, const std::string &spare_name);
+
+  // file recording the log segment size; the log exists only while this file does
   std::string log_name_;
-  // stream to write db file
-  std::fstream db_io_;
+  int64_t log_segment_size_;
+  // protects the log segment fields below
+  std::mutex log_latch_;
+  // descriptors of the open log segments by segment number
+  std::map<int64_t, int> log_segment_fds_;
+  // segment holding the first log byte that has not been recycled
+  int64_t first_log_segment_{0};
+  // recycled segment files waiting to be reused
+  std::vector<std::string> spare_log_segments_;
+  // preparation of the segment after the one being written
+  std::future<void> log_segment_prep_;
+  std::atomic<int64_t> log_size_{0};
+  // file holding the master record, next to the log file
+  std::string master_name_;
+  // backend performing all page I/O on the db file
+  std::unique_ptr<DiskBackend> backend_;
   std::string file_name_;
-  int num_flushes_;
-  int num_writes_;
+  std::atomic<int> num_flushes_;
+  std::atomic<int> num_writes_;
+  std::atomic<int> num_reads_;
   bool flush_log_;
   std::future<void> *flush_log_f_;
-  // With multiple buffer pool instances, need to protect file access
-  std::mutex db_io_latch_;
 };
 
 }  // namespace bustub
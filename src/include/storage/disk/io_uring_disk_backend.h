@@ -0,0 +1,97 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// io_uring_disk_backend.h
+//
+// Identification: src/include/storage/disk/io_uring_disk_backend.h
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <condition_variable>  // NOLINT
+#include <mutex>               // NOLINT
+#include <string>
+#include <thread>  // NOLINT
+#include <vector>
+
+#include "storage/disk/posix_disk_backend.h"
+
+namespace bustub {
+
+/**
+ * IoUringDiskBackend serves asynchronous requests through an io_uring instance driven directly by system calls, so no
+ * extra library is needed. Submit places one vectored read or write per run of pages on the submission queue and
+ * enters the kernel once per batch; a completion thread reaps completions and invokes the callbacks. Up to
+ * queue_depth operations are in flight at once. Synchronous calls use the inherited pread/pwrite paths.
+ */
+class IoUringDiskBackend : public PosixDiskBackend {
+ public:
+  /**
+   * Open or create the database file and set up the ring.
+   * @param db_file the file name of the database file
+   * @param queue_depth number of submission queue entries
+   * @param direct_io true to bypass the OS page cache with O_DIRECT, if the file system supports it
+   * @throws Exception if io_uring is not supported by the build or the kernel
+   */
+  explicit IoUringDiskBackend(const std::string &db_file, unsigned queue_depth = IO_URING_QUEUE_DEPTH,
+                              bool direct_io = false);
+
+  ~IoUringDiskBackend() override;
+
+  void Submit(std::vector<DiskRequest> *requests) override;
+
+  void ShutDown() override;
+
+ private:
+  struct RequestState;
+  struct Operation;
+
+  /** Body of the completion thread. */
+  void RunCompletionThread();
+
+  /** Finish an operation whose completion reported res. */
+  void Complete(Operation *operation, int res);
+
+  /** Place one operation on the submission queue. Must hold latch_, and an entry must be free. */
+  void Enqueue(Operation *operation);
+
+  /** Hand every queued entry to the kernel. Must hold latch_. */
+  void SubmitQueued();
+
+  /** Unmap the rings and close the ring descriptor. */
+  void ReleaseRing();
+
+  int ring_fd_{-1};
+  unsigned sq_entries_{0};
+  /** Entries placed on the submission queue but not yet handed to the kernel. */
+  unsigned queued_{0};
+  /** Operations handed to the kernel whose completion has not been reaped yet. */
+  unsigned in_flight_{0};
+
+  void *sq_ring_{nullptr};
+  size_t sq_ring_size_{0};
+  void *cq_ring_{nullptr};
+  size_t cq_ring_size_{0};
+  void *sqes_{nullptr};
+  size_t sqes_size_{0};
+  unsigned *sq_head_{nullptr};
+  unsigned *sq_tail_{nullptr};
+  unsigned *sq_mask_{nullptr};
+  unsigned *sq_array_{nullptr};
+  unsigned *cq_head_{nullptr};
+  unsigned *cq_tail_{nullptr};
+  unsigned *cq_mask_{nullptr};
+  void *cqes_{nullptr};
+
+  std::thread completion_thread_;
+  /** Serializes submitters and protects queued_ and in_flight_. */
+  std::mutex latch_;
+  /** Signalled whenever an operation completes. */
+  std::condition_variable completion_cv_;
+};
+
+}  // namespace bustub
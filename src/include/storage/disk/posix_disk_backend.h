@@ -0,0 +1,80 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// posix_disk_backend.h
+//
+// Identification: src/include/storage/disk/posix_disk_backend.h
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <condition_variable>  // NOLINT
+#include <deque>
+#include <mutex>  // NOLINT
+#include <string>
+#include <thread>  // NOLINT
+#include <vector>
+
+#include "storage/disk/disk_backend.h"
+
+namespace bustub {
+
+/**
+ * PosixDiskBackend accesses the database file with pread/pwrite and their vectored variants on a raw descriptor. The
+ * calls carry their own offset, so page I/O from different threads proceeds in parallel without any latch.
+ * Asynchronous requests are served by a small pool of I/O threads, which bounds how many of them are in flight.
+ */
+class PosixDiskBackend : public DiskBackend {
+ public:
+  /**
+   * Open or create the database file.
+   * @param db_file the file name of the database file
+   * @param num_io_threads number of threads serving asynchronous requests; 0 starts none and makes Submit synchronous
+   * @param direct_io true to bypass the OS page cache with O_DIRECT, if the file system supports it
+   */
+  explicit PosixDiskBackend(const std::string &db_file, size_t num_io_threads = POSIX_DISK_BACKEND_THREADS,
+                            bool direct_io = false);
+
+  ~PosixDiskBackend() override;
+
+  void ReadPages(page_id_t page_id, char *const *pages_data, size_t num_pages) override;
+
+  void WritePages(page_id_t page_id, const char *const *pages_data, size_t num_pages) override;
+
+  void Sync() override;
+
+  page_id_t GetNumPages() override;
+
+  void Submit(std::vector<DiskRequest> *requests) override;
+
+  void ShutDown() override;
+
+  /** @return true if the database file was opened with O_DIRECT */
+  bool UsesDirectIO() const { return direct_io_; }
+
+ protected:
+  /** Body of an I/O thread. */
+  void RunIOThread();
+
+  /** Raw descriptor of the database file. */
+  int db_fd_;
+  /** True if db_fd_ bypasses the page cache, in which case every buffer must be PAGE_SIZE aligned. */
+  bool direct_io_{false};
+
+ private:
+  /** @return true if every buffer can be handed to the kernel as is */
+  bool CanTransferDirectly(const char *const *pages_data, size_t num_pages) const;
+
+  std::vector<std::thread> io_threads_;
+  /** Requests waiting for an I/O thread, protected by queue_latch_. */
+  std::deque<DiskRequest> queue_;
+  bool running_{true};
+  std::mutex queue_latch_;
+  std::condition_variable queue_cv_;
+};
+
+}  // namespace bustub
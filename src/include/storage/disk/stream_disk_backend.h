@@ -0,0 +1,57 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// stream_disk_backend.h
+//
+// Identification: src/include/storage/disk/stream_disk_backend.h
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <fstream>
+#include <mutex>  // NOLINT
+#include <string>
+
+#include "storage/disk/disk_backend.h"
+
+namespace bustub {
+
+/**
+ * StreamDiskBackend accesses the database file through a single std::fstream. All page I/O is serialized by one latch,
+ * and asynchronous requests complete synchronously. It is the fallback when no better backend is available.
+ */
+class StreamDiskBackend : public DiskBackend {
+ public:
+  /**
+   * Open or create the database file.
+   * @param db_file the file name of the database file
+   */
+  explicit StreamDiskBackend(const std::string &db_file);
+
+  void ReadPages(page_id_t page_id, char *const *pages_data, size_t num_pages) override;
+
+  void WritePages(page_id_t page_id, const char *const *pages_data, size_t num_pages) override;
+
+  void Sync() override;
+
+  page_id_t GetNumPages() override;
+
+  void ShutDown() override;
+
+ private:
+  void ReadPage(page_id_t page_id, char *page_data);
+
+  void WritePage(page_id_t page_id, const char *page_data);
+
+  int GetFileSize();
+
+  std::fstream db_io_;
+  std::string file_name_;
+  std::mutex db_io_latch_;
+};
+
+}  // namespace bustub
@@ -10,11 +10,16 @@
 //===----------------------------------------------------------------------===//
 #pragma once
 
+#include <atomic>
+#include <fstream>
+#include <functional>
+#include <mutex>  // NOLINT
 #include <queue>
 #include <string>
 #include <vector>
 
 #include "concurrency/transaction.h"
+#include "storage/index/epoch_manager.h"
 #include "storage/index/index_iterator.h"
 #include "storage/page/b_plus_tree_internal_page.h"
 #include "storage/page/b_plus_tree_leaf_page.h"
@@ -32,15 +37,31 @@ namespace bustub {
  * (2) support insert & remove
  * (3) The structure should shrink and grow dynamically
  * (4) Implement index iterator for range scan
+ *
+ * Concurrency follows optimistic lock coupling. Lookups and scans never latch a page: they read each page under its
+ * version (see BPlusTreePage) and restart from the root if a writer got in the way. Writers first descend the same
+ * way and write-latch only the leaf, which is all that most inserts and removes change. Only when the leaf would
+ * split or underflow do they restart with latch crabbing, taking the root latch and write latches from the root down
+ * and keeping them (in the transaction's page set) only on the pages the change can reach.
+ *
+ * As readers hold no latches, a page that a merge unlinks is deleted only once no reader can still be on its way to
+ * it. Every operation runs in an epoch of the tree's EpochManager for this.
  */
 INDEX_TEMPLATE_ARGUMENTS
 class BPlusTree {
   using InternalPage = BPlusTreeInternalPage<KeyType, page_id_t, KeyComparator>;
   using LeafPage = BPlusTreeLeafPage<KeyType, ValueType, KeyComparator>;
 
+  friend class INDEXITERATOR_TYPE;
+
+  enum class Operation { INSERT, REMOVE };
+
+  // which leaf to descend to when not looking for a key
+  enum class Edge { NONE, LEFT, RIGHT };
+
  public:
   explicit BPlusTree(std::string name, BufferPoolManager *buffer_pool_manager, const KeyComparator &comparator,
-                     int leaf_max_size = LEAF_PAGE_SIZE, int internal_max_size = INTERNAL_PAGE_SIZE);
+                     int leaf_max_size = LEAF_PAGE_SIZE, int internal_max_size = INTERNAL_PAGE_MAX_SIZE);
 
   // Returns true if this B+ tree has no keys and values.
   bool IsEmpty() const;
@@ -51,6 +72,9 @@ class BPlusTree {
   // Remove a key and its value from this B+ tree.
   void Remove(const KeyType &key, Transaction *transaction = nullptr);
 
+  // Build an empty B+ tree from key and value pairs produced in ascending key order, filling pages to fill_factor.
+  bool BulkLoad(const std::function<bool(KeyType *, ValueType *)> &next, double fill_factor = 1.0);
+
   // return the value associated with a given key
   bool GetValue(const KeyType &key, std::vector<ValueType> *result, Transaction *transaction = nullptr);
 
@@ -59,6 +83,10 @@ class BPlusTree {
   INDEXITERATOR_TYPE Begin(const KeyType &key);
   INDEXITERATOR_TYPE End();
 
+  // index iterator at the last entry (up to key), for backward scans with operator--
+  INDEXITERATOR_TYPE RBegin();
+  INDEXITERATOR_TYPE RBegin(const KeyType &key);
+
   void Print(BufferPoolManager *bpm) {
     ToString(reinterpret_cast<BPlusTreePage *>(bpm->FetchPage(root_page_id_)->GetData()), bpm);
   }
@@ -76,34 +104,83 @@ class BPlusTree {
 
   // read data from file and remove one by one
   void RemoveFromFile(const std::string &file_name, Transaction *transaction = nullptr);
-  // expose for test purpose
+  // expose for test purpose; the leaf is returned pinned but not latched
   Page *FindLeafPage(const KeyType &key, bool leftMost = false);
 
  private:
+  bool FindLeafPageOptimistic(const KeyType &key, Edge edge, Page **leaf_page, uint64_t *version);
+
+  Page *FindLeafPageForWrite(const KeyType &key, Operation operation, Transaction *transaction);
+
+  bool IsSafe(BPlusTreePage *node, Operation operation) const;
+
+  void SetPrevLeaf(page_id_t page_id, page_id_t prev_page_id);
+
+  Page *FetchTreePage(page_id_t page_id);
+
+  Page *FindLatchedPage(page_id_t page_id, Transaction *transaction) const;
+
+  void ReleaseLatchedPage(Page *page);
+
+  void ReleaseLatchedPages(Transaction *transaction);
+
+  void ReleaseLatchedPagesAfter(Page *page, Transaction *transaction);
+
   void StartNewTree(const KeyType &key, const ValueType &value);
 
-  bool InsertIntoLeaf(const KeyType &key, const ValueType &value, Transaction *transaction = nullptr);
+  bool InsertIntoLeaf(const KeyType &key, const ValueType &value, Transaction *transaction);
 
   void InsertIntoParent(BPlusTreePage *old_node, const KeyType &key, BPlusTreePage *new_node,
-                        Transaction *transaction = nullptr);
+                        Transaction *transaction);
 
   template <typename N>
-  N *Split(N *node);
+  N *Split(N *node, Transaction *transaction);
+
+  // bulk load support: the last two pages of one level of the tree being built, both pinned
+  struct BulkLoadLevel {
+    Page *prev_{nullptr};
+    Page *cur_{nullptr};
+  };
+
+  void BulkLoadNewPage(std::vector<BulkLoadLevel> *levels, size_t level, double fill_factor);
+
+  void BulkLoadAppend(std::vector<BulkLoadLevel> *levels, size_t level, Page *child_page, double fill_factor);
+
+  void BulkLoadAbort(std::vector<BulkLoadLevel> *levels);
+
+  int BulkLoadFill(BPlusTreePage *page, double fill_factor) const;
+
+  void RemoveFromLeaf(const KeyType &key, Transaction *transaction);
 
   template <typename N>
-  bool CoalesceOrRedistribute(N *node, Transaction *transaction = nullptr);
+  bool CoalesceOrRedistribute(N *node, Transaction *transaction);
 
   template <typename N>
   bool Coalesce(N **neighbor_node, N **node, BPlusTreeInternalPage<KeyType, page_id_t, KeyComparator> **parent,
-                int index, Transaction *transaction = nullptr);
+                int index, Transaction *transaction);
 
   template <typename N>
-  void Redistribute(N *neighbor_node, N *node, int index);
+  void Redistribute(N *neighbor_node, N *node, InternalPage *parent, int index);
 
   bool AdjustRoot(BPlusTreePage *node);
 
   void UpdateRootPageId(int insert_record = 0);
 
+  // iterator support
+  void SeekLeaf(INDEXITERATOR_TYPE *iterator, const KeyType *key, bool exclusive);
+
+  void SeekLeafReverse(INDEXITERATOR_TYPE *iterator, const KeyType *key, bool exclusive);
+
+  bool ReadLeaf(INDEXITERATOR_TYPE *iterator, const KeyType *key, Edge edge);
+
+  void NextLeaf(INDEXITERATOR_TYPE *iterator);
+
+  void PrevLeaf(INDEXITERATOR_TYPE *iterator);
+
+  bool ReadAdjacentLeaf(INDEXITERATOR_TYPE *iterator, bool forward);
+
+  void CopyLeafItems(LeafPage *leaf, std::vector<MappingType> *items) const;
+
   /* Debug Routines for FREE!! */
   void ToGraph(BPlusTreePage *page, BufferPoolManager *bpm, std::ofstream &out) const;
 
@@ -111,8 +188,13 @@ class BPlusTree {
 
   // member variable
   std::string index_name_;
-  page_id_t root_page_id_;
+  // read without the root latch by optimistic readers, changed only under it
+  std::atomic<page_id_t> root_page_id_;
+  // held by crabbing writers for as long as they hold the root page, which they may replace
+  std::mutex root_latch_;
   BufferPoolManager *buffer_pool_manager_;
+  // defers deleting the pages merges unlink
+  EpochManager epoch_manager_;
   KeyComparator comparator_;
   int leaf_max_size_;
   int internal_max_size_;
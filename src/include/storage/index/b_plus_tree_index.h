@@ -11,6 +11,7 @@
 
 #pragma once
 
+#include <functional>
 #include <map>
 #include <memory>
 #include <string>
@@ -34,12 +35,18 @@ class BPlusTreeIndex : public Index {
 
   void ScanKey(const Tuple &key, std::vector<RID> *result, Transaction *transaction) override;
 
+  bool BulkLoad(const std::function<bool(KeyType *, ValueType *)> &next, double fill_factor = 1.0);
+
   INDEXITERATOR_TYPE GetBeginIterator();
 
   INDEXITERATOR_TYPE GetBeginIterator(const KeyType &key);
 
   INDEXITERATOR_TYPE GetEndIterator();
 
+  INDEXITERATOR_TYPE GetReverseBeginIterator();
+
+  INDEXITERATOR_TYPE GetReverseBeginIterator(const KeyType &key);
+
  protected:
   // comparator for key
   KeyComparator comparator_;
@@ -0,0 +1,111 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// epoch_manager.h
+//
+// Identification: src/include/storage/index/epoch_manager.h
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <mutex>  // NOLINT
+#include <vector>
+
+#include "buffer/buffer_pool_manager.h"
+#include "common/config.h"
+#include "common/macros.h"
+
+namespace bustub {
+
+/**
+ * EpochManager defers deleting the pages an index unlinks until no optimistic reader can still be on its way to them.
+ *
+ * Every operation on the index runs in the epoch that was current when it started (see EpochGuard), so while the
+ * global epoch is e, operations are only running in e and e - 1. A page unlinked while the global epoch is e is
+ * retired into the list of e. The epoch advances from e + 1 to e + 2 only once nobody is left in e, so by then every
+ * operation that could have read the page's id has finished, and the list of e is deleted from the buffer pool.
+ *
+ * Ids kept across operations, like the leaves an index iterator links to, are not protected by this. Their holder
+ * remembers the epoch it read them in and checks MayHaveReclaimed() before it follows them.
+ */
+class EpochManager {
+ public:
+  /**
+   * Create a new EpochManager.
+   * @param buffer_pool_manager buffer pool the retired pages are deleted from
+   */
+  explicit EpochManager(BufferPoolManager *buffer_pool_manager) : buffer_pool_manager_(buffer_pool_manager) {}
+
+  ~EpochManager() = default;
+
+  DISALLOW_COPY_AND_MOVE(EpochManager);
+
+  /** @return the current epoch, which the caller is now running in until it calls Exit() with it */
+  uint64_t Enter();
+
+  /**
+   * Leave an epoch entered with Enter(), and delete the retired pages nobody can reach any more.
+   * @param epoch the epoch Enter() returned
+   */
+  void Exit(uint64_t epoch);
+
+  /**
+   * Retire a page that is no longer linked from the index, to be deleted once nobody can reach it. The caller must not
+   * hold a pin on it any more.
+   * @param page_id id of the page
+   */
+  void Retire(page_id_t page_id);
+
+  /**
+   * @param epoch the epoch some page ids were read in
+   * @return false if none of the pages that were linked from the index then has been deleted since, as such pages
+   * can only have been retired in that epoch or later
+   */
+  bool MayHaveReclaimed(uint64_t epoch) const { return reclaimed_epoch_.load() >= epoch; }
+
+ private:
+  /** Operations run in the current epoch or the one before, and a third list is needed for the pages being deleted. */
+  static constexpr size_t NUM_EPOCHS = 3;
+
+  /** Advances the epoch as far as the running operations allow, deleting the pages retired in the epochs passed. */
+  void Reclaim();
+
+  BufferPoolManager *buffer_pool_manager_;
+  std::atomic<uint64_t> global_epoch_{1};
+  /** Number of operations running in each epoch, by epoch % NUM_EPOCHS. */
+  std::array<std::atomic<int>, NUM_EPOCHS> num_active_{};
+  /** Protects retired_ and advancing the epoch. */
+  std::mutex latch_;
+  /** Pages retired in each epoch, by epoch % NUM_EPOCHS. */
+  std::array<std::vector<page_id_t>, NUM_EPOCHS> retired_;
+  std::atomic<size_t> num_retired_{0};
+  /** No page retired after this epoch has been deleted yet. */
+  std::atomic<uint64_t> reclaimed_epoch_{0};
+};
+
+/**
+ * EpochGuard runs the scope it lives in in the current epoch of an EpochManager, like std::lock_guard does for a lock.
+ */
+class EpochGuard {
+ public:
+  explicit EpochGuard(EpochManager *epoch_manager) : epoch_manager_(epoch_manager), epoch_(epoch_manager->Enter()) {}
+
+  ~EpochGuard() { epoch_manager_->Exit(epoch_); }
+
+  DISALLOW_COPY_AND_MOVE(EpochGuard);
+
+  /** @return the epoch the scope runs in */
+  uint64_t GetEpoch() const { return epoch_; }
+
+ private:
+  EpochManager *epoch_manager_;
+  uint64_t epoch_;
+};
+
+}  // namespace bustub
@@ -12,10 +12,15 @@
 
 #pragma once
 
+#include <cstdint>
 #include <cstring>
+#include <string>
+#include <vector>
 
+#include "common/exception.h"
 #include "storage/table/tuple.h"
 #include "type/value.h"
+#include "type/value_factory.h"
 
 namespace bustub {
 
@@ -25,42 +30,168 @@ namespace bustub {
  * This key type uses an fixed length array to hold data for indexing
  * purposes, the actual size of which is specified and instantiated
  * with a template argument.
+ *
+ * The columns of a key are stored one after another in an order-preserving
+ * binary encoding, so that keys compare as their bytes do:
+ *  - integers and timestamps are big-endian, with the sign bit of signed types flipped
+ *  - decimals are big-endian, with the sign bit flipped if positive and all bits inverted if negative
+ *  - varchars are a byte that is 0 if null and 1 otherwise, then their bytes with each 0 byte escaped
+ *    as 0x00 0xFF, then 0x00 0x00
+ * The bytes after the last column are 0. SetFromKey rejects a key that does not fit, as cutting it short would make
+ * distinct keys equal, but a bound set by SetFromPrefix is cut short.
  */
 template <size_t KeySize>
 class GenericKey {
  public:
-  inline void SetFromKey(const Tuple &tuple) {
+  /** @throws Exception of type OUT_OF_RANGE if the encoded key is longer than KeySize */
+  inline void SetFromKey(const Tuple &tuple, const Schema *key_schema) {
     // intialize to 0
     memset(data_, 0, KeySize);
-    memcpy(data_, tuple.GetData(), tuple.GetLength());
+    size_t pos = 0;
+    uint32_t column_count = key_schema->GetColumnCount();
+    for (uint32_t i = 0; i < column_count; i++) {
+      PutValue(&pos, tuple.GetValue(key_schema, i), key_schema->GetColumn(i).GetType());
+    }
+    if (pos > KeySize) {
+      throw Exception(ExceptionType::OUT_OF_RANGE,
+                      "index key of " + std::to_string(pos) + " bytes is longer than " + std::to_string(KeySize));
+    }
+  }
+
+  /**
+   * Set the key to a bound of the keys whose leading columns are values: the bytes after them are all fill, so that
+   * 0 gives a key not greater than any of them and 0xFF one not less than any of them.
+   */
+  inline void SetFromPrefix(const std::vector<Value> &values, const Schema *key_schema, uint8_t fill) {
+    memset(data_, fill, KeySize);
+    size_t pos = 0;
+    for (uint32_t i = 0; i < values.size(); i++) {
+      PutValue(&pos, values[i], key_schema->GetColumn(i).GetType());
+    }
   }
 
   // NOTE: for test purpose only
+  // encodes key as a bigint column
   inline void SetFromInteger(int64_t key) {
     memset(data_, 0, KeySize);
-    memcpy(data_, &key, sizeof(int64_t));
+    size_t pos = 0;
+    Put(&pos, static_cast<uint64_t>(key) ^ SIGN_BIT, 8);
   }
 
   inline Value ToValue(Schema *schema, uint32_t column_idx) const {
-    const char *data_ptr;
-    const auto &col = schema->GetColumn(column_idx);
-    const TypeId column_type = col.GetType();
-    const bool is_inlined = col.IsInlined();
-    if (is_inlined) {
-      data_ptr = (data_ + col.GetOffset());
-    } else {
-      int32_t offset = *reinterpret_cast<int32_t *>(const_cast<char *>(data_ + col.GetOffset()));
-      data_ptr = (data_ + offset);
+    size_t pos = 0;
+    for (uint32_t i = 0;; i++) {
+      const TypeId column_type = schema->GetColumn(i).GetType();
+      switch (column_type) {
+        case TypeId::BOOLEAN:
+        case TypeId::TINYINT: {
+          auto value = static_cast<int8_t>(Get(&pos, 1) ^ 0x80);
+          if (i == column_idx) {
+            return Value(column_type, value);
+          }
+          break;
+        }
+        case TypeId::SMALLINT: {
+          auto value = static_cast<int16_t>(Get(&pos, 2) ^ 0x8000);
+          if (i == column_idx) {
+            return Value(column_type, value);
+          }
+          break;
+        }
+        case TypeId::INTEGER: {
+          auto value = static_cast<int32_t>(Get(&pos, 4) ^ 0x80000000);
+          if (i == column_idx) {
+            return Value(column_type, value);
+          }
+          break;
+        }
+        case TypeId::BIGINT: {
+          auto value = static_cast<int64_t>(Get(&pos, 8) ^ SIGN_BIT);
+          if (i == column_idx) {
+            return Value(column_type, value);
+          }
+          break;
+        }
+        case TypeId::TIMESTAMP: {
+          uint64_t value = Get(&pos, 8);
+          if (i == column_idx) {
+            return Value(column_type, value);
+          }
+          break;
+        }
+        case TypeId::DECIMAL: {
+          uint64_t bits = Get(&pos, 8);
+          bits = (bits & SIGN_BIT) != 0 ? bits ^ SIGN_BIT : ~bits;
+          double value;
+          memcpy(&value, &bits, sizeof(value));
+          if (i == column_idx) {
+            return Value(column_type, value);
+          }
+          break;
+        }
+        case TypeId::VARCHAR: {
+          bool is_null = Get(&pos, 1) == 0;
+          std::string chars;
+          while (!is_null && pos < KeySize) {
+            char c = data_[pos++];
+            if (c == '\0') {
+              if (Get(&pos, 1) != 0xFF) {
+                break;
+              }
+            }
+            chars.push_back(c);
+          }
+          if (i == column_idx) {
+            return is_null ? ValueFactory::GetNullValueByType(column_type) : Value(column_type, chars);
+          }
+          break;
+        }
+        default:
+          throw Exception(ExceptionType::NOT_IMPLEMENTED, "unsupported key column type");
+      }
+    }
+  }
+
+  /** @return whether the key was not cut short, so that ToValue gives back every column it was set from */
+  inline bool IsComplete(const Schema *key_schema) const {
+    size_t pos = 0;
+    uint32_t column_count = key_schema->GetColumnCount();
+    for (uint32_t i = 0; i < column_count; i++) {
+      TypeId column_type = key_schema->GetColumn(i).GetType();
+      if (column_type != TypeId::VARCHAR) {
+        pos += Type::GetTypeSize(column_type);
+        continue;
+      }
+      if (pos >= KeySize) {
+        return false;
+      }
+      if (data_[pos++] == '\0') {
+        continue;
+      }
+      // Look for the terminator, stepping over escaped 0 bytes.
+      for (;;) {
+        if (pos + 1 >= KeySize) {
+          return false;
+        }
+        if (data_[pos] == '\0' && static_cast<uint8_t>(data_[pos + 1]) != 0xFF) {
+          pos += 2;
+          break;
+        }
+        pos += data_[pos] == '\0' ? 2 : 1;
+      }
     }
-    return Value::DeserializeFrom(data_ptr, column_type);
+    return pos <= KeySize;
   }
 
   // NOTE: for test purpose only
-  // interpret the first 8 bytes as int64_t from data vector
-  inline int64_t ToString() const { return *reinterpret_cast<int64_t *>(const_cast<char *>(data_)); }
+  // decode the first 8 bytes as a bigint column
+  inline int64_t ToString() const {
+    size_t pos = 0;
+    return static_cast<int64_t>(Get(&pos, 8) ^ SIGN_BIT);
+  }
 
   // NOTE: for test purpose only
-  // interpret the first 8 bytes as int64_t from data vector
+  // decode the first 8 bytes as a bigint column
   friend std::ostream &operator<<(std::ostream &os, const GenericKey &key) {
     os << key.ToString();
     return os;
@@ -68,30 +199,101 @@ class GenericKey {
 
   // actual location of data, extends past the end.
   char data_[KeySize];
+
+ private:
+  static constexpr uint64_t SIGN_BIT = uint64_t{1} << 63;
+
+  /** Append value, of a column of the given type, at *pos. */
+  inline void PutValue(size_t *pos, const Value &value, TypeId type) {
+    switch (type) {
+      case TypeId::BOOLEAN:
+      case TypeId::TINYINT:
+        Put(pos, static_cast<uint8_t>(value.GetAs<int8_t>()) ^ 0x80, 1);
+        break;
+      case TypeId::SMALLINT:
+        Put(pos, static_cast<uint16_t>(value.GetAs<int16_t>()) ^ 0x8000, 2);
+        break;
+      case TypeId::INTEGER:
+        Put(pos, static_cast<uint32_t>(value.GetAs<int32_t>()) ^ 0x80000000, 4);
+        break;
+      case TypeId::BIGINT:
+        Put(pos, static_cast<uint64_t>(value.GetAs<int64_t>()) ^ SIGN_BIT, 8);
+        break;
+      case TypeId::TIMESTAMP:
+        Put(pos, value.GetAs<uint64_t>(), 8);
+        break;
+      case TypeId::DECIMAL: {
+        // -0.0 equals 0.0
+        double number = value.GetAs<double>() == 0 ? 0 : value.GetAs<double>();
+        uint64_t bits;
+        memcpy(&bits, &number, sizeof(bits));
+        Put(pos, (bits & SIGN_BIT) != 0 ? ~bits : bits ^ SIGN_BIT, 8);
+        break;
+      }
+      case TypeId::VARCHAR: {
+        if (value.IsNull()) {
+          Put(pos, 0, 1);
+          break;
+        }
+        Put(pos, 1, 1);
+        // The length of a varchar value counts a terminating null.
+        uint32_t length = value.GetLength() == 0 ? 0 : value.GetLength() - 1;
+        const char *chars = value.GetData();
+        for (uint32_t j = 0; j < length; j++) {
+          Put(pos, static_cast<uint8_t>(chars[j]), 1);
+          if (chars[j] == '\0') {
+            Put(pos, 0xFF, 1);
+          }
+        }
+        Put(pos, 0, 2);
+        break;
+      }
+      default:
+        throw Exception(ExceptionType::NOT_IMPLEMENTED, "unsupported key column type");
+    }
+  }
+
+  /** Append the low size bytes of bits at *pos, most significant first, dropping what does not fit. */
+  inline void Put(size_t *pos, uint64_t bits, size_t size) {
+    for (size_t i = size; i > 0; i--) {
+      if (*pos < KeySize) {
+        data_[*pos] = static_cast<char>(bits >> (8 * (i - 1)));
+      }
+      ++*pos;
+    }
+  }
+
+  /** Read size bytes at *pos as a big-endian integer, reading 0 past the end of the key. */
+  inline uint64_t Get(size_t *pos, size_t size) const {
+    uint64_t bits = 0;
+    for (size_t i = 0; i < size; i++, ++*pos) {
+      bits = (bits << 8) | (*pos < KeySize ? static_cast<uint8_t>(data_[*pos]) : 0);
+    }
+    return bits;
+  }
 };
 
 /**
  * Function object returns true if lhs < rhs, used for trees
+ * Keys are encoded so that they compare as their bytes do (see GenericKey).
  */
 template <size_t KeySize>
 class GenericComparator {
  public:
   inline int operator()(const GenericKey<KeySize> &lhs, const GenericKey<KeySize> &rhs) const {
-    uint32_t column_count = key_schema_->GetColumnCount();
-
-    for (uint32_t i = 0; i < column_count; i++) {
-      Value lhs_value = (lhs.ToValue(key_schema_, i));
-      Value rhs_value = (rhs.ToValue(key_schema_, i));
+    return memcmp(lhs.data_, rhs.data_, KeySize);
+  }
 
-      if (lhs_value.CompareLessThan(rhs_value) == CmpBool::CmpTrue) {
-        return -1;
-      }
-      if (lhs_value.CompareGreaterThan(rhs_value) == CmpBool::CmpTrue) {
-        return 1;
-      }
+  /**
+   * The head of a key is its first eight bytes, read as a big-endian integer. A key's head is never greater than that
+   * of a greater key, so two keys whose heads differ compare as their heads do.
+   */
+  inline uint64_t Head(const GenericKey<KeySize> &key) const {
+    uint64_t head = 0;
+    for (size_t i = 0; i < sizeof(head); i++) {
+      head = (head << 8) | (i < KeySize ? static_cast<uint8_t>(key.data_[i]) : 0);
     }
-    // equals
-    return 0;
+    return head;
   }
 
   GenericComparator(const GenericComparator &other) : key_schema_{other.key_schema_} {}
@@ -13,16 +13,31 @@
  * For range scan of b+ tree
  */
 #pragma once
+#include <vector>
+
 #include "storage/page/b_plus_tree_leaf_page.h"
 
 namespace bustub {
 
 #define INDEXITERATOR_TYPE IndexIterator<KeyType, ValueType, KeyComparator>
 
+INDEX_TEMPLATE_ARGUMENTS
+class BPlusTree;
+
+/**
+ * Iterates over the leaves of a B+ tree in key order, forward with operator++ or backward with operator--. Stepping
+ * past either end of the tree makes it the end iterator.
+ *
+ * The iterator works on a copy of the current leaf taken with a validated optimistic read, so it holds no latch or
+ * pin between steps and never blocks writers. Moving to the next or previous leaf is left to the tree, which checks
+ * that the leaf it came from still links to it and otherwise finds the way again from the last key returned.
+ */
 INDEX_TEMPLATE_ARGUMENTS
 class IndexIterator {
+  friend class BPlusTree<KeyType, ValueType, KeyComparator>;
+
  public:
-  // you may define your own constructor based on your member variables
+  /** Creates the end iterator. */
   IndexIterator();
   ~IndexIterator();
 
@@ -32,12 +47,28 @@ class IndexIterator {
 
   IndexIterator &operator++();
 
-  bool operator==(const IndexIterator &itr) const { throw std::runtime_error("unimplemented"); }
+  IndexIterator &operator--();
+
+  bool operator==(const IndexIterator &itr) const { return page_id_ == itr.page_id_ && index_ == itr.index_; }
 
-  bool operator!=(const IndexIterator &itr) const { throw std::runtime_error("unimplemented"); }
+  bool operator!=(const IndexIterator &itr) const { return !(*this == itr); }
 
  private:
-  // add your own private member variables here
+  explicit IndexIterator(BPlusTree<KeyType, ValueType, KeyComparator> *tree);
+
+  void SetEnd();
+
+  BPlusTree<KeyType, ValueType, KeyComparator> *tree_{nullptr};
+  /** The leaf the items were copied from, or INVALID_PAGE_ID at the end */
+  page_id_t page_id_{INVALID_PAGE_ID};
+  /** The version of that leaf when it was copied */
+  uint64_t version_{0};
+  page_id_t next_page_id_{INVALID_PAGE_ID};
+  page_id_t prev_page_id_{INVALID_PAGE_ID};
+  /** The epoch the page ids above were read in; the pages may be deleted once it is over */
+  uint64_t epoch_{0};
+  std::vector<MappingType> items_;
+  int index_{0};
 };
 
 }  // namespace bustub
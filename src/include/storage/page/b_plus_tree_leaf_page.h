@@ -18,8 +18,10 @@
 namespace bustub {
 
 #define B_PLUS_TREE_LEAF_PAGE_TYPE BPlusTreeLeafPage<KeyType, ValueType, KeyComparator>
-#define LEAF_PAGE_HEADER_SIZE 28
-#define LEAF_PAGE_SIZE ((PAGE_SIZE - LEAF_PAGE_HEADER_SIZE) / sizeof(MappingType))
+#define LEAF_PAGE_HEADER_SIZE 40
+#define LEAF_PAGE_HEADS_END ((PAGE_SIZE - PAGE_CHECKSUM_SIZE) & ~size_t{7})
+#define LEAF_PAGE_SIZE ((LEAF_PAGE_HEADS_END - LEAF_PAGE_HEADER_SIZE) / (sizeof(MappingType) + sizeof(uint64_t)))
+#define LEAF_PAGE_HEADS_OFFSET (LEAF_PAGE_HEADS_END - LEAF_PAGE_SIZE * sizeof(uint64_t))
 
 /**
  * Store indexed key and record id(record id = page id combined with slot id,
@@ -27,17 +29,22 @@ namespace bustub {
  * page. Only support unique key.
  *
  * Leaf page format (keys are stored in order):
- *  ----------------------------------------------------------------------
- * | HEADER | KEY(1) + RID(1) | KEY(2) + RID(2) | ... | KEY(n) + RID(n)
- *  ----------------------------------------------------------------------
+ *  ----------------------------------------------------------------------------------------
+ * | HEADER | KEY(1) + RID(1) | ... | KEY(n) + RID(n) | ... | HEAD(1) | ... | HEAD(n) | ...
+ *  ----------------------------------------------------------------------------------------
  *
- *  Header format (size in byte, 28 bytes in total):
+ * Each key has a head (see GenericComparator::Head), kept in an array of its own that starts at
+ * LEAF_PAGE_HEADS_OFFSET, whatever the max size of the page. The array ends at the last multiple of 8 before the page
+ * checksum, so that the heads are aligned. Key lookups scan the heads, which are plain integers and are compared
+ * several at a time, and compare full keys only among those that share the head of the key looked up.
+ *
+ *  Header format (size in byte, 40 bytes in total):
  *  ---------------------------------------------------------------------
  * | PageType (4) | LSN (4) | CurrentSize (4) | MaxSize (4) |
  *  ---------------------------------------------------------------------
- *  -----------------------------------------------
- * | ParentPageId (4) | PageId (4) | NextPageId (4)
- *  -----------------------------------------------
+ *  ---------------------------------------------------------------------------------
+ * | ParentPageId (4) | PageId (4) | Version (8) | NextPageId (4) | PrevPageId (4)
+ *  ---------------------------------------------------------------------------------
  */
 INDEX_TEMPLATE_ARGUMENTS
 class BPlusTreeLeafPage : public BPlusTreePage {
@@ -48,6 +55,8 @@ class BPlusTreeLeafPage : public BPlusTreePage {
   // helper methods
   page_id_t GetNextPageId() const;
   void SetNextPageId(page_id_t next_page_id);
+  page_id_t GetPrevPageId() const;
+  void SetPrevPageId(page_id_t prev_page_id);
   KeyType KeyAt(int index) const;
   int KeyIndex(const KeyType &key, const KeyComparator &comparator) const;
   const MappingType &GetItem(int index);
@@ -64,10 +73,17 @@ class BPlusTreeLeafPage : public BPlusTreePage {
   void MoveLastToFrontOf(BPlusTreeLeafPage *recipient);
 
  private:
-  void CopyNFrom(MappingType *items, int size);
-  void CopyLastFrom(const MappingType &item);
-  void CopyFirstFrom(const MappingType &item);
+  int HeadIndex(uint64_t head, int begin, int size) const;
+  void CopyNFrom(MappingType *items, const uint64_t *heads, int size);
+  void CopyLastFrom(const MappingType &item, uint64_t head);
+  void CopyFirstFrom(const MappingType &item, uint64_t head);
+  static_assert(LEAF_PAGE_HEADS_OFFSET % alignof(uint64_t) == 0, "the heads of a leaf page must be aligned");
+  uint64_t *Heads() { return reinterpret_cast<uint64_t *>(reinterpret_cast<char *>(this) + LEAF_PAGE_HEADS_OFFSET); }
+  const uint64_t *Heads() const {
+    return reinterpret_cast<const uint64_t *>(reinterpret_cast<const char *>(this) + LEAF_PAGE_HEADS_OFFSET);
+  }
   page_id_t next_page_id_;
+  page_id_t prev_page_id_;
   MappingType array_[0];
 };
 }  // namespace bustub
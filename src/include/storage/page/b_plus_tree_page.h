@@ -10,6 +10,7 @@
 //===----------------------------------------------------------------------===//
 #pragma once
 
+#include <atomic>
 #include <cassert>
 #include <climits>
 #include <cstdlib>
@@ -33,12 +34,18 @@ enum class IndexPageType { INVALID_INDEX_PAGE = 0, LEAF_PAGE, INTERNAL_PAGE };
  * It actually serves as a header part for each B+ tree page and
  * contains information shared by both leaf page and internal page.
  *
- * Header format (size in byte, 24 bytes in total):
+ * Header format (size in byte, 32 bytes in total):
  * ----------------------------------------------------------------------------
  * | PageType (4) | LSN (4) | CurrentSize (4) | MaxSize (4) |
  * ----------------------------------------------------------------------------
- * | ParentPageId (4) | PageId(4) |
+ * | ParentPageId (4) | PageId(4) | Version (8) |
  * ----------------------------------------------------------------------------
+ *
+ * The version lets readers traverse the tree without latching pages (optimistic lock coupling). Writers change a
+ * page only under its write latch and between BeginWrite() and EndWrite(), which leave the version odd while the
+ * page is being changed and advance it afterwards. A reader takes the version with ReadVersion(), reads the page and
+ * then checks with Validate() that the version did not move; otherwise what it read may be torn and it restarts.
+ * A page removed from the tree is marked obsolete so that readers still holding its id restart as well.
  */
 class BPlusTreePage {
  public:
@@ -62,14 +69,43 @@ class BPlusTreePage {
 
   void SetLSN(lsn_t lsn = INVALID_LSN);
 
+  /** @return the version to validate an optimistic read of this page against */
+  uint64_t ReadVersion() const { return version_.load(std::memory_order_acquire); }
+
+  /** @return true if the page has not been written since version was read */
+  bool Validate(uint64_t version) const {
+    std::atomic_thread_fence(std::memory_order_acquire);
+    return version_.load(std::memory_order_relaxed) == version;
+  }
+
+  /** @return true if a version read from the page is neither mid-write nor obsolete, i.e. worth reading under */
+  static bool IsStable(uint64_t version) { return (version & (VERSION_WRITING | VERSION_OBSOLETE)) == 0; }
+
+  /** Starts changing the page, unless that was already started. The caller holds the page's write latch. */
+  void BeginWrite();
+
+  /** @return true if BeginWrite() was called and EndWrite() not yet */
+  bool IsBeingWritten() const { return (version_.load(std::memory_order_relaxed) & VERSION_WRITING) != 0; }
+
+  /** Finishes changing the page and publishes a new version. */
+  void EndWrite();
+
+  /** Marks the page as no longer part of the tree. Must be called between BeginWrite() and EndWrite(). */
+  void MarkObsolete();
+
  private:
+  static constexpr uint64_t VERSION_WRITING = 1;
+  static constexpr uint64_t VERSION_OBSOLETE = 2;
+  static constexpr uint64_t VERSION_STEP = 4;
+
   // member variable, attributes that both internal and leaf page share
-  IndexPageType page_type_ __attribute__((__unused__));
-  lsn_t lsn_ __attribute__((__unused__));
-  int size_ __attribute__((__unused__));
-  int max_size_ __attribute__((__unused__));
-  page_id_t parent_page_id_ __attribute__((__unused__));
-  page_id_t page_id_ __attribute__((__unused__));
+  IndexPageType page_type_;
+  lsn_t lsn_;
+  int size_;
+  int max_size_;
+  page_id_t parent_page_id_;
+  page_id_t page_id_;
+  std::atomic<uint64_t> version_;
 };
 
 }  // namespace bustub
@@ -30,8 +30,13 @@ namespace bustub {
  *  ----------------------------------------------------------------
  *
  *  Here '+' means concatenation.
- *  The above format omits the space required for the occupied_ and
- *  readable_ arrays. More information is in storage/page/hash_table_page_defs.h.
+ *  The above format omits the space required for the occupied_, readable_
+ *  and fingerprints_ arrays, which follow the pairs. More information is in
+ *  storage/page/hash_table_page_defs.h.
+ *
+ *  Each slot keeps a one byte fingerprint of its key, so that a search
+ *  compares the fingerprints of many slots at once and calls the comparator
+ *  only on the slots whose fingerprint matches.
  *
  */
 template <typename KeyType, typename ValueType, typename KeyComparator>
@@ -137,6 +142,11 @@ class HashTableBucketPage {
    */
   void PrintBucket();
 
+  /**
+   * @return the fingerprint of a key, a byte of its hash that is independent of the hash the table indexes by
+   */
+  static uint8_t Fingerprint(const KeyType &key);
+
   /**
    * @return the length of occupied_ or readable_
    */
@@ -150,11 +160,23 @@ class HashTableBucketPage {
   }
 
  private:
+  /**
+   * Finds the readable slots whose key has a fingerprint, from a slot on, up to the first slot never occupied.
+   *
+   * @param fingerprint the fingerprint to match
+   * @param begin the slot to start at
+   * @return the first matching slot at or after begin, or BUCKET_ARRAY_SIZE if there is none
+   */
+  uint32_t NextCandidate(uint8_t fingerprint, uint32_t begin) const;
+
   //  For more on BUCKET_ARRAY_SIZE see storage/page/hash_table_page_defs.h
+  // The pairs come first, so that the byte arrays after them need no alignment padding.
+  MappingType array_[BUCKET_ARRAY_SIZE];
   char occupied_[(BUCKET_ARRAY_SIZE - 1) / 8 + 1]{0};
   // 0 if tombstone/brand new (never occupied), 1 otherwise.
   char readable_[(BUCKET_ARRAY_SIZE - 1) / 8 + 1]{0};
-  MappingType array_[BUCKET_ARRAY_SIZE];
+  // Fingerprint(KeyAt(i)) for each readable slot i.
+  uint8_t fingerprints_[BUCKET_ARRAY_SIZE];
 };
 
 }  // namespace bustub
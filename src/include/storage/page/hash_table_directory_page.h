@@ -26,6 +26,9 @@ namespace bustub {
  *
  * Directory Page for extendible hash table.
  *
+ * The slots of a directory page point to bucket pages. The table's header page is a directory page too, whose slots
+ * point to directory pages, so that a table can outgrow the DIRECTORY_ARRAY_SIZE buckets of one directory page.
+ *
  * Directory format (size in byte):
  * --------------------------------------------------------------------------------------------
  * | LSN (4) | PageId(4) | GlobalDepth(4) | LocalDepths(512) | BucketPageIds(2048) | Free(1524)
@@ -114,7 +117,8 @@ class HashTableDirectoryPage {
   uint32_t GetGlobalDepth();
 
   /**
-   * Increment the global depth of the directory
+   * Increment the global depth of the directory, up to DIRECTORY_MAX_DEPTH
+   * The new half of the directory starts out as a copy of the old one.
    */
   void IncrGlobalDepth();
 
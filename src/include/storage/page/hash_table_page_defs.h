@@ -22,23 +22,26 @@
 /**
  * BLOCK_ARRAY_SIZE is the number of (key, value) pairs that can be stored in a linear probe hash block page. It is an
  * approximate calculation based on the size of MappingType (which is a std::pair of KeyType and ValueType). For each
- * key/value pair, we need two additional bits for occupied_ and readable_. 4 * PAGE_SIZE / (4 * sizeof (MappingType) +
- * 1) = PAGE_SIZE/(sizeof (MappingType) + 0.25) because 0.25 bytes = 2 bits is the space required to maintain the
- * occupied and readable flags for a key value pair.
+ * key/value pair, we need two additional bits for occupied_ and readable_. 4 * S / (4 * sizeof (MappingType) + 1) =
+ * S/(sizeof (MappingType) + 0.25) because 0.25 bytes = 2 bits is the space required to maintain the occupied and
+ * readable flags for a key value pair. S = PAGE_SIZE - PAGE_CHECKSUM_SIZE leaves the page checksum alone.
  */
-#define BLOCK_ARRAY_SIZE (4 * PAGE_SIZE / (4 * sizeof(MappingType) + 1))
+#define BLOCK_ARRAY_SIZE (4 * (PAGE_SIZE - PAGE_CHECKSUM_SIZE) / (4 * sizeof(MappingType) + 1))
 
 /**
  * Extendible Hashing Definitions
  */
 #define HASH_TABLE_BUCKET_TYPE HashTableBucketPage<KeyType, ValueType, KeyComparator>
 #define DIRECTORY_ARRAY_SIZE 512
+/** The greatest global depth of a directory page, at which its DIRECTORY_ARRAY_SIZE slots are all in use. */
+#define DIRECTORY_MAX_DEPTH 9
 
 /**
  * BUCKET_ARRAY_SIZE is the number of (key, value) pairs that can be stored in an extendible hashing bucket page.
  * It is an approximate calculation based on the size of MappingType (which is a std::pair of KeyType and ValueType).
- * For each key/value pair, we need two additional bits for occupied_ and readable_. 4 * (PAGE_SIZE - 4) / (4 * sizeof
- * (MappingType) + 1) = (PAGE_SIZE - 4)/(sizeof (MappingType) + 0.25) because 0.25 bytes = 2 bits is the space required
- * to maintain the occupied and readable flags for a key value pair.
+ * For each key/value pair, we need two additional bits for occupied_ and readable_, and one byte for its fingerprint.
+ * 4 * (PAGE_SIZE - 4) / (4 * sizeof (MappingType) + 5) = (PAGE_SIZE - 4)/(sizeof (MappingType) + 1.25) because 1.25
+ * bytes = 1 byte and 2 bits is the space required to maintain the fingerprint and the occupied and readable flags for
+ * a key value pair. The 4 bytes left over hold the page checksum.
  */
-#define BUCKET_ARRAY_SIZE (4 * PAGE_SIZE / (4 * sizeof(MappingType) + 1))
+#define BUCKET_ARRAY_SIZE (4 * (PAGE_SIZE - PAGE_CHECKSUM_SIZE) / (4 * sizeof(MappingType) + 5))
@@ -12,8 +12,10 @@
 
 #pragma once
 
+#include <atomic>
 #include <cstring>
 #include <iostream>
+#include <memory>
 
 #include "common/config.h"
 #include "common/rwlatch.h"
@@ -24,14 +26,20 @@ namespace bustub {
  * Page is the basic unit of storage within the database system. Page provides a wrapper for actual data pages being
  * held in main memory. Page also contains book-keeping information that is used by the buffer pool manager, e.g.
  * pin count, dirty flag, page id, etc.
+ *
+ * The data of a buffer pool frame lives in the pool's FrameArena, apart from this book-keeping, so that it is aligned
+ * for direct I/O.
+ *
+ * The last PAGE_CHECKSUM_SIZE bytes of the data are not for page contents: the DiskManager keeps the page checksum
+ * there.
  */
 class Page {
   // There is book-keeping information inside the page that should only be relevant to the buffer pool manager.
   friend class BufferPoolManagerInstance;
 
  public:
-  /** Constructor. Zeros out the page data. */
-  Page() { ResetMemory(); }
+  /** Constructor for a page that owns its data, e.g. a scratch page outside the buffer pool. Zeros out the data. */
+  Page() : owned_data_(new char[PAGE_SIZE]{}), data_(owned_data_.get()) {}
 
   /** Default destructor. */
   ~Page() = default;
@@ -43,7 +51,11 @@ class Page {
   inline page_id_t GetPageId() { return page_id_; }
 
   /** @return the pin count of this page */
-  inline int GetPinCount() { return pin_count_; }
+  inline int GetPinCount() {
+    // A negative count marks a frame that the buffer pool is evicting or keeps on its free list.
+    int pin_count = pin_count_;
+    return pin_count < 0 ? 0 : pin_count;
+  }
 
   /** @return true if the page in memory has been modified from the page on disk, false otherwise */
   inline bool IsDirty() { return is_dirty_; }
@@ -57,14 +69,21 @@ class Page {
   /** Acquire the page read latch. */
   inline void RLatch() { rwlatch_.RLock(); }
 
+  /** Acquire the page read latch unless a writer holds or waits for it. @return true if the latch was acquired */
+  inline bool TryRLatch() { return rwlatch_.TryRLock(); }
+
   /** Release the page read latch. */
   inline void RUnlatch() { rwlatch_.RUnlock(); }
 
   /** @return the page LSN. */
   inline lsn_t GetLSN() { return *reinterpret_cast<lsn_t *>(GetData() + OFFSET_LSN); }
 
-  /** Sets the page LSN. */
-  inline void SetLSN(lsn_t lsn) { memcpy(GetData() + OFFSET_LSN, &lsn, sizeof(lsn_t)); }
+  /** Sets the page LSN. The first LSN set after the page was last written back becomes its recLSN. */
+  inline void SetLSN(lsn_t lsn) {
+    memcpy(GetData() + OFFSET_LSN, &lsn, sizeof(lsn_t));
+    lsn_t rec_lsn = INVALID_LSN;
+    rec_lsn_.compare_exchange_strong(rec_lsn, lsn);
+  }
 
  protected:
   static_assert(sizeof(page_id_t) == 4);
@@ -75,17 +94,27 @@ class Page {
   static constexpr size_t OFFSET_LSN = 4;
 
  private:
+  /** Constructor for a buffer pool frame whose data lives elsewhere. Zeros out the page data. */
+  explicit Page(char *data) : data_(data) { ResetMemory(); }
+
   /** Zeroes out the data that is held within the page. */
   inline void ResetMemory() { memset(data_, OFFSET_PAGE_START, PAGE_SIZE); }
 
+  /** Storage of a page that is not part of a buffer pool. */
+  std::unique_ptr<char[]> owned_data_;
   /** The actual data that is stored within a page. */
-  char data_[PAGE_SIZE]{};
+  char *data_;
   /** The ID of this page. */
-  page_id_t page_id_ = INVALID_PAGE_ID;
-  /** The pin count of this page. */
-  int pin_count_ = 0;
+  std::atomic<page_id_t> page_id_{INVALID_PAGE_ID};
+  /** The pin count of this page. Atomic so that resident pages can be pinned without the buffer pool latch. */
+  std::atomic<int> pin_count_{0};
   /** True if the page is dirty, i.e. it is different from its corresponding page on disk. */
-  bool is_dirty_ = false;
+  std::atomic<bool> is_dirty_{false};
+  /**
+   * LSN of the oldest logged change that may be missing from the page on disk, or INVALID_LSN if there is none. The
+   * buffer pool only resets it when it writes the page while no writer can be in the middle of a change.
+   */
+  std::atomic<lsn_t> rec_lsn_{INVALID_LSN};
   /** Page latch. */
   ReaderWriterLatch rwlatch_;
 };
@@ -32,7 +32,10 @@ class TableIterator {
   TableIterator(TableHeap *table_heap, RID rid, Transaction *txn);
 
   TableIterator(const TableIterator &other)
-      : table_heap_(other.table_heap_), tuple_(new Tuple(*other.tuple_)), txn_(other.txn_) {}
+      : table_heap_(other.table_heap_),
+        tuple_(new Tuple(*other.tuple_)),
+        txn_(other.txn_),
+        prefetch_frontier_(other.prefetch_frontier_) {}
 
   ~TableIterator() { delete tuple_; }
 
@@ -52,13 +55,22 @@ class TableIterator {
     table_heap_ = other.table_heap_;
     *tuple_ = *other.tuple_;
     txn_ = other.txn_;
+    prefetch_frontier_ = other.prefetch_frontier_;
     return *this;
   }
 
  private:
+  /**
+   * Ask the buffer pool to read ahead before the scan moves from one page to the next. Table pages are usually
+   * allocated back to back, so the chain is predicted to continue with the stride of this step.
+   */
+  void Prefetch(page_id_t page_id, page_id_t next_page_id);
+
   TableHeap *table_heap_;
   Tuple *tuple_;
   Transaction *txn_;
+  /** First page id that has not been hinted to the buffer pool yet. */
+  page_id_t prefetch_frontier_{INVALID_PAGE_ID};
 };
 
 }  // namespace bustub
@@ -42,6 +42,9 @@ class Tuple {
   // constructor for creating a new tuple based on input value
   Tuple(std::vector<Value> values, const Schema *schema);
 
+  // constructor for a tuple that reads data in place instead of owning a copy of it (shallow, never written through)
+  Tuple(const char *data, uint32_t size) : size_(size), data_(const_cast<char *>(data)) {}
+
   // copy constructor, deep copy
   Tuple(const Tuple &other);
 
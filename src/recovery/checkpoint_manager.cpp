@@ -12,16 +12,70 @@
 
 #include "recovery/checkpoint_manager.h"
 
+#include <algorithm>
+#include <utility>
+#include <vector>
+
+#include "common/macros.h"
+
 namespace bustub {
 
+CheckpointManager::~CheckpointManager() {
+  if (flush_thread_.joinable()) {
+    flush_thread_.join();
+  }
+}
+
 void CheckpointManager::BeginCheckpoint() {
-  // Block all the transactions and ensure that both the WAL and all dirty buffer pool pages are persisted to disk,
-  // creating a consistent checkpoint. Do NOT allow transactions to resume at the end of this method, resume them
-  // in CheckpointManager::EndCheckpoint() instead. This is for grading purposes.
+  BUSTUB_ASSERT(!flush_thread_.joinable(), "the previous checkpoint has not ended");
+  if (!enable_logging) {
+    // Without a log there is nothing to shorten; the checkpoint just writes the dirty pages back.
+    buffer_pool_manager_->FlushAllPages();
+    return;
+  }
+
+  // Every change logged before BEGIN_CHECKPOINT is either on disk or in a page of the dirty page table taken below.
+  LogRecord begin_record(INVALID_TXN_ID, INVALID_LSN, LogRecordType::BEGIN_CHECKPOINT);
+  lsn_t begin_lsn = log_manager_->AppendLogRecord(&begin_record);
+  std::vector<std::pair<txn_id_t, lsn_t>> active_txns;
+  lsn_t oldest_begin_lsn = transaction_manager_->GetActiveTransactionTable(&active_txns);
+  std::vector<std::pair<page_id_t, lsn_t>> dirty_pages;
+  buffer_pool_manager_->GetDirtyPageTable(&dirty_pages);
+
+  // Redo starts at the oldest change that may be missing on disk. Recovery reads the log from further back if an active
+  // transaction began earlier, since undo follows that transaction's records.
+  lsn_t redo_lsn = begin_lsn;
+  std::vector<page_id_t> page_ids;
+  for (const auto &[page_id, rec_lsn] : dirty_pages) {
+    redo_lsn = std::min(redo_lsn, rec_lsn);
+    page_ids.push_back(page_id);
+  }
+  lsn_t read_lsn = oldest_begin_lsn == INVALID_LSN ? redo_lsn : std::min(redo_lsn, oldest_begin_lsn);
+  read_offset_ = log_manager_->GetLogOffset(read_lsn);
+  // Later checkpoints never need to read from further back.
+  log_manager_->TrimLogOffsets(read_lsn);
+
+  LogRecord end_record(begin_lsn, redo_lsn, read_offset_, std::move(active_txns), std::move(dirty_pages));
+  checkpoint_lsn_ = log_manager_->AppendLogRecord(&end_record);
+  log_manager_->Flush(checkpoint_lsn_);
+  checkpoint_offset_ = log_manager_->GetLogOffset(checkpoint_lsn_);
+
+  flush_thread_ = std::thread([this, page_ids = std::move(page_ids)] {
+    buffer_pool_manager_->FlushCheckpointPages(page_ids);
+  });
 }
 
 void CheckpointManager::EndCheckpoint() {
-  // Allow transactions to resume, completing the checkpoint.
+  if (!flush_thread_.joinable()) {
+    return;
+  }
+  flush_thread_.join();
+  // Pages that were written back before the dirty page table was taken are not in it, so they must be durable before
+  // recovery may rely on the checkpoint.
+  disk_manager_->SyncPages();
+  disk_manager_->WriteMasterRecord(checkpoint_offset_, checkpoint_lsn_);
+  // Recovery now starts reading at the checkpoint, so the log before it is no longer needed.
+  disk_manager_->RecycleLogSegments(read_offset_);
 }
 
 }  // namespace bustub
@@ -0,0 +1,216 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// log_compression.cpp
+//
+// Identification: src/recovery/log_compression.cpp
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "recovery/log_compression.h"
+
+#include <algorithm>
+#include <cstring>
+
+#include "common/config.h"
+
+namespace bustub {
+
+namespace {
+/** Shortest back reference. */
+constexpr int MIN_MATCH = 4;
+/** The last bytes of a buffer are always literals, and no match starts this close to its end. */
+constexpr int LAST_LITERALS = 5;
+constexpr int MATCH_LIMIT = 12;
+/** Largest distance a back reference can reach. */
+constexpr int MAX_OFFSET = 65535;
+constexpr int HASH_BITS = 12;
+/** After this many misses in a row, the compressor starts skipping ahead through incompressible data. */
+constexpr int SKIP_TRIGGER = 6;
+
+inline uint32_t Read32(const char *p) {
+  uint32_t value;
+  memcpy(&value, p, sizeof(value));
+  return value;
+}
+
+inline uint32_t Hash(uint32_t sequence) { return (sequence * 2654435761U) >> (32 - HASH_BITS); }
+
+/** Write a length that did not fit into its token nibble as a run of 255s and a final smaller byte. */
+inline bool WriteLength(int length, char *dst, int capacity, int *op) {
+  for (; length >= 255; length -= 255) {
+    if (*op >= capacity) {
+      return false;
+    }
+    dst[(*op)++] = static_cast<char>(255);
+  }
+  if (*op >= capacity) {
+    return false;
+  }
+  dst[(*op)++] = static_cast<char>(length);
+  return true;
+}
+
+inline bool ReadLength(const char *src, int src_size, int *ip, int *length) {
+  uint8_t byte;
+  do {
+    if (*ip >= src_size) {
+      return false;
+    }
+    byte = static_cast<uint8_t>(src[(*ip)++]);
+    *length += byte;
+  } while (byte == 255);
+  return true;
+}
+}  // namespace
+
+int LogCompression::CompressBlock(const char *data, int size, char *block) {
+  int compressed_size = Compress(data, size, block + LOG_BLOCK_HEADER_SIZE, size - LOG_BLOCK_HEADER_SIZE - 1);
+  if (compressed_size == 0) {
+    return 0;
+  }
+  int32_t header[3] = {LOG_BLOCK_MARKER, compressed_size, size};
+  memcpy(block, header, sizeof(header));
+  return LOG_BLOCK_HEADER_SIZE + compressed_size;
+}
+
+bool LogCompression::IsBlock(const char *data, int available) {
+  int32_t marker;
+  if (available < static_cast<int>(sizeof(marker))) {
+    return false;
+  }
+  memcpy(&marker, data, sizeof(marker));
+  return marker == LOG_BLOCK_MARKER;
+}
+
+int LogCompression::DecompressBlock(const char *block, int available, char *data, int *size) {
+  if (available < LOG_BLOCK_HEADER_SIZE) {
+    return 0;
+  }
+  int32_t header[3];
+  memcpy(header, block, sizeof(header));
+  int32_t compressed_size = header[1];
+  int32_t raw_size = header[2];
+  if (raw_size <= 0 || raw_size > LOG_BUFFER_SIZE || compressed_size <= 0 || compressed_size >= raw_size) {
+    return -1;
+  }
+  if (available < LOG_BLOCK_HEADER_SIZE + compressed_size) {
+    return 0;
+  }
+  if (!Decompress(block + LOG_BLOCK_HEADER_SIZE, compressed_size, data, raw_size)) {
+    return -1;
+  }
+  *size = raw_size;
+  return LOG_BLOCK_HEADER_SIZE + compressed_size;
+}
+
+int LogCompression::Compress(const char *src, int size, char *dst, int capacity) {
+  int32_t table[1 << HASH_BITS];
+  for (auto &position : table) {
+    position = -1;
+  }
+  int ip = 0;
+  int anchor = 0;
+  int op = 0;
+  int misses = 0;
+  auto emit = [&](int literal_length, int match_length, int offset) {
+    int token_at = op;
+    if (op >= capacity) {
+      return false;
+    }
+    op++;
+    int token = std::min(literal_length, 15) << 4;
+    if (literal_length >= 15 && !WriteLength(literal_length - 15, dst, capacity, &op)) {
+      return false;
+    }
+    if (op + literal_length > capacity) {
+      return false;
+    }
+    memcpy(dst + op, src + anchor, literal_length);
+    op += literal_length;
+    if (match_length > 0) {
+      if (op + 2 > capacity) {
+        return false;
+      }
+      dst[op++] = static_cast<char>(offset & 0xff);
+      dst[op++] = static_cast<char>(offset >> 8);
+      int extra = match_length - MIN_MATCH;
+      token |= std::min(extra, 15);
+      if (extra >= 15 && !WriteLength(extra - 15, dst, capacity, &op)) {
+        return false;
+      }
+    }
+    dst[token_at] = static_cast<char>(token);
+    return true;
+  };
+
+  while (ip < size - MATCH_LIMIT) {
+    uint32_t sequence = Read32(src + ip);
+    uint32_t hash = Hash(sequence);
+    int ref = table[hash];
+    table[hash] = ip;
+    if (ref < 0 || ip - ref > MAX_OFFSET || Read32(src + ref) != sequence) {
+      ip += 1 + (misses++ >> SKIP_TRIGGER);
+      continue;
+    }
+    misses = 0;
+    int match_length = MIN_MATCH;
+    while (ip + match_length < size - LAST_LITERALS && src[ref + match_length] == src[ip + match_length]) {
+      match_length++;
+    }
+    if (!emit(ip - anchor, match_length, ip - ref)) {
+      return 0;
+    }
+    ip += match_length;
+    anchor = ip;
+  }
+  if (!emit(size - anchor, 0, 0)) {
+    return 0;
+  }
+  return op;
+}
+
+bool LogCompression::Decompress(const char *src, int src_size, char *dst, int size) {
+  int ip = 0;
+  int op = 0;
+  while (ip < src_size) {
+    auto token = static_cast<uint8_t>(src[ip++]);
+    int literal_length = token >> 4;
+    if (literal_length == 15 && !ReadLength(src, src_size, &ip, &literal_length)) {
+      return false;
+    }
+    if (literal_length > src_size - ip || literal_length > size - op) {
+      return false;
+    }
+    memcpy(dst + op, src + ip, literal_length);
+    ip += literal_length;
+    op += literal_length;
+    if (ip == src_size) {
+      // The last sequence has literals only.
+      break;
+    }
+    if (src_size - ip < 2) {
+      return false;
+    }
+    int offset = static_cast<uint8_t>(src[ip]) | (static_cast<uint8_t>(src[ip + 1]) << 8);
+    ip += 2;
+    int match_length = token & 15;
+    if (match_length == 15 && !ReadLength(src, src_size, &ip, &match_length)) {
+      return false;
+    }
+    match_length += MIN_MATCH;
+    if (offset == 0 || offset > op || match_length > size - op) {
+      return false;
+    }
+    // A reference may overlap the bytes it produces, so copy byte by byte.
+    for (int i = 0; i < match_length; i++, op++) {
+      dst[op] = dst[op - offset];
+    }
+  }
+  return op == size;
+}
+
+}  // namespace bustub
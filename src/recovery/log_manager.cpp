@@ -12,6 +12,13 @@
 
 #include "recovery/log_manager.h"
 
+#include <cstring>
+#include <iterator>
+#include <utility>
+
+#include "common/macros.h"
+#include "recovery/log_compression.h"
+
 namespace bustub {
 /*
  * set enable_logging = true
@@ -22,33 +29,256 @@ namespace bustub {
  *
  * This thread runs forever until system shutdown/StopFlushThread
  */
-void LogManager::RunFlushThread() {}
+void LogManager::RunFlushThread() {
+  std::scoped_lock lock(latch_);
+  if (flush_thread_ != nullptr) {
+    return;
+  }
+  running_ = true;
+  enable_logging = true;
+  flush_thread_ = new std::thread(&LogManager::FlushLoop, this);
+}
 
 /*
  * Stop and join the flush thread, set enable_logging = false
+ * Records appended before the call are flushed first.
  */
-void LogManager::StopFlushThread() {}
+void LogManager::StopFlushThread() {
+  std::thread *flush_thread;
+  {
+    std::scoped_lock lock(latch_);
+    if (flush_thread_ == nullptr) {
+      return;
+    }
+    running_ = false;
+    enable_logging = false;
+    flush_thread = flush_thread_;
+  }
+  cv_.notify_one();
+  flush_thread->join();
+  delete flush_thread;
+  std::scoped_lock lock(latch_);
+  flush_thread_ = nullptr;
+  // Wake committers that raced with the shutdown; Flush returns once the thread is gone.
+  flush_cv_.notify_all();
+}
 
 /*
  * append a log record into log buffer
  * you MUST set the log record's lsn within this method
  * @return: lsn that is assigned to this log record
  *
- *
- * example below
- * // First, serialize the must have fields(20 bytes in total)
- * log_record.lsn_ = next_lsn_++;
- * memcpy(log_buffer_ + offset_, &log_record, 20);
- * int pos = offset_ + 20;
- *
- * if (log_record.log_record_type_ == LogRecordType::INSERT) {
- *    memcpy(log_buffer_ + pos, &log_record.insert_rid_, sizeof(RID));
- *    pos += sizeof(RID);
- *    // we have provided serialize function for tuple class
- *    log_record.insert_tuple_.SerializeTo(log_buffer_ + pos);
- *  }
- *
+ * The flush thread must be running, otherwise appenders wait forever once the buffer is full.
  */
-lsn_t LogManager::AppendLogRecord(LogRecord *log_record) { return INVALID_LSN; }
+lsn_t LogManager::AppendLogRecord(LogRecord *log_record) {
+  auto size = static_cast<uint64_t>(log_record->size_);
+  BUSTUB_ASSERT(size <= static_cast<uint64_t>(LOG_BUFFER_SIZE), "log record does not fit into the log buffer");
+  while (true) {
+    uint64_t state = reservation_.fetch_add((uint64_t{1} << RESERVATION_LSN_SHIFT) + size);
+    uint64_t offset = state & RESERVATION_OFFSET_MASK;
+    if (offset + size <= static_cast<uint64_t>(LOG_BUFFER_SIZE)) {
+      log_record->lsn_ = static_cast<lsn_t>(state >> RESERVATION_LSN_SHIFT);
+      // The buffer cannot be swapped before filled_ covers this record, so log_buffer_ is stable here.
+      SerializeLogRecord(*log_record, log_buffer_ + offset);
+      filled_.fetch_add(size, std::memory_order_release);
+      return log_record->lsn_;
+    }
+    // The buffer is full. Only the first reservation to overflow it seals it; its LSN and every later one are
+    // discarded when the buffer is swapped, and the appenders try again.
+    std::unique_lock lock(latch_);
+    if (offset <= static_cast<uint64_t>(LOG_BUFFER_SIZE)) {
+      SealLogBuffer(state);
+    }
+    swap_cv_.wait(lock, [&] {
+      return (reservation_.load() & RESERVATION_OFFSET_MASK) <= static_cast<uint64_t>(LOG_BUFFER_SIZE);
+    });
+  }
+}
+
+void LogManager::Flush(lsn_t lsn) {
+  std::unique_lock lock(latch_);
+  while (persistent_lsn_ < lsn && flush_thread_ != nullptr) {
+    flush_requested_ = true;
+    cv_.notify_one();
+    flush_cv_.wait(lock);
+  }
+}
+
+int64_t LogManager::GetLogOffset(lsn_t lsn) {
+  std::unique_lock lock(latch_);
+  while (true) {
+    auto iter = std::upper_bound(buffer_offsets_.begin(), buffer_offsets_.end(), lsn,
+                                 [](lsn_t lsn, const std::pair<lsn_t, int64_t> &entry) { return lsn < entry.first; });
+    BUSTUB_ASSERT(iter != buffer_offsets_.begin(), "the log offset of the record has been trimmed");
+    int64_t offset = std::prev(iter)->second;
+    if (offset >= 0) {
+      return offset;
+    }
+    flush_cv_.wait(lock);
+  }
+}
+
+void LogManager::TrimLogOffsets(lsn_t lsn) {
+  std::scoped_lock lock(latch_);
+  while (buffer_offsets_.size() > 1 && buffer_offsets_[1].first <= lsn) {
+    buffer_offsets_.pop_front();
+  }
+}
+
+void LogManager::AddLogOffset(lsn_t first_lsn, int64_t offset) {
+  buffer_offsets_.emplace_back(first_lsn, offset);
+  if (buffer_offsets_.size() > MAX_LOG_OFFSETS) {
+    // A coarser index still finds a buffer at or before each record, so keep every other entry and the newest one.
+    std::deque<std::pair<lsn_t, int64_t>> coarse;
+    for (size_t i = 0; i < buffer_offsets_.size(); i += 2) {
+      coarse.push_back(buffer_offsets_[i]);
+    }
+    if (buffer_offsets_.size() % 2 == 0) {
+      coarse.push_back(buffer_offsets_.back());
+    }
+    buffer_offsets_ = std::move(coarse);
+  }
+}
+
+void LogManager::SerializeLogRecord(const LogRecord &log_record, char *buf) {
+  // First, serialize the must have fields(20 bytes in total)
+  memcpy(buf, &log_record, LogRecord::HEADER_SIZE);
+  int pos = LogRecord::HEADER_SIZE;
+  switch (log_record.log_record_type_) {
+    case LogRecordType::INSERT:
+      memcpy(buf + pos, &log_record.insert_rid_, sizeof(RID));
+      pos += sizeof(RID);
+      log_record.insert_tuple_.SerializeTo(buf + pos);
+      break;
+    case LogRecordType::MARKDELETE:
+    case LogRecordType::APPLYDELETE:
+    case LogRecordType::ROLLBACKDELETE:
+      memcpy(buf + pos, &log_record.delete_rid_, sizeof(RID));
+      pos += sizeof(RID);
+      log_record.delete_tuple_.SerializeTo(buf + pos);
+      break;
+    case LogRecordType::UPDATE:
+      memcpy(buf + pos, &log_record.update_rid_, sizeof(RID));
+      pos += sizeof(RID);
+      log_record.old_tuple_.SerializeTo(buf + pos);
+      pos += sizeof(int32_t) + log_record.old_tuple_.GetLength();
+      log_record.new_tuple_.SerializeTo(buf + pos);
+      break;
+    case LogRecordType::UPDATE_DELTA: {
+      memcpy(buf + pos, &log_record.update_rid_, sizeof(RID));
+      pos += sizeof(RID);
+      memcpy(buf + pos, &log_record.update_tuple_size_, sizeof(uint32_t));
+      pos += sizeof(uint32_t);
+      auto count = static_cast<int32_t>(log_record.update_ranges_.size());
+      memcpy(buf + pos, &count, sizeof(int32_t));
+      pos += sizeof(int32_t);
+      size_t data_pos = 0;
+      for (const auto &[offset, length] : log_record.update_ranges_) {
+        memcpy(buf + pos, &offset, sizeof(uint16_t));
+        memcpy(buf + pos + sizeof(uint16_t), &length, sizeof(uint16_t));
+        pos += LogRecord::UPDATE_RANGE_HEADER_SIZE;
+        memcpy(buf + pos, log_record.update_old_bytes_.data() + data_pos, length);
+        pos += length;
+        memcpy(buf + pos, log_record.update_new_bytes_.data() + data_pos, length);
+        pos += length;
+        data_pos += length;
+      }
+      break;
+    }
+    case LogRecordType::NEWPAGE:
+      memcpy(buf + pos, &log_record.prev_page_id_, sizeof(page_id_t));
+      pos += sizeof(page_id_t);
+      memcpy(buf + pos, &log_record.page_id_, sizeof(page_id_t));
+      break;
+    case LogRecordType::END_CHECKPOINT: {
+      memcpy(buf + pos, &log_record.checkpoint_begin_lsn_, sizeof(lsn_t));
+      pos += sizeof(lsn_t);
+      memcpy(buf + pos, &log_record.redo_lsn_, sizeof(lsn_t));
+      pos += sizeof(lsn_t);
+      memcpy(buf + pos, &log_record.redo_offset_, sizeof(int64_t));
+      pos += sizeof(int64_t);
+      auto count = log_record.has_checkpoint_tables_ ? static_cast<int32_t>(log_record.active_txns_.size()) : -1;
+      memcpy(buf + pos, &count, sizeof(int32_t));
+      pos += sizeof(int32_t);
+      for (const auto &[txn_id, last_lsn] : log_record.active_txns_) {
+        memcpy(buf + pos, &txn_id, sizeof(txn_id_t));
+        memcpy(buf + pos + sizeof(txn_id_t), &last_lsn, sizeof(lsn_t));
+        pos += LogRecord::CHECKPOINT_ENTRY_SIZE;
+      }
+      count = log_record.has_checkpoint_tables_ ? static_cast<int32_t>(log_record.dirty_pages_.size()) : -1;
+      memcpy(buf + pos, &count, sizeof(int32_t));
+      pos += sizeof(int32_t);
+      for (const auto &[page_id, rec_lsn] : log_record.dirty_pages_) {
+        memcpy(buf + pos, &page_id, sizeof(page_id_t));
+        memcpy(buf + pos + sizeof(page_id_t), &rec_lsn, sizeof(lsn_t));
+        pos += LogRecord::CHECKPOINT_ENTRY_SIZE;
+      }
+      break;
+    }
+    default:
+      break;
+  }
+}
+
+void LogManager::SealLogBuffer(uint64_t state) {
+  sealed_ = true;
+  sealed_size_ = state & RESERVATION_OFFSET_MASK;
+  sealed_next_lsn_ = static_cast<lsn_t>(state >> RESERVATION_LSN_SHIFT);
+  cv_.notify_one();
+}
+
+void LogManager::FlushLoop() {
+  std::unique_lock lock(latch_);
+  while (true) {
+    cv_.wait_for(lock, log_timeout, [&] { return sealed_ || flush_requested_ || !running_; });
+    bool stopping = !running_;
+    flush_requested_ = false;
+    if (!sealed_) {
+      if ((reservation_.load() & RESERVATION_OFFSET_MASK) == 0) {
+        // Nothing to write.
+        if (stopping) {
+          return;
+        }
+        continue;
+      }
+      // Seal the buffer ourselves by reserving more than is left, unless an appender overflowed it first.
+      uint64_t state = reservation_.fetch_add(LOG_BUFFER_SIZE + 1);
+      if ((state & RESERVATION_OFFSET_MASK) <= static_cast<uint64_t>(LOG_BUFFER_SIZE)) {
+        SealLogBuffer(state);
+      } else {
+        cv_.wait(lock, [&] { return sealed_; });
+      }
+    }
+
+    // Wait for the appenders that reserved space before the seal to finish copying their records.
+    while (filled_.load(std::memory_order_acquire) != sealed_size_) {
+      std::this_thread::yield();
+    }
+    std::swap(log_buffer_, flush_buffer_);
+    uint64_t size = sealed_size_;
+    lsn_t last_lsn = sealed_next_lsn_ - 1;
+    AddLogOffset(sealed_next_lsn_, -1);
+    sealed_ = false;
+    filled_ = 0;
+    reservation_ = static_cast<uint64_t>(sealed_next_lsn_) << RESERVATION_LSN_SHIFT;
+    swap_cv_.notify_all();
+
+    // Appenders fill the fresh buffer while the sealed one is compressed and written.
+    lock.unlock();
+    if (log_compression && size > 0) {
+      int block_size = LogCompression::CompressBlock(flush_buffer_, static_cast<int>(size), compress_buffer_);
+      if (block_size > 0) {
+        std::swap(flush_buffer_, compress_buffer_);
+        size = block_size;
+      }
+    }
+    disk_manager_->WriteLog(flush_buffer_, static_cast<int>(size));
+    lock.lock();
+    log_file_size_ += static_cast<int64_t>(size);
+    buffer_offsets_.back().second = log_file_size_;
+    persistent_lsn_ = last_lsn;
+    flush_cv_.notify_all();
+  }
+}
 
 }  // namespace bustub
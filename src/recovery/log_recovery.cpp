@@ -12,15 +12,145 @@
 
 #include "recovery/log_recovery.h"
 
+#include <atomic>
+#include <cinttypes>
+#include <cstring>
+#include <future>  // NOLINT
+#include <memory>
+#include <thread>  // NOLINT
+
+#include "common/logger.h"
+#include "common/macros.h"
+#include "recovery/log_compression.h"
 #include "storage/page/table_page.h"
 
 namespace bustub {
+
+namespace {
+/** Records handed to a redo worker at once. */
+constexpr size_t REDO_BATCH_SIZE = 256;
+/** Batches a redo worker may have queued before the log reader waits for it. */
+constexpr size_t REDO_MAX_PENDING_BATCHES = 16;
+}  // namespace
+
 /*
  * deserialize a log record from log buffer
  * @return: true means deserialize succeed, otherwise can't deserialize cause
  * incomplete log record
  */
-bool LogRecovery::DeserializeLogRecord(const char *data, LogRecord *log_record) { return false; }
+bool LogRecovery::DeserializeLogRecord(const char *data, int size, LogRecord *log_record) {
+  if (size < LogRecord::HEADER_SIZE) {
+    return false;
+  }
+  int32_t record_size;
+  lsn_t lsn;
+  txn_id_t txn_id;
+  lsn_t prev_lsn;
+  LogRecordType log_record_type;
+  memcpy(&record_size, data, sizeof(int32_t));
+  memcpy(&lsn, data + 4, sizeof(lsn_t));
+  memcpy(&txn_id, data + 8, sizeof(txn_id_t));
+  memcpy(&prev_lsn, data + 12, sizeof(lsn_t));
+  memcpy(&log_record_type, data + 16, sizeof(LogRecordType));
+  // A zeroed or torn tail ends the log.
+  if (record_size < LogRecord::HEADER_SIZE || record_size > size || lsn == INVALID_LSN ||
+      log_record_type <= LogRecordType::INVALID || log_record_type > LogRecordType::UPDATE_DELTA) {
+    return false;
+  }
+
+  *log_record = LogRecord();
+  log_record->size_ = record_size;
+  log_record->lsn_ = lsn;
+  log_record->txn_id_ = txn_id;
+  log_record->prev_lsn_ = prev_lsn;
+  log_record->log_record_type_ = log_record_type;
+  const char *pos = data + LogRecord::HEADER_SIZE;
+  switch (log_record_type) {
+    case LogRecordType::INSERT:
+      memcpy(&log_record->insert_rid_, pos, sizeof(RID));
+      log_record->insert_tuple_.DeserializeFrom(pos + sizeof(RID));
+      break;
+    case LogRecordType::MARKDELETE:
+    case LogRecordType::APPLYDELETE:
+    case LogRecordType::ROLLBACKDELETE:
+      memcpy(&log_record->delete_rid_, pos, sizeof(RID));
+      log_record->delete_tuple_.DeserializeFrom(pos + sizeof(RID));
+      break;
+    case LogRecordType::UPDATE:
+      memcpy(&log_record->update_rid_, pos, sizeof(RID));
+      pos += sizeof(RID);
+      log_record->old_tuple_.DeserializeFrom(pos);
+      pos += sizeof(int32_t) + log_record->old_tuple_.GetLength();
+      log_record->new_tuple_.DeserializeFrom(pos);
+      break;
+    case LogRecordType::UPDATE_DELTA: {
+      const char *end = data + record_size;
+      memcpy(&log_record->update_rid_, pos, sizeof(RID));
+      pos += sizeof(RID);
+      memcpy(&log_record->update_tuple_size_, pos, sizeof(uint32_t));
+      pos += sizeof(uint32_t);
+      int32_t count;
+      memcpy(&count, pos, sizeof(int32_t));
+      pos += sizeof(int32_t);
+      for (int32_t i = 0; i < count; i++) {
+        uint16_t offset;
+        uint16_t length;
+        if (end - pos < LogRecord::UPDATE_RANGE_HEADER_SIZE) {
+          return false;
+        }
+        memcpy(&offset, pos, sizeof(uint16_t));
+        memcpy(&length, pos + sizeof(uint16_t), sizeof(uint16_t));
+        pos += LogRecord::UPDATE_RANGE_HEADER_SIZE;
+        if (end - pos < 2 * length || offset + length > log_record->update_tuple_size_) {
+          return false;
+        }
+        log_record->update_ranges_.emplace_back(offset, length);
+        log_record->update_old_bytes_.append(pos, length);
+        log_record->update_new_bytes_.append(pos + length, length);
+        pos += 2 * length;
+      }
+      break;
+    }
+    case LogRecordType::NEWPAGE:
+      memcpy(&log_record->prev_page_id_, pos, sizeof(page_id_t));
+      memcpy(&log_record->page_id_, pos + sizeof(page_id_t), sizeof(page_id_t));
+      break;
+    case LogRecordType::END_CHECKPOINT: {
+      memcpy(&log_record->checkpoint_begin_lsn_, pos, sizeof(lsn_t));
+      pos += sizeof(lsn_t);
+      memcpy(&log_record->redo_lsn_, pos, sizeof(lsn_t));
+      pos += sizeof(lsn_t);
+      memcpy(&log_record->redo_offset_, pos, sizeof(int64_t));
+      pos += sizeof(int64_t);
+      int32_t count;
+      memcpy(&count, pos, sizeof(int32_t));
+      pos += sizeof(int32_t);
+      log_record->has_checkpoint_tables_ = count >= 0;
+      for (int32_t i = 0; i < count; i++) {
+        txn_id_t txn_id;
+        lsn_t last_lsn;
+        memcpy(&txn_id, pos, sizeof(txn_id_t));
+        memcpy(&last_lsn, pos + sizeof(txn_id_t), sizeof(lsn_t));
+        log_record->active_txns_.emplace_back(txn_id, last_lsn);
+        pos += LogRecord::CHECKPOINT_ENTRY_SIZE;
+      }
+      memcpy(&count, pos, sizeof(int32_t));
+      pos += sizeof(int32_t);
+      for (int32_t i = 0; i < count; i++) {
+        page_id_t page_id;
+        lsn_t rec_lsn;
+        memcpy(&page_id, pos, sizeof(page_id_t));
+        memcpy(&rec_lsn, pos + sizeof(page_id_t), sizeof(lsn_t));
+        log_record->dirty_pages_.emplace_back(page_id, rec_lsn);
+        pos += LogRecord::CHECKPOINT_ENTRY_SIZE;
+      }
+      break;
+    }
+    default:
+      break;
+  }
+  return true;
+}
 
 /*
  *redo phase on TABLE PAGE level(table/table_page.h)
@@ -28,13 +158,400 @@ bool LogRecovery::DeserializeLogRecord(const char *data, LogRecord *log_record)
  *log buffer to reduce unnecessary I/O operations), remember to compare page's
  *LSN with log_record's sequence number, and also build active_txn_ table &
  *lsn_mapping_ table
+ *
+ *If the master record points to a checkpoint, reading starts where the checkpoint says instead, and records older
+ *than its redo LSN only serve the active transaction table and undo.
  */
-void LogRecovery::Redo() {}
+void LogRecovery::Redo() {
+  active_txn_.clear();
+  lsn_mapping_.clear();
+
+  int64_t start_offset = 0;
+  lsn_t redo_lsn = INVALID_LSN;
+  lsn_t checkpoint_begin_lsn = INVALID_LSN;
+  std::unordered_map<page_id_t, lsn_t> dirty_pages;
+  LogRecord checkpoint;
+  if (ReadCheckpoint(&checkpoint)) {
+    start_offset = checkpoint.redo_offset_;
+    redo_lsn = checkpoint.redo_lsn_;
+    if (checkpoint.has_checkpoint_tables_) {
+      // Changes logged before the checkpoint began are on disk unless the dirty page table says otherwise.
+      checkpoint_begin_lsn = checkpoint.checkpoint_begin_lsn_;
+      dirty_pages.insert(checkpoint.dirty_pages_.begin(), checkpoint.dirty_pages_.end());
+      active_txn_.insert(checkpoint.active_txns_.begin(), checkpoint.active_txns_.end());
+    }
+  }
+  auto needs_redo = [&](page_id_t page_id, lsn_t lsn) {
+    if (lsn < redo_lsn) {
+      return false;
+    }
+    if (lsn >= checkpoint_begin_lsn) {
+      return true;
+    }
+    auto iter = dirty_pages.find(page_id);
+    return iter != dirty_pages.end() && lsn >= iter->second;
+  };
+
+  std::vector<RedoWorker> workers(num_threads_);
+  std::vector<std::thread> threads;
+  for (auto &worker : workers) {
+    threads.emplace_back(&LogRecovery::RunRedoWorker, this, &worker);
+  }
+  std::vector<std::vector<RedoTask>> batches(num_threads_);
+  auto dispatch = [&](size_t index) {
+    RedoWorker &worker = workers[index];
+    {
+      std::unique_lock lock(worker.latch_);
+      worker.cv_.wait(lock, [&] { return worker.batches_.size() < REDO_MAX_PENDING_BATCHES; });
+      worker.batches_.push_back(std::move(batches[index]));
+    }
+    worker.cv_.notify_all();
+    batches[index].clear();
+  };
+
+  int64_t log_size = disk_manager_->GetLogSize();
+  int64_t end_offset = ScanLog(start_offset, [&](LogRecord *log_record, const LogPosition &position) {
+    lsn_mapping_[log_record->lsn_] = position;
+    if (log_record->log_record_type_ == LogRecordType::COMMIT || log_record->log_record_type_ == LogRecordType::ABORT) {
+      active_txn_.erase(log_record->txn_id_);
+    } else if (log_record->txn_id_ != INVALID_TXN_ID) {
+      active_txn_[log_record->txn_id_] = log_record->lsn_;
+    }
+    for (page_id_t page_id : GetChangedPages(log_record)) {
+      if (!needs_redo(page_id, log_record->lsn_)) {
+        continue;
+      }
+      size_t index = static_cast<size_t>(page_id) % num_threads_;
+      batches[index].push_back({page_id, *log_record});
+      if (batches[index].size() >= REDO_BATCH_SIZE) {
+        dispatch(index);
+      }
+    }
+    return true;
+  });
+  if (end_offset != log_size) {
+    LOG_DEBUG("ignoring %" PRId64 " bytes of incomplete log records", log_size - end_offset);
+  }
+
+  for (size_t index = 0; index < num_threads_; index++) {
+    if (!batches[index].empty()) {
+      dispatch(index);
+    }
+    {
+      std::scoped_lock lock(workers[index].latch_);
+      workers[index].done_ = true;
+    }
+    workers[index].cv_.notify_all();
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+}
 
 /*
  *undo phase on TABLE PAGE level(table/table_page.h)
  *iterate through active txn map and undo each operation
  */
-void LogRecovery::Undo() {}
+void LogRecovery::Undo() {
+  std::vector<lsn_t> last_lsns;
+  for (const auto &[txn_id, lsn] : active_txn_) {
+    last_lsns.push_back(lsn);
+  }
+  // Loser transactions are independent of each other, so each thread rolls back whole transactions. Pages they share
+  // are protected by the page latch.
+  std::atomic<size_t> next_txn{0};
+  auto undo_txns = [&] {
+    LogReadBuffer buf;
+    LogRecord log_record;
+    for (size_t i = next_txn++; i < last_lsns.size(); i = next_txn++) {
+      lsn_t lsn = last_lsns[i];
+      while (lsn != INVALID_LSN) {
+        auto iter = lsn_mapping_.find(lsn);
+        if (iter == lsn_mapping_.end() || !ReadLogRecord(iter->second, &buf, &log_record)) {
+          LOG_DEBUG("log record %d of a loser transaction is missing", lsn);
+          break;
+        }
+        UndoLogRecord(&log_record);
+        lsn = log_record.prev_lsn_;
+      }
+    }
+  };
+  std::vector<std::thread> threads;
+  for (size_t i = 1; i < std::min(num_threads_, last_lsns.size()); i++) {
+    threads.emplace_back(undo_txns);
+  }
+  undo_txns();
+  for (auto &thread : threads) {
+    thread.join();
+  }
+  active_txn_.clear();
+  lsn_mapping_.clear();
+}
+
+std::vector<page_id_t> LogRecovery::GetChangedPages(LogRecord *log_record) {
+  switch (log_record->log_record_type_) {
+    case LogRecordType::INSERT:
+      return {log_record->insert_rid_.GetPageId()};
+    case LogRecordType::MARKDELETE:
+    case LogRecordType::APPLYDELETE:
+    case LogRecordType::ROLLBACKDELETE:
+      return {log_record->delete_rid_.GetPageId()};
+    case LogRecordType::UPDATE:
+    case LogRecordType::UPDATE_DELTA:
+      return {log_record->update_rid_.GetPageId()};
+    case LogRecordType::NEWPAGE:
+      if (log_record->prev_page_id_ == INVALID_PAGE_ID) {
+        return {log_record->page_id_};
+      }
+      return {log_record->page_id_, log_record->prev_page_id_};
+    default:
+      return {};
+  }
+}
+
+void LogRecovery::RedoLogRecord(LogRecord *log_record, page_id_t page_id) {
+  auto *page = static_cast<TablePage *>(buffer_pool_manager_->FetchPage(page_id));
+  BUSTUB_ASSERT(page != nullptr, "redo workers pin one page each, which must fit into the buffer pool");
+  if (page->GetLSN() >= log_record->lsn_) {
+    buffer_pool_manager_->UnpinPage(page_id, false);
+    return;
+  }
+  switch (log_record->log_record_type_) {
+    case LogRecordType::INSERT: {
+      RID rid;
+      page->InsertTuple(log_record->insert_tuple_, &rid, nullptr, nullptr, nullptr);
+      break;
+    }
+    case LogRecordType::MARKDELETE:
+      page->MarkDelete(log_record->delete_rid_, nullptr, nullptr, nullptr);
+      break;
+    case LogRecordType::APPLYDELETE:
+      page->ApplyDelete(log_record->delete_rid_, nullptr, nullptr);
+      break;
+    case LogRecordType::ROLLBACKDELETE:
+      page->RollbackDelete(log_record->delete_rid_, nullptr, nullptr);
+      break;
+    case LogRecordType::UPDATE: {
+      Tuple old_tuple;
+      page->UpdateTuple(log_record->new_tuple_, &old_tuple, log_record->update_rid_, nullptr, nullptr, nullptr);
+      break;
+    }
+    case LogRecordType::UPDATE_DELTA: {
+      Tuple tuple;
+      if (page->GetTuple(log_record->update_rid_, &tuple, nullptr, nullptr) &&
+          ApplyUpdateDelta(*log_record, false, &tuple)) {
+        Tuple old_tuple;
+        page->UpdateTuple(tuple, &old_tuple, log_record->update_rid_, nullptr, nullptr, nullptr);
+      }
+      break;
+    }
+    case LogRecordType::NEWPAGE:
+      if (page_id == log_record->page_id_) {
+        page->Init(page_id, PAGE_SIZE - PAGE_CHECKSUM_SIZE, log_record->prev_page_id_, nullptr, nullptr);
+      } else {
+        page->SetNextPageId(log_record->page_id_);
+      }
+      break;
+    default:
+      break;
+  }
+  page->SetLSN(log_record->lsn_);
+  buffer_pool_manager_->UnpinPage(page_id, true);
+}
+
+void LogRecovery::UndoLogRecord(LogRecord *log_record) {
+  std::vector<page_id_t> pages = GetChangedPages(log_record);
+  // A new page stays allocated; it is simply empty once its inserts are undone.
+  if (pages.empty() || log_record->log_record_type_ == LogRecordType::NEWPAGE) {
+    return;
+  }
+  auto *page = static_cast<TablePage *>(buffer_pool_manager_->FetchPage(pages[0]));
+  BUSTUB_ASSERT(page != nullptr, "undo threads pin one page each, which must fit into the buffer pool");
+  page->WLatch();
+  switch (log_record->log_record_type_) {
+    case LogRecordType::INSERT:
+      page->ApplyDelete(log_record->insert_rid_, nullptr, nullptr);
+      break;
+    case LogRecordType::MARKDELETE:
+      page->RollbackDelete(log_record->delete_rid_, nullptr, nullptr);
+      break;
+    case LogRecordType::APPLYDELETE: {
+      RID rid;
+      page->InsertTuple(log_record->delete_tuple_, &rid, nullptr, nullptr, nullptr);
+      break;
+    }
+    case LogRecordType::ROLLBACKDELETE:
+      page->MarkDelete(log_record->delete_rid_, nullptr, nullptr, nullptr);
+      break;
+    case LogRecordType::UPDATE: {
+      Tuple new_tuple;
+      page->UpdateTuple(log_record->old_tuple_, &new_tuple, log_record->update_rid_, nullptr, nullptr, nullptr);
+      break;
+    }
+    case LogRecordType::UPDATE_DELTA: {
+      Tuple tuple;
+      if (page->GetTuple(log_record->update_rid_, &tuple, nullptr, nullptr) &&
+          ApplyUpdateDelta(*log_record, true, &tuple)) {
+        Tuple new_tuple;
+        page->UpdateTuple(tuple, &new_tuple, log_record->update_rid_, nullptr, nullptr, nullptr);
+      }
+      break;
+    }
+    default:
+      break;
+  }
+  page->WUnlatch();
+  buffer_pool_manager_->UnpinPage(pages[0], true);
+}
+
+bool LogRecovery::ApplyUpdateDelta(const LogRecord &log_record, bool undo, Tuple *tuple) {
+  if (tuple->GetLength() != log_record.update_tuple_size_) {
+    return false;
+  }
+  const std::string &bytes = undo ? log_record.update_old_bytes_ : log_record.update_new_bytes_;
+  size_t pos = 0;
+  for (const auto &[offset, length] : log_record.update_ranges_) {
+    memcpy(tuple->GetData() + offset, bytes.data() + pos, length);
+    pos += length;
+  }
+  return true;
+}
+
+bool LogRecovery::ReadLogRecord(const LogPosition &position, LogReadBuffer *buf, LogRecord *log_record) {
+  char *data = buf->data_.get();
+  if (position.block_offset_ >= 0) {
+    if (buf->block_offset_ != position.offset_) {
+      // A block is shorter than a log buffer; reading past the end of the log yields zeros.
+      buf->block_offset_ = -1;
+      if (!disk_manager_->ReadLog(data, LOG_BUFFER_SIZE, position.offset_) ||
+          LogCompression::DecompressBlock(data, LOG_BUFFER_SIZE, buf->block_.get(), &buf->block_size_) <= 0) {
+        return false;
+      }
+      buf->block_offset_ = position.offset_;
+    }
+    return DeserializeLogRecord(buf->block_.get() + position.block_offset_, buf->block_size_ - position.block_offset_,
+                                log_record);
+  }
+  int64_t offset = position.offset_;
+  if (!disk_manager_->ReadLog(data, LogRecord::HEADER_SIZE, offset)) {
+    return false;
+  }
+  int32_t size;
+  memcpy(&size, data, sizeof(int32_t));
+  if (size < LogRecord::HEADER_SIZE || size > LOG_BUFFER_SIZE) {
+    return false;
+  }
+  if (size > LogRecord::HEADER_SIZE && !disk_manager_->ReadLog(data + LogRecord::HEADER_SIZE,
+                                                               size - LogRecord::HEADER_SIZE,
+                                                               offset + LogRecord::HEADER_SIZE)) {
+    return false;
+  }
+  return DeserializeLogRecord(data, size, log_record);
+}
+
+bool LogRecovery::ReadCheckpoint(LogRecord *checkpoint) {
+  int64_t offset;
+  lsn_t lsn;
+  if (!disk_manager_->ReadMasterRecord(&offset, &lsn)) {
+    return false;
+  }
+  // The master record points to the log buffer holding the checkpoint, or to an earlier one.
+  bool found = false;
+  ScanLog(offset, [&](LogRecord *log_record, const LogPosition & /*position*/) {
+    if (log_record->lsn_ == lsn) {
+      found = log_record->log_record_type_ == LogRecordType::END_CHECKPOINT;
+      *checkpoint = *log_record;
+      return false;
+    }
+    return log_record->lsn_ < lsn;
+  });
+  if (!found) {
+    LOG_DEBUG("ignoring master record without a checkpoint at offset %" PRId64, offset);
+  }
+  return found;
+}
+
+int64_t LogRecovery::ScanLog(int64_t offset, const std::function<bool(LogRecord *, const LogPosition &)> &visit) {
+  // Chunks are read to LOG_BUFFER_SIZE bytes into a buffer; the unparsed tail of the previous chunk is moved in front.
+  int64_t log_size = disk_manager_->GetLogSize();
+  auto read_chunk = [this, log_size](char *buf, int64_t offset) {
+    auto size = static_cast<int>(std::min<int64_t>(LOG_RECOVERY_READ_SIZE, log_size - offset));
+    if (size <= 0) {
+      return 0;
+    }
+    disk_manager_->ReadLog(buf + LOG_BUFFER_SIZE, size, offset);
+    return size;
+  };
+  int64_t chunk_offset = offset;
+  int chunk_size = read_chunk(log_buffer_, chunk_offset);
+  int tail = 0;
+  bool corrupt = false;
+  offset_ = offset;
+  LogRecord log_record;
+  while (chunk_size > 0) {
+    auto read_ahead = std::async(std::launch::async, read_chunk, read_ahead_buffer_, chunk_offset + chunk_size);
+    const char *data = log_buffer_ + LOG_BUFFER_SIZE - tail;
+    int available = tail + chunk_size;
+    int pos = 0;
+    while (true) {
+      if (LogCompression::IsBlock(data + pos, available - pos)) {
+        int raw_size;
+        int block_size = LogCompression::DecompressBlock(data + pos, available - pos, block_buffer_, &raw_size);
+        if (block_size < 0) {
+          LOG_DEBUG("corrupt log block at offset %" PRId64, offset_ + pos);
+          corrupt = true;
+        }
+        if (block_size <= 0) {
+          break;
+        }
+        for (int block_pos = 0;
+             block_pos < raw_size && DeserializeLogRecord(block_buffer_ + block_pos, raw_size - block_pos, &log_record);
+             block_pos += log_record.size_) {
+          if (!visit(&log_record, {offset_ + pos, block_pos})) {
+            return offset_ + pos;
+          }
+        }
+        pos += block_size;
+      } else if (DeserializeLogRecord(data + pos, available - pos, &log_record)) {
+        if (!visit(&log_record, {offset_ + pos, -1})) {
+          return offset_ + pos;
+        }
+        pos += log_record.size_;
+      } else {
+        break;
+      }
+    }
+    offset_ += pos;
+    tail = available - pos;
+    chunk_offset += chunk_size;
+    chunk_size = read_ahead.get();
+    if (chunk_size == 0 || corrupt) {
+      break;
+    }
+    BUSTUB_ASSERT(tail <= LOG_BUFFER_SIZE, "a log record is larger than the log buffer");
+    memcpy(read_ahead_buffer_ + LOG_BUFFER_SIZE - tail, data + pos, tail);
+    std::swap(log_buffer_, read_ahead_buffer_);
+  }
+  return offset_;
+}
+
+void LogRecovery::RunRedoWorker(RedoWorker *worker) {
+  while (true) {
+    std::vector<RedoTask> batch;
+    {
+      std::unique_lock lock(worker->latch_);
+      worker->cv_.wait(lock, [&] { return !worker->batches_.empty() || worker->done_; });
+      if (worker->batches_.empty()) {
+        return;
+      }
+      batch = std::move(worker->batches_.front());
+      worker->batches_.pop_front();
+    }
+    worker->cv_.notify_all();
+    for (auto &task : batch) {
+      RedoLogRecord(&task.log_record_, task.page_id_);
+    }
+  }
+}
 
 }  // namespace bustub
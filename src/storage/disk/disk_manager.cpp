@@ -10,8 +10,15 @@
 //
 //===----------------------------------------------------------------------===//
 
+#include <dirent.h>
+#include <fcntl.h>
 #include <sys/stat.h>
+#include <unistd.h>
+#include <algorithm>
 #include <cassert>
+#include <cctype>
+#include <cerrno>
+#include <cstdio>
 #include <cstring>
 #include <iostream>
 #include <mutex>  // NOLINT
@@ -20,113 +27,178 @@
 
 #include "common/exception.h"
 #include "common/logger.h"
+#include "common/util/crc32c.h"
 #include "storage/disk/disk_manager.h"
+#include "storage/disk/io_uring_disk_backend.h"
+#include "storage/disk/posix_disk_backend.h"
+#include "storage/disk/stream_disk_backend.h"
 
 namespace bustub {
 
 static char *buffer_used;
 
+namespace {
+bool WriteFully(int fd, const char *data, int size, int64_t offset) {
+  for (int written = 0; written < size;) {
+    ssize_t n = pwrite(fd, data + written, size - written, offset + written);
+    if (n < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+      return false;
+    }
+    written += static_cast<int>(n);
+  }
+  return true;
+}
+
+bool IsNumber(const std::string &str, std::string::size_type begin, std::string::size_type end) {
+  return begin < end && std::all_of(str.begin() + begin, str.begin() + end, [](char c) { return isdigit(c) != 0; });
+}
+}  // namespace
+
 /**
  * Constructor: open/create a single database file & log file
  * @input db_file: database file name
  */
-DiskManager::DiskManager(const std::string &db_file)
-    : file_name_(db_file), num_flushes_(0), num_writes_(0), flush_log_(false), flush_log_f_(nullptr) {
+DiskManager::DiskManager(const std::string &db_file, DiskBackendType backend_type, bool direct_io,
+                         int64_t log_segment_size)
+    : log_segment_size_(log_segment_size),
+      file_name_(db_file),
+      num_flushes_(0),
+      num_writes_(0),
+      num_reads_(0),
+      flush_log_(false),
+      flush_log_f_(nullptr) {
+  switch (backend_type) {
+    case DiskBackendType::IO_URING:
+      try {
+        backend_ = std::make_unique<IoUringDiskBackend>(db_file, IO_URING_QUEUE_DEPTH, direct_io);
+        break;
+      } catch (Exception &e) {
+        // Fall back, e.g. when the kernel does not offer io_uring. Only the POSIX backend keeps up direct I/O.
+        if (direct_io) {
+          LOG_INFO("falling back to the POSIX disk backend: %s", e.what());
+          backend_ = std::make_unique<PosixDiskBackend>(db_file, POSIX_DISK_BACKEND_THREADS, direct_io);
+          break;
+        }
+        LOG_INFO("falling back to the stream disk backend: %s", e.what());
+      }
+      [[fallthrough]];
+    case DiskBackendType::STREAM:
+      backend_ = std::make_unique<StreamDiskBackend>(db_file);
+      break;
+    case DiskBackendType::POSIX:
+      backend_ = std::make_unique<PosixDiskBackend>(db_file, POSIX_DISK_BACKEND_THREADS, direct_io);
+      break;
+  }
+
   std::string::size_type n = file_name_.rfind('.');
   if (n == std::string::npos) {
     LOG_DEBUG("wrong file format");
     return;
   }
   log_name_ = file_name_.substr(0, n) + ".log";
-
-  log_io_.open(log_name_, std::ios::binary | std::ios::in | std::ios::app | std::ios::out);
-  // directory or file does not exist
-  if (!log_io_.is_open()) {
-    log_io_.clear();
-    // create a new file
-    log_io_.open(log_name_, std::ios::binary | std::ios::trunc | std::ios::app | std::ios::out);
-    log_io_.close();
-    // reopen with original mode
-    log_io_.open(log_name_, std::ios::binary | std::ios::in | std::ios::app | std::ios::out);
-    if (!log_io_.is_open()) {
-      throw Exception("can't open dblog file");
-    }
-  }
-
-  std::scoped_lock scoped_db_io_latch(db_io_latch_);
-  db_io_.open(db_file, std::ios::binary | std::ios::in | std::ios::out);
-  // directory or file does not exist
-  if (!db_io_.is_open()) {
-    db_io_.clear();
-    // create a new file
-    db_io_.open(db_file, std::ios::binary | std::ios::trunc | std::ios::out);
-    db_io_.close();
-    // reopen with original mode
-    db_io_.open(db_file, std::ios::binary | std::ios::in | std::ios::out);
-    if (!db_io_.is_open()) {
-      throw Exception("can't open db file");
-    }
+  master_name_ = file_name_.substr(0, n) + ".master";
+  OpenLog();
+  // A master record left over from an earlier log would point into the new one.
+  if (GetLogSize() == 0) {
+    remove(master_name_.c_str());
   }
+
   buffer_used = nullptr;
 }
 
+DiskManager::~DiskManager() { CloseLog(); }
+
 /**
  * Close all file streams
  */
 void DiskManager::ShutDown() {
-  {
-    std::scoped_lock scoped_db_io_latch(db_io_latch_);
-    db_io_.close();
-  }
-  log_io_.close();
+  backend_->ShutDown();
+  CloseLog();
 }
 
 /**
  * Write the contents of the specified page into disk file
  */
-void DiskManager::WritePage(page_id_t page_id, const char *page_data) {
-  std::scoped_lock scoped_db_io_latch(db_io_latch_);
-  size_t offset = static_cast<size_t>(page_id) * PAGE_SIZE;
-  // set write cursor to offset
+void DiskManager::WritePage(page_id_t page_id, char *page_data) {
   num_writes_ += 1;
-  db_io_.seekp(offset);
-  db_io_.write(page_data, PAGE_SIZE);
-  // check for I/O error
-  if (db_io_.bad()) {
-    LOG_DEBUG("I/O error while writing");
-    return;
+  StampPage(page_id, page_data);
+  backend_->WritePages(page_id, &page_data, 1);
+}
+
+/**
+ * Write a run of consecutive pages into disk file
+ */
+void DiskManager::WritePages(page_id_t page_id, char *const *pages_data, size_t num_pages) {
+  num_writes_ += static_cast<int>(num_pages);
+  for (size_t i = 0; i < num_pages; i++) {
+    StampPage(page_id + static_cast<page_id_t>(i), pages_data[i]);
   }
-  // needs to flush to keep disk file in sync
-  db_io_.flush();
+  backend_->WritePages(page_id, pages_data, num_pages);
 }
 
 /**
- * Read the contents of the specified page into the given memory area
+ * Force the db file to stable storage
  */
-void DiskManager::ReadPage(page_id_t page_id, char *page_data) {
-  std::scoped_lock scoped_db_io_latch(db_io_latch_);
-  int offset = page_id * PAGE_SIZE;
-  // check if read beyond file length
-  if (offset > GetFileSize(file_name_)) {
-    LOG_DEBUG("I/O error reading past end of file");
-    // std::cerr << "I/O error while reading" << std::endl;
-  } else {
-    // set read cursor to offset
-    db_io_.seekp(offset);
-    db_io_.read(page_data, PAGE_SIZE);
-    if (db_io_.bad()) {
-      LOG_DEBUG("I/O error while reading");
-      return;
+void DiskManager::SyncPages() { backend_->Sync(); }
+
+/**
+ * Read a run of consecutive pages into the given memory areas
+ */
+void DiskManager::ReadPages(page_id_t page_id, char *const *pages_data, size_t num_pages, bool verify) {
+  num_reads_ += static_cast<int>(num_pages);
+  backend_->ReadPages(page_id, pages_data, num_pages);
+  for (size_t i = 0; verify && i < num_pages; i++) {
+    if (!VerifyPage(page_id + static_cast<page_id_t>(i), pages_data[i])) {
+      throw CorruptedPageException(page_id + static_cast<page_id_t>(i));
     }
-    // if file ends before reading PAGE_SIZE
-    int read_count = db_io_.gcount();
-    if (read_count < PAGE_SIZE) {
-      LOG_DEBUG("Read less than a page");
-      db_io_.clear();
-      // std::cerr << "Read less than a page" << std::endl;
-      memset(page_data + read_count, 0, PAGE_SIZE - read_count);
+  }
+}
+
+/**
+ * Read the contents of the specified page into the given memory area
+ */
+void DiskManager::ReadPage(page_id_t page_id, char *page_data, bool verify) {
+  num_reads_ += 1;
+  backend_->ReadPages(page_id, &page_data, 1);
+  if (verify && !VerifyPage(page_id, page_data)) {
+    throw CorruptedPageException(page_id);
+  }
+}
+
+/**
+ * Start asynchronous page reads and writes
+ */
+void DiskManager::SubmitRequests(std::vector<DiskRequest> *requests) {
+  for (const auto &request : *requests) {
+    (request.is_write_ ? num_writes_ : num_reads_) += static_cast<int>(request.pages_data_.size());
+    for (size_t i = 0; request.is_write_ && i < request.pages_data_.size(); i++) {
+      StampPage(request.page_id_ + static_cast<page_id_t>(i), request.pages_data_[i]);
     }
   }
+  backend_->Submit(requests);
+}
+
+bool DiskManager::VerifyPage(page_id_t page_id, const char *page_data) {
+  uint32_t checksum;
+  memcpy(&checksum, page_data + OFFSET_PAGE_CHECKSUM, sizeof(checksum));
+  if (checksum == ComputePageChecksum(page_id, page_data)) {
+    return true;
+  }
+  // A page that was allocated but never written reads as zeros, checksum included.
+  return checksum == 0 && std::all_of(page_data, page_data + OFFSET_PAGE_CHECKSUM, [](char c) { return c == 0; });
+}
+
+uint32_t DiskManager::ComputePageChecksum(page_id_t page_id, const char *page_data) {
+  uint32_t checksum = Crc32c::Value(reinterpret_cast<const char *>(&page_id), sizeof(page_id));
+  return Crc32c::Extend(checksum, page_data, OFFSET_PAGE_CHECKSUM);
+}
+
+void DiskManager::StampPage(page_id_t page_id, char *page_data) {
+  uint32_t checksum = ComputePageChecksum(page_id, page_data);
+  memcpy(page_data + OFFSET_PAGE_CHECKSUM, &checksum, sizeof(checksum));
 }
 
 /**
@@ -150,16 +222,38 @@ void DiskManager::WriteLog(char *log_data, int size) {
   }
 
   num_flushes_ += 1;
-  // sequence write
-  log_io_.write(log_data, size);
-
-  // check for I/O error
-  if (log_io_.bad()) {
-    LOG_DEBUG("I/O error while writing log");
-    return;
+  // sequence write, split at segment boundaries
+  int64_t offset = log_size_;
+  std::vector<int> fds;
+  for (int written = 0; written < size;) {
+    int64_t segment = offset / log_segment_size_;
+    int64_t segment_offset = offset % log_segment_size_;
+    int count = static_cast<int>(std::min<int64_t>(size - written, log_segment_size_ - segment_offset));
+    int fd;
+    {
+      std::scoped_lock lock(log_latch_);
+      fd = OpenLogSegment(segment, true);
+    }
+    int64_t used = segment_offset + count;
+    if (!WriteFully(fd, log_data + written, count, LOG_SEGMENT_HEADER_SIZE + segment_offset) ||
+        !WriteFully(fd, reinterpret_cast<char *>(&used), sizeof(used), sizeof(int64_t))) {
+      LOG_DEBUG("I/O error while writing log");
+      return;
+    }
+    if (fds.empty() || fds.back() != fd) {
+      fds.push_back(fd);
+    }
+    written += count;
+    offset += count;
   }
-  // needs to flush to keep disk file in sync
-  log_io_.flush();
+  // The records are durable only once they reach the device, not just the OS page cache.
+  for (int fd : fds) {
+    if (fdatasync(fd) != 0) {
+      LOG_DEBUG("I/O error while syncing log");
+      return;
+    }
+  }
+  log_size_ = offset;
   flush_log_ = false;
 }
 
@@ -168,29 +262,116 @@ void DiskManager::WriteLog(char *log_data, int size) {
  * Always read from the beginning and perform sequence read
  * @return: false means already reach the end
  */
-bool DiskManager::ReadLog(char *log_data, int size, int offset) {
-  if (offset >= GetFileSize(log_name_)) {
-    // LOG_DEBUG("end of log file");
-    // LOG_DEBUG("file size is %d", GetFileSize(log_name_));
+bool DiskManager::ReadLog(char *log_data, int size, int64_t offset) {
+  int64_t log_size = log_size_;
+  if (offset >= log_size || offset < GetLogStart()) {
     return false;
   }
-  log_io_.seekp(offset);
-  log_io_.read(log_data, size);
-
-  if (log_io_.bad()) {
-    LOG_DEBUG("I/O error while reading log");
-    return false;
+  int read_count = 0;
+  while (read_count < size && offset + read_count < log_size) {
+    int64_t segment = (offset + read_count) / log_segment_size_;
+    int64_t segment_offset = (offset + read_count) % log_segment_size_;
+    int count = static_cast<int>(
+        std::min({static_cast<int64_t>(size - read_count), log_segment_size_ - segment_offset,
+                  log_size - offset - read_count}));
+    std::scoped_lock lock(log_latch_);
+    int fd = OpenLogSegment(segment, false);
+    ssize_t n = fd < 0 ? -1 : pread(fd, log_data + read_count, count, LOG_SEGMENT_HEADER_SIZE + segment_offset);
+    if (n < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+      LOG_DEBUG("I/O error while reading log");
+      return false;
+    }
+    if (n == 0) {
+      break;
+    }
+    read_count += static_cast<int>(n);
   }
-  // if log file ends before reading "size"
-  int read_count = log_io_.gcount();
+  // if log ends before reading "size"
   if (read_count < size) {
-    log_io_.clear();
     memset(log_data + read_count, 0, size - read_count);
   }
 
   return true;
 }
 
+/**
+ * Returns the size of the log
+ */
+int64_t DiskManager::GetLogSize() { return log_size_; }
+
+/**
+ * Returns the offset of the oldest log byte still kept
+ */
+int64_t DiskManager::GetLogStart() {
+  std::scoped_lock lock(log_latch_);
+  return first_log_segment_ * log_segment_size_;
+}
+
+/**
+ * Move the segments before offset aside as spares, or delete them if there are enough spares
+ */
+void DiskManager::RecycleLogSegments(int64_t offset) {
+  std::scoped_lock lock(log_latch_);
+  // The segment being written is never recycled.
+  int64_t end_segment = std::min(offset, static_cast<int64_t>(log_size_)) / log_segment_size_;
+  for (; first_log_segment_ < end_segment; first_log_segment_++) {
+    auto iter = log_segment_fds_.find(first_log_segment_);
+    if (iter != log_segment_fds_.end()) {
+      close(iter->second);
+      log_segment_fds_.erase(iter);
+    }
+    std::string name = GetLogSegmentName(first_log_segment_);
+    std::string spare_name = log_name_ + ".spare" + std::to_string(first_log_segment_);
+    if (spare_log_segments_.size() < LOG_MAX_SPARE_SEGMENTS && rename(name.c_str(), spare_name.c_str()) == 0) {
+      spare_log_segments_.push_back(spare_name);
+    } else {
+      remove(name.c_str());
+    }
+  }
+}
+
+/**
+ * Write the master record to a temporary file first and rename it over the old one, so that a crash leaves either
+ * record intact.
+ */
+void DiskManager::WriteMasterRecord(int64_t offset, lsn_t lsn) {
+  std::string tmp_name = master_name_ + ".tmp";
+  int fd = open(tmp_name.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+  if (fd < 0) {
+    throw Exception("can't open master record file");
+  }
+  char record[sizeof(int64_t) + sizeof(lsn_t)];
+  memcpy(record, &offset, sizeof(int64_t));
+  memcpy(record + sizeof(int64_t), &lsn, sizeof(lsn_t));
+  bool written = write(fd, record, sizeof(record)) == static_cast<ssize_t>(sizeof(record)) && fdatasync(fd) == 0;
+  close(fd);
+  if (!written || rename(tmp_name.c_str(), master_name_.c_str()) != 0) {
+    throw Exception("can't write master record");
+  }
+}
+
+/**
+ * Reads the location of the last checkpoint record, returns false if there is none
+ */
+bool DiskManager::ReadMasterRecord(int64_t *offset, lsn_t *lsn) {
+  int fd = open(master_name_.c_str(), O_RDONLY);
+  if (fd < 0) {
+    return false;
+  }
+  char record[sizeof(int64_t) + sizeof(lsn_t)];
+  bool read_ok = read(fd, record, sizeof(record)) == static_cast<ssize_t>(sizeof(record));
+  close(fd);
+  if (!read_ok) {
+    return false;
+  }
+  memcpy(offset, record, sizeof(int64_t));
+  memcpy(lsn, record + sizeof(int64_t), sizeof(lsn_t));
+  return true;
+}
+
 /**
  * Returns number of flushes made so far
  */
@@ -201,18 +382,190 @@ int DiskManager::GetNumFlushes() const { return num_flushes_; }
  */
 int DiskManager::GetNumWrites() const { return num_writes_; }
 
+/**
+ * Returns number of page reads made so far
+ */
+int DiskManager::GetNumReads() const { return num_reads_; }
+
+/**
+ * Returns number of pages in the database file
+ */
+page_id_t DiskManager::GetNumPages() { return backend_->GetNumPages(); }
+
 /**
  * Returns true if the log is currently being flushed
  */
 bool DiskManager::GetFlushState() const { return flush_log_; }
 
 /**
- * Private helper function to get disk file size
+ * Read the segment size and the segments of the log, or start a new log
  */
-int DiskManager::GetFileSize(const std::string &file_name) {
-  struct stat stat_buf;
-  int rc = stat(file_name.c_str(), &stat_buf);
-  return rc == 0 ? static_cast<int>(stat_buf.st_size) : -1;
+void DiskManager::OpenLog() {
+  std::string::size_type slash = log_name_.rfind('/');
+  std::string dir_name = slash == std::string::npos ? "." : log_name_.substr(0, slash + 1);
+  std::string prefix = log_name_.substr(slash == std::string::npos ? 0 : slash + 1) + ".";
+  int control_fd = open(log_name_.c_str(), O_RDONLY);
+  int64_t segment_size = 0;
+  bool exists = control_fd >= 0 &&
+                read(control_fd, &segment_size, sizeof(segment_size)) == static_cast<ssize_t>(sizeof(segment_size)) &&
+                segment_size > 0;
+  if (control_fd >= 0) {
+    close(control_fd);
+  }
+  if (exists) {
+    log_segment_size_ = segment_size;
+  }
+
+  // Segments and spares of a log whose control file is gone belong to no log.
+  std::vector<int64_t> segments;
+  DIR *dir = opendir(dir_name.c_str());
+  if (dir == nullptr) {
+    throw Exception("can't list log directory");
+  }
+  for (dirent *entry = readdir(dir); entry != nullptr; entry = readdir(dir)) {
+    std::string name = entry->d_name;
+    if (name.compare(0, prefix.size(), prefix) != 0) {
+      continue;
+    }
+    // Only <number>, spare<number> and <number>.tmp are files of the log; anything else is left alone.
+    std::string suffix = name.substr(prefix.size());
+    std::string path = log_name_ + "." + suffix;
+    bool is_segment = IsNumber(suffix, 0, suffix.size());
+    bool is_spare = suffix.compare(0, 5, "spare") == 0 && IsNumber(suffix, 5, suffix.size());
+    bool is_tmp = suffix.size() > 4 && suffix.compare(suffix.size() - 4, 4, ".tmp") == 0 &&
+                  IsNumber(suffix, 0, suffix.size() - 4);
+    if (!is_segment && !is_spare && !is_tmp) {
+      continue;
+    }
+    if (!exists || is_tmp) {
+      // A segment that was being prepared is half written.
+      remove(path.c_str());
+    } else if (is_segment) {
+      segments.push_back(std::stoll(suffix));
+    } else {
+      spare_log_segments_.push_back(path);
+    }
+  }
+  closedir(dir);
+
+  if (!exists) {
+    int fd = open(log_name_.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0 || !WriteFully(fd, reinterpret_cast<char *>(&log_segment_size_), sizeof(log_segment_size_), 0) ||
+        fdatasync(fd) != 0) {
+      throw Exception("can't create dblog file");
+    }
+    close(fd);
+    return;
+  }
+
+  // The log ends in the last segment with bytes written to it. Later ones were only prepared.
+  std::sort(segments.begin(), segments.end());
+  first_log_segment_ = segments.empty() ? 0 : segments.front();
+  int64_t log_size = first_log_segment_ * log_segment_size_;
+  for (int64_t segment : segments) {
+    int64_t header[2];
+    int fd = open(GetLogSegmentName(segment).c_str(), O_RDONLY);
+    if (fd >= 0 && pread(fd, header, sizeof(header), 0) == static_cast<ssize_t>(sizeof(header)) &&
+        header[0] == segment && header[1] > 0) {
+      log_size = std::max(log_size, segment * log_segment_size_ + header[1]);
+    }
+    if (fd >= 0) {
+      close(fd);
+    }
+  }
+  log_size_ = log_size;
+}
+
+void DiskManager::CloseLog() {
+  std::scoped_lock lock(log_latch_);
+  if (log_segment_prep_.valid()) {
+    log_segment_prep_.wait();
+  }
+  for (const auto &[segment, fd] : log_segment_fds_) {
+    close(fd);
+  }
+  log_segment_fds_.clear();
+}
+
+std::string DiskManager::GetLogSegmentName(int64_t segment) const {
+  std::string number = std::to_string(segment);
+  return log_name_ + "." + std::string(number.size() < 10 ? 10 - number.size() : 0, '0') + number;
+}
+
+int DiskManager::OpenLogSegment(int64_t segment, bool create) {
+  auto iter = log_segment_fds_.find(segment);
+  if (iter != log_segment_fds_.end()) {
+    return iter->second;
+  }
+  if (create && log_segment_prep_.valid()) {
+    // Usually the segment this is preparing.
+    log_segment_prep_.get();
+  }
+  int fd = open(GetLogSegmentName(segment).c_str(), O_RDWR);
+  if (fd < 0 && create) {
+    PrepareLogSegment(segment, TakeSpareLogSegment());
+    fd = open(GetLogSegmentName(segment).c_str(), O_RDWR);
+  }
+  if (fd < 0) {
+    if (create) {
+      throw Exception("can't open log segment");
+    }
+    return -1;
+  }
+  log_segment_fds_[segment] = fd;
+  if (create) {
+    // Get the next segment ready while this one fills up.
+    std::string next_name = GetLogSegmentName(segment + 1);
+    if (access(next_name.c_str(), F_OK) != 0) {
+      log_segment_prep_ =
+          std::async(std::launch::async, &DiskManager::PrepareLogSegment, this, segment + 1, TakeSpareLogSegment());
+    }
+  }
+  return fd;
+}
+
+std::string DiskManager::TakeSpareLogSegment() {
+  if (spare_log_segments_.empty()) {
+    return "";
+  }
+  std::string spare_name = spare_log_segments_.back();
+  spare_log_segments_.pop_back();
+  return spare_name;
+}
+
+void DiskManager::PrepareLogSegment(int64_t segment, const std::string &spare_name) {
+  std::string name = GetLogSegmentName(segment);
+  std::string tmp_name = name + ".tmp";
+  if (spare_name.empty() || rename(spare_name.c_str(), tmp_name.c_str()) != 0) {
+    remove(tmp_name.c_str());
+  }
+  int fd = open(tmp_name.c_str(), O_RDWR | O_CREAT, 0644);
+  if (fd < 0) {
+    throw Exception("can't create log segment");
+  }
+  // Overwriting every byte reuses the blocks of a spare, or allocates those of a new file now rather than when a log
+  // write is synced. Zeros also end the log for recovery.
+  std::vector<char> zeros(LOG_RECOVERY_READ_SIZE);
+  int64_t header[2] = {segment, 0};
+  int64_t file_size = LOG_SEGMENT_HEADER_SIZE + log_segment_size_;
+  bool prepared = WriteFully(fd, reinterpret_cast<char *>(header), sizeof(header), 0);
+  for (int64_t offset = sizeof(header); prepared && offset < file_size; offset += zeros.size()) {
+    int count = static_cast<int>(std::min<int64_t>(zeros.size(), file_size - offset));
+    prepared = WriteFully(fd, zeros.data(), count, offset);
+  }
+  prepared = prepared && ftruncate(fd, file_size) == 0 && fdatasync(fd) == 0;
+  close(fd);
+  if (!prepared || rename(tmp_name.c_str(), name.c_str()) != 0) {
+    throw Exception("can't prepare log segment");
+  }
+  // The new name must be durable before records in the segment can be.
+  std::string::size_type slash = log_name_.rfind('/');
+  std::string dir_name = slash == std::string::npos ? "." : log_name_.substr(0, slash + 1);
+  int dir_fd = open(dir_name.c_str(), O_RDONLY | O_DIRECTORY);
+  if (dir_fd >= 0) {
+    fsync(dir_fd);
+    close(dir_fd);
+  }
 }
 
 }  // namespace bustub
@@ -0,0 +1,264 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// io_uring_disk_backend.cpp
+//
+// Identification: src/storage/disk/io_uring_disk_backend.cpp
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "storage/disk/io_uring_disk_backend.h"
+
+#if __has_include(<linux/io_uring.h>)
+#define BUSTUB_HAVE_IO_URING
+#endif
+
+#ifdef BUSTUB_HAVE_IO_URING
+#include <linux/io_uring.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <sys/uio.h>
+#include <unistd.h>
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <climits>
+#include <cstring>
+#endif
+
+#include "common/exception.h"
+#include "common/logger.h"
+
+namespace bustub {
+
+#ifdef BUSTUB_HAVE_IO_URING
+
+/** A submitted request, split into one operation per IOV_MAX pages. */
+struct IoUringDiskBackend::RequestState {
+  DiskRequest request_;
+  std::atomic<size_t> pending_operations_;
+};
+
+/** One vectored read or write on the submission queue. */
+struct IoUringDiskBackend::Operation {
+  RequestState *state_;
+  /** Index of the first page of the request covered by this operation. */
+  size_t first_page_;
+  std::vector<iovec> iov_;
+};
+
+IoUringDiskBackend::IoUringDiskBackend(const std::string &db_file, unsigned queue_depth, bool direct_io)
+    : PosixDiskBackend(db_file, 0, direct_io) {
+  io_uring_params params;
+  memset(&params, 0, sizeof(params));
+  ring_fd_ = static_cast<int>(syscall(__NR_io_uring_setup, queue_depth, &params));
+  if (ring_fd_ < 0) {
+    throw Exception("io_uring is not available");
+  }
+  sq_entries_ = params.sq_entries;
+
+  sq_ring_size_ = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+  cq_ring_size_ = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+  bool single_mmap = (params.features & IORING_FEAT_SINGLE_MMAP) != 0;
+  if (single_mmap) {
+    sq_ring_size_ = cq_ring_size_ = std::max(sq_ring_size_, cq_ring_size_);
+  }
+  sqes_size_ = params.sq_entries * sizeof(io_uring_sqe);
+  auto map = [&](size_t size, off_t offset) -> void * {
+    void *addr = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring_fd_, offset);
+    return addr == MAP_FAILED ? nullptr : addr;
+  };
+  sq_ring_ = map(sq_ring_size_, IORING_OFF_SQ_RING);
+  cq_ring_ = single_mmap ? sq_ring_ : map(cq_ring_size_, IORING_OFF_CQ_RING);
+  sqes_ = map(sqes_size_, IORING_OFF_SQES);
+  if (sq_ring_ == nullptr || cq_ring_ == nullptr || sqes_ == nullptr) {
+    ReleaseRing();
+    throw Exception("io_uring is not available");
+  }
+
+  auto *sq_ring = static_cast<char *>(sq_ring_);
+  auto *cq_ring = static_cast<char *>(cq_ring_);
+  sq_head_ = reinterpret_cast<unsigned *>(sq_ring + params.sq_off.head);
+  sq_tail_ = reinterpret_cast<unsigned *>(sq_ring + params.sq_off.tail);
+  sq_mask_ = reinterpret_cast<unsigned *>(sq_ring + params.sq_off.ring_mask);
+  sq_array_ = reinterpret_cast<unsigned *>(sq_ring + params.sq_off.array);
+  cq_head_ = reinterpret_cast<unsigned *>(cq_ring + params.cq_off.head);
+  cq_tail_ = reinterpret_cast<unsigned *>(cq_ring + params.cq_off.tail);
+  cq_mask_ = reinterpret_cast<unsigned *>(cq_ring + params.cq_off.ring_mask);
+  cqes_ = cq_ring + params.cq_off.cqes;
+
+  completion_thread_ = std::thread(&IoUringDiskBackend::RunCompletionThread, this);
+}
+
+IoUringDiskBackend::~IoUringDiskBackend() { ShutDown(); }
+
+void IoUringDiskBackend::Submit(std::vector<DiskRequest> *requests) {
+  if (ring_fd_ < 0) {
+    PosixDiskBackend::Submit(requests);
+    return;
+  }
+  std::vector<DiskRequest> empty_requests;
+  {
+    std::unique_lock lock(latch_);
+    for (auto &request : *requests) {
+      size_t num_pages = request.pages_data_.size();
+      if (num_pages == 0) {
+        empty_requests.push_back(std::move(request));
+        continue;
+      }
+      size_t num_operations = (num_pages + IOV_MAX - 1) / IOV_MAX;
+      auto *state = new RequestState{std::move(request), {num_operations}};
+      for (size_t first_page = 0; first_page < num_pages; first_page += IOV_MAX) {
+        auto *operation = new Operation{state, first_page, {}};
+        for (size_t i = first_page; i < std::min<size_t>(num_pages, first_page + IOV_MAX); i++) {
+          operation->iov_.push_back({state->request_.pages_data_[i], static_cast<size_t>(PAGE_SIZE)});
+        }
+        // Never have more operations outstanding than the submission queue holds, so the completion queue (twice
+        // as large) cannot overflow.
+        while (queued_ + in_flight_ >= sq_entries_) {
+          SubmitQueued();
+          completion_cv_.wait(lock);
+        }
+        Enqueue(operation);
+      }
+    }
+    SubmitQueued();
+  }
+  for (auto &request : empty_requests) {
+    request.callback_();
+  }
+}
+
+void IoUringDiskBackend::ShutDown() {
+  if (ring_fd_ >= 0) {
+    {
+      std::unique_lock lock(latch_);
+      SubmitQueued();
+      completion_cv_.wait(lock, [&] { return in_flight_ == 0; });
+      // A no-op without an operation tells the completion thread to exit.
+      Enqueue(nullptr);
+      SubmitQueued();
+    }
+    completion_thread_.join();
+    ReleaseRing();
+  }
+  PosixDiskBackend::ShutDown();
+}
+
+void IoUringDiskBackend::RunCompletionThread() {
+  while (true) {
+    unsigned head = *cq_head_;
+    if (head == __atomic_load_n(cq_tail_, __ATOMIC_ACQUIRE)) {
+      // Sleep until at least one completion arrives. Interrupted waits simply retry.
+      syscall(__NR_io_uring_enter, ring_fd_, 0, 1, IORING_ENTER_GETEVENTS, nullptr, 0);
+      continue;
+    }
+    auto *cqe = static_cast<io_uring_cqe *>(cqes_) + (head & *cq_mask_);
+    auto *operation = reinterpret_cast<Operation *>(cqe->user_data);
+    int res = cqe->res;
+    __atomic_store_n(cq_head_, head + 1, __ATOMIC_RELEASE);
+    if (operation == nullptr) {
+      return;
+    }
+    Complete(operation, res);
+    {
+      std::scoped_lock lock(latch_);
+      in_flight_--;
+    }
+    completion_cv_.notify_all();
+  }
+}
+
+void IoUringDiskBackend::Complete(Operation *operation, int res) {
+  RequestState *state = operation->state_;
+  DiskRequest &request = state->request_;
+  size_t num_pages = operation->iov_.size();
+  if (res != static_cast<int>(num_pages * PAGE_SIZE)) {
+    // Errors, short transfers, reads past the end of the file and unaligned buffers under O_DIRECT are rare; redo the
+    // whole operation synchronously, which handles all of them like every other transfer.
+    page_id_t page_id = request.page_id_ + static_cast<page_id_t>(operation->first_page_);
+    char *const *pages_data = request.pages_data_.data() + operation->first_page_;
+    if (request.is_write_) {
+      WritePages(page_id, pages_data, num_pages);
+    } else {
+      ReadPages(page_id, pages_data, num_pages);
+    }
+  }
+  delete operation;
+  if (state->pending_operations_.fetch_sub(1) == 1) {
+    request.callback_();
+    delete state;
+  }
+}
+
+void IoUringDiskBackend::Enqueue(Operation *operation) {
+  unsigned tail = *sq_tail_;
+  unsigned index = tail & *sq_mask_;
+  auto *sqe = static_cast<io_uring_sqe *>(sqes_) + index;
+  memset(sqe, 0, sizeof(*sqe));
+  if (operation == nullptr) {
+    sqe->opcode = IORING_OP_NOP;
+    sqe->fd = -1;
+  } else {
+    const DiskRequest &request = operation->state_->request_;
+    sqe->opcode = request.is_write_ ? IORING_OP_WRITEV : IORING_OP_READV;
+    sqe->fd = db_fd_;
+    sqe->off = static_cast<uint64_t>(request.page_id_ + operation->first_page_) * PAGE_SIZE;
+    sqe->addr = reinterpret_cast<uint64_t>(operation->iov_.data());
+    sqe->len = static_cast<uint32_t>(operation->iov_.size());
+  }
+  sqe->user_data = reinterpret_cast<uint64_t>(operation);
+  sq_array_[index] = index;
+  __atomic_store_n(sq_tail_, tail + 1, __ATOMIC_RELEASE);
+  queued_++;
+}
+
+void IoUringDiskBackend::SubmitQueued() {
+  while (queued_ > 0) {
+    int submitted = static_cast<int>(syscall(__NR_io_uring_enter, ring_fd_, queued_, 0, 0, nullptr, 0));
+    if (submitted < 0) {
+      if (errno == EINTR || errno == EAGAIN || errno == EBUSY) {
+        continue;
+      }
+      LOG_DEBUG("io_uring submission failed");
+      return;
+    }
+    queued_ -= submitted;
+    in_flight_ += submitted;
+  }
+}
+
+void IoUringDiskBackend::ReleaseRing() {
+  if (sqes_ != nullptr) {
+    munmap(sqes_, sqes_size_);
+  }
+  if (cq_ring_ != nullptr && cq_ring_ != sq_ring_) {
+    munmap(cq_ring_, cq_ring_size_);
+  }
+  if (sq_ring_ != nullptr) {
+    munmap(sq_ring_, sq_ring_size_);
+  }
+  sqes_ = cq_ring_ = sq_ring_ = nullptr;
+  close(ring_fd_);
+  ring_fd_ = -1;
+}
+
+#else
+
+IoUringDiskBackend::IoUringDiskBackend(const std::string &db_file, unsigned queue_depth, bool direct_io)
+    : PosixDiskBackend(db_file, 0, direct_io) {
+  throw Exception("io_uring is not available");
+}
+
+IoUringDiskBackend::~IoUringDiskBackend() = default;
+
+void IoUringDiskBackend::Submit(std::vector<DiskRequest> *requests) { PosixDiskBackend::Submit(requests); }
+
+void IoUringDiskBackend::ShutDown() { PosixDiskBackend::ShutDown(); }
+
+#endif
+
+}  // namespace bustub
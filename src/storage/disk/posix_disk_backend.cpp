@@ -0,0 +1,221 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// posix_disk_backend.cpp
+//
+// Identification: src/storage/disk/posix_disk_backend.cpp
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "storage/disk/posix_disk_backend.h"
+
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <sys/uio.h>
+#include <unistd.h>
+#include <algorithm>
+#include <cerrno>
+#include <climits>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+
+#include "common/exception.h"
+#include "common/logger.h"
+
+namespace bustub {
+
+PosixDiskBackend::PosixDiskBackend(const std::string &db_file, size_t num_io_threads, bool direct_io) {
+  db_fd_ = -1;
+  if (direct_io) {
+    db_fd_ = open(db_file.c_str(), O_RDWR | O_CREAT | O_DIRECT, 0644);
+    direct_io_ = db_fd_ >= 0;
+    if (db_fd_ < 0 && errno == EINVAL) {
+      LOG_INFO("file system does not support O_DIRECT, using buffered I/O");
+    }
+  }
+  if (db_fd_ < 0) {
+    db_fd_ = open(db_file.c_str(), O_RDWR | O_CREAT, 0644);
+  }
+  if (db_fd_ < 0) {
+    throw Exception("can't open db file");
+  }
+  for (size_t i = 0; i < num_io_threads; i++) {
+    io_threads_.emplace_back(&PosixDiskBackend::RunIOThread, this);
+  }
+}
+
+PosixDiskBackend::~PosixDiskBackend() { ShutDown(); }
+
+/**
+ * Read a run of consecutive pages with as few preadv calls as possible
+ */
+void PosixDiskBackend::ReadPages(page_id_t page_id, char *const *pages_data, size_t num_pages) {
+  if (!CanTransferDirectly(pages_data, num_pages)) {
+    // Bounce through an aligned buffer, one page at a time; buffer pool frames never take this path.
+    std::unique_ptr<char, decltype(&free)> bounce(static_cast<char *>(aligned_alloc(PAGE_SIZE, PAGE_SIZE)), &free);
+    char *bounce_data = bounce.get();
+    for (size_t i = 0; i < num_pages; i++) {
+      ReadPages(page_id + static_cast<page_id_t>(i), &bounce_data, 1);
+      memcpy(pages_data[i], bounce_data, PAGE_SIZE);
+    }
+    return;
+  }
+  std::vector<iovec> iov(std::min<size_t>(num_pages, IOV_MAX));
+  size_t read_pages = 0;
+  while (read_pages < num_pages) {
+    size_t batch = std::min<size_t>(num_pages - read_pages, IOV_MAX);
+    for (size_t i = 0; i < batch; i++) {
+      iov[i].iov_base = pages_data[read_pages + i];
+      iov[i].iov_len = PAGE_SIZE;
+    }
+    off_t offset = static_cast<off_t>(page_id + read_pages) * PAGE_SIZE;
+    ssize_t read_bytes = preadv(db_fd_, iov.data(), static_cast<int>(batch), offset);
+    if (read_bytes < 0) {
+      LOG_DEBUG("I/O error while reading");
+      return;
+    }
+    if (read_bytes == 0) {
+      // End of file: the rest of the run has never been written.
+      for (size_t i = read_pages; i < num_pages; i++) {
+        memset(pages_data[i], 0, PAGE_SIZE);
+      }
+      return;
+    }
+    size_t full_pages = static_cast<size_t>(read_bytes) / PAGE_SIZE;
+    size_t partial = static_cast<size_t>(read_bytes) % PAGE_SIZE;
+    if (partial != 0) {
+      char *rest = pages_data[read_pages + full_pages] + partial;
+      ssize_t rest_bytes = pread(db_fd_, rest, PAGE_SIZE - partial, offset + read_bytes);
+      if (rest_bytes < 0) {
+        LOG_DEBUG("I/O error while reading");
+        return;
+      }
+      if (rest_bytes < static_cast<ssize_t>(PAGE_SIZE - partial)) {
+        memset(rest + rest_bytes, 0, PAGE_SIZE - partial - rest_bytes);
+      }
+      full_pages++;
+    }
+    read_pages += full_pages;
+  }
+}
+
+/**
+ * Write a run of consecutive pages with as few pwritev calls as possible
+ */
+void PosixDiskBackend::WritePages(page_id_t page_id, const char *const *pages_data, size_t num_pages) {
+  if (!CanTransferDirectly(pages_data, num_pages)) {
+    std::unique_ptr<char, decltype(&free)> bounce(static_cast<char *>(aligned_alloc(PAGE_SIZE, PAGE_SIZE)), &free);
+    const char *bounce_data = bounce.get();
+    for (size_t i = 0; i < num_pages; i++) {
+      memcpy(bounce.get(), pages_data[i], PAGE_SIZE);
+      WritePages(page_id + static_cast<page_id_t>(i), &bounce_data, 1);
+    }
+    return;
+  }
+  std::vector<iovec> iov(std::min<size_t>(num_pages, IOV_MAX));
+  size_t written_pages = 0;
+  while (written_pages < num_pages) {
+    size_t batch = std::min<size_t>(num_pages - written_pages, IOV_MAX);
+    for (size_t i = 0; i < batch; i++) {
+      iov[i].iov_base = const_cast<char *>(pages_data[written_pages + i]);
+      iov[i].iov_len = PAGE_SIZE;
+    }
+    off_t offset = static_cast<off_t>(page_id + written_pages) * PAGE_SIZE;
+    ssize_t written = pwritev(db_fd_, iov.data(), static_cast<int>(batch), offset);
+    if (written < 0) {
+      LOG_DEBUG("I/O error while writing");
+      return;
+    }
+    // A short write may stop in the middle of a page; finish that page before issuing the next vectored write.
+    size_t full_pages = static_cast<size_t>(written) / PAGE_SIZE;
+    size_t partial = static_cast<size_t>(written) % PAGE_SIZE;
+    if (partial != 0) {
+      const char *rest = pages_data[written_pages + full_pages] + partial;
+      if (pwrite(db_fd_, rest, PAGE_SIZE - partial, offset + written) != static_cast<ssize_t>(PAGE_SIZE - partial)) {
+        LOG_DEBUG("I/O error while writing");
+        return;
+      }
+      full_pages++;
+    }
+    written_pages += full_pages;
+  }
+}
+
+void PosixDiskBackend::Sync() {
+  if (fdatasync(db_fd_) != 0) {
+    LOG_DEBUG("I/O error while syncing");
+  }
+}
+
+page_id_t PosixDiskBackend::GetNumPages() {
+  struct stat stat_buf;
+  if (fstat(db_fd_, &stat_buf) != 0) {
+    return 0;
+  }
+  return static_cast<page_id_t>(stat_buf.st_size / PAGE_SIZE);
+}
+
+void PosixDiskBackend::Submit(std::vector<DiskRequest> *requests) {
+  if (io_threads_.empty()) {
+    DiskBackend::Submit(requests);
+    return;
+  }
+  {
+    std::scoped_lock lock(queue_latch_);
+    for (auto &request : *requests) {
+      queue_.push_back(std::move(request));
+    }
+  }
+  queue_cv_.notify_all();
+}
+
+void PosixDiskBackend::ShutDown() {
+  {
+    std::scoped_lock lock(queue_latch_);
+    running_ = false;
+  }
+  queue_cv_.notify_all();
+  // The I/O threads drain the queue before they exit.
+  for (auto &thread : io_threads_) {
+    thread.join();
+  }
+  io_threads_.clear();
+  if (db_fd_ >= 0) {
+    close(db_fd_);
+    db_fd_ = -1;
+  }
+}
+
+bool PosixDiskBackend::CanTransferDirectly(const char *const *pages_data, size_t num_pages) const {
+  return !direct_io_ || std::all_of(pages_data, pages_data + num_pages, [](const char *data) {
+           return reinterpret_cast<uintptr_t>(data) % PAGE_SIZE == 0;
+         });
+}
+
+void PosixDiskBackend::RunIOThread() {
+  while (true) {
+    DiskRequest request;
+    {
+      std::unique_lock lock(queue_latch_);
+      queue_cv_.wait(lock, [&] { return !running_ || !queue_.empty(); });
+      if (queue_.empty()) {
+        return;
+      }
+      request = std::move(queue_.front());
+      queue_.pop_front();
+    }
+    if (request.is_write_) {
+      WritePages(request.page_id_, request.pages_data_.data(), request.pages_data_.size());
+    } else {
+      ReadPages(request.page_id_, request.pages_data_.data(), request.pages_data_.size());
+    }
+    request.callback_();
+  }
+}
+
+}  // namespace bustub
@@ -0,0 +1,128 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// stream_disk_backend.cpp
+//
+// Identification: src/storage/disk/stream_disk_backend.cpp
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "storage/disk/stream_disk_backend.h"
+
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <cstring>
+
+#include "common/exception.h"
+#include "common/logger.h"
+
+namespace bustub {
+
+StreamDiskBackend::StreamDiskBackend(const std::string &db_file) : file_name_(db_file) {
+  std::scoped_lock scoped_db_io_latch(db_io_latch_);
+  db_io_.open(db_file, std::ios::binary | std::ios::in | std::ios::out);
+  // directory or file does not exist
+  if (!db_io_.is_open()) {
+    db_io_.clear();
+    // create a new file
+    db_io_.open(db_file, std::ios::binary | std::ios::trunc | std::ios::out);
+    db_io_.close();
+    // reopen with original mode
+    db_io_.open(db_file, std::ios::binary | std::ios::in | std::ios::out);
+    if (!db_io_.is_open()) {
+      throw Exception("can't open db file");
+    }
+  }
+}
+
+void StreamDiskBackend::ReadPages(page_id_t page_id, char *const *pages_data, size_t num_pages) {
+  std::scoped_lock scoped_db_io_latch(db_io_latch_);
+  for (size_t i = 0; i < num_pages; i++) {
+    ReadPage(page_id + static_cast<page_id_t>(i), pages_data[i]);
+  }
+}
+
+void StreamDiskBackend::WritePages(page_id_t page_id, const char *const *pages_data, size_t num_pages) {
+  std::scoped_lock scoped_db_io_latch(db_io_latch_);
+  for (size_t i = 0; i < num_pages; i++) {
+    WritePage(page_id + static_cast<page_id_t>(i), pages_data[i]);
+  }
+}
+
+void StreamDiskBackend::Sync() {
+  // The stream flushes every write to the OS already; fsync through any descriptor of the file makes it durable.
+  int fd = open(file_name_.c_str(), O_RDONLY);
+  if (fd < 0 || fdatasync(fd) != 0) {
+    LOG_DEBUG("I/O error while syncing");
+  }
+  if (fd >= 0) {
+    close(fd);
+  }
+}
+
+page_id_t StreamDiskBackend::GetNumPages() {
+  int size = GetFileSize();
+  return size < 0 ? 0 : size / PAGE_SIZE;
+}
+
+void StreamDiskBackend::ShutDown() {
+  std::scoped_lock scoped_db_io_latch(db_io_latch_);
+  db_io_.close();
+}
+
+/**
+ * Read the contents of the specified page into the given memory area
+ */
+void StreamDiskBackend::ReadPage(page_id_t page_id, char *page_data) {
+  int offset = page_id * PAGE_SIZE;
+  // check if read beyond file length
+  if (offset > GetFileSize()) {
+    LOG_DEBUG("I/O error reading past end of file");
+    // std::cerr << "I/O error while reading" << std::endl;
+  } else {
+    // set read cursor to offset
+    db_io_.seekp(offset);
+    db_io_.read(page_data, PAGE_SIZE);
+    if (db_io_.bad()) {
+      LOG_DEBUG("I/O error while reading");
+      return;
+    }
+    // if file ends before reading PAGE_SIZE
+    int read_count = db_io_.gcount();
+    if (read_count < PAGE_SIZE) {
+      LOG_DEBUG("Read less than a page");
+      db_io_.clear();
+      // std::cerr << "Read less than a page" << std::endl;
+      memset(page_data + read_count, 0, PAGE_SIZE - read_count);
+    }
+  }
+}
+
+/**
+ * Write the contents of the specified page into disk file
+ */
+void StreamDiskBackend::WritePage(page_id_t page_id, const char *page_data) {
+  size_t offset = static_cast<size_t>(page_id) * PAGE_SIZE;
+  // set write cursor to offset
+  db_io_.seekp(offset);
+  db_io_.write(page_data, PAGE_SIZE);
+  // check for I/O error
+  if (db_io_.bad()) {
+    LOG_DEBUG("I/O error while writing");
+    return;
+  }
+  // needs to flush to keep disk file in sync
+  db_io_.flush();
+}
+
+int StreamDiskBackend::GetFileSize() {
+  struct stat stat_buf;
+  int rc = stat(file_name_.c_str(), &stat_buf);
+  return rc == 0 ? static_cast<int>(stat_buf.st_size) : -1;
+}
+
+}  // namespace bustub
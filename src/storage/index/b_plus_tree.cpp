@@ -9,7 +9,13 @@
 //
 //===----------------------------------------------------------------------===//
 
+#include <algorithm>
+#include <cmath>
+#include <functional>
 #include <string>
+#include <thread>  // NOLINT
+#include <type_traits>
+#include <utility>
 
 #include "common/exception.h"
 #include "common/rid.h"
@@ -23,15 +29,17 @@ BPLUSTREE_TYPE::BPlusTree(std::string name, BufferPoolManager *buffer_pool_manag
     : index_name_(std::move(name)),
       root_page_id_(INVALID_PAGE_ID),
       buffer_pool_manager_(buffer_pool_manager),
+      epoch_manager_(buffer_pool_manager),
       comparator_(comparator),
-      leaf_max_size_(leaf_max_size),
-      internal_max_size_(internal_max_size) {}
+      // larger sizes would not fit into a page
+      leaf_max_size_(std::min(leaf_max_size, static_cast<int>(LEAF_PAGE_SIZE))),
+      internal_max_size_(std::min(internal_max_size, static_cast<int>(INTERNAL_PAGE_MAX_SIZE))) {}
 
 /*
  * Helper function to decide whether current b+tree is empty
  */
 INDEX_TEMPLATE_ARGUMENTS
-bool BPLUSTREE_TYPE::IsEmpty() const { return true; }
+bool BPLUSTREE_TYPE::IsEmpty() const { return root_page_id_ == INVALID_PAGE_ID; }
 /*****************************************************************************
  * SEARCH
  *****************************************************************************/
@@ -42,7 +50,29 @@ bool BPLUSTREE_TYPE::IsEmpty() const { return true; }
  */
 INDEX_TEMPLATE_ARGUMENTS
 bool BPLUSTREE_TYPE::GetValue(const KeyType &key, std::vector<ValueType> *result, Transaction *transaction) {
-  return false;
+  EpochGuard guard(&epoch_manager_);
+  // Each iteration after the first is a restart after a conflict with a writer.
+  for (;; std::this_thread::yield()) {
+    Page *page;
+    uint64_t version;
+    if (!FindLeafPageOptimistic(key, Edge::NONE, &page, &version)) {
+      continue;
+    }
+    if (page == nullptr) {
+      return false;
+    }
+    auto *leaf = reinterpret_cast<LeafPage *>(page->GetData());
+    ValueType value;
+    bool found = leaf->Lookup(key, &value, comparator_);
+    bool valid = leaf->Validate(version);
+    buffer_pool_manager_->UnpinPage(page->GetPageId(), false);
+    if (valid) {
+      if (found) {
+        result->push_back(value);
+      }
+      return found;
+    }
+  }
 }
 
 /*****************************************************************************
@@ -56,7 +86,47 @@ bool BPLUSTREE_TYPE::GetValue(const KeyType &key, std::vector<ValueType> *result
  * keys return false, otherwise return true.
  */
 INDEX_TEMPLATE_ARGUMENTS
-bool BPLUSTREE_TYPE::Insert(const KeyType &key, const ValueType &value, Transaction *transaction) { return false; }
+bool BPLUSTREE_TYPE::Insert(const KeyType &key, const ValueType &value, Transaction *transaction) {
+  EpochGuard guard(&epoch_manager_);
+  // Fast path: find the leaf optimistically and latch only it, as long as it has room for the key.
+  for (;; std::this_thread::yield()) {
+    Page *page;
+    uint64_t version;
+    if (!FindLeafPageOptimistic(key, Edge::NONE, &page, &version)) {
+      continue;
+    }
+    if (page == nullptr) {
+      break;
+    }
+    auto *leaf = reinterpret_cast<LeafPage *>(page->GetData());
+    page->WLatch();
+    if (!leaf->Validate(version)) {
+      page->WUnlatch();
+      buffer_pool_manager_->UnpinPage(page->GetPageId(), false);
+      continue;
+    }
+    ValueType existing_value;
+    bool exists = leaf->Lookup(key, &existing_value, comparator_);
+    bool safe = IsSafe(leaf, Operation::INSERT);
+    if (!exists && safe) {
+      leaf->BeginWrite();
+      leaf->Insert(key, value, comparator_);
+      leaf->EndWrite();
+    }
+    page->WUnlatch();
+    buffer_pool_manager_->UnpinPage(page->GetPageId(), !exists && safe);
+    if (exists || safe) {
+      return !exists;
+    }
+    break;
+  }
+
+  if (transaction == nullptr) {
+    Transaction local_transaction(INVALID_TXN_ID);
+    return InsertIntoLeaf(key, value, &local_transaction);
+  }
+  return InsertIntoLeaf(key, value, transaction);
+}
 /*
  * Insert constant key & value pair into an empty tree
  * User needs to first ask for new page from buffer pool manager(NOTICE: throw
@@ -64,7 +134,20 @@ bool BPLUSTREE_TYPE::Insert(const KeyType &key, const ValueType &value, Transact
  * tree's root page id and insert entry directly into leaf page.
  */
 INDEX_TEMPLATE_ARGUMENTS
-void BPLUSTREE_TYPE::StartNewTree(const KeyType &key, const ValueType &value) {}
+void BPLUSTREE_TYPE::StartNewTree(const KeyType &key, const ValueType &value) {
+  page_id_t page_id;
+  Page *page = buffer_pool_manager_->NewPage(&page_id);
+  if (page == nullptr) {
+    throw Exception(ExceptionType::OUT_OF_MEMORY, "cannot allocate a page for the root");
+  }
+  auto *root = reinterpret_cast<LeafPage *>(page->GetData());
+  root->Init(page_id, INVALID_PAGE_ID, leaf_max_size_);
+  root->Insert(key, value, comparator_);
+  // Readers can reach the root as soon as its id is published, so it is filled in first.
+  root_page_id_ = page_id;
+  UpdateRootPageId(1);
+  buffer_pool_manager_->UnpinPage(page_id, true);
+}
 
 /*
  * Insert constant key & value pair into leaf page
@@ -76,7 +159,29 @@ void BPLUSTREE_TYPE::StartNewTree(const KeyType &key, const ValueType &value) {}
  */
 INDEX_TEMPLATE_ARGUMENTS
 bool BPLUSTREE_TYPE::InsertIntoLeaf(const KeyType &key, const ValueType &value, Transaction *transaction) {
-  return false;
+  root_latch_.lock();
+  transaction->AddIntoPageSet(nullptr);
+  if (IsEmpty()) {
+    StartNewTree(key, value);
+    ReleaseLatchedPages(transaction);
+    return true;
+  }
+
+  Page *page = FindLeafPageForWrite(key, Operation::INSERT, transaction);
+  auto *leaf = reinterpret_cast<LeafPage *>(page->GetData());
+  ValueType existing_value;
+  if (leaf->Lookup(key, &existing_value, comparator_)) {
+    ReleaseLatchedPages(transaction);
+    return false;
+  }
+  leaf->BeginWrite();
+  leaf->Insert(key, value, comparator_);
+  if (leaf->GetSize() >= leaf->GetMaxSize()) {
+    LeafPage *new_leaf = Split(leaf, transaction);
+    InsertIntoParent(leaf, new_leaf->KeyAt(0), new_leaf, transaction);
+  }
+  ReleaseLatchedPages(transaction);
+  return true;
 }
 
 /*
@@ -85,11 +190,34 @@ bool BPLUSTREE_TYPE::InsertIntoLeaf(const KeyType &key, const ValueType &value,
  * User needs to first ask for new page from buffer pool manager(NOTICE: throw
  * an "out of memory" exception if returned value is nullptr), then move half
  * of key & value pairs from input page to newly created page
+ * The new page is write-latched and added to the transaction's page set, to be released with the rest.
  */
 INDEX_TEMPLATE_ARGUMENTS
 template <typename N>
-N *BPLUSTREE_TYPE::Split(N *node) {
-  return nullptr;
+N *BPLUSTREE_TYPE::Split(N *node, Transaction *transaction) {
+  page_id_t page_id;
+  Page *page = buffer_pool_manager_->NewPage(&page_id);
+  if (page == nullptr) {
+    throw Exception(ExceptionType::OUT_OF_MEMORY, "cannot allocate a page to split into");
+  }
+  page->WLatch();
+  transaction->AddIntoPageSet(page);
+  auto *new_node = reinterpret_cast<N *>(page->GetData());
+  new_node->BeginWrite();
+  if constexpr (std::is_same_v<N, LeafPage>) {
+    new_node->Init(page_id, node->GetParentPageId(), leaf_max_size_);
+    node->MoveHalfTo(new_node);
+    new_node->SetNextPageId(node->GetNextPageId());
+    new_node->SetPrevPageId(node->GetPageId());
+    if (node->GetNextPageId() != INVALID_PAGE_ID) {
+      SetPrevLeaf(node->GetNextPageId(), page_id);
+    }
+    node->SetNextPageId(page_id);
+  } else {
+    new_node->Init(page_id, node->GetParentPageId(), internal_max_size_);
+    node->MoveHalfTo(new_node, buffer_pool_manager_);
+  }
+  return new_node;
 }
 
 /*
@@ -103,7 +231,238 @@ N *BPLUSTREE_TYPE::Split(N *node) {
  */
 INDEX_TEMPLATE_ARGUMENTS
 void BPLUSTREE_TYPE::InsertIntoParent(BPlusTreePage *old_node, const KeyType &key, BPlusTreePage *new_node,
-                                      Transaction *transaction) {}
+                                      Transaction *transaction) {
+  if (old_node->IsRootPage()) {
+    page_id_t root_page_id;
+    Page *page = buffer_pool_manager_->NewPage(&root_page_id);
+    if (page == nullptr) {
+      throw Exception(ExceptionType::OUT_OF_MEMORY, "cannot allocate a page for the new root");
+    }
+    auto *root = reinterpret_cast<InternalPage *>(page->GetData());
+    root->Init(root_page_id, INVALID_PAGE_ID, internal_max_size_);
+    root->PopulateNewRoot(old_node->GetPageId(), key, new_node->GetPageId());
+    old_node->SetParentPageId(root_page_id);
+    new_node->SetParentPageId(root_page_id);
+    root_page_id_ = root_page_id;
+    UpdateRootPageId();
+    buffer_pool_manager_->UnpinPage(root_page_id, true);
+    return;
+  }
+
+  Page *parent_page = FindLatchedPage(old_node->GetParentPageId(), transaction);
+  auto *parent = reinterpret_cast<InternalPage *>(parent_page->GetData());
+  parent->BeginWrite();
+  parent->InsertNodeAfter(old_node->GetPageId(), key, new_node->GetPageId());
+  if (parent->GetSize() <= parent->GetMaxSize()) {
+    return;
+  }
+  // Splitting the parent re-parents children under their latches, so the pages below it are released first. The
+  // parent is already being written, so readers cannot get past it to them.
+  ReleaseLatchedPagesAfter(parent_page, transaction);
+  InternalPage *new_parent = Split(parent, transaction);
+  InsertIntoParent(parent, new_parent->KeyAt(0), new_parent, transaction);
+}
+
+/*****************************************************************************
+ * BULK LOAD
+ *****************************************************************************/
+/*
+ * Build this tree from the key & value pairs next produces, in ascending key
+ * order, until it returns false.
+ * Pages are filled left to right to fill_factor of their capacity, and each
+ * level is built from the pages completed below it, so that every page is
+ * written once rather than split over and over. Only the last two pages of a
+ * level are rebalanced at the end, so that none is left under its minimum
+ * size. As with Insert, a key equal to the one before it is skipped.
+ * The tree is only published once it is complete. Input out of order throws,
+ * leaving the tree empty and the pages built so far unreferenced.
+ * @return: false if the tree is not empty, otherwise true.
+ */
+INDEX_TEMPLATE_ARGUMENTS
+bool BPLUSTREE_TYPE::BulkLoad(const std::function<bool(KeyType *, ValueType *)> &next, double fill_factor) {
+  std::lock_guard<std::mutex> guard(root_latch_);
+  if (!IsEmpty()) {
+    return false;
+  }
+
+  std::vector<BulkLoadLevel> levels(1);
+  KeyType key;
+  ValueType value;
+  KeyType last_key;
+  bool first = true;
+  while (next(&key, &value)) {
+    if (!first) {
+      int order = comparator_(last_key, key);
+      if (order == 0) {
+        continue;
+      }
+      if (order > 0) {
+        BulkLoadAbort(&levels);
+        throw Exception(ExceptionType::INVALID, "bulk load input is not in ascending key order");
+      }
+    }
+    first = false;
+    last_key = key;
+
+    auto *leaf = levels[0].cur_ == nullptr ? nullptr : reinterpret_cast<LeafPage *>(levels[0].cur_->GetData());
+    if (leaf == nullptr || leaf->GetSize() >= BulkLoadFill(leaf, fill_factor)) {
+      BulkLoadNewPage(&levels, 0, fill_factor);
+      leaf = reinterpret_cast<LeafPage *>(levels[0].cur_->GetData());
+    }
+    leaf->Insert(key, value, comparator_);
+  }
+  if (first) {
+    return true;
+  }
+
+  // Complete the levels bottom-up. The first level left with a single page holds the root.
+  Page *root_page = nullptr;
+  for (size_t level = 0; root_page == nullptr; level++) {
+    Page *prev_page = levels[level].prev_;
+    Page *cur_page = levels[level].cur_;
+    if (prev_page == nullptr) {
+      root_page = cur_page;
+      break;
+    }
+    auto *prev = reinterpret_cast<BPlusTreePage *>(prev_page->GetData());
+    auto *cur = reinterpret_cast<BPlusTreePage *>(cur_page->GetData());
+    bool merged = false;
+    if (cur->GetSize() < cur->GetMinSize()) {
+      int capacity = cur->IsLeafPage() ? cur->GetMaxSize() - 1 : cur->GetMaxSize();
+      merged = prev->GetSize() + cur->GetSize() <= capacity;
+      if (cur->IsLeafPage()) {
+        auto *prev_leaf = reinterpret_cast<LeafPage *>(prev);
+        auto *cur_leaf = reinterpret_cast<LeafPage *>(cur);
+        if (merged) {
+          cur_leaf->MoveAllTo(prev_leaf);
+        }
+        while (!merged && cur_leaf->GetSize() < cur_leaf->GetMinSize()) {
+          prev_leaf->MoveLastToFrontOf(cur_leaf);
+        }
+      } else {
+        auto *prev_internal = reinterpret_cast<InternalPage *>(prev);
+        auto *cur_internal = reinterpret_cast<InternalPage *>(cur);
+        if (merged) {
+          cur_internal->MoveAllTo(prev_internal, cur_internal->KeyAt(0), buffer_pool_manager_);
+        }
+        while (!merged && cur_internal->GetSize() < cur_internal->GetMinSize()) {
+          prev_internal->MoveLastToFrontOf(cur_internal, cur_internal->KeyAt(0), buffer_pool_manager_);
+        }
+      }
+    }
+    if (merged) {
+      levels[level].cur_ = nullptr;
+      buffer_pool_manager_->UnpinPage(cur_page->GetPageId(), false);
+      buffer_pool_manager_->DeletePage(cur_page->GetPageId());
+      if (levels.size() == level + 1) {
+        // The two pages were all there was to the level, so the merged one is the root.
+        root_page = prev_page;
+        break;
+      }
+    }
+    // Each page leaves its level once appended, so that an abort unpins it only while it is pinned.
+    BulkLoadAppend(&levels, level + 1, prev_page, fill_factor);
+    levels[level].prev_ = nullptr;
+    if (!merged) {
+      BulkLoadAppend(&levels, level + 1, cur_page, fill_factor);
+      levels[level].cur_ = nullptr;
+    }
+  }
+
+  // Readers can reach the root as soon as its id is published, so the tree is complete first.
+  root_page_id_ = root_page->GetPageId();
+  UpdateRootPageId(1);
+  buffer_pool_manager_->UnpinPage(root_page->GetPageId(), true);
+  return true;
+}
+
+/*
+ * Start a new page at the given level of a bulk load, after the level's current
+ * page. The page before the current one is complete by then, and moves up into
+ * the level above first, so that every pinned page is held by a level if no
+ * page can be allocated.
+ */
+INDEX_TEMPLATE_ARGUMENTS
+void BPLUSTREE_TYPE::BulkLoadNewPage(std::vector<BulkLoadLevel> *levels, size_t level, double fill_factor) {
+  if ((*levels)[level].prev_ != nullptr) {
+    BulkLoadAppend(levels, level + 1, (*levels)[level].prev_, fill_factor);
+    (*levels)[level].prev_ = nullptr;
+  }
+  page_id_t page_id;
+  Page *page = buffer_pool_manager_->NewPage(&page_id);
+  if (page == nullptr) {
+    BulkLoadAbort(levels);
+    throw Exception(ExceptionType::OUT_OF_MEMORY, "cannot allocate a page to bulk load into");
+  }
+  if (level == 0) {
+    reinterpret_cast<LeafPage *>(page->GetData())->Init(page_id, INVALID_PAGE_ID, leaf_max_size_);
+  } else {
+    reinterpret_cast<InternalPage *>(page->GetData())->Init(page_id, INVALID_PAGE_ID, internal_max_size_);
+  }
+
+  Page *cur_page = (*levels)[level].cur_;
+  if (cur_page != nullptr) {
+    if (level == 0) {
+      reinterpret_cast<LeafPage *>(cur_page->GetData())->SetNextPageId(page_id);
+      reinterpret_cast<LeafPage *>(page->GetData())->SetPrevPageId(cur_page->GetPageId());
+    }
+    (*levels)[level].prev_ = cur_page;
+  }
+  (*levels)[level].cur_ = page;
+}
+
+/*
+ * Add a complete child page to the given level of a bulk load, and unpin it.
+ * Each internal page keeps the smallest key below it as its first key, to be
+ * added to its own parent in turn.
+ */
+INDEX_TEMPLATE_ARGUMENTS
+void BPLUSTREE_TYPE::BulkLoadAppend(std::vector<BulkLoadLevel> *levels, size_t level, Page *child_page,
+                                    double fill_factor) {
+  if (levels->size() == level) {
+    levels->emplace_back();
+  }
+  Page *parent_page = (*levels)[level].cur_;
+  auto *parent = parent_page == nullptr ? nullptr : reinterpret_cast<InternalPage *>(parent_page->GetData());
+  if (parent == nullptr || parent->GetSize() >= BulkLoadFill(parent, fill_factor)) {
+    BulkLoadNewPage(levels, level, fill_factor);
+    parent = reinterpret_cast<InternalPage *>((*levels)[level].cur_->GetData());
+  }
+
+  auto *child = reinterpret_cast<BPlusTreePage *>(child_page->GetData());
+  KeyType key = child->IsLeafPage() ? reinterpret_cast<LeafPage *>(child)->KeyAt(0)
+                                    : reinterpret_cast<InternalPage *>(child)->KeyAt(0);
+  parent->Append(key, child->GetPageId());
+  child->SetParentPageId(parent->GetPageId());
+  buffer_pool_manager_->UnpinPage(child->GetPageId(), true);
+}
+
+/*
+ * Unpin the pages still held by the levels of a bulk load that is given up on.
+ * The pages built so far are left unreferenced.
+ */
+INDEX_TEMPLATE_ARGUMENTS
+void BPLUSTREE_TYPE::BulkLoadAbort(std::vector<BulkLoadLevel> *levels) {
+  for (auto &level : *levels) {
+    for (Page *page : {level.prev_, level.cur_}) {
+      if (page != nullptr) {
+        buffer_pool_manager_->UnpinPage(page->GetPageId(), false);
+      }
+    }
+    level = BulkLoadLevel();
+  }
+}
+
+/*
+ * The number of entries a bulk load puts in a page: fill_factor of what the
+ * page holds without splitting, but never under its minimum size.
+ */
+INDEX_TEMPLATE_ARGUMENTS
+int BPLUSTREE_TYPE::BulkLoadFill(BPlusTreePage *page, double fill_factor) const {
+  int capacity = page->IsLeafPage() ? page->GetMaxSize() - 1 : page->GetMaxSize();
+  auto fill = static_cast<int>(std::lround(fill_factor * capacity));
+  return std::clamp(fill, std::max(page->GetMinSize(), page->IsLeafPage() ? 1 : 2), capacity);
+}
 
 /*****************************************************************************
  * REMOVE
@@ -116,7 +475,78 @@ void BPLUSTREE_TYPE::InsertIntoParent(BPlusTreePage *old_node, const KeyType &ke
  * necessary.
  */
 INDEX_TEMPLATE_ARGUMENTS
-void BPLUSTREE_TYPE::Remove(const KeyType &key, Transaction *transaction) {}
+void BPLUSTREE_TYPE::Remove(const KeyType &key, Transaction *transaction) {
+  EpochGuard guard(&epoch_manager_);
+  // Fast path: find the leaf optimistically and latch only it, as long as it stays at least half full.
+  for (;; std::this_thread::yield()) {
+    Page *page;
+    uint64_t version;
+    if (!FindLeafPageOptimistic(key, Edge::NONE, &page, &version)) {
+      continue;
+    }
+    if (page == nullptr) {
+      return;
+    }
+    auto *leaf = reinterpret_cast<LeafPage *>(page->GetData());
+    page->WLatch();
+    if (!leaf->Validate(version)) {
+      page->WUnlatch();
+      buffer_pool_manager_->UnpinPage(page->GetPageId(), false);
+      continue;
+    }
+    ValueType existing_value;
+    bool exists = leaf->Lookup(key, &existing_value, comparator_);
+    bool safe = IsSafe(leaf, Operation::REMOVE);
+    if (exists && safe) {
+      leaf->BeginWrite();
+      leaf->RemoveAndDeleteRecord(key, comparator_);
+      leaf->EndWrite();
+    }
+    page->WUnlatch();
+    buffer_pool_manager_->UnpinPage(page->GetPageId(), exists && safe);
+    if (!exists || safe) {
+      return;
+    }
+    break;
+  }
+
+  if (transaction == nullptr) {
+    Transaction local_transaction(INVALID_TXN_ID);
+    RemoveFromLeaf(key, &local_transaction);
+    return;
+  }
+  RemoveFromLeaf(key, transaction);
+}
+
+/*
+ * Delete key & value pair from its leaf page with latch crabbing, merging or
+ * redistributing pages that underflow. The pages that merges leave in the
+ * transaction's deleted page set are retired once they are released.
+ */
+INDEX_TEMPLATE_ARGUMENTS
+void BPLUSTREE_TYPE::RemoveFromLeaf(const KeyType &key, Transaction *transaction) {
+  root_latch_.lock();
+  transaction->AddIntoPageSet(nullptr);
+  if (IsEmpty()) {
+    ReleaseLatchedPages(transaction);
+    return;
+  }
+
+  Page *page = FindLeafPageForWrite(key, Operation::REMOVE, transaction);
+  auto *leaf = reinterpret_cast<LeafPage *>(page->GetData());
+  ValueType existing_value;
+  if (leaf->Lookup(key, &existing_value, comparator_)) {
+    leaf->BeginWrite();
+    leaf->RemoveAndDeleteRecord(key, comparator_);
+    CoalesceOrRedistribute(leaf, transaction);
+  }
+  ReleaseLatchedPages(transaction);
+  auto deleted_pages = transaction->GetDeletedPageSet();
+  for (page_id_t page_id : *deleted_pages) {
+    epoch_manager_.Retire(page_id);
+  }
+  deleted_pages->clear();
+}
 
 /*
  * User needs to first find the sibling of input page. If sibling's size + input
@@ -128,6 +558,36 @@ void BPLUSTREE_TYPE::Remove(const KeyType &key, Transaction *transaction) {}
 INDEX_TEMPLATE_ARGUMENTS
 template <typename N>
 bool BPLUSTREE_TYPE::CoalesceOrRedistribute(N *node, Transaction *transaction) {
+  // Merging, redistributing and adjusting the root re-parent children under their latches, so the pages below node
+  // are released first. node is already being written, so readers cannot get past it to them.
+  ReleaseLatchedPagesAfter(FindLatchedPage(node->GetPageId(), transaction), transaction);
+  if (node->IsRootPage()) {
+    bool root_deleted = AdjustRoot(node);
+    if (root_deleted) {
+      transaction->AddIntoDeletedPageSet(node->GetPageId());
+    }
+    return root_deleted;
+  }
+  if (node->GetSize() >= node->GetMinSize()) {
+    return false;
+  }
+
+  auto *parent = reinterpret_cast<InternalPage *>(
+      FindLatchedPage(node->GetParentPageId(), transaction)->GetData());
+  int index = parent->ValueIndex(node->GetPageId());
+  Page *sibling_page = FetchTreePage(parent->ValueAt(index == 0 ? 1 : index - 1));
+  sibling_page->WLatch();
+  transaction->AddIntoPageSet(sibling_page);
+  auto *sibling = reinterpret_cast<N *>(sibling_page->GetData());
+  sibling->BeginWrite();
+  parent->BeginWrite();
+
+  // A leaf splits once it is full, while an internal page only splits once it overflows.
+  int merged_size = sibling->GetSize() + node->GetSize();
+  if (node->IsLeafPage() ? merged_size < node->GetMaxSize() : merged_size <= node->GetMaxSize()) {
+    return Coalesce(&sibling, &node, &parent, index, transaction);
+  }
+  Redistribute(sibling, node, parent, index);
   return false;
 }
 
@@ -148,7 +608,25 @@ template <typename N>
 bool BPLUSTREE_TYPE::Coalesce(N **neighbor_node, N **node,
                               BPlusTreeInternalPage<KeyType, page_id_t, KeyComparator> **parent, int index,
                               Transaction *transaction) {
-  return false;
+  // The right page is always merged into the left one, so a page leaves the leaf chain only by changing the pages
+  // that link to it.
+  if (index == 0) {
+    std::swap(*neighbor_node, *node);
+    index = 1;
+  }
+  if constexpr (std::is_same_v<N, LeafPage>) {
+    (*node)->MoveAllTo(*neighbor_node);
+    if ((*neighbor_node)->GetNextPageId() != INVALID_PAGE_ID) {
+      SetPrevLeaf((*neighbor_node)->GetNextPageId(), (*neighbor_node)->GetPageId());
+    }
+  } else {
+    (*node)->MoveAllTo(*neighbor_node, (*parent)->KeyAt(index), buffer_pool_manager_);
+  }
+  (*parent)->Remove(index);
+  // Readers that already got to the page restart once they validate it, and it is deleted after the last of them.
+  (*node)->MarkObsolete();
+  transaction->AddIntoDeletedPageSet((*node)->GetPageId());
+  return CoalesceOrRedistribute(*parent, transaction);
 }
 
 /*
@@ -159,10 +637,27 @@ bool BPLUSTREE_TYPE::Coalesce(N **neighbor_node, N **node,
  * Using template N to represent either internal page or leaf page.
  * @param   neighbor_node      sibling page of input "node"
  * @param   node               input from method coalesceOrRedistribute()
+ * @param   parent             parent page of both, whose separating key is updated
  */
 INDEX_TEMPLATE_ARGUMENTS
 template <typename N>
-void BPLUSTREE_TYPE::Redistribute(N *neighbor_node, N *node, int index) {}
+void BPLUSTREE_TYPE::Redistribute(N *neighbor_node, N *node, InternalPage *parent, int index) {
+  if (index == 0) {
+    if constexpr (std::is_same_v<N, LeafPage>) {
+      neighbor_node->MoveFirstToEndOf(node);
+    } else {
+      neighbor_node->MoveFirstToEndOf(node, parent->KeyAt(1), buffer_pool_manager_);
+    }
+    parent->SetKeyAt(1, neighbor_node->KeyAt(0));
+  } else {
+    if constexpr (std::is_same_v<N, LeafPage>) {
+      neighbor_node->MoveLastToFrontOf(node);
+    } else {
+      neighbor_node->MoveLastToFrontOf(node, parent->KeyAt(index), buffer_pool_manager_);
+    }
+    parent->SetKeyAt(index, node->KeyAt(0));
+  }
+}
 /*
  * Update root page if necessary
  * NOTE: size of root page can be less than min size and this method is only
@@ -174,7 +669,31 @@ void BPLUSTREE_TYPE::Redistribute(N *neighbor_node, N *node, int index) {}
  * happend
  */
 INDEX_TEMPLATE_ARGUMENTS
-bool BPLUSTREE_TYPE::AdjustRoot(BPlusTreePage *old_root_node) { return false; }
+bool BPLUSTREE_TYPE::AdjustRoot(BPlusTreePage *old_root_node) {
+  if (old_root_node->IsLeafPage()) {
+    if (old_root_node->GetSize() > 0) {
+      return false;
+    }
+    root_page_id_ = INVALID_PAGE_ID;
+  } else {
+    if (old_root_node->GetSize() > 1) {
+      return false;
+    }
+    page_id_t child_page_id = reinterpret_cast<InternalPage *>(old_root_node)->RemoveAndReturnOnlyChild();
+    Page *child_page = FetchTreePage(child_page_id);
+    auto *child = reinterpret_cast<BPlusTreePage *>(child_page->GetData());
+    child_page->WLatch();
+    child->BeginWrite();
+    child->SetParentPageId(INVALID_PAGE_ID);
+    child->EndWrite();
+    child_page->WUnlatch();
+    buffer_pool_manager_->UnpinPage(child_page_id, true);
+    root_page_id_ = child_page_id;
+  }
+  UpdateRootPageId();
+  old_root_node->MarkObsolete();
+  return true;
+}
 
 /*****************************************************************************
  * INDEX ITERATOR
@@ -185,7 +704,13 @@ bool BPLUSTREE_TYPE::AdjustRoot(BPlusTreePage *old_root_node) { return false; }
  * @return : index iterator
  */
 INDEX_TEMPLATE_ARGUMENTS
-INDEXITERATOR_TYPE BPLUSTREE_TYPE::Begin() { return INDEXITERATOR_TYPE(); }
+INDEXITERATOR_TYPE BPLUSTREE_TYPE::Begin() {
+  EpochGuard guard(&epoch_manager_);
+  INDEXITERATOR_TYPE iterator(this);
+  SeekLeaf(&iterator, nullptr, false);
+  iterator.epoch_ = guard.GetEpoch();
+  return iterator;
+}
 
 /*
  * Input parameter is low key, find the leaf page that contains the input key
@@ -193,7 +718,41 @@ INDEXITERATOR_TYPE BPLUSTREE_TYPE::Begin() { return INDEXITERATOR_TYPE(); }
  * @return : index iterator
  */
 INDEX_TEMPLATE_ARGUMENTS
-INDEXITERATOR_TYPE BPLUSTREE_TYPE::Begin(const KeyType &key) { return INDEXITERATOR_TYPE(); }
+INDEXITERATOR_TYPE BPLUSTREE_TYPE::Begin(const KeyType &key) {
+  EpochGuard guard(&epoch_manager_);
+  INDEXITERATOR_TYPE iterator(this);
+  SeekLeaf(&iterator, &key, false);
+  iterator.epoch_ = guard.GetEpoch();
+  return iterator;
+}
+
+/*
+ * Input parameter is void, find the right most leaf page first, then construct
+ * index iterator at the last entry of the tree, to be moved with operator--
+ * @return : index iterator
+ */
+INDEX_TEMPLATE_ARGUMENTS
+INDEXITERATOR_TYPE BPLUSTREE_TYPE::RBegin() {
+  EpochGuard guard(&epoch_manager_);
+  INDEXITERATOR_TYPE iterator(this);
+  SeekLeafReverse(&iterator, nullptr, false);
+  iterator.epoch_ = guard.GetEpoch();
+  return iterator;
+}
+
+/*
+ * Input parameter is high key, construct index iterator at the last entry
+ * whose key is not greater than it, to be moved with operator--
+ * @return : index iterator
+ */
+INDEX_TEMPLATE_ARGUMENTS
+INDEXITERATOR_TYPE BPLUSTREE_TYPE::RBegin(const KeyType &key) {
+  EpochGuard guard(&epoch_manager_);
+  INDEXITERATOR_TYPE iterator(this);
+  SeekLeafReverse(&iterator, &key, false);
+  iterator.epoch_ = guard.GetEpoch();
+  return iterator;
+}
 
 /*
  * Input parameter is void, construct an index iterator representing the end
@@ -203,16 +762,424 @@ INDEXITERATOR_TYPE BPLUSTREE_TYPE::Begin(const KeyType &key) { return INDEXITERA
 INDEX_TEMPLATE_ARGUMENTS
 INDEXITERATOR_TYPE BPLUSTREE_TYPE::End() { return INDEXITERATOR_TYPE(); }
 
+/*
+ * Position iterator at the first entry after key (exclusive) or from key on, or
+ * at the first entry of the tree if key is nullptr
+ */
+INDEX_TEMPLATE_ARGUMENTS
+void BPLUSTREE_TYPE::SeekLeaf(INDEXITERATOR_TYPE *iterator, const KeyType *key, bool exclusive) {
+  for (;; std::this_thread::yield()) {
+    if (!ReadLeaf(iterator, key, Edge::LEFT)) {
+      continue;
+    }
+    if (iterator->IsEnd()) {
+      return;
+    }
+    auto &items = iterator->items_;
+    iterator->index_ = 0;
+    if (key != nullptr) {
+      auto position = std::partition_point(items.begin(), items.end(), [&](const MappingType &item) {
+        int cmp = comparator_(item.first, *key);
+        return exclusive ? cmp <= 0 : cmp < 0;
+      });
+      iterator->index_ = static_cast<int>(position - items.begin());
+    }
+    if (iterator->index_ < static_cast<int>(items.size())) {
+      return;
+    }
+    if (iterator->next_page_id_ == INVALID_PAGE_ID) {
+      iterator->SetEnd();
+      return;
+    }
+    // Every key in this leaf is before key, so the position is the start of the next leaf.
+    if (ReadAdjacentLeaf(iterator, true)) {
+      return;
+    }
+  }
+}
+
+/*
+ * Position iterator at the last entry before key (exclusive) or up to key, or
+ * at the last entry of the tree if key is nullptr
+ */
+INDEX_TEMPLATE_ARGUMENTS
+void BPLUSTREE_TYPE::SeekLeafReverse(INDEXITERATOR_TYPE *iterator, const KeyType *key, bool exclusive) {
+  for (;; std::this_thread::yield()) {
+    if (!ReadLeaf(iterator, key, Edge::RIGHT)) {
+      continue;
+    }
+    if (iterator->IsEnd()) {
+      return;
+    }
+    auto &items = iterator->items_;
+    iterator->index_ = static_cast<int>(items.size()) - 1;
+    if (key != nullptr) {
+      auto position = std::partition_point(items.begin(), items.end(), [&](const MappingType &item) {
+        int cmp = comparator_(item.first, *key);
+        return exclusive ? cmp < 0 : cmp <= 0;
+      });
+      iterator->index_ = static_cast<int>(position - items.begin()) - 1;
+    }
+    if (iterator->index_ >= 0) {
+      return;
+    }
+    if (iterator->prev_page_id_ == INVALID_PAGE_ID) {
+      iterator->SetEnd();
+      return;
+    }
+    // Every key in this leaf is after key, so the position is the end of the previous leaf.
+    if (ReadAdjacentLeaf(iterator, false)) {
+      return;
+    }
+  }
+}
+
+/*
+ * Copy the leaf covering key into iterator, or the leaf at edge if key is
+ * nullptr, leaving the position in it to the caller; an empty tree makes
+ * iterator the end iterator
+ * @return : false if a writer got in the way and the caller should restart
+ */
+INDEX_TEMPLATE_ARGUMENTS
+bool BPLUSTREE_TYPE::ReadLeaf(INDEXITERATOR_TYPE *iterator, const KeyType *key, Edge edge) {
+  Page *page;
+  uint64_t version;
+  if (!FindLeafPageOptimistic(key != nullptr ? *key : KeyType{}, key != nullptr ? Edge::NONE : edge, &page,
+                              &version)) {
+    return false;
+  }
+  if (page == nullptr) {
+    iterator->SetEnd();
+    return true;
+  }
+  auto *leaf = reinterpret_cast<LeafPage *>(page->GetData());
+  page_id_t page_id = page->GetPageId();
+  page_id_t next_page_id = leaf->GetNextPageId();
+  page_id_t prev_page_id = leaf->GetPrevPageId();
+  CopyLeafItems(leaf, &iterator->items_);
+  bool valid = leaf->Validate(version);
+  buffer_pool_manager_->UnpinPage(page_id, false);
+  if (!valid) {
+    return false;
+  }
+
+  iterator->page_id_ = page_id;
+  iterator->version_ = version;
+  iterator->next_page_id_ = next_page_id;
+  iterator->prev_page_id_ = prev_page_id;
+  return true;
+}
+
+/*
+ * Move iterator on to the next leaf once it has gone past the last entry of its
+ * current one, or to the end
+ */
+INDEX_TEMPLATE_ARGUMENTS
+void BPLUSTREE_TYPE::NextLeaf(INDEXITERATOR_TYPE *iterator) {
+  if (iterator->IsEnd() || iterator->index_ < static_cast<int>(iterator->items_.size())) {
+    return;
+  }
+  EpochGuard guard(&epoch_manager_);
+  while (!iterator->IsEnd() && iterator->index_ == static_cast<int>(iterator->items_.size())) {
+    if (iterator->next_page_id_ == INVALID_PAGE_ID || iterator->items_.empty()) {
+      iterator->SetEnd();
+      return;
+    }
+    // The leaves the iterator links to may have been deleted since an earlier epoch, and then it cannot even check
+    // them. If they are there but the leaf behind us changed, it may no longer link to the page we read. Either way,
+    // find the way again from the last key returned.
+    if (epoch_manager_.MayHaveReclaimed(iterator->epoch_) || !ReadAdjacentLeaf(iterator, true)) {
+      KeyType last_key = iterator->items_.back().first;
+      SeekLeaf(iterator, &last_key, true);
+    }
+  }
+  iterator->epoch_ = guard.GetEpoch();
+}
+
+/*
+ * Move iterator back to the previous leaf once it has gone before the first
+ * entry of its current one, or to the end
+ */
+INDEX_TEMPLATE_ARGUMENTS
+void BPLUSTREE_TYPE::PrevLeaf(INDEXITERATOR_TYPE *iterator) {
+  if (iterator->IsEnd() || iterator->index_ >= 0) {
+    return;
+  }
+  EpochGuard guard(&epoch_manager_);
+  while (!iterator->IsEnd() && iterator->index_ < 0) {
+    if (iterator->prev_page_id_ == INVALID_PAGE_ID || iterator->items_.empty()) {
+      iterator->SetEnd();
+      return;
+    }
+    if (epoch_manager_.MayHaveReclaimed(iterator->epoch_) || !ReadAdjacentLeaf(iterator, false)) {
+      KeyType first_key = iterator->items_.front().first;
+      SeekLeafReverse(iterator, &first_key, true);
+    }
+  }
+  iterator->epoch_ = guard.GetEpoch();
+}
+
+/*
+ * Copy the leaf after (forward) or before the iterator's current one into the
+ * iterator, positioned at its first or last entry respectively
+ * @return : false if the copy cannot be trusted, because the leaf read was
+ * being changed or the current one no longer links to it
+ */
+INDEX_TEMPLATE_ARGUMENTS
+bool BPLUSTREE_TYPE::ReadAdjacentLeaf(INDEXITERATOR_TYPE *iterator, bool forward) {
+  page_id_t page_id = forward ? iterator->next_page_id_ : iterator->prev_page_id_;
+  Page *page = FetchTreePage(page_id);
+  auto *leaf = reinterpret_cast<LeafPage *>(page->GetData());
+  uint64_t version = leaf->ReadVersion();
+  page_id_t next_page_id = INVALID_PAGE_ID;
+  page_id_t prev_page_id = INVALID_PAGE_ID;
+  std::vector<MappingType> items;
+  bool valid = false;
+  if (BPlusTreePage::IsStable(version) && leaf->IsLeafPage()) {
+    next_page_id = leaf->GetNextPageId();
+    prev_page_id = leaf->GetPrevPageId();
+    CopyLeafItems(leaf, &items);
+    valid = leaf->Validate(version);
+  }
+  buffer_pool_manager_->UnpinPage(page_id, false);
+  if (!valid) {
+    return false;
+  }
+
+  // A leaf is only deleted or split after the leaves on both sides of it are changed to link past or to the new
+  // page, so if the current leaf is unchanged the copy is of its live neighbour.
+  Page *current_page = FetchTreePage(iterator->page_id_);
+  bool linked = reinterpret_cast<BPlusTreePage *>(current_page->GetData())->Validate(iterator->version_);
+  buffer_pool_manager_->UnpinPage(iterator->page_id_, false);
+  if (!linked) {
+    return false;
+  }
+
+  iterator->page_id_ = page_id;
+  iterator->version_ = version;
+  iterator->next_page_id_ = next_page_id;
+  iterator->prev_page_id_ = prev_page_id;
+  iterator->items_.swap(items);
+  iterator->index_ = forward ? 0 : static_cast<int>(iterator->items_.size()) - 1;
+  return true;
+}
+
+/*
+ * Copy the entries of a leaf that is read optimistically
+ * The copy is only used once the read is validated, but the size is bounded
+ * regardless so that a torn read stays within the page.
+ */
+INDEX_TEMPLATE_ARGUMENTS
+void BPLUSTREE_TYPE::CopyLeafItems(LeafPage *leaf, std::vector<MappingType> *items) const {
+  int size = std::clamp(leaf->GetSize(), 0, static_cast<int>(LEAF_PAGE_SIZE));
+  items->clear();
+  for (int i = 0; i < size; i++) {
+    items->push_back(leaf->GetItem(i));
+  }
+}
+
 /*****************************************************************************
  * UTILITIES AND DEBUG
  *****************************************************************************/
 /*
  * Find leaf page containing particular key, if leftMost flag == true, find
  * the left most leaf page
+ * @return : the leaf page pinned (the caller unpins it), or nullptr if the
+ * tree is empty
  */
 INDEX_TEMPLATE_ARGUMENTS
 Page *BPLUSTREE_TYPE::FindLeafPage(const KeyType &key, bool leftMost) {
-  throw Exception(ExceptionType::NOT_IMPLEMENTED, "Implement this for test");
+  EpochGuard guard(&epoch_manager_);
+  for (;; std::this_thread::yield()) {
+    Page *page;
+    uint64_t version;
+    if (FindLeafPageOptimistic(key, leftMost ? Edge::LEFT : Edge::NONE, &page, &version)) {
+      return page;
+    }
+  }
+}
+
+/*
+ * Descend to the leaf covering key (or the left or right most leaf, as edge
+ * says) without latching
+ * Each page's version is read on arrival and validated before its child pointer
+ * is followed. The parent is validated again once the child is pinned, so the
+ * child cannot have been merged away and deleted in between.
+ * @return : false if a writer got in the way and the caller should restart;
+ * otherwise leaf_page is the pinned leaf (nullptr if the tree is empty) and
+ * version the version that reads of it must be validated against
+ */
+INDEX_TEMPLATE_ARGUMENTS
+bool BPLUSTREE_TYPE::FindLeafPageOptimistic(const KeyType &key, Edge edge, Page **leaf_page, uint64_t *version) {
+  page_id_t page_id = root_page_id_;
+  if (page_id == INVALID_PAGE_ID) {
+    *leaf_page = nullptr;
+    return true;
+  }
+  Page *page = FetchTreePage(page_id);
+  auto *node = reinterpret_cast<BPlusTreePage *>(page->GetData());
+  uint64_t node_version = node->ReadVersion();
+  // The root is replaced only while it is being written, so it is still the root if it was after reading its version.
+  if (!BPlusTreePage::IsStable(node_version) || root_page_id_ != page_id) {
+    buffer_pool_manager_->UnpinPage(page_id, false);
+    return false;
+  }
+
+  while (!node->IsLeafPage()) {
+    auto *internal = reinterpret_cast<InternalPage *>(node);
+    page_id_t child_page_id;
+    if (edge == Edge::LEFT) {
+      child_page_id = internal->ValueAt(0);
+    } else if (edge == Edge::RIGHT) {
+      // The size may be torn until the version is validated below.
+      int last = std::clamp(internal->GetSize() - 1, 0, static_cast<int>(INTERNAL_PAGE_SIZE) - 1);
+      child_page_id = internal->ValueAt(last);
+    } else {
+      child_page_id = internal->Lookup(key, comparator_);
+    }
+    if (!node->Validate(node_version)) {
+      buffer_pool_manager_->UnpinPage(page_id, false);
+      return false;
+    }
+    Page *child_page = buffer_pool_manager_->FetchPage(child_page_id);
+    if (child_page == nullptr) {
+      buffer_pool_manager_->UnpinPage(page_id, false);
+      throw Exception(ExceptionType::OUT_OF_MEMORY, "cannot fetch a B+ tree page");
+    }
+    auto *child = reinterpret_cast<BPlusTreePage *>(child_page->GetData());
+    uint64_t child_version = child->ReadVersion();
+    bool valid = BPlusTreePage::IsStable(child_version) && node->Validate(node_version);
+    buffer_pool_manager_->UnpinPage(page_id, false);
+    if (!valid) {
+      buffer_pool_manager_->UnpinPage(child_page_id, false);
+      return false;
+    }
+    page = child_page;
+    page_id = child_page_id;
+    node = child;
+    node_version = child_version;
+  }
+  *leaf_page = page;
+  *version = node_version;
+  return true;
+}
+
+/*
+ * Descend to the leaf covering key with latch crabbing
+ * The caller holds the root latch, recorded as nullptr in the transaction's page
+ * set. Each page is write-latched and added to the page set; whenever a page is
+ * safe, i.e. the operation cannot change its parent, the latches above it are
+ * released.
+ */
+INDEX_TEMPLATE_ARGUMENTS
+Page *BPLUSTREE_TYPE::FindLeafPageForWrite(const KeyType &key, Operation operation, Transaction *transaction) {
+  Page *page = FetchTreePage(root_page_id_);
+  page->WLatch();
+  auto *node = reinterpret_cast<BPlusTreePage *>(page->GetData());
+  while (true) {
+    if (IsSafe(node, operation)) {
+      ReleaseLatchedPages(transaction);
+    }
+    transaction->AddIntoPageSet(page);
+    if (node->IsLeafPage()) {
+      return page;
+    }
+    page = FetchTreePage(reinterpret_cast<InternalPage *>(node)->Lookup(key, comparator_));
+    page->WLatch();
+    node = reinterpret_cast<BPlusTreePage *>(page->GetData());
+  }
+}
+
+/*
+ * @return : true if inserting into or removing from below node cannot split or
+ * underflow node itself
+ */
+INDEX_TEMPLATE_ARGUMENTS
+bool BPLUSTREE_TYPE::IsSafe(BPlusTreePage *node, Operation operation) const {
+  if (operation == Operation::INSERT) {
+    return node->IsLeafPage() ? node->GetSize() + 1 < node->GetMaxSize() : node->GetSize() < node->GetMaxSize();
+  }
+  if (node->IsRootPage()) {
+    return node->GetSize() > (node->IsLeafPage() ? 1 : 2);
+  }
+  return node->GetSize() > node->GetMinSize();
+}
+
+/*
+ * Link the leaf page_id back to prev_page_id, under the leaf's write latch
+ * The writer holds the latch of the leaf before it. Writers latch a leaf left
+ * of one they hold only under the latch of their common parent, so this cannot
+ * deadlock with another writer.
+ */
+INDEX_TEMPLATE_ARGUMENTS
+void BPLUSTREE_TYPE::SetPrevLeaf(page_id_t page_id, page_id_t prev_page_id) {
+  Page *page = FetchTreePage(page_id);
+  page->WLatch();
+  auto *leaf = reinterpret_cast<LeafPage *>(page->GetData());
+  leaf->BeginWrite();
+  leaf->SetPrevPageId(prev_page_id);
+  leaf->EndWrite();
+  page->WUnlatch();
+  buffer_pool_manager_->UnpinPage(page_id, true);
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+Page *BPLUSTREE_TYPE::FetchTreePage(page_id_t page_id) {
+  Page *page = buffer_pool_manager_->FetchPage(page_id);
+  if (page == nullptr) {
+    throw Exception(ExceptionType::OUT_OF_MEMORY, "cannot fetch a B+ tree page");
+  }
+  return page;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+Page *BPLUSTREE_TYPE::FindLatchedPage(page_id_t page_id, Transaction *transaction) const {
+  for (Page *page : *transaction->GetPageSet()) {
+    if (page != nullptr && page->GetPageId() == page_id) {
+      return page;
+    }
+  }
+  throw Exception(ExceptionType::INVALID, "B+ tree page is not latched");
+}
+
+/*
+ * Release a page latched by a writer, publishing its new version if it was
+ * written; nullptr stands for the root latch
+ */
+INDEX_TEMPLATE_ARGUMENTS
+void BPLUSTREE_TYPE::ReleaseLatchedPage(Page *page) {
+  if (page == nullptr) {
+    root_latch_.unlock();
+    return;
+  }
+  auto *node = reinterpret_cast<BPlusTreePage *>(page->GetData());
+  bool is_dirty = node->IsBeingWritten();
+  if (is_dirty) {
+    node->EndWrite();
+  }
+  page->WUnlatch();
+  buffer_pool_manager_->UnpinPage(page->GetPageId(), is_dirty);
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void BPLUSTREE_TYPE::ReleaseLatchedPages(Transaction *transaction) {
+  auto pages = transaction->GetPageSet();
+  while (!pages->empty()) {
+    ReleaseLatchedPage(pages->back());
+    pages->pop_back();
+  }
+}
+
+/*
+ * Release the pages latched after page, i.e. the part of the path below it
+ */
+INDEX_TEMPLATE_ARGUMENTS
+void BPLUSTREE_TYPE::ReleaseLatchedPagesAfter(Page *page, Transaction *transaction) {
+  auto pages = transaction->GetPageSet();
+  while (pages->back() != page) {
+    ReleaseLatchedPage(pages->back());
+    pages->pop_back();
+  }
 }
 
 /*
@@ -226,13 +1193,14 @@ Page *BPLUSTREE_TYPE::FindLeafPage(const KeyType &key, bool leftMost) {
 INDEX_TEMPLATE_ARGUMENTS
 void BPLUSTREE_TYPE::UpdateRootPageId(int insert_record) {
   HeaderPage *header_page = static_cast<HeaderPage *>(buffer_pool_manager_->FetchPage(HEADER_PAGE_ID));
-  if (insert_record != 0) {
-    // create a new record<index_name + root_page_id> in header_page
-    header_page->InsertRecord(index_name_, root_page_id_);
-  } else {
+  // Other trees update the header page concurrently.
+  header_page->WLatch();
+  // A tree that emptied out and grew again still has its record, which is updated instead.
+  if (insert_record == 0 || !header_page->InsertRecord(index_name_, root_page_id_)) {
     // update root_page_id in header_page
     header_page->UpdateRecord(index_name_, root_page_id_);
   }
+  header_page->WUnlatch();
   buffer_pool_manager_->UnpinPage(HEADER_PAGE_ID, true);
 }
 
@@ -372,7 +1340,7 @@ void BPLUSTREE_TYPE::ToString(BPlusTreePage *page, BufferPoolManager *bpm) const
   if (page->IsLeafPage()) {
     LeafPage *leaf = reinterpret_cast<LeafPage *>(page);
     std::cout << "Leaf Page: " << leaf->GetPageId() << " parent: " << leaf->GetParentPageId()
-              << " next: " << leaf->GetNextPageId() << std::endl;
+              << " next: " << leaf->GetNextPageId() << " prev: " << leaf->GetPrevPageId() << std::endl;
     for (int i = 0; i < leaf->GetSize(); i++) {
       std::cout << leaf->KeyAt(i) << ",";
     }
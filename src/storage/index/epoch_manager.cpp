@@ -0,0 +1,72 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// epoch_manager.cpp
+//
+// Identification: src/storage/index/epoch_manager.cpp
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "storage/index/epoch_manager.h"
+
+#include <algorithm>
+
+namespace bustub {
+
+uint64_t EpochManager::Enter() {
+  while (true) {
+    uint64_t epoch = global_epoch_.load();
+    num_active_[epoch % NUM_EPOCHS]++;
+    // The epoch may have moved on before we were counted, and then nothing keeps it from moving past us.
+    if (global_epoch_.load() == epoch) {
+      return epoch;
+    }
+    num_active_[epoch % NUM_EPOCHS]--;
+  }
+}
+
+void EpochManager::Exit(uint64_t epoch) {
+  num_active_[epoch % NUM_EPOCHS]--;
+  if (num_retired_.load() > 0) {
+    Reclaim();
+  }
+}
+
+void EpochManager::Retire(page_id_t page_id) {
+  std::lock_guard<std::mutex> guard(latch_);
+  retired_[global_epoch_.load() % NUM_EPOCHS].push_back(page_id);
+  num_retired_++;
+}
+
+void EpochManager::Reclaim() {
+  std::unique_lock<std::mutex> guard(latch_, std::try_to_lock);
+  // Whoever holds the latch is retiring pages or already reclaiming them.
+  if (!guard.owns_lock()) {
+    return;
+  }
+  // Two steps take the pages retired in the current epoch all the way, if nobody else is running.
+  for (size_t step = 1; step < NUM_EPOCHS && num_retired_.load() > 0; step++) {
+    uint64_t epoch = global_epoch_.load();
+    if (num_active_[(epoch - 1) % NUM_EPOCHS].load() > 0) {
+      return;
+    }
+    global_epoch_.store(epoch + 1);
+
+    // Nobody is running in epoch - 1 or before, and nobody can enter them any more.
+    auto &retired = retired_[(epoch - 1) % NUM_EPOCHS];
+    // A page still pinned, say by the page cleaner, is kept to be deleted with the list's next epoch.
+    auto kept_end = std::remove_if(retired.begin(), retired.end(),
+                               [this](page_id_t page_id) { return buffer_pool_manager_->DeletePage(page_id); });
+    size_t num_deleted = retired.end() - kept_end;
+    retired.erase(kept_end, retired.end());
+    if (num_deleted > 0) {
+      num_retired_ -= num_deleted;
+      reclaimed_epoch_.store(epoch - 1);
+    }
+  }
+}
+
+}  // namespace bustub
@@ -11,29 +11,73 @@
 //===----------------------------------------------------------------------===//
 
 #include "storage/page/hash_table_bucket_page.h"
+
+#ifdef __AVX2__
+#include <immintrin.h>
+#endif
+#include <algorithm>
+#include <cstring>
+
 #include "common/logger.h"
 #include "common/util/hash_util.h"
+#include "murmur3/MurmurHash3.h"
 #include "storage/index/generic_key.h"
 #include "storage/index/hash_comparator.h"
 #include "storage/table/tmp_tuple.h"
 
-#include <algorithm>
-
 namespace bustub {
 
 template <typename KeyType, typename ValueType, typename KeyComparator>
-bool HASH_TABLE_BUCKET_TYPE::GetValue(KeyType key, KeyComparator cmp, std::vector<ValueType> *result) {
-  for (uint32_t i = 0; i < BUCKET_ARRAY_SIZE; i++) {
-    if (!IsReadable(i)) {
-      // 为什么要break，occupied是什么意思？
-      // 每次insert都是顺序插入的，线性探测，插入后必然会把该位的occupied设为1，即使删除该位，该位仍然为1
-      // 用来表明，这个地方之前有值。如果readable该位为0，说明是被remove了。所以如果readable为0，
-      // occupied也是0，说明这里根本没有插入过，后面更不可能插入过数据，也不用再探索后面的数组了
-      if (!IsOccupied(i)) {
-        break;
+uint8_t HASH_TABLE_BUCKET_TYPE::Fingerprint(const KeyType &key) {
+  // the table hashes keys with MurmurHash3_x64_128, so a hash with another seed and variant is independent of it
+  uint32_t hash = murmur3::MurmurHash3_x86_32(reinterpret_cast<const void *>(&key), sizeof(KeyType), 0x5bd1e995);
+  return static_cast<uint8_t>(hash >> 24);
+}
+
+template <typename KeyType, typename ValueType, typename KeyComparator>
+uint32_t HASH_TABLE_BUCKET_TYPE::NextCandidate(uint8_t fingerprint, uint32_t begin) const {
+  uint32_t index = begin;
+#ifdef __AVX2__
+  // Blocks of 32 slots start at a multiple of 32, so their occupied_ and readable_ bits are 4 whole bytes, in the order
+  // of the lanes of a byte compare mask on a little-endian machine.
+  const __m256i target = _mm256_set1_epi8(static_cast<char>(fingerprint));
+  for (uint32_t block = begin & ~31U; block + 32 <= BUCKET_ARRAY_SIZE; block += 32) {
+    __m256i prints = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(fingerprints_ + block));
+    auto matches = static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(prints, target)));
+    uint32_t readable;
+    uint32_t occupied;
+    std::memcpy(&readable, readable_ + block / 8, sizeof(readable));
+    std::memcpy(&occupied, occupied_ + block / 8, sizeof(occupied));
+    matches &= readable;
+    if (block < begin) {
+      matches &= ~0U << (begin - block);
+    }
+    if (matches != 0) {
+      return block + __builtin_ctz(matches);
+    }
+    // slots are occupied in order, so there is nothing past the first one that never was
+    if (occupied != ~0U) {
+      return BUCKET_ARRAY_SIZE;
+    }
+    index = block + 32;
+  }
+#endif
+  for (; index < BUCKET_ARRAY_SIZE; index++) {
+    if (IsReadable(index)) {
+      if (fingerprints_[index] == fingerprint) {
+        return index;
       }
-      continue;
+    } else if (!IsOccupied(index)) {
+      break;
     }
+  }
+  return BUCKET_ARRAY_SIZE;
+}
+
+template <typename KeyType, typename ValueType, typename KeyComparator>
+bool HASH_TABLE_BUCKET_TYPE::GetValue(KeyType key, KeyComparator cmp, std::vector<ValueType> *result) {
+  uint8_t fingerprint = Fingerprint(key);
+  for (uint32_t i = NextCandidate(fingerprint, 0); i < BUCKET_ARRAY_SIZE; i = NextCandidate(fingerprint, i + 1)) {
     if (cmp(key, KeyAt(i)) == 0) {
       result->emplace_back(ValueAt(i));
     }
@@ -46,14 +90,16 @@ bool HASH_TABLE_BUCKET_TYPE::Insert(KeyType key, ValueType value, KeyComparator
   if (IsFull()) {
     return false;
   }
-  std::vector<ValueType> result;
-  GetValue(key, cmp, &result);
-  if (std::find(result.cbegin(), result.cend(), value) != result.cend()) {
-    return false;
+  uint8_t fingerprint = Fingerprint(key);
+  for (uint32_t i = NextCandidate(fingerprint, 0); i < BUCKET_ARRAY_SIZE; i = NextCandidate(fingerprint, i + 1)) {
+    if (cmp(key, KeyAt(i)) == 0 && value == ValueAt(i)) {
+      return false;
+    }
   }
   for (uint32_t i = 0; i < BUCKET_ARRAY_SIZE; i++) {
     if (!IsReadable(i)) {
       array_[i] = MappingType(key, value);
+      fingerprints_[i] = fingerprint;
       SetReadable(i, 1);
       SetOccupied(i, 1);
       break;
@@ -64,18 +110,14 @@ bool HASH_TABLE_BUCKET_TYPE::Insert(KeyType key, ValueType value, KeyComparator
 
 template <typename KeyType, typename ValueType, typename KeyComparator>
 bool HASH_TABLE_BUCKET_TYPE::Remove(KeyType key, ValueType value, KeyComparator cmp) {
-  bool success = false;
-  for (uint32_t i = 0; i < BUCKET_ARRAY_SIZE; i++) {
-    if (!IsReadable(i)) {
-      continue;
-    }
+  uint8_t fingerprint = Fingerprint(key);
+  for (uint32_t i = NextCandidate(fingerprint, 0); i < BUCKET_ARRAY_SIZE; i = NextCandidate(fingerprint, i + 1)) {
     if (cmp(key, KeyAt(i)) == 0 && value == ValueAt(i)) {
       SetReadable(i, 0);
-      success = true;
-      break;
+      return true;
     }
   }
-  return success;
+  return false;
 }
 
 template <typename KeyType, typename ValueType, typename KeyComparator>
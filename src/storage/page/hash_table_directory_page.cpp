@@ -29,7 +29,16 @@ uint32_t HashTableDirectoryPage::GetGlobalDepth() { return global_depth_; }
 
 uint32_t HashTableDirectoryPage::GetGlobalDepthMask() { return Pow(2, global_depth_) - 1; }
 
-void HashTableDirectoryPage::IncrGlobalDepth() { global_depth_++; }
+void HashTableDirectoryPage::IncrGlobalDepth() {
+  assert(global_depth_ < DIRECTORY_MAX_DEPTH);
+  // Each new slot points where its split image does, until one of the buckets they share is split.
+  uint32_t size = Size();
+  for (uint32_t i = 0; i < size; i++) {
+    bucket_page_ids_[size + i] = bucket_page_ids_[i];
+    local_depths_[size + i] = local_depths_[i];
+  }
+  global_depth_++;
+}
 
 void HashTableDirectoryPage::DecrGlobalDepth() { global_depth_--; }
 
@@ -68,7 +77,6 @@ void HashTableDirectoryPage::DecrLocalDepth(uint32_t bucket_idx) {
   local_depths_[bucket_idx] = local_depths_[bucket_idx] - 1;
 }
 
-// TODO 怎么写的 没看懂
 /**
  * Gets the high bit corresponding to the bucket's local depth.
  * This is not the same as the bucket index itself.  This method
@@ -79,20 +87,12 @@ void HashTableDirectoryPage::DecrLocalDepth(uint32_t bucket_idx) {
  */
 uint32_t HashTableDirectoryPage::GetLocalHighBit(uint32_t bucket_idx) {
   auto local_depth = GetLocalDepth(bucket_idx);
-  return ((bucket_idx >> (local_depth - 1)) + 1) << (local_depth - 1);
+  return local_depth == 0 ? 0 : 1U << (local_depth - 1);
 }
 
 uint32_t HashTableDirectoryPage::GetSplitImageIndex(uint32_t bucket_idx) {
-  auto high_bits = GetLocalHighBit(bucket_idx);
-  uint32_t split_image_index = high_bits | (bucket_idx & (Pow(2, GetLocalDepth(bucket_idx) - 1) - 1));
-  return split_image_index & GetLocalDepthMask(bucket_idx);
-
-  // auto which = GetLocalDepth(bucket_idx) - 1;
-  // if (bucket_idx >> which == 1) {
-  //   return bucket_idx & ((1 << which) - 1);
-  // } else {
-  //   return bucket_idx | (1 << which);
-  // }
+  // The split image differs from the bucket in the highest bit that the local depth covers.
+  return (bucket_idx ^ GetLocalHighBit(bucket_idx)) & GetLocalDepthMask(bucket_idx);
 }
 
 /**
@@ -11,6 +11,7 @@
 //===----------------------------------------------------------------------===//
 
 #include <cassert>
+#include <vector>
 
 #include "storage/table/table_heap.h"
 
@@ -43,6 +44,7 @@ TableIterator &TableIterator::operator++() {
   if (!cur_page->GetNextTupleRid(tuple_->rid_,
                                  &next_tuple_rid)) {  // end of this page
     while (cur_page->GetNextPageId() != INVALID_PAGE_ID) {
+      Prefetch(cur_page->GetTablePageId(), cur_page->GetNextPageId());
       auto next_page = static_cast<TablePage *>(buffer_pool_manager->FetchPage(cur_page->GetNextPageId()));
       cur_page->RUnlatch();
       buffer_pool_manager->UnpinPage(cur_page->GetTablePageId(), false);
@@ -64,6 +66,27 @@ TableIterator &TableIterator::operator++() {
   return *this;
 }
 
+void TableIterator::Prefetch(page_id_t page_id, page_id_t next_page_id) {
+  auto window = static_cast<page_id_t>(table_scan_prefetch_window);
+  page_id_t stride = next_page_id - page_id;
+  if (window == 0 || stride <= 0) {
+    return;
+  }
+  // Hint in batches: only top the window up once the scan has consumed half of it.
+  bool on_stride = prefetch_frontier_ > next_page_id && (prefetch_frontier_ - next_page_id) % stride == 0;
+  if (on_stride && (prefetch_frontier_ - next_page_id) / stride > window / 2) {
+    return;
+  }
+  page_id_t first = on_stride ? prefetch_frontier_ : next_page_id + stride;
+  page_id_t last = next_page_id + window * stride;
+  std::vector<page_id_t> page_ids;
+  for (page_id_t prefetch_page_id = first; prefetch_page_id <= last; prefetch_page_id += stride) {
+    page_ids.push_back(prefetch_page_id);
+  }
+  prefetch_frontier_ = last + stride;
+  table_heap_->buffer_pool_manager_->PrefetchPages(page_ids);
+}
+
 TableIterator TableIterator::operator++(int) {
   TableIterator clone(*this);
   ++(*this);
@@ -11,10 +11,17 @@
 //===----------------------------------------------------------------------===//
 
 #include "buffer/buffer_pool_manager_instance.h"
+#include <chrono>  // NOLINT
+#include <cstdint>
 #include <cstdio>
+#include <cstring>
 #include <random>
 #include <string>
+#include <thread>  // NOLINT
+#include <utility>
+#include <vector>
 #include "buffer/buffer_pool_manager.h"
+#include "common/exception.h"
 #include "gtest/gtest.h"
 
 namespace bustub {
@@ -45,9 +52,9 @@ TEST(BufferPoolManagerInstanceTest, BinaryDataTest) {
     i = uniform_dist(rng);
   }
 
-  // Insert terminal characters both in the middle and at end
+  // Insert terminal characters both in the middle and at end, which is just before the page checksum
   random_binary_data[PAGE_SIZE / 2] = '\0';
-  random_binary_data[PAGE_SIZE - 1] = '\0';
+  random_binary_data[PAGE_SIZE - PAGE_CHECKSUM_SIZE - 1] = '\0';
 
   // Scenario: Once we have a page, we should be able to read and write content.
   std::memcpy(page0->GetData(), random_binary_data, PAGE_SIZE);
@@ -74,7 +81,7 @@ TEST(BufferPoolManagerInstanceTest, BinaryDataTest) {
   }
   // Scenario: We should be able to fetch the data we wrote a while ago.
   page0 = bpm->FetchPage(0);
-  EXPECT_EQ(0, memcmp(page0->GetData(), random_binary_data, PAGE_SIZE));
+  EXPECT_EQ(0, memcmp(page0->GetData(), random_binary_data, PAGE_SIZE - PAGE_CHECKSUM_SIZE));
   EXPECT_EQ(true, bpm->UnpinPage(0, true));
 
   // Shutdown the disk manager and remove the temporary file we created.
@@ -141,4 +148,371 @@ TEST(BufferPoolManagerInstanceTest, SampleTest) {
   delete disk_manager;
 }
 
+// NOLINTNEXTLINE
+TEST(BufferPoolManagerInstanceTest, PageCleanerTest) {
+  const std::string db_name = "test.db";
+  const size_t buffer_pool_size = 10;
+  const double saved_dirty_ratio = page_cleaner_dirty_ratio;
+  page_cleaner_dirty_ratio = 0.0;
+
+  auto *disk_manager = new DiskManager(db_name);
+  auto *bpm = new BufferPoolManagerInstance(buffer_pool_size, disk_manager);
+
+  // Scenario: dirty every frame and unpin it. Unpinning no longer writes anything back by itself.
+  page_id_t page_id_temp;
+  for (size_t i = 0; i < buffer_pool_size; ++i) {
+    auto *page = bpm->NewPage(&page_id_temp);
+    ASSERT_NE(nullptr, page);
+    snprintf(page->GetData(), PAGE_SIZE, "page %d", page_id_temp);
+    EXPECT_TRUE(bpm->UnpinPage(page_id_temp, true));
+  }
+
+  // Scenario: with a dirty-ratio mark of zero the cleaner writes back every unpinned dirty frame.
+  for (int i = 0; i < 500 && bpm->GetNumCleanedPages() < buffer_pool_size; i++) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+  }
+  EXPECT_EQ(buffer_pool_size, bpm->GetNumCleanedPages());
+  for (size_t i = 0; i < buffer_pool_size; ++i) {
+    EXPECT_FALSE(bpm->GetPages()[i].IsDirty());
+  }
+
+  // Scenario: evicting the cleaned pages needs no inline write-back, and their contents survived on disk.
+  for (size_t i = 0; i < buffer_pool_size; ++i) {
+    ASSERT_NE(nullptr, bpm->NewPage(&page_id_temp));
+    EXPECT_TRUE(bpm->UnpinPage(page_id_temp, false));
+  }
+  EXPECT_EQ(0, bpm->GetNumInlineWritebacks());
+  auto *page0 = bpm->FetchPage(0);
+  ASSERT_NE(nullptr, page0);
+  EXPECT_EQ(0, strcmp(page0->GetData(), "page 0"));
+  EXPECT_TRUE(bpm->UnpinPage(0, false));
+
+  page_cleaner_dirty_ratio = saved_dirty_ratio;
+  disk_manager->ShutDown();
+  remove("test.db");
+
+  delete bpm;
+  delete disk_manager;
+}
+
+// NOLINTNEXTLINE
+TEST(BufferPoolManagerInstanceTest, PrefetchTest) {
+  const std::string db_name = "test.db";
+  const size_t buffer_pool_size = 10;
+  // Keep the page cleaner out of the way: a frame it pins is passed over by eviction, which would leave other pages
+  // resident than the ones expected below.
+  const double saved_dirty_ratio = page_cleaner_dirty_ratio;
+  page_cleaner_dirty_ratio = 1.0;
+
+  auto *disk_manager = new DiskManager(db_name);
+  auto *bpm = new BufferPoolManagerInstance(buffer_pool_size, disk_manager);
+
+  // Scenario: write twice as many pages as fit, so that pages 0..9 end up on disk only.
+  page_id_t page_id_temp;
+  for (size_t i = 0; i < 2 * buffer_pool_size; ++i) {
+    auto *page = bpm->NewPage(&page_id_temp);
+    ASSERT_NE(nullptr, page);
+    snprintf(page->GetData(), PAGE_SIZE, "page %d", page_id_temp);
+    EXPECT_TRUE(bpm->UnpinPage(page_id_temp, true));
+  }
+  bpm->FlushAllPages();
+
+  // Scenario: prefetch a few evicted pages, one resident page and one page that was never allocated.
+  bpm->PrefetchPages({0, 1, 2, 3, 4, 15, 100});
+  for (int i = 0; i < 500 && bpm->GetNumPrefetchedPages() < 5; i++) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+  }
+  EXPECT_EQ(5, bpm->GetNumPrefetchedPages());
+
+  // Scenario: fetching the prefetched pages needs no disk read, and prefetched frames were left unpinned.
+  int reads = disk_manager->GetNumReads();
+  for (page_id_t page_id = 0; page_id < 5; ++page_id) {
+    auto *page = bpm->FetchPage(page_id);
+    ASSERT_NE(nullptr, page);
+    EXPECT_EQ(1, page->GetPinCount());
+    EXPECT_EQ(0, strcmp(page->GetData(), ("page " + std::to_string(page_id)).c_str()));
+    EXPECT_TRUE(bpm->UnpinPage(page_id, false));
+  }
+  EXPECT_EQ(reads, disk_manager->GetNumReads());
+  for (size_t i = 0; i < buffer_pool_size; ++i) {
+    EXPECT_NE(nullptr, bpm->NewPage(&page_id_temp));
+  }
+
+  page_cleaner_dirty_ratio = saved_dirty_ratio;
+  disk_manager->ShutDown();
+  remove("test.db");
+
+  delete bpm;
+  delete disk_manager;
+}
+
+// NOLINTNEXTLINE
+TEST(BufferPoolManagerInstanceTest, PrefetchRaceTest) {
+  const std::string db_name = "test.db";
+  const size_t buffer_pool_size = 10;
+  const page_id_t num_pages = 20;
+  const int rounds = 300;
+
+  auto *disk_manager = new DiskManager(db_name);
+  auto *bpm = new BufferPoolManagerInstance(buffer_pool_size, disk_manager);
+  std::vector<page_id_t> page_ids;
+  for (page_id_t i = 0; i < num_pages; ++i) {
+    page_id_t page_id;
+    auto *page = bpm->NewPage(&page_id);
+    ASSERT_NE(nullptr, page);
+    page_ids.push_back(page_id);
+    EXPECT_TRUE(bpm->UnpinPage(page_id, true));
+  }
+  bpm->FlushAllPages();
+
+  // Scenario: pages are read ahead, a few at a time like a scan does, while they are fetched, changed and evicted
+  // again. A read that a fetch overtook must never be published over the change, or a counter goes missing.
+  const size_t window = 4;
+  for (int round = 0; round < rounds; ++round) {
+    for (size_t i = 0; i < page_ids.size(); ++i) {
+      page_id_t page_id = page_ids[i];
+      bpm->PrefetchPages({page_id, page_ids[(i + 1) % page_ids.size()], page_ids[(i + window) % page_ids.size()]});
+      auto *page = bpm->FetchPage(page_id);
+      ASSERT_NE(nullptr, page);
+      ++*reinterpret_cast<int *>(page->GetData());
+      EXPECT_TRUE(bpm->UnpinPage(page_id, true));
+    }
+  }
+  for (page_id_t page_id : page_ids) {
+    auto *page = bpm->FetchPage(page_id);
+    ASSERT_NE(nullptr, page);
+    EXPECT_EQ(rounds, *reinterpret_cast<int *>(page->GetData())) << page_id;
+    EXPECT_TRUE(bpm->UnpinPage(page_id, false));
+  }
+
+  // Scenario: a page deleted while it is read ahead does not come back.
+  bpm->PrefetchPages({page_ids.back()});
+  EXPECT_TRUE(bpm->DeletePage(page_ids.back()));
+  for (int i = 0; i < 100; i++) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  }
+  int pages_resident = 0;
+  for (size_t i = 0; i < buffer_pool_size; ++i) {
+    pages_resident += static_cast<int>(bpm->GetPages()[i].GetPageId() == page_ids.back());
+  }
+  EXPECT_EQ(0, pages_resident);
+
+  disk_manager->ShutDown();
+  remove("test.db");
+
+  delete bpm;
+  delete disk_manager;
+}
+
+// NOLINTNEXTLINE
+TEST(BufferPoolManagerInstanceTest, CorruptedPageTest) {
+  const std::string db_name = "test.db";
+  const size_t buffer_pool_size = 10;
+  // Keep the page cleaner out of the way: a frame it pins is passed over by eviction, which would leave other pages
+  // resident than the ones expected below.
+  const double saved_dirty_ratio = page_cleaner_dirty_ratio;
+  page_cleaner_dirty_ratio = 1.0;
+
+  auto *disk_manager = new DiskManager(db_name);
+  auto *bpm = new BufferPoolManagerInstance(buffer_pool_size, disk_manager);
+
+  // Scenario: write twice as many pages as fit, then damage page 3 on disk.
+  page_id_t page_id_temp;
+  for (size_t i = 0; i < 2 * buffer_pool_size; ++i) {
+    auto *page = bpm->NewPage(&page_id_temp);
+    ASSERT_NE(nullptr, page);
+    snprintf(page->GetData(), PAGE_SIZE, "page %d", page_id_temp);
+    EXPECT_TRUE(bpm->UnpinPage(page_id_temp, true));
+  }
+  bpm->FlushAllPages();
+  FILE *file = fopen(db_name.c_str(), "r+b");
+  ASSERT_NE(nullptr, file);
+  fseek(file, 3 * PAGE_SIZE + 1, SEEK_SET);
+  fputc('X', file);
+  fclose(file);
+
+  // Scenario: the read-ahead drops the damaged page, and fetching it throws without losing the frame.
+  bpm->PrefetchPages({2, 3, 4});
+  for (int i = 0; i < 500 && bpm->GetNumPrefetchedPages() < 2; i++) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+  }
+  EXPECT_EQ(2, bpm->GetNumPrefetchedPages());
+  EXPECT_THROW(bpm->FetchPage(3), CorruptedPageException);
+  EXPECT_THROW(bpm->FetchPage(3), CorruptedPageException);
+  for (size_t i = 0; i < buffer_pool_size; ++i) {
+    EXPECT_NE(nullptr, bpm->NewPage(&page_id_temp));
+  }
+
+  page_cleaner_dirty_ratio = saved_dirty_ratio;
+  disk_manager->ShutDown();
+  remove("test.db");
+
+  delete bpm;
+  delete disk_manager;
+}
+
+// NOLINTNEXTLINE
+TEST(BufferPoolManagerInstanceTest, FlushLatchTest) {
+  const std::string db_name = "test.db";
+  const size_t buffer_pool_size = 10;
+  // Only the flushes below may write the page.
+  const double saved_dirty_ratio = page_cleaner_dirty_ratio;
+  page_cleaner_dirty_ratio = 1.0;
+
+  auto *disk_manager = new DiskManager(db_name);
+  auto *bpm = new BufferPoolManagerInstance(buffer_pool_size, disk_manager);
+  page_id_t page_id;
+  auto *page = bpm->NewPage(&page_id);
+  ASSERT_NE(nullptr, page);
+
+  // Scenario: a flush waits for the writer that holds the page's write latch, so it never writes a page that is half
+  // changed, whose checksum would not match what reaches the disk.
+  page->WLatch();
+  memset(page->GetData(), 'a', PAGE_SIZE / 2);
+  EXPECT_TRUE(bpm->UnpinPage(page_id, true));
+  ASSERT_EQ(page, bpm->FetchPage(page_id));
+  int num_writes = disk_manager->GetNumWrites();
+  std::thread flusher([&] { EXPECT_TRUE(bpm->FlushPage(page_id)); });
+  std::this_thread::sleep_for(std::chrono::milliseconds(100));
+  EXPECT_EQ(num_writes, disk_manager->GetNumWrites());
+  memset(page->GetData() + PAGE_SIZE / 2, 'b', PAGE_SIZE / 2 - PAGE_CHECKSUM_SIZE);
+  page->WUnlatch();
+  flusher.join();
+  EXPECT_EQ(num_writes + 1, disk_manager->GetNumWrites());
+  char buf[PAGE_SIZE];
+  ASSERT_NO_THROW(disk_manager->ReadPage(page_id, buf));
+  EXPECT_EQ(0, memcmp(buf, page->GetData(), PAGE_SIZE));
+
+  // Scenario: so does the batched flush, after which the page is clean and out of the dirty page table.
+  page->WLatch();
+  page->SetLSN(1);
+  memset(page->GetData() + PAGE_SIZE / 2, 'c', PAGE_SIZE / 2 - PAGE_CHECKSUM_SIZE);
+  EXPECT_TRUE(bpm->UnpinPage(page_id, true));
+  ASSERT_EQ(page, bpm->FetchPage(page_id));
+  num_writes = disk_manager->GetNumWrites();
+  flusher = std::thread([&] { bpm->FlushAllPages(); });
+  std::this_thread::sleep_for(std::chrono::milliseconds(100));
+  EXPECT_EQ(num_writes, disk_manager->GetNumWrites());
+  memset(page->GetData(), 'd', PAGE_SIZE / 2);
+  page->WUnlatch();
+  flusher.join();
+  EXPECT_EQ(num_writes + 1, disk_manager->GetNumWrites());
+  ASSERT_NO_THROW(disk_manager->ReadPage(page_id, buf));
+  EXPECT_EQ(0, memcmp(buf, page->GetData(), PAGE_SIZE));
+  std::vector<std::pair<page_id_t, lsn_t>> dirty_page_table;
+  bpm->GetDirtyPageTable(&dirty_page_table);
+  EXPECT_TRUE(dirty_page_table.empty());
+  EXPECT_TRUE(bpm->UnpinPage(page_id, false));
+
+  page_cleaner_dirty_ratio = saved_dirty_ratio;
+  disk_manager->ShutDown();
+  remove("test.db");
+
+  delete bpm;
+  delete disk_manager;
+}
+
+// NOLINTNEXTLINE
+TEST(BufferPoolManagerInstanceTest, DirectIOTest) {
+  const std::string db_name = "test.db";
+  const size_t buffer_pool_size = 10;
+
+  auto *disk_manager = new DiskManager(db_name, DiskBackendType::POSIX, true);
+  auto *bpm = new BufferPoolManagerInstance(buffer_pool_size, disk_manager);
+
+  // Scenario: every frame is PAGE_SIZE aligned, so page I/O never needs a bounce buffer.
+  page_id_t page_id_temp;
+  for (size_t i = 0; i < buffer_pool_size; ++i) {
+    auto *page = bpm->NewPage(&page_id_temp);
+    ASSERT_NE(nullptr, page);
+    EXPECT_EQ(0, reinterpret_cast<uintptr_t>(page->GetData()) % PAGE_SIZE);
+    snprintf(page->GetData(), PAGE_SIZE, "page %d", page_id_temp);
+    EXPECT_TRUE(bpm->UnpinPage(page_id_temp, true));
+  }
+
+  // Scenario: pages survive eviction through the unbuffered file.
+  for (size_t i = 0; i < buffer_pool_size; ++i) {
+    EXPECT_NE(nullptr, bpm->NewPage(&page_id_temp));
+    EXPECT_TRUE(bpm->UnpinPage(page_id_temp, false));
+  }
+  for (page_id_t page_id = 0; page_id < static_cast<page_id_t>(buffer_pool_size); ++page_id) {
+    auto *page = bpm->FetchPage(page_id);
+    ASSERT_NE(nullptr, page);
+    EXPECT_EQ(0, strcmp(page->GetData(), ("page " + std::to_string(page_id)).c_str()));
+    EXPECT_TRUE(bpm->UnpinPage(page_id, false));
+  }
+
+  disk_manager->ShutDown();
+  remove("test.db");
+
+  delete bpm;
+  delete disk_manager;
+}
+
+// NOLINTNEXTLINE
+TEST(BufferPoolManagerInstanceTest, WriteAheadLogTest) {
+  const std::string db_name = "test.db";
+  const size_t buffer_pool_size = 2;
+  const auto saved_log_timeout = log_timeout;
+  // nothing but the buffer pool forces the log in this test
+  log_timeout = std::chrono::seconds(600);
+  // and nothing but the scenarios below writes pages
+  const double saved_dirty_ratio = page_cleaner_dirty_ratio;
+  page_cleaner_dirty_ratio = 1.0;
+
+  auto *disk_manager = new DiskManager(db_name);
+  auto *log_manager = new LogManager(disk_manager);
+  auto *bpm = new BufferPoolManagerInstance(buffer_pool_size, disk_manager, log_manager);
+  log_manager->RunFlushThread();
+  auto append_log_record = [&] {
+    LogRecord log_record(0, INVALID_LSN, LogRecordType::NEWPAGE, INVALID_PAGE_ID, 0);
+    return log_manager->AppendLogRecord(&log_record);
+  };
+
+  // Scenario: evicting a page forces the log up to the page LSN before the page is written.
+  page_id_t page_id;
+  auto *page = bpm->NewPage(&page_id);
+  ASSERT_NE(nullptr, page);
+  lsn_t lsn = append_log_record();
+  page->SetLSN(lsn);
+  EXPECT_TRUE(bpm->UnpinPage(page_id, true));
+  EXPECT_LT(log_manager->GetPersistentLSN(), lsn);
+  for (size_t i = 0; i < buffer_pool_size; ++i) {
+    page_id_t page_id_temp;
+    ASSERT_NE(nullptr, bpm->NewPage(&page_id_temp));
+    EXPECT_TRUE(bpm->UnpinPage(page_id_temp, false));
+  }
+  EXPECT_GE(log_manager->GetPersistentLSN(), lsn);
+
+  // Scenario: so do FlushPage and FlushAllPages.
+  page = bpm->FetchPage(page_id);
+  ASSERT_NE(nullptr, page);
+  lsn = append_log_record();
+  page->SetLSN(lsn);
+  EXPECT_TRUE(bpm->UnpinPage(page_id, true));
+  EXPECT_LT(log_manager->GetPersistentLSN(), lsn);
+  EXPECT_TRUE(bpm->FlushPage(page_id));
+  EXPECT_GE(log_manager->GetPersistentLSN(), lsn);
+
+  page = bpm->FetchPage(page_id);
+  ASSERT_NE(nullptr, page);
+  lsn = append_log_record();
+  page->SetLSN(lsn);
+  EXPECT_TRUE(bpm->UnpinPage(page_id, true));
+  EXPECT_LT(log_manager->GetPersistentLSN(), lsn);
+  bpm->FlushAllPages();
+  EXPECT_GE(log_manager->GetPersistentLSN(), lsn);
+
+  log_manager->StopFlushThread();
+  log_timeout = saved_log_timeout;
+  page_cleaner_dirty_ratio = saved_dirty_ratio;
+  disk_manager->ShutDown();
+  remove("test.db");
+  remove("test.log");
+
+  delete bpm;
+  delete log_manager;
+  delete disk_manager;
+}
+
 }  // namespace bustub
@@ -0,0 +1,144 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// lru_k_replacer_test.cpp
+//
+// Identification: test/buffer/lru_k_replacer_test.cpp
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <cstdio>
+#include <thread>  // NOLINT
+#include <vector>
+
+#include "buffer/lru_k_replacer.h"
+#include "gtest/gtest.h"
+
+namespace bustub {
+
+TEST(LRUKReplacerTest, SampleTest) {
+  LRUKReplacer lru_k_replacer(7, 2, 0);
+
+  // Scenario: unpin five frames, i.e. add them to the replacer with one reference each.
+  for (frame_id_t frame_id = 1; frame_id <= 5; frame_id++) {
+    lru_k_replacer.Unpin(frame_id);
+  }
+  EXPECT_EQ(5, lru_k_replacer.Size());
+
+  // Scenario: frame 1 is referenced a second time, so it now has a finite backward 2-distance.
+  lru_k_replacer.Pin(1);
+  lru_k_replacer.Unpin(1);
+
+  // Scenario: frames with fewer than two references go first, oldest first.
+  int value;
+  lru_k_replacer.Victim(&value);
+  EXPECT_EQ(2, value);
+  lru_k_replacer.Victim(&value);
+  EXPECT_EQ(3, value);
+
+  // Scenario: frame 4 gets its second reference after frame 1 did.
+  lru_k_replacer.Pin(4);
+  lru_k_replacer.Unpin(4);
+  EXPECT_EQ(3, lru_k_replacer.Size());
+
+  // Scenario: frame 5 still has an infinite distance; then the larger 2-distance (frame 1) goes before frame 4.
+  lru_k_replacer.Victim(&value);
+  EXPECT_EQ(5, value);
+  lru_k_replacer.Victim(&value);
+  EXPECT_EQ(1, value);
+  lru_k_replacer.Victim(&value);
+  EXPECT_EQ(4, value);
+  EXPECT_FALSE(lru_k_replacer.Victim(&value));
+}
+
+TEST(LRUKReplacerTest, CorrelatedReferenceTest) {
+  LRUKReplacer lru_k_replacer(8, 2, 4);
+
+  // Scenario: frame 0 is fetched three times in one burst, like a page revisited within one traversal.
+  lru_k_replacer.Pin(0);
+  lru_k_replacer.Unpin(0);
+  lru_k_replacer.Pin(0);
+  lru_k_replacer.Pin(0);
+  lru_k_replacer.Unpin(0);
+
+  // Scenario: frames 2..6 are referenced once each afterwards.
+  for (frame_id_t frame_id = 2; frame_id <= 6; frame_id++) {
+    lru_k_replacer.Unpin(frame_id);
+  }
+  EXPECT_EQ(6, lru_k_replacer.Size());
+
+  // Scenario: the burst counts as a single reference, so frame 0 is not protected. Frames 3..6 are still inside their
+  // correlated period and are only chosen once nothing else is left.
+  int value;
+  lru_k_replacer.Victim(&value);
+  EXPECT_EQ(0, value);
+  lru_k_replacer.Victim(&value);
+  EXPECT_EQ(2, value);
+  lru_k_replacer.Victim(&value);
+  EXPECT_EQ(3, value);
+
+  // Scenario: pinned frames are never victims.
+  lru_k_replacer.Pin(4);
+  lru_k_replacer.Victim(&value);
+  EXPECT_EQ(5, value);
+  lru_k_replacer.Victim(&value);
+  EXPECT_EQ(6, value);
+  EXPECT_FALSE(lru_k_replacer.Victim(&value));
+  EXPECT_EQ(0, lru_k_replacer.Size());
+}
+
+TEST(LRUKReplacerTest, InfiniteDistanceTest) {
+  LRUKReplacer lru_k_replacer(4, 3, 0);
+
+  // Scenario: frame 1 is referenced before and after frame 2, but neither has three references yet.
+  lru_k_replacer.Unpin(1);
+  lru_k_replacer.Unpin(2);
+  lru_k_replacer.Pin(1);
+  lru_k_replacer.Unpin(1);
+
+  // Scenario: among infinite distances, the oldest reference goes first, not the oldest last reference.
+  int value;
+  lru_k_replacer.Victim(&value);
+  EXPECT_EQ(1, value);
+  lru_k_replacer.Victim(&value);
+  EXPECT_EQ(2, value);
+  EXPECT_FALSE(lru_k_replacer.Victim(&value));
+}
+
+TEST(LRUKReplacerTest, LargePoolTest) {
+  const int num_frames = 1000;
+  LRUKReplacer lru_k_replacer(num_frames, 2, 0);
+
+  // Scenario: every frame is referenced once in order, then the even ones again, in reverse order.
+  for (int i = 0; i < num_frames; i++) {
+    lru_k_replacer.Unpin(i);
+  }
+  for (int i = num_frames - 2; i >= 0; i -= 2) {
+    lru_k_replacer.Pin(i);
+    lru_k_replacer.Unpin(i);
+  }
+  // a pinned frame is never a victim, and a re-unpinned one keeps its place
+  lru_k_replacer.Pin(1);
+  lru_k_replacer.Unpin(3);
+  EXPECT_EQ(num_frames - 1, lru_k_replacer.Size());
+
+  // Scenario: the odd frames go first, by their only reference, then the even ones by their second most recent.
+  int value;
+  for (int i = 3; i < num_frames; i += 2) {
+    ASSERT_TRUE(lru_k_replacer.Victim(&value));
+    EXPECT_EQ(i, value);
+  }
+  for (int i = 0; i < num_frames; i += 2) {
+    ASSERT_TRUE(lru_k_replacer.Victim(&value));
+    EXPECT_EQ(i, value);
+  }
+  EXPECT_FALSE(lru_k_replacer.Victim(&value));
+  lru_k_replacer.Unpin(1);
+  ASSERT_TRUE(lru_k_replacer.Victim(&value));
+  EXPECT_EQ(1, value);
+}
+
+}  // namespace bustub
@@ -0,0 +1,142 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// page_table_test.cpp
+//
+// Identification: test/buffer/page_table_test.cpp
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <atomic>
+#include <cstdio>
+#include <thread>  // NOLINT
+#include <vector>
+
+#include "buffer/buffer_pool_manager_instance.h"
+#include "buffer/page_table.h"
+#include "gtest/gtest.h"
+
+namespace bustub {
+
+TEST(PageTableTest, SampleTest) {
+  PageTable page_table(8);
+  frame_id_t frame_id;
+
+  // Scenario: an empty table finds nothing.
+  EXPECT_FALSE(page_table.Find(0, &frame_id));
+
+  // Scenario: insert strided page ids, like the ones a parallel BPM instance hands out.
+  for (page_id_t page_id = 0; page_id < 8; page_id++) {
+    page_table.Insert(page_id * 5, page_id);
+  }
+  for (page_id_t page_id = 0; page_id < 8; page_id++) {
+    ASSERT_TRUE(page_table.Find(page_id * 5, &frame_id));
+    EXPECT_EQ(page_id, frame_id);
+  }
+
+  // Scenario: removing entries keeps the rest of their probe sequences reachable.
+  EXPECT_TRUE(page_table.Remove(0));
+  EXPECT_TRUE(page_table.Remove(15));
+  EXPECT_FALSE(page_table.Remove(15));
+  EXPECT_FALSE(page_table.Find(0, &frame_id));
+  EXPECT_FALSE(page_table.Find(15, &frame_id));
+  for (page_id_t page_id : {1, 2, 4, 5, 6, 7}) {
+    ASSERT_TRUE(page_table.Find(page_id * 5, &frame_id));
+    EXPECT_EQ(page_id, frame_id);
+  }
+
+  // Scenario: a removed page can be inserted again with a new frame.
+  page_table.Insert(15, 0);
+  ASSERT_TRUE(page_table.Find(15, &frame_id));
+  EXPECT_EQ(0, frame_id);
+}
+
+TEST(PageTableTest, ConcurrentReadTest) {
+  const int num_pages = 64;
+  PageTable page_table(num_pages);
+  for (page_id_t page_id = 0; page_id < num_pages / 2; page_id++) {
+    page_table.Insert(page_id, page_id);
+  }
+
+  // Scenario: readers never observe a wrong frame while a writer churns the other half of the table.
+  std::atomic<bool> done{false};
+  std::vector<std::thread> readers;
+  for (int tid = 0; tid < 4; tid++) {
+    readers.emplace_back([&] {
+      frame_id_t frame_id;
+      while (!done) {
+        for (page_id_t page_id = 0; page_id < num_pages; page_id++) {
+          if (page_table.Find(page_id, &frame_id)) {
+            EXPECT_EQ(page_id, frame_id);
+          }
+        }
+      }
+    });
+  }
+  for (int round = 0; round < 1000; round++) {
+    for (page_id_t page_id = num_pages / 2; page_id < num_pages; page_id++) {
+      page_table.Insert(page_id, page_id);
+    }
+    for (page_id_t page_id = num_pages / 2; page_id < num_pages; page_id++) {
+      page_table.Remove(page_id);
+    }
+  }
+  done = true;
+  for (auto &reader : readers) {
+    reader.join();
+  }
+}
+
+TEST(PageTableTest, ConcurrentFetchTest) {
+  const std::string db_name = "test.db";
+  const size_t buffer_pool_size = 8;
+  const int num_pages = 32;
+
+  auto *disk_manager = new DiskManager(db_name);
+  auto *bpm = new BufferPoolManagerInstance(buffer_pool_size, disk_manager);
+
+  page_id_t page_id_temp;
+  for (int i = 0; i < num_pages; i++) {
+    auto *page = bpm->NewPage(&page_id_temp);
+    ASSERT_NE(nullptr, page);
+    snprintf(page->GetData(), PAGE_SIZE, "%d", page_id_temp);
+    EXPECT_TRUE(bpm->UnpinPage(page_id_temp, true));
+  }
+
+  // Scenario: threads fetching overlapping pages through a pool smaller than the working set always see the right
+  // contents, and every pin they take is released.
+  std::vector<std::thread> threads;
+  for (int tid = 0; tid < 4; tid++) {
+    threads.emplace_back([bpm, tid] {
+      char expected[PAGE_SIZE];
+      for (int i = 0; i < 2000; i++) {
+        page_id_t page_id = (i * 7 + tid) % num_pages;
+        auto *page = bpm->FetchPage(page_id);
+        if (page == nullptr) {
+          continue;
+        }
+        snprintf(expected, PAGE_SIZE, "%d", page_id);
+        EXPECT_EQ(page_id, page->GetPageId());
+        EXPECT_EQ(0, strcmp(page->GetData(), expected));
+        EXPECT_TRUE(bpm->UnpinPage(page_id, false));
+      }
+    });
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+  for (size_t i = 0; i < buffer_pool_size; i++) {
+    EXPECT_EQ(0, bpm->GetPages()[i].GetPinCount());
+  }
+
+  disk_manager->ShutDown();
+  remove("test.db");
+
+  delete bpm;
+  delete disk_manager;
+}
+
+}  // namespace bustub
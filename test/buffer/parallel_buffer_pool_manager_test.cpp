@@ -14,6 +14,7 @@
 #include <cstdio>
 #include <random>
 #include <string>
+#include <vector>
 #include "buffer/buffer_pool_manager.h"
 #include "gtest/gtest.h"
 
@@ -46,9 +47,9 @@ TEST(ParallelBufferPoolManagerTest, BinaryDataTest) {
     i = uniform_dist(rng);
   }
 
-  // Insert terminal characters both in the middle and at end
+  // Insert terminal characters both in the middle and at end, which is just before the page checksum
   random_binary_data[PAGE_SIZE / 2] = '\0';
-  random_binary_data[PAGE_SIZE - 1] = '\0';
+  random_binary_data[PAGE_SIZE - PAGE_CHECKSUM_SIZE - 1] = '\0';
 
   // Scenario: Once we have a page, we should be able to read and write content.
   std::memcpy(page0->GetData(), random_binary_data, PAGE_SIZE);
@@ -76,7 +77,7 @@ TEST(ParallelBufferPoolManagerTest, BinaryDataTest) {
 
   // Scenario: We should be able to fetch the data we wrote a while ago.
   page0 = bpm->FetchPage(0);
-  EXPECT_EQ(0, memcmp(page0->GetData(), random_binary_data, PAGE_SIZE));
+  EXPECT_EQ(0, memcmp(page0->GetData(), random_binary_data, PAGE_SIZE - PAGE_CHECKSUM_SIZE));
   EXPECT_EQ(true, bpm->UnpinPage(0, true));
 
   // Shutdown the disk manager and remove the temporary file we created.
@@ -151,4 +152,53 @@ TEST(ParallelBufferPoolManagerTest, SampleTest) {
   delete disk_manager;
 }
 
+// NOLINTNEXTLINE
+TEST(ParallelBufferPoolManagerTest, FlushAllPagesTest) {
+  const std::string db_name = "test.db";
+  const size_t buffer_pool_size = 10;
+  const size_t num_instances = 5;
+
+  auto *disk_manager = new DiskManager(db_name);
+  auto *bpm = new ParallelBufferPoolManager(num_instances, buffer_pool_size, disk_manager);
+
+  // Scenario: fill the pool with dirty pages whose ids are striped over all instances, keeping a few pinned.
+  std::vector<Page *> pages;
+  page_id_t page_id_temp;
+  for (size_t i = 0; i < buffer_pool_size * num_instances; ++i) {
+    auto *page = bpm->NewPage(&page_id_temp);
+    ASSERT_NE(nullptr, page);
+    snprintf(page->GetData(), PAGE_SIZE, "page %d", page_id_temp);
+    pages.push_back(page);
+  }
+  for (size_t i = 0; i < pages.size(); ++i) {
+    EXPECT_TRUE(bpm->UnpinPage(pages[i]->GetPageId(), true));
+    if (i % 7 == 0) {
+      EXPECT_EQ(pages[i], bpm->FetchPage(pages[i]->GetPageId()));
+    }
+  }
+
+  // Scenario: after a flush every page is clean and its contents are on disk, pinned or not.
+  bpm->FlushAllPages();
+  char buffer[PAGE_SIZE];
+  for (auto *page : pages) {
+    EXPECT_FALSE(page->IsDirty());
+    disk_manager->ReadPage(page->GetPageId(), buffer);
+    EXPECT_EQ(0, strcmp(buffer, ("page " + std::to_string(page->GetPageId())).c_str()));
+  }
+
+  // Scenario: the pins taken by the flush are released, so unpinned pages can still be evicted.
+  for (size_t i = 0; i < pages.size(); i += 7) {
+    EXPECT_TRUE(bpm->UnpinPage(pages[i]->GetPageId(), false));
+  }
+  for (size_t i = 0; i < buffer_pool_size * num_instances; ++i) {
+    EXPECT_NE(nullptr, bpm->NewPage(&page_id_temp));
+  }
+
+  disk_manager->ShutDown();
+  remove("test.db");
+
+  delete bpm;
+  delete disk_manager;
+}
+
 }  // namespace bustub
@@ -0,0 +1,67 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// two_queue_replacer_test.cpp
+//
+// Identification: test/buffer/two_queue_replacer_test.cpp
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <cstdio>
+#include <thread>  // NOLINT
+#include <vector>
+
+#include "buffer/two_queue_replacer.h"
+#include "gtest/gtest.h"
+
+namespace bustub {
+
+TEST(TwoQueueReplacerTest, SampleTest) {
+  TwoQueueReplacer replacer(8);
+
+  // Scenario: load pages 10..15 into frames 0..5 and unpin them. They all sit in the probation queue.
+  for (frame_id_t frame_id = 0; frame_id < 6; frame_id++) {
+    replacer.RecordLoad(frame_id, 10 + frame_id);
+    replacer.Unpin(frame_id);
+  }
+  EXPECT_EQ(6, replacer.Size());
+
+  // Scenario: a correlated re-reference does not change a probation page's FIFO position.
+  replacer.Pin(0);
+  replacer.Unpin(0);
+  int value;
+  ASSERT_TRUE(replacer.Victim(&value));
+  EXPECT_EQ(0, value);
+  ASSERT_TRUE(replacer.Victim(&value));
+  EXPECT_EQ(1, value);
+  EXPECT_EQ(4, replacer.Size());
+
+  // Scenario: page 10 comes back while it is still remembered, so it is protected.
+  replacer.RecordLoad(0, 10);
+  replacer.Unpin(0);
+  // Scenario: a scan of new pages only churns the probation queue.
+  for (int i = 0; i < 20; i++) {
+    ASSERT_TRUE(replacer.Victim(&value));
+    EXPECT_NE(0, value);
+    replacer.RecordLoad(value, 100 + i);
+    replacer.Unpin(value);
+  }
+  EXPECT_EQ(5, replacer.Size());
+
+  // Scenario: pinned frames are never victims.
+  replacer.Pin(0);
+  for (int i = 0; i < 4; i++) {
+    ASSERT_TRUE(replacer.Victim(&value));
+    EXPECT_NE(0, value);
+  }
+  EXPECT_FALSE(replacer.Victim(&value));
+  replacer.Unpin(0);
+  ASSERT_TRUE(replacer.Victim(&value));
+  EXPECT_EQ(0, value);
+  EXPECT_EQ(0, replacer.Size());
+}
+
+}  // namespace bustub
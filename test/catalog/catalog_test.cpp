@@ -688,4 +688,72 @@ TEST(CatalogTest, DISABLED_IndexInteraction3) {
   remove("catalog_test.log");
 }
 
+// Should be able to bulk load a B+ tree index from the existing data of a table
+TEST(CatalogTest, CreateBPlusTreeIndex) {
+  auto disk_manager = std::make_unique<DiskManager>("catalog_test.db");
+  auto bpm = std::make_unique<BufferPoolManagerInstance>(32, disk_manager.get());
+  auto catalog = std::make_unique<Catalog>(bpm.get(), nullptr, nullptr);
+  auto txn = std::make_unique<Transaction>(0);
+  page_id_t header_page_id;
+  bpm->NewPage(&header_page_id);
+
+  const std::string table_name{"foobar"};
+  const std::string index_name{"index1"};
+
+  // Construct a new table whose key column holds -1000..999 out of order, with -1000 twice
+  std::vector<Column> columns{{"A", TypeId::INTEGER}, {"B", TypeId::BIGINT}};
+  Schema table_schema{columns};
+  auto *table_info = catalog->CreateTable(txn.get(), table_name, table_schema);
+  ASSERT_NE(Catalog::NULL_TABLE_INFO, table_info);
+  std::vector<RID> rids(2000);
+  for (int64_t i = 0; i <= 2000; i++) {
+    int64_t key = (i * 7919) % 2000 - 1000;
+    Tuple tuple{std::vector<Value>{ValueFactory::GetIntegerValue(static_cast<int32_t>(i)),
+                                   ValueFactory::GetBigIntValue(key)},
+                &table_schema};
+    RID rid;
+    ASSERT_TRUE(table_info->table_->InsertTuple(tuple, &rid, txn.get()));
+    if (i < 2000) {
+      rids[key + 1000] = rid;
+    }
+  }
+
+  // Index construction should succeed, and fail for an index that already exists
+  std::vector<Column> key_columns{{"B", TypeId::BIGINT}};
+  std::vector<uint32_t> key_attrs{1};
+  Schema key_schema{key_columns};
+  auto *index_info = catalog->CreateBPlusTreeIndex<BigintKeyType, BigintValueType, BigintComparatorType>(
+      txn.get(), index_name, table_name, table_schema, key_schema, key_attrs, BIGINT_SIZE, 0.7);
+  ASSERT_NE(Catalog::NULL_INDEX_INFO, index_info);
+  EXPECT_EQ(index_info, catalog->GetIndex(index_name, table_name));
+  EXPECT_EQ(Catalog::NULL_INDEX_INFO,
+            (catalog->CreateBPlusTreeIndex<BigintKeyType, BigintValueType, BigintComparatorType>(
+                txn.get(), index_name, table_name, table_schema, key_schema, key_attrs, BIGINT_SIZE)));
+
+  // Every key should be found, with the first tuple that has it
+  auto *index = index_info->index_.get();
+  for (int64_t key = -1000; key < 1000; key++) {
+    Tuple tuple{std::vector<Value>{ValueFactory::GetIntegerValue(0), ValueFactory::GetBigIntValue(key)},
+                &table_schema};
+    std::vector<RID> results{};
+    index->ScanKey(tuple.KeyFromTuple(table_schema, key_schema, key_attrs), &results, txn.get());
+    ASSERT_EQ(1, results.size());
+    EXPECT_EQ(rids[key + 1000], results[0]);
+  }
+
+  // A scan should see the keys in order
+  auto *tree_index = dynamic_cast<BPlusTreeIndex<BigintKeyType, BigintValueType, BigintComparatorType> *>(index);
+  ASSERT_NE(nullptr, tree_index);
+  int64_t next_key = -1000;
+  for (auto iterator = tree_index->GetBeginIterator(); iterator != tree_index->GetEndIterator(); ++iterator) {
+    EXPECT_EQ(rids[next_key + 1000], (*iterator).second);
+    next_key++;
+  }
+  EXPECT_EQ(1000, next_key);
+
+  bpm->UnpinPage(header_page_id, true);
+  remove("catalog_test.db");
+  remove("catalog_test.log");
+}
+
 }  // namespace bustub
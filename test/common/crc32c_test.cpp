@@ -0,0 +1,67 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// crc32c_test.cpp
+//
+// Identification: test/common/crc32c_test.cpp
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <algorithm>
+#include <cstring>
+#include <random>
+#include <vector>
+
+#include "common/util/crc32c.h"
+#include "gtest/gtest.h"
+
+namespace bustub {
+
+/** A bit at a time, straight from the definition. */
+static uint32_t ReferenceCrc32c(const char *data, size_t size) {
+  uint32_t crc = ~0U;
+  for (size_t i = 0; i < size; i++) {
+    crc ^= static_cast<uint8_t>(data[i]);
+    for (int bit = 0; bit < 8; bit++) {
+      crc = (crc >> 1) ^ ((crc & 1) != 0 ? 0x82f63b78 : 0);
+    }
+  }
+  return ~crc;
+}
+
+// NOLINTNEXTLINE
+TEST(Crc32cTest, KnownValuesTest) {
+  EXPECT_EQ(0U, Crc32c::Value("", 0));
+  EXPECT_EQ(0xe3069283U, Crc32c::Value("123456789", 9));
+  char zeros[32] = {0};
+  EXPECT_EQ(0x8a9136aaU, Crc32c::Value(zeros, sizeof(zeros)));
+}
+
+// NOLINTNEXTLINE
+TEST(Crc32cTest, LengthsAndExtendTest) {
+  std::mt19937 rng(42);
+  std::vector<char> data(3 * 4096 + 17);
+  for (char &c : data) {
+    c = static_cast<char>(rng());
+  }
+
+  // Scenario: every length around the sizes the interleaved path switches at, at unaligned starts too.
+  for (size_t offset : {0, 1, 3}) {
+    for (size_t size = 0; size + offset <= data.size(); size += size < 1600 ? 1 : 397) {
+      ASSERT_EQ(ReferenceCrc32c(data.data() + offset, size), Crc32c::Value(data.data() + offset, size))
+          << "offset " << offset << " size " << size;
+    }
+  }
+
+  // Scenario: extending a checksum piece by piece gives the checksum of the whole.
+  uint32_t crc = 0;
+  for (size_t begin = 0, step = 1; begin < data.size(); begin += step, step = step * 3 + 1) {
+    crc = Crc32c::Extend(crc, data.data() + begin, std::min(step, data.size() - begin));
+  }
+  EXPECT_EQ(ReferenceCrc32c(data.data(), data.size()), crc);
+}
+
+}  // namespace bustub
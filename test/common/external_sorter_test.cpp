@@ -0,0 +1,60 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// external_sorter_test.cpp
+//
+// Identification: test/common/external_sorter_test.cpp
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <algorithm>
+#include <functional>
+#include <random>
+#include <vector>
+
+#include "common/util/external_sorter.h"
+#include "gtest/gtest.h"
+
+namespace bustub {
+
+// NOLINTNEXTLINE
+TEST(ExternalSorterTest, SortTest) {
+  std::mt19937 rng(42);
+  for (size_t size : {0, 1, 999, 1000, 1001, 25000}) {
+    std::vector<uint64_t> items(size);
+    for (auto &item : items) {
+      item = rng() % 5000;
+    }
+
+    // Scenario: a budget of 1000 items keeps small inputs in memory and spills larger ones in runs of that size.
+    ExternalSorter<uint64_t> sorter(1000 * sizeof(uint64_t));
+    for (auto item : items) {
+      sorter.Add(item);
+    }
+    std::sort(items.begin(), items.end());
+    uint64_t item;
+    for (auto expected : items) {
+      ASSERT_TRUE(sorter.Next(&item));
+      ASSERT_EQ(expected, item);
+    }
+    EXPECT_FALSE(sorter.Next(&item));
+    EXPECT_EQ(size < 1000 ? 0 : (size + 999) / 1000, sorter.GetNumSpilledRuns()) << size;
+  }
+
+  // Scenario: items are ordered by the given comparison.
+  ExternalSorter<int, std::greater<>> sorter(4 * sizeof(int));
+  for (int i = 0; i < 10; i++) {
+    sorter.Add(i);
+  }
+  int item;
+  for (int i = 9; i >= 0; i--) {
+    ASSERT_TRUE(sorter.Next(&item));
+    EXPECT_EQ(i, item);
+  }
+  EXPECT_FALSE(sorter.Next(&item));
+}
+
+}  // namespace bustub
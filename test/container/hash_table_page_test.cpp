@@ -10,6 +10,7 @@
 //
 //===----------------------------------------------------------------------===//
 
+#include <algorithm>
 #include <thread>  // NOLINT
 #include <vector>
 
@@ -114,4 +115,50 @@ TEST(HashTablePageTest, BucketPageSampleTest) {
   delete bpm;
 }
 
+// NOLINTNEXTLINE
+TEST(HashTablePageTest, BucketPageFullTest) {
+  DiskManager *disk_manager = new DiskManager("test.db");
+  auto *bpm = new BufferPoolManagerInstance(5, disk_manager);
+
+  page_id_t bucket_page_id = INVALID_PAGE_ID;
+  auto bucket_page = reinterpret_cast<HashTableBucketPage<int, int, IntComparator> *>(
+      bpm->NewPage(&bucket_page_id, nullptr)->GetData());
+
+  // fill every slot, with three values for each key, so that the last slots are searched too
+  int num_slots = 0;
+  while (bucket_page->Insert(num_slots / 3, num_slots, IntComparator())) {
+    num_slots++;
+  }
+  EXPECT_TRUE(bucket_page->IsFull());
+  int num_keys = (num_slots + 2) / 3;
+  for (int key = 0; key < num_keys; key++) {
+    std::vector<int> res;
+    EXPECT_TRUE(bucket_page->GetValue(key, IntComparator(), &res));
+    EXPECT_EQ(std::min(3, num_slots - 3 * key), res.size()) << key;
+    EXPECT_FALSE(bucket_page->Insert(key, 3 * key, IntComparator()));
+  }
+  std::vector<int> res;
+  EXPECT_FALSE(bucket_page->GetValue(num_keys, IntComparator(), &res));
+
+  // the tombstones of removed pairs are skipped, and reused by the next inserts
+  for (int slot = 0; slot < num_slots; slot += 2) {
+    EXPECT_TRUE(bucket_page->Remove(slot / 3, slot, IntComparator()));
+  }
+  for (int slot = 0; slot < num_slots; slot++) {
+    std::vector<int> res;
+    bucket_page->GetValue(slot / 3, IntComparator(), &res);
+    EXPECT_EQ(slot % 2 == 1, std::find(res.begin(), res.end(), slot) != res.end()) << slot;
+  }
+  EXPECT_TRUE(bucket_page->Insert(-1, -1, IntComparator()));
+  res.clear();
+  EXPECT_TRUE(bucket_page->GetValue(-1, IntComparator(), &res));
+  EXPECT_EQ(1, res.size());
+
+  bpm->UnpinPage(bucket_page_id, true, nullptr);
+  disk_manager->ShutDown();
+  remove("test.db");
+  delete disk_manager;
+  delete bpm;
+}
+
 }  // namespace bustub
@@ -18,9 +18,20 @@
 #include "container/hash/extendible_hash_table.h"
 #include "gtest/gtest.h"
 #include "murmur3/MurmurHash3.h"
+#include "storage/index/generic_key.h"
 
 namespace bustub {
 
+namespace {
+
+GenericKey<64> MakeKey(int64_t value) {
+  GenericKey<64> key;
+  key.SetFromInteger(value);
+  return key;
+}
+
+}  // namespace
+
 // NOLINTNEXTLINE
 
 // NOLINTNEXTLINE
@@ -117,4 +128,127 @@ TEST(HashTableTest, SampleTest) {
   delete bpm;
 }
 
+// NOLINTNEXTLINE
+TEST(HashTableTest, GrowDirectoryTest) {
+  auto *disk_manager = new DiskManager("test.db");
+  auto *bpm = new BufferPoolManagerInstance(50, disk_manager);
+  Schema key_schema({Column("a", TypeId::BIGINT)});
+  ExtendibleHashTable<GenericKey<64>, RID, GenericComparator<64>> ht("blah", bpm, GenericComparator<64>(&key_schema),
+                                                                    HashFunction<GenericKey<64>>());
+
+  // more buckets than one directory page can point to
+  const int64_t scale = 40000;
+  for (int64_t i = 0; i < scale; i++) {
+    EXPECT_TRUE(ht.Insert(nullptr, MakeKey(i), RID(i)));
+  }
+  ht.VerifyIntegrity();
+  EXPECT_GT(ht.GetGlobalDepth(), DIRECTORY_MAX_DEPTH);
+
+  for (int64_t i = 0; i < scale; i++) {
+    std::vector<RID> res;
+    ht.GetValue(nullptr, MakeKey(i), &res);
+    ASSERT_EQ(1, res.size()) << "Failed to keep " << i;
+    EXPECT_EQ(RID(i), res[0]);
+  }
+  EXPECT_FALSE(ht.Insert(nullptr, MakeKey(7), RID(7)));
+
+  for (int64_t i = 0; i < scale; i++) {
+    EXPECT_TRUE(ht.Remove(nullptr, MakeKey(i), RID(i)));
+  }
+  ht.VerifyIntegrity();
+  for (int64_t i = 0; i < scale; i += 97) {
+    std::vector<RID> res;
+    EXPECT_FALSE(ht.GetValue(nullptr, MakeKey(i), &res));
+  }
+
+  disk_manager->ShutDown();
+  remove("test.db");
+  delete disk_manager;
+  delete bpm;
+}
+
+// NOLINTNEXTLINE
+TEST(HashTableTest, DeleteBucketsTest) {
+  auto *disk_manager = new DiskManager("test.db");
+  // large enough that no page of the table is evicted
+  auto *bpm = new BufferPoolManagerInstance(200, disk_manager);
+  Schema key_schema({Column("a", TypeId::BIGINT)});
+  ExtendibleHashTable<GenericKey<64>, RID, GenericComparator<64>> ht("blah", bpm, GenericComparator<64>(&key_schema),
+                                                                    HashFunction<GenericKey<64>>());
+  auto count_pages = [&] {
+    int count = 0;
+    for (size_t i = 0; i < bpm->GetPoolSize(); i++) {
+      count += static_cast<int>(bpm->GetPages()[i].GetPageId() != INVALID_PAGE_ID);
+    }
+    return count;
+  };
+
+  const int64_t scale = 3000;
+  for (int64_t i = 0; i < scale; i++) {
+    EXPECT_TRUE(ht.Insert(nullptr, MakeKey(i), RID(i)));
+  }
+  int pages_before = count_pages();
+
+  // Scenario: the buckets that empty out and merge into their split images are deleted.
+  for (int64_t i = 0; i < scale; i++) {
+    EXPECT_TRUE(ht.Remove(nullptr, MakeKey(i), RID(i)));
+  }
+  ht.VerifyIntegrity();
+  EXPECT_LT(count_pages(), pages_before / 4);
+
+  disk_manager->ShutDown();
+  remove("test.db");
+  delete disk_manager;
+  delete bpm;
+}
+
+// NOLINTNEXTLINE
+TEST(HashTableTest, ConcurrentTest) {
+  auto *disk_manager = new DiskManager("test.db");
+  auto *bpm = new BufferPoolManagerInstance(50, disk_manager);
+  Schema key_schema({Column("a", TypeId::BIGINT)});
+  ExtendibleHashTable<GenericKey<64>, RID, GenericComparator<64>> ht("blah", bpm, GenericComparator<64>(&key_schema),
+                                                                    HashFunction<GenericKey<64>>());
+
+  // each thread inserts its own keys, reads them back, and removes the odd ones, while the others split around it
+  const int64_t num_threads = 4;
+  const int64_t scale = 10000;
+  std::vector<std::thread> threads;
+  for (int64_t t = 0; t < num_threads; t++) {
+    threads.emplace_back([&ht, t] {
+      for (int64_t i = t; i < scale * num_threads; i += num_threads) {
+        EXPECT_TRUE(ht.Insert(nullptr, MakeKey(i), RID(i)));
+        std::vector<RID> res;
+        ht.GetValue(nullptr, MakeKey(i), &res);
+        EXPECT_EQ(1, res.size()) << "Failed to insert " << i;
+      }
+      for (int64_t i = t; i < scale * num_threads; i += num_threads) {
+        if (i % 2 == 1) {
+          EXPECT_TRUE(ht.Remove(nullptr, MakeKey(i), RID(i)));
+        }
+      }
+    });
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+
+  ht.VerifyIntegrity();
+  for (int64_t i = 0; i < scale * num_threads; i++) {
+    std::vector<RID> res;
+    ht.GetValue(nullptr, MakeKey(i), &res);
+    if (i % 2 == 1) {
+      EXPECT_EQ(0, res.size()) << "Failed to remove " << i;
+    } else {
+      ASSERT_EQ(1, res.size()) << "Failed to keep " << i;
+      EXPECT_EQ(RID(i), res[0]);
+    }
+  }
+
+  disk_manager->ShutDown();
+  remove("test.db");
+  delete disk_manager;
+  delete bpm;
+}
+
 }  // namespace bustub
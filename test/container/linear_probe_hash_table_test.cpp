@@ -0,0 +1,196 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// linear_probe_hash_table_test.cpp
+//
+// Identification: test/container/linear_probe_hash_table_test.cpp
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <thread>  // NOLINT
+#include <vector>
+
+#include "buffer/buffer_pool_manager_instance.h"
+#include "common/logger.h"
+#include "container/hash/linear_probe_hash_table.h"
+#include "gtest/gtest.h"
+
+namespace bustub {
+
+// NOLINTNEXTLINE
+TEST(LinearProbeHashTableTest, SampleTest) {
+  auto *disk_manager = new DiskManager("test.db");
+  auto *bpm = new BufferPoolManagerInstance(50, disk_manager);
+  LinearProbeHashTable<int, int, IntComparator> ht("blah", bpm, IntComparator(), 1000, HashFunction<int>());
+
+  // insert a few values, with two values for each key but the first
+  for (int i = 0; i < 5; i++) {
+    EXPECT_TRUE(ht.Insert(nullptr, i, i));
+    if (i > 0) {
+      EXPECT_TRUE(ht.Insert(nullptr, i, 2 * i));
+    }
+  }
+  // duplicate values for the same key are not allowed
+  EXPECT_FALSE(ht.Insert(nullptr, 1, 2));
+
+  for (int i = 0; i < 5; i++) {
+    std::vector<int> res;
+    EXPECT_TRUE(ht.GetValue(nullptr, i, &res));
+    EXPECT_EQ(i == 0 ? 1 : 2, res.size()) << "Failed to keep " << i;
+  }
+  std::vector<int> res;
+  EXPECT_FALSE(ht.GetValue(nullptr, 20, &res));
+
+  // a removed pair leaves a tombstone that lookups of the other pairs go past
+  for (int i = 0; i < 5; i++) {
+    EXPECT_TRUE(ht.Remove(nullptr, i, i));
+    EXPECT_FALSE(ht.Remove(nullptr, i, i));
+    std::vector<int> res;
+    ht.GetValue(nullptr, i, &res);
+    if (i == 0) {
+      EXPECT_EQ(0, res.size());
+    } else {
+      ASSERT_EQ(1, res.size());
+      EXPECT_EQ(2 * i, res[0]);
+    }
+  }
+
+  disk_manager->ShutDown();
+  remove("test.db");
+  delete disk_manager;
+  delete bpm;
+}
+
+// NOLINTNEXTLINE
+TEST(LinearProbeHashTableTest, ResizeTest) {
+  auto *disk_manager = new DiskManager("test.db");
+  auto *bpm = new BufferPoolManagerInstance(50, disk_manager);
+  LinearProbeHashTable<int, int, IntComparator> ht("blah", bpm, IntComparator(), 10, HashFunction<int>());
+  size_t initial_size = ht.GetSize();
+
+  // the table grows by several doublings, and each resize is still in progress for a while after it starts
+  const int scale = 20000;
+  for (int i = 0; i < scale; i++) {
+    EXPECT_TRUE(ht.Insert(nullptr, i, i));
+    if (i % 97 == 0) {
+      for (int j = 0; j <= i; j += 31) {
+        std::vector<int> res;
+        ht.GetValue(nullptr, j, &res);
+        ASSERT_EQ(1, res.size()) << "Failed to keep " << j << " after inserting " << i;
+        EXPECT_EQ(j, res[0]);
+      }
+    }
+  }
+  EXPECT_GE(ht.GetSize(), 4 * initial_size);
+  EXPECT_GE(ht.GetSize(), static_cast<size_t>(scale));
+
+  for (int i = 0; i < scale; i += 2) {
+    EXPECT_TRUE(ht.Remove(nullptr, i, i));
+  }
+  for (int i = 0; i < scale; i++) {
+    std::vector<int> res;
+    ht.GetValue(nullptr, i, &res);
+    EXPECT_EQ(i % 2, res.size()) << i;
+  }
+
+  // an explicit resize moves every pair over as well
+  size_t size = ht.GetSize();
+  ht.Resize(size);
+  EXPECT_EQ(2 * size, ht.GetSize());
+  for (int i = 0; i < scale; i++) {
+    EXPECT_EQ(i % 2 == 0, ht.Insert(nullptr, i, i));
+  }
+  for (int i = 0; i < scale; i++) {
+    std::vector<int> res;
+    ht.GetValue(nullptr, i, &res);
+    ASSERT_EQ(1, res.size()) << i;
+    EXPECT_EQ(i, res[0]);
+  }
+
+  disk_manager->ShutDown();
+  remove("test.db");
+  delete disk_manager;
+  delete bpm;
+}
+
+// NOLINTNEXTLINE
+TEST(LinearProbeHashTableTest, ChurnTest) {
+  auto *disk_manager = new DiskManager("test.db");
+  auto *bpm = new BufferPoolManagerInstance(50, disk_manager);
+  LinearProbeHashTable<int, int, IntComparator> ht("blah", bpm, IntComparator(), 10, HashFunction<int>());
+
+  const int num_pairs = 1000;
+  for (int i = 0; i < num_pairs; i++) {
+    EXPECT_TRUE(ht.Insert(nullptr, i, i));
+  }
+  size_t size = ht.GetSize();
+
+  // removes leave tombstones, which are cleared by rehashing at the same size rather than by growing the table
+  const int num_rounds = 50 * num_pairs;
+  for (int i = 0; i < num_rounds; i++) {
+    EXPECT_TRUE(ht.Remove(nullptr, i, i));
+    EXPECT_TRUE(ht.Insert(nullptr, i + num_pairs, i + num_pairs));
+  }
+  EXPECT_LE(ht.GetSize(), 2 * size);
+  for (int i = num_rounds - num_pairs; i < num_rounds + num_pairs; i++) {
+    std::vector<int> res;
+    ht.GetValue(nullptr, i, &res);
+    EXPECT_EQ(i < num_rounds ? 0 : 1, res.size()) << i;
+  }
+
+  disk_manager->ShutDown();
+  remove("test.db");
+  delete disk_manager;
+  delete bpm;
+}
+
+// NOLINTNEXTLINE
+TEST(LinearProbeHashTableTest, ConcurrentTest) {
+  auto *disk_manager = new DiskManager("test.db");
+  auto *bpm = new BufferPoolManagerInstance(50, disk_manager);
+  LinearProbeHashTable<int, int, IntComparator> ht("blah", bpm, IntComparator(), 10, HashFunction<int>());
+
+  // each thread inserts its own keys, reads them back, and removes the odd ones, while the table resizes around it
+  const int num_threads = 4;
+  const int scale = 10000;
+  std::vector<std::thread> threads;
+  for (int t = 0; t < num_threads; t++) {
+    threads.emplace_back([&ht, t] {
+      for (int i = t; i < scale * num_threads; i += num_threads) {
+        EXPECT_TRUE(ht.Insert(nullptr, i, i));
+        std::vector<int> res;
+        ht.GetValue(nullptr, i, &res);
+        EXPECT_EQ(1, res.size()) << "Failed to insert " << i;
+      }
+      for (int i = t; i < scale * num_threads; i += num_threads) {
+        if (i % 2 == 1) {
+          EXPECT_TRUE(ht.Remove(nullptr, i, i));
+        }
+      }
+    });
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+
+  for (int i = 0; i < scale * num_threads; i++) {
+    std::vector<int> res;
+    ht.GetValue(nullptr, i, &res);
+    if (i % 2 == 1) {
+      EXPECT_EQ(0, res.size()) << "Failed to remove " << i;
+    } else {
+      ASSERT_EQ(1, res.size()) << "Failed to keep " << i;
+      EXPECT_EQ(i, res[0]);
+    }
+  }
+
+  disk_manager->ShutDown();
+  remove("test.db");
+  delete disk_manager;
+  delete bpm;
+}
+
+}  // namespace bustub
@@ -10,6 +10,7 @@
 //
 //===----------------------------------------------------------------------===//
 
+#include <algorithm>
 #include <memory>
 #include <numeric>
 #include <string>
@@ -33,6 +34,7 @@
 #include "execution/plans/delete_plan.h"
 #include "execution/plans/distinct_plan.h"
 #include "execution/plans/hash_join_plan.h"
+#include "execution/plans/index_scan_plan.h"
 #include "execution/plans/limit_plan.h"
 #include "execution/plans/seq_scan_plan.h"
 #include "execution/plans/update_plan.h"
@@ -1410,6 +1412,69 @@ TEST_F(ExecutorTest, HashJoinTestTwo) {
   }
 }
 
+// SELECT t1.colA, t1.colB, t2.colA, t2.colB FROM test_1 t1 JOIN test_1 t2 ON t1.colB = t2.colB;
+TEST_F(ExecutorTest, HashJoinManyMatchesTest) {
+  const Schema *out_schema1;
+  std::unique_ptr<AbstractPlanNode> scan_plan1;
+  const Schema *out_schema2;
+  std::unique_ptr<AbstractPlanNode> scan_plan2;
+  {
+    auto table_info = GetExecutorContext()->GetCatalog()->GetTable("test_1");
+    auto &schema = table_info->schema_;
+    auto col_a = MakeColumnValueExpression(schema, 0, "colA");
+    auto col_b = MakeColumnValueExpression(schema, 0, "colB");
+    out_schema1 = MakeOutputSchema({{"colA", col_a}, {"colB", col_b}});
+    scan_plan1 = std::make_unique<SeqScanPlanNode>(out_schema1, nullptr, table_info->oid_);
+    out_schema2 = MakeOutputSchema({{"colA", col_a}, {"colB", col_b}});
+    scan_plan2 = std::make_unique<SeqScanPlanNode>(out_schema2, nullptr, table_info->oid_);
+  }
+
+  const Schema *out_final;
+  std::unique_ptr<HashJoinPlanNode> join_plan;
+  {
+    auto left_col_a = MakeColumnValueExpression(*out_schema1, 0, "colA");
+    auto left_col_b = MakeColumnValueExpression(*out_schema1, 0, "colB");
+    auto right_col_a = MakeColumnValueExpression(*out_schema2, 1, "colA");
+    auto right_col_b = MakeColumnValueExpression(*out_schema2, 1, "colB");
+    out_final = MakeOutputSchema({{"left_colA", left_col_a},
+                                  {"left_colB", left_col_b},
+                                  {"right_colA", right_col_a},
+                                  {"right_colB", right_col_b}});
+    join_plan = std::make_unique<HashJoinPlanNode>(
+        out_final, std::vector<const AbstractPlanNode *>{scan_plan1.get(), scan_plan2.get()}, left_col_b, right_col_b);
+  }
+
+  // colB only takes ten values, so every row matches about a tenth of the table, over several probe batches
+  std::vector<Tuple> scan_set;
+  GetExecutionEngine()->Execute(scan_plan1.get(), &scan_set, GetTxn(), GetExecutorContext());
+  ASSERT_EQ(TEST1_SIZE, scan_set.size());
+  std::vector<int32_t> col_b(TEST1_SIZE);
+  std::vector<size_t> rows_per_col_b(10, 0);
+  for (const auto &tuple : scan_set) {
+    auto col_a = tuple.GetValue(out_schema1, 0).GetAs<int32_t>();
+    col_b[col_a] = tuple.GetValue(out_schema1, 1).GetAs<int32_t>();
+    rows_per_col_b[col_b[col_a]]++;
+  }
+  size_t expected_size = 0;
+  for (auto rows : rows_per_col_b) {
+    expected_size += rows * rows;
+  }
+
+  std::vector<Tuple> result_set;
+  GetExecutionEngine()->Execute(join_plan.get(), &result_set, GetTxn(), GetExecutorContext());
+  ASSERT_EQ(expected_size, result_set.size());
+  std::vector<bool> seen(TEST1_SIZE * TEST1_SIZE, false);
+  for (const auto &tuple : result_set) {
+    auto left_col_a = tuple.GetValue(out_final, 0).GetAs<int32_t>();
+    auto right_col_a = tuple.GetValue(out_final, 2).GetAs<int32_t>();
+    ASSERT_EQ(col_b[left_col_a], tuple.GetValue(out_final, 1).GetAs<int32_t>());
+    ASSERT_EQ(col_b[right_col_a], tuple.GetValue(out_final, 3).GetAs<int32_t>());
+    ASSERT_EQ(col_b[left_col_a], col_b[right_col_a]);
+    ASSERT_FALSE(seen[left_col_a * TEST1_SIZE + right_col_a]) << left_col_a << " " << right_col_a;
+    seen[left_col_a * TEST1_SIZE + right_col_a] = true;
+  }
+}
+
 // SELECT COUNT(colA), SUM(colA), min(colA), max(colA) from test_1;
 TEST_F(ExecutorTest, SimpleAggregationTest) {
   const Schema *scan_schema;
@@ -1541,6 +1606,181 @@ TEST_F(ExecutorTest, SimpleLimitTest) {
   }
 }
 
+// SELECT colA, colB FROM test_1 WHERE colB < 5 ORDER BY colA DESC LIMIT 10, with a reverse index scan on colA
+TEST_F(ExecutorTest, ReverseIndexScanLimitTest) {
+  auto *table_info = GetExecutorContext()->GetCatalog()->GetTable("test_1");
+  auto &schema = table_info->schema_;
+  auto key_schema = ParseCreateStatement("colA int");
+  auto *index_info = GetExecutorContext()->GetCatalog()->CreateBPlusTreeIndex<KeyType, ValueType, ComparatorType>(
+      GetTxn(), "index1", "test_1", schema, *key_schema, {0}, 8);
+
+  auto *col_a = MakeColumnValueExpression(schema, 0, "colA");
+  auto *col_b = MakeColumnValueExpression(schema, 0, "colB");
+  auto *const5 = MakeConstantValueExpression(ValueFactory::GetIntegerValue(5));
+  auto *predicate = MakeComparisonExpression(col_b, const5, ComparisonType::LessThan);
+  auto *out_schema = MakeOutputSchema({{"colA", col_a}, {"colB", col_b}});
+
+  // The forward scan returns the qualifying tuples in ascending colA order
+  IndexScanPlanNode forward_plan{out_schema, predicate, index_info->index_oid_};
+  std::vector<Tuple> forward_set{};
+  GetExecutionEngine()->Execute(&forward_plan, &forward_set, GetTxn(), GetExecutorContext());
+  ASSERT_FALSE(forward_set.empty());
+  for (size_t i = 0; i < forward_set.size(); ++i) {
+    ASSERT_LT(forward_set[i].GetValue(out_schema, out_schema->GetColIdx("colB")).GetAs<int32_t>(), 5);
+    if (i > 0) {
+      ASSERT_LT(forward_set[i - 1].GetValue(out_schema, out_schema->GetColIdx("colA")).GetAs<int32_t>(),
+                forward_set[i].GetValue(out_schema, out_schema->GetColIdx("colA")).GetAs<int32_t>());
+    }
+  }
+
+  // The reverse scan under the limit returns the last ten of them, in descending order
+  IndexScanPlanNode reverse_plan{out_schema, predicate, index_info->index_oid_, true};
+  LimitPlanNode limit_plan{out_schema, &reverse_plan, 10};
+  std::vector<Tuple> result_set{};
+  GetExecutionEngine()->Execute(&limit_plan, &result_set, GetTxn(), GetExecutorContext());
+
+  ASSERT_EQ(result_set.size(), 10);
+  for (size_t i = 0; i < result_set.size(); ++i) {
+    auto &expected = forward_set[forward_set.size() - 1 - i];
+    ASSERT_EQ(result_set[i].GetValue(out_schema, out_schema->GetColIdx("colA")).GetAs<int32_t>(),
+              expected.GetValue(out_schema, out_schema->GetColIdx("colA")).GetAs<int32_t>());
+    ASSERT_EQ(result_set[i].GetValue(out_schema, out_schema->GetColIdx("colB")).GetAs<int32_t>(),
+              expected.GetValue(out_schema, out_schema->GetColIdx("colB")).GetAs<int32_t>());
+  }
+}
+
+// SELECT colA, colB FROM test_1 WHERE colA >= 100 AND colA < 200 AND colB < 5, with an index scan on colA
+TEST_F(ExecutorTest, RangeIndexScanTest) {
+  auto *table_info = GetExecutorContext()->GetCatalog()->GetTable("test_1");
+  auto &schema = table_info->schema_;
+  auto key_schema = ParseCreateStatement("colA int");
+  auto *index_info = GetExecutorContext()->GetCatalog()->CreateBPlusTreeIndex<KeyType, ValueType, ComparatorType>(
+      GetTxn(), "index1", "test_1", schema, *key_schema, {0}, 8);
+
+  auto *col_a = MakeColumnValueExpression(schema, 0, "colA");
+  auto *col_b = MakeColumnValueExpression(schema, 0, "colB");
+  auto *const100 = MakeConstantValueExpression(ValueFactory::GetIntegerValue(100));
+  auto *const200 = MakeConstantValueExpression(ValueFactory::GetIntegerValue(200));
+  auto *const5 = MakeConstantValueExpression(ValueFactory::GetIntegerValue(5));
+  // the lower bound is written with the constant first
+  auto *predicate = MakeLogicExpression(
+      MakeLogicExpression(MakeComparisonExpression(const100, col_a, ComparisonType::LessThanOrEqual),
+                          MakeComparisonExpression(col_a, const200, ComparisonType::LessThan), LogicType::And),
+      MakeComparisonExpression(col_b, const5, ComparisonType::LessThan), LogicType::And);
+  auto *out_schema = MakeOutputSchema({{"colA", col_a}, {"colB", col_b}});
+
+  SeqScanPlanNode seq_scan_plan{out_schema, predicate, table_info->oid_};
+  std::vector<Tuple> expected_set{};
+  GetExecutionEngine()->Execute(&seq_scan_plan, &expected_set, GetTxn(), GetExecutorContext());
+  std::sort(expected_set.begin(), expected_set.end(), [out_schema](const Tuple &lhs, const Tuple &rhs) {
+    return lhs.GetValue(out_schema, 0).GetAs<int32_t>() < rhs.GetValue(out_schema, 0).GetAs<int32_t>();
+  });
+  ASSERT_FALSE(expected_set.empty());
+
+  for (bool reverse : {false, true}) {
+    IndexScanPlanNode index_scan_plan{out_schema, predicate, index_info->index_oid_, reverse};
+    std::vector<Tuple> result_set{};
+    GetExecutionEngine()->Execute(&index_scan_plan, &result_set, GetTxn(), GetExecutorContext());
+    if (reverse) {
+      std::reverse(result_set.begin(), result_set.end());
+    }
+    ASSERT_EQ(result_set.size(), expected_set.size());
+    for (size_t i = 0; i < result_set.size(); ++i) {
+      ASSERT_EQ(result_set[i].GetValue(out_schema, 0).GetAs<int32_t>(),
+                expected_set[i].GetValue(out_schema, 0).GetAs<int32_t>());
+      ASSERT_EQ(result_set[i].GetValue(out_schema, 1).GetAs<int32_t>(),
+                expected_set[i].GetValue(out_schema, 1).GetAs<int32_t>());
+    }
+  }
+}
+
+// SELECT colA, colB FROM test_1 WHERE colB = 3 AND colA > 900, with an index scan on (colB, colA)
+TEST_F(ExecutorTest, PrefixIndexScanTest) {
+  auto *table_info = GetExecutorContext()->GetCatalog()->GetTable("test_1");
+  auto &schema = table_info->schema_;
+  auto key_schema = ParseCreateStatement("colB int,colA int");
+  auto *index_info = GetExecutorContext()->GetCatalog()->CreateBPlusTreeIndex<KeyType, ValueType, ComparatorType>(
+      GetTxn(), "index1", "test_1", schema, *key_schema, {1, 0}, 8);
+
+  auto *col_a = MakeColumnValueExpression(schema, 0, "colA");
+  auto *col_b = MakeColumnValueExpression(schema, 0, "colB");
+  auto *const900 = MakeConstantValueExpression(ValueFactory::GetIntegerValue(900));
+  auto *const3 = MakeConstantValueExpression(ValueFactory::GetIntegerValue(3));
+  auto *predicate = MakeLogicExpression(MakeComparisonExpression(col_b, const3, ComparisonType::Equal),
+                                        MakeComparisonExpression(col_a, const900, ComparisonType::GreaterThan),
+                                        LogicType::And);
+  auto *out_schema = MakeOutputSchema({{"colA", col_a}, {"colB", col_b}});
+
+  SeqScanPlanNode seq_scan_plan{out_schema, predicate, table_info->oid_};
+  std::vector<Tuple> expected_set{};
+  GetExecutionEngine()->Execute(&seq_scan_plan, &expected_set, GetTxn(), GetExecutorContext());
+
+  IndexScanPlanNode index_scan_plan{out_schema, predicate, index_info->index_oid_};
+  std::vector<Tuple> result_set{};
+  GetExecutionEngine()->Execute(&index_scan_plan, &result_set, GetTxn(), GetExecutorContext());
+
+  // both scans return the tuples in colA order, the table's order being that of colA as well
+  ASSERT_EQ(result_set.size(), expected_set.size());
+  for (size_t i = 0; i < result_set.size(); ++i) {
+    ASSERT_EQ(result_set[i].GetValue(out_schema, 0).GetAs<int32_t>(),
+              expected_set[i].GetValue(out_schema, 0).GetAs<int32_t>());
+    ASSERT_EQ(result_set[i].GetValue(out_schema, 1).GetAs<int32_t>(), 3);
+  }
+}
+
+// SELECT colA, colB FROM test_1 WHERE colB = 3, answered from an index on (colB, colA) alone
+TEST_F(ExecutorTest, IndexOnlyScanTest) {
+  auto *table_info = GetExecutorContext()->GetCatalog()->GetTable("test_1");
+  auto &schema = table_info->schema_;
+  auto key_schema = ParseCreateStatement("colB int,colA int");
+  auto *index_info = GetExecutorContext()->GetCatalog()->CreateBPlusTreeIndex<KeyType, ValueType, ComparatorType>(
+      GetTxn(), "index1", "test_1", schema, *key_schema, {1, 0}, 8);
+
+  // Change colB of the matching tuples in the table heap, but not in the index: only a scan that reads the heap sees
+  // the change.
+  std::vector<std::pair<RID, int32_t>> expected;
+  for (auto iter = table_info->table_->Begin(GetTxn()); iter != table_info->table_->End(); ++iter) {
+    if (iter->GetValue(&schema, 1).GetAs<int32_t>() == 3) {
+      expected.emplace_back(iter->GetRid(), iter->GetValue(&schema, 0).GetAs<int32_t>());
+    }
+  }
+  ASSERT_FALSE(expected.empty());
+  for (const auto &[rid, col_a] : expected) {
+    Tuple old_tuple;
+    ASSERT_TRUE(table_info->table_->GetTuple(rid, &old_tuple, GetTxn()));
+    std::vector<Value> values{ValueFactory::GetIntegerValue(col_a), ValueFactory::GetIntegerValue(4),
+                              old_tuple.GetValue(&schema, 2), old_tuple.GetValue(&schema, 3)};
+    ASSERT_TRUE(table_info->table_->UpdateTuple(Tuple(values, &schema), rid, GetTxn()));
+  }
+
+  auto *col_a = MakeColumnValueExpression(schema, 0, "colA");
+  auto *col_b = MakeColumnValueExpression(schema, 0, "colB");
+  auto *col_c = MakeColumnValueExpression(schema, 0, "colC");
+  auto *const3 = MakeConstantValueExpression(ValueFactory::GetIntegerValue(3));
+  auto *predicate = MakeComparisonExpression(col_b, const3, ComparisonType::Equal);
+
+  // The index covers colA and colB, so the rows come from the keys
+  auto *out_schema = MakeOutputSchema({{"colA", col_a}, {"colB", col_b}});
+  IndexScanPlanNode covered_plan{out_schema, predicate, index_info->index_oid_};
+  std::vector<Tuple> result_set{};
+  GetExecutionEngine()->Execute(&covered_plan, &result_set, GetTxn(), GetExecutorContext());
+  ASSERT_EQ(result_set.size(), expected.size());
+  for (size_t i = 0; i < result_set.size(); ++i) {
+    ASSERT_EQ(result_set[i].GetValue(out_schema, 0).GetAs<int32_t>(), expected[i].second);
+    ASSERT_EQ(result_set[i].GetValue(out_schema, 1).GetAs<int32_t>(), 3);
+  }
+
+  // colC is not in the index, so the rows come from the heap
+  auto *wide_schema = MakeOutputSchema({{"colA", col_a}, {"colB", col_b}, {"colC", col_c}});
+  IndexScanPlanNode uncovered_plan{wide_schema, predicate, index_info->index_oid_};
+  result_set.clear();
+  GetExecutionEngine()->Execute(&uncovered_plan, &result_set, GetTxn(), GetExecutorContext());
+  ASSERT_EQ(result_set.size(), expected.size());
+  for (auto &tuple : result_set) {
+    ASSERT_EQ(tuple.GetValue(wide_schema, 1).GetAs<int32_t>(), 4);
+  }
+}
+
 // SELECT DISTINCT colC FROM test_7
 TEST_F(ExecutorTest, SimpleDistinctTest) {
   auto *table_info = GetExecutorContext()->GetCatalog()->GetTable("test_7");
@@ -0,0 +1,261 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// log_manager_test.cpp
+//
+// Identification: test/recovery/log_manager_test.cpp
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <algorithm>
+#include <cstring>
+#include <random>
+#include <string>
+#include <thread>  // NOLINT
+#include <vector>
+
+#include "concurrency/transaction_manager.h"
+#include "gtest/gtest.h"
+#include "recovery/log_compression.h"
+#include "recovery/log_manager.h"
+#include "recovery/log_recovery.h"
+#include "type/value_factory.h"
+
+namespace bustub {
+
+class LogManagerTest : public ::testing::Test {
+ protected:
+  // This function is called before every test.
+  void SetUp() override {
+    remove("test.db");
+    remove("test.log");
+  }
+
+  // This function is called after every test.
+  void TearDown() override {
+    enable_logging = false;
+    log_compression = false;
+    remove("test.db");
+    remove("test.log");
+  };
+};
+
+// NOLINTNEXTLINE
+TEST_F(LogManagerTest, ConcurrentAppendTest) {
+  const int num_threads = 8;
+  const int records_per_thread = 4000;
+  auto *disk_manager = new DiskManager("test.db");
+  auto *log_manager = new LogManager(disk_manager);
+  log_manager->RunFlushThread();
+  ASSERT_TRUE(enable_logging);
+
+  // Scenario: many appenders overflow the log buffer many times over. Every record gets its own LSN.
+  std::vector<std::vector<lsn_t>> lsns(num_threads);
+  std::vector<std::thread> threads;
+  for (int t = 0; t < num_threads; t++) {
+    threads.emplace_back([&, t] {
+      for (int i = 0; i < records_per_thread; i++) {
+        LogRecord log_record(t, INVALID_LSN, LogRecordType::NEWPAGE, t, i);
+        lsns[t].push_back(log_manager->AppendLogRecord(&log_record));
+      }
+    });
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+  std::vector<lsn_t> all_lsns;
+  for (auto &thread_lsns : lsns) {
+    EXPECT_TRUE(std::is_sorted(thread_lsns.begin(), thread_lsns.end()));
+    all_lsns.insert(all_lsns.end(), thread_lsns.begin(), thread_lsns.end());
+  }
+  std::sort(all_lsns.begin(), all_lsns.end());
+  for (size_t i = 0; i < all_lsns.size(); i++) {
+    ASSERT_EQ(static_cast<lsn_t>(i), all_lsns[i]);
+  }
+
+  // Scenario: a forced flush makes everything persistent.
+  lsn_t last_lsn = num_threads * records_per_thread - 1;
+  log_manager->Flush(last_lsn);
+  EXPECT_EQ(last_lsn, log_manager->GetPersistentLSN());
+  log_manager->StopFlushThread();
+  EXPECT_FALSE(enable_logging);
+
+  // Scenario: the log file holds the records in LSN order, each at the offset its predecessor ends.
+  char header[20];
+  int offset = 0;
+  for (lsn_t lsn = 0; lsn <= last_lsn; lsn++) {
+    ASSERT_TRUE(disk_manager->ReadLog(header, sizeof(header), offset));
+    int32_t size;
+    lsn_t record_lsn;
+    memcpy(&size, header, sizeof(size));
+    memcpy(&record_lsn, header + 4, sizeof(record_lsn));
+    ASSERT_EQ(lsn, record_lsn);
+    ASSERT_EQ(28, size);
+    offset += size;
+  }
+  EXPECT_FALSE(disk_manager->ReadLog(header, sizeof(header), offset));
+
+  disk_manager->ShutDown();
+  delete log_manager;
+  delete disk_manager;
+}
+
+// NOLINTNEXTLINE
+TEST_F(LogManagerTest, GroupCommitTest) {
+  const int num_threads = 16;
+  const int txns_per_thread = 50;
+  auto *disk_manager = new DiskManager("test.db");
+  auto *log_manager = new LogManager(disk_manager);
+  TransactionManager txn_manager(nullptr, log_manager);
+  log_manager->RunFlushThread();
+
+  // Scenario: every commit is durable when Commit returns, and concurrent commits share log flushes.
+  std::vector<std::thread> threads;
+  for (int t = 0; t < num_threads; t++) {
+    threads.emplace_back([&] {
+      for (int i = 0; i < txns_per_thread; i++) {
+        Transaction *txn = txn_manager.Begin();
+        txn_manager.Commit(txn);
+        EXPECT_LE(txn->GetPrevLSN(), log_manager->GetPersistentLSN());
+        delete txn;
+      }
+    });
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+  EXPECT_EQ(2 * num_threads * txns_per_thread - 1, log_manager->GetPersistentLSN());
+  EXPECT_LT(disk_manager->GetNumFlushes(), num_threads * txns_per_thread);
+
+  log_manager->StopFlushThread();
+  disk_manager->ShutDown();
+  delete log_manager;
+  delete disk_manager;
+}
+
+// NOLINTNEXTLINE
+TEST_F(LogManagerTest, UpdateDeltaTest) {
+  Schema schema{std::vector<Column>{
+      {"id", TypeId::INTEGER}, {"balance", TypeId::BIGINT}, {"payload", TypeId::VARCHAR, 200}}};
+  auto make_tuple = [&](int64_t balance, const std::string &payload) {
+    return Tuple({ValueFactory::GetIntegerValue(7), ValueFactory::GetBigIntValue(balance),
+                  ValueFactory::GetVarcharValue(payload)},
+                 &schema);
+  };
+  Tuple old_tuple = make_tuple(100, std::string(200, 'x'));
+  RID rid(3, 5);
+
+  // Scenario: changing one column of a wide tuple logs only the bytes that differ.
+  Tuple new_tuple = make_tuple(101, std::string(200, 'x'));
+  LogRecord delta(1, INVALID_LSN, LogRecordType::UPDATE, rid, old_tuple, new_tuple);
+  ASSERT_EQ(LogRecordType::UPDATE_DELTA, delta.GetLogRecordType());
+  ASSERT_EQ(1, delta.GetUpdateRanges().size());
+  EXPECT_EQ(4, delta.GetUpdateRanges()[0].first);
+  EXPECT_EQ(1, delta.GetUpdateRanges()[0].second);
+  LogRecord full_size(1, INVALID_LSN, LogRecordType::UPDATE, rid, old_tuple, make_tuple(100, std::string(199, 'x')));
+  EXPECT_EQ(LogRecordType::UPDATE, full_size.GetLogRecordType());
+  EXPECT_LT(delta.GetSize() * 10, full_size.GetSize());
+
+  // Scenario: nearby changes share a range.
+  std::string payload(200, 'x');
+  payload[10] = 'a';
+  payload[12] = 'b';
+  payload[100] = 'c';
+  LogRecord ranges(1, INVALID_LSN, LogRecordType::UPDATE, rid, old_tuple, make_tuple(100, payload));
+  ASSERT_EQ(LogRecordType::UPDATE_DELTA, ranges.GetLogRecordType());
+  EXPECT_EQ(2, ranges.GetUpdateRanges().size());
+
+  // Scenario: the delta survives the log file.
+  auto *disk_manager = new DiskManager("test.db");
+  auto *log_manager = new LogManager(disk_manager);
+  log_manager->RunFlushThread();
+  lsn_t lsn = log_manager->AppendLogRecord(&ranges);
+  log_manager->Flush(lsn);
+  log_manager->StopFlushThread();
+  std::vector<char> buf(ranges.GetSize());
+  ASSERT_TRUE(disk_manager->ReadLog(buf.data(), ranges.GetSize(), 0));
+  LogRecovery log_recovery(disk_manager, nullptr);
+  LogRecord read;
+  ASSERT_TRUE(log_recovery.DeserializeLogRecord(buf.data(), ranges.GetSize(), &read));
+  EXPECT_EQ(LogRecordType::UPDATE_DELTA, read.GetLogRecordType());
+  EXPECT_EQ(rid, read.GetUpdateRID());
+  EXPECT_EQ(ranges.GetUpdateRanges(), read.GetUpdateRanges());
+  // A torn record is not mistaken for a complete one.
+  EXPECT_FALSE(log_recovery.DeserializeLogRecord(buf.data(), ranges.GetSize() - 1, &read));
+
+  disk_manager->ShutDown();
+  delete log_manager;
+  delete disk_manager;
+}
+
+// NOLINTNEXTLINE
+TEST_F(LogManagerTest, CompressionTest) {
+  std::vector<char> raw(LOG_BUFFER_SIZE);
+  std::vector<char> block(LOG_BUFFER_SIZE);
+  std::vector<char> out(LOG_BUFFER_SIZE);
+  int size;
+
+  // Scenario: random bytes do not compress, repetitive ones do and come back unchanged.
+  std::mt19937 rng(42);
+  for (auto &byte : raw) {
+    byte = static_cast<char>(rng());
+  }
+  EXPECT_EQ(0, LogCompression::CompressBlock(raw.data(), LOG_BUFFER_SIZE, block.data()));
+  for (int i = 0; i < LOG_BUFFER_SIZE; i++) {
+    raw[i] = i % 100 < 60 ? 'x' : static_cast<char>(rng() % 4);
+  }
+  int block_size = LogCompression::CompressBlock(raw.data(), LOG_BUFFER_SIZE, block.data());
+  ASSERT_GT(block_size, 0);
+  EXPECT_LT(block_size, LOG_BUFFER_SIZE / 2);
+  ASSERT_TRUE(LogCompression::IsBlock(block.data(), block_size));
+  EXPECT_EQ(0, LogCompression::DecompressBlock(block.data(), block_size - 1, out.data(), &size));
+  ASSERT_EQ(block_size, LogCompression::DecompressBlock(block.data(), block_size, out.data(), &size));
+  ASSERT_EQ(LOG_BUFFER_SIZE, size);
+  EXPECT_EQ(0, memcmp(raw.data(), out.data(), size));
+  // A block that does not decompress to the size in its header is rejected.
+  int32_t wrong_size = LOG_BUFFER_SIZE - 1;
+  memcpy(block.data() + 2 * sizeof(int32_t), &wrong_size, sizeof(wrong_size));
+  EXPECT_EQ(-1, LogCompression::DecompressBlock(block.data(), block_size, out.data(), &size));
+
+  // Scenario: with compression on, the log is shorter and still holds every record in order.
+  log_compression = true;
+  auto *disk_manager = new DiskManager("test.db");
+  auto *log_manager = new LogManager(disk_manager);
+  log_manager->RunFlushThread();
+  const int num_records = 20000;
+  int raw_size = 0;
+  for (int i = 0; i < num_records; i++) {
+    LogRecord log_record(i % 8, INVALID_LSN, LogRecordType::NEWPAGE, i % 8, i);
+    raw_size += log_record.GetSize();
+    log_manager->AppendLogRecord(&log_record);
+  }
+  log_manager->StopFlushThread();
+  int log_size = disk_manager->GetLogSize();
+  EXPECT_LT(log_size, raw_size / 2);
+
+  std::vector<char> log(log_size);
+  ASSERT_TRUE(disk_manager->ReadLog(log.data(), log_size, 0));
+  LogRecovery log_recovery(disk_manager, nullptr);
+  LogRecord log_record;
+  lsn_t next_lsn = 0;
+  for (int offset = 0; offset < log_size;) {
+    ASSERT_TRUE(LogCompression::IsBlock(log.data() + offset, log_size - offset));
+    block_size = LogCompression::DecompressBlock(log.data() + offset, log_size - offset, out.data(), &size);
+    ASSERT_GT(block_size, 0);
+    for (int pos = 0; pos < size; pos += log_record.GetSize()) {
+      ASSERT_TRUE(log_recovery.DeserializeLogRecord(out.data() + pos, size - pos, &log_record));
+      ASSERT_EQ(next_lsn++, log_record.GetLSN());
+    }
+    offset += block_size;
+  }
+  EXPECT_EQ(num_records, next_lsn);
+
+  disk_manager->ShutDown();
+  delete log_manager;
+  delete disk_manager;
+}
+
+}  // namespace bustub
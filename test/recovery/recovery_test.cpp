@@ -10,7 +10,10 @@
 //
 //===----------------------------------------------------------------------===//
 
+#include <algorithm>
 #include <string>
+#include <thread>  // NOLINT
+#include <utility>
 #include <vector>
 
 #include "common/bustub_instance.h"
@@ -19,10 +22,12 @@
 #include "concurrency/transaction_manager.h"
 #include "gtest/gtest.h"
 #include "logging/common.h"
+#include "recovery/log_compression.h"
 #include "recovery/log_recovery.h"
 #include "storage/table/table_heap.h"
 #include "storage/table/table_iterator.h"
 #include "storage/table/tuple.h"
+#include "type/value_factory.h"
 
 namespace bustub {
 
@@ -32,18 +37,21 @@ class RecoveryTest : public ::testing::Test {
   void SetUp() override {
     remove("test.db");
     remove("test.log");
+    remove("test.master");
   }
 
   // This function is called after every test.
   void TearDown() override {
     LOG_INFO("Tearing down the system..");
+    log_compression = false;
     remove("test.db");
     remove("test.log");
+    remove("test.master");
   };
 };
 
 // NOLINTNEXTLINE
-TEST_F(RecoveryTest, DISABLED_RedoTest) {
+TEST_F(RecoveryTest, RedoTest) {
   BustubInstance *bustub_instance = new BustubInstance("test.db");
 
   ASSERT_FALSE(enable_logging);
@@ -132,7 +140,7 @@ TEST_F(RecoveryTest, DISABLED_RedoTest) {
 }
 
 // NOLINTNEXTLINE
-TEST_F(RecoveryTest, DISABLED_UndoTest) {
+TEST_F(RecoveryTest, UndoTest) {
   BustubInstance *bustub_instance = new BustubInstance("test.db");
 
   ASSERT_FALSE(enable_logging);
@@ -211,7 +219,81 @@ TEST_F(RecoveryTest, DISABLED_UndoTest) {
 }
 
 // NOLINTNEXTLINE
-TEST_F(RecoveryTest, DISABLED_CheckpointTest) {
+TEST_F(RecoveryTest, ParallelRedoUndoTest) {
+  const int num_txns = 40;
+  const int tuples_per_txn = 50;
+  BustubInstance *bustub_instance = new BustubInstance("test.db");
+  bustub_instance->log_manager_->RunFlushThread();
+
+  Transaction *txn = bustub_instance->transaction_manager_->Begin();
+  auto *test_table = new TableHeap(bustub_instance->buffer_pool_manager_, bustub_instance->lock_manager_,
+                                   bustub_instance->log_manager_, txn);
+  page_id_t first_page_id = test_table->GetFirstPageId();
+  bustub_instance->transaction_manager_->Commit(txn);
+  delete txn;
+
+  // Scenario: spread many transactions over many more pages than the buffer pool holds. Every other transaction is
+  // still running at the crash.
+  Schema schema{std::vector<Column>{{"id", TypeId::INTEGER}, {"payload", TypeId::VARCHAR, 40}}};
+  std::vector<std::pair<RID, int32_t>> committed;
+  std::vector<RID> uncommitted;
+  std::vector<Transaction *> losers;
+  for (int i = 0; i < num_txns; i++) {
+    txn = bustub_instance->transaction_manager_->Begin();
+    for (int j = 0; j < tuples_per_txn; j++) {
+      int32_t id = i * tuples_per_txn + j;
+      Tuple tuple({ValueFactory::GetIntegerValue(id), ValueFactory::GetVarcharValue(std::string(40, 'a' + i % 26))},
+                  &schema);
+      RID rid;
+      ASSERT_TRUE(test_table->InsertTuple(tuple, &rid, txn));
+      if (i % 2 == 0) {
+        committed.emplace_back(rid, id);
+      } else {
+        uncommitted.push_back(rid);
+      }
+    }
+    if (i % 2 == 0) {
+      bustub_instance->transaction_manager_->Commit(txn);
+      delete txn;
+    } else {
+      losers.push_back(txn);
+    }
+  }
+  ASSERT_GT(bustub_instance->disk_manager_->GetNumWrites(), 0);
+
+  LOG_INFO("System crash with running transactions");
+  delete test_table;
+  delete bustub_instance;
+  for (auto *loser : losers) {
+    delete loser;
+  }
+
+  // Scenario: recover with several redo and undo threads.
+  bustub_instance = new BustubInstance("test.db");
+  LogRecovery log_recovery(bustub_instance->disk_manager_, bustub_instance->buffer_pool_manager_, 4);
+  log_recovery.Redo();
+  log_recovery.Undo();
+
+  txn = bustub_instance->transaction_manager_->Begin();
+  test_table = new TableHeap(bustub_instance->buffer_pool_manager_, bustub_instance->lock_manager_,
+                             bustub_instance->log_manager_, first_page_id);
+  Tuple tuple;
+  for (auto &[rid, id] : committed) {
+    ASSERT_TRUE(test_table->GetTuple(rid, &tuple, txn));
+    EXPECT_EQ(id, tuple.GetValue(&schema, 0).GetAs<int32_t>());
+  }
+  for (auto &rid : uncommitted) {
+    EXPECT_FALSE(test_table->GetTuple(rid, &tuple, txn));
+  }
+  bustub_instance->transaction_manager_->Commit(txn);
+
+  delete txn;
+  delete test_table;
+  delete bustub_instance;
+}
+
+// NOLINTNEXTLINE
+TEST_F(RecoveryTest, CheckpointTest) {
   BustubInstance *bustub_instance = new BustubInstance("test.db");
 
   EXPECT_FALSE(enable_logging);
@@ -314,4 +396,258 @@ TEST_F(RecoveryTest, DISABLED_CheckpointTest) {
   LOG_INFO("Shutdown System");
   delete bustub_instance;
 }
+
+// NOLINTNEXTLINE
+TEST_F(RecoveryTest, FuzzyCheckpointTest) {
+  BustubInstance *bustub_instance = new BustubInstance("test.db");
+  bustub_instance->log_manager_->RunFlushThread();
+
+  Transaction *txn = bustub_instance->transaction_manager_->Begin();
+  auto *test_table = new TableHeap(bustub_instance->buffer_pool_manager_, bustub_instance->lock_manager_,
+                                   bustub_instance->log_manager_, txn);
+  page_id_t first_page_id = test_table->GetFirstPageId();
+  bustub_instance->transaction_manager_->Commit(txn);
+  delete txn;
+
+  Schema schema{std::vector<Column>{{"id", TypeId::INTEGER}, {"payload", TypeId::VARCHAR, 40}}};
+  std::vector<std::pair<RID, int32_t>> committed;
+  std::vector<RID> uncommitted;
+  auto insert = [&](Transaction *txn, int32_t id, bool commits) {
+    Tuple tuple({ValueFactory::GetIntegerValue(id), ValueFactory::GetVarcharValue(std::string(40, 'x'))}, &schema);
+    RID rid;
+    ASSERT_TRUE(test_table->InsertTuple(tuple, &rid, txn));
+    if (commits) {
+      committed.emplace_back(rid, id);
+    } else {
+      uncommitted.push_back(rid);
+    }
+  };
+
+  // Scenario: a transaction commits before the checkpoint, and a loser transaction spans it.
+  txn = bustub_instance->transaction_manager_->Begin();
+  for (int32_t id = 0; id < 200; id++) {
+    insert(txn, id, true);
+  }
+  bustub_instance->transaction_manager_->Commit(txn);
+  delete txn;
+  Transaction *loser = bustub_instance->transaction_manager_->Begin();
+  for (int32_t id = 1000; id < 1050; id++) {
+    insert(loser, id, false);
+  }
+
+  // Scenario: a writer keeps inserting while the checkpoint runs; it is never blocked for the whole checkpoint.
+  std::vector<std::pair<RID, int32_t>> writer_committed;
+  std::thread writer([&] {
+    Transaction *writer_txn = bustub_instance->transaction_manager_->Begin();
+    for (int32_t id = 2000; id < 2200; id++) {
+      Tuple tuple({ValueFactory::GetIntegerValue(id), ValueFactory::GetVarcharValue(std::string(40, 'y'))}, &schema);
+      RID rid;
+      ASSERT_TRUE(test_table->InsertTuple(tuple, &rid, writer_txn));
+      writer_committed.emplace_back(rid, id);
+    }
+    bustub_instance->transaction_manager_->Commit(writer_txn);
+    delete writer_txn;
+  });
+  bustub_instance->checkpoint_manager_->BeginCheckpoint();
+  bustub_instance->checkpoint_manager_->EndCheckpoint();
+  writer.join();
+  committed.insert(committed.end(), writer_committed.begin(), writer_committed.end());
+
+  // Scenario: more work after the checkpoint, then a crash with the loser still running.
+  txn = bustub_instance->transaction_manager_->Begin();
+  for (int32_t id = 3000; id < 3100; id++) {
+    insert(txn, id, true);
+  }
+  bustub_instance->transaction_manager_->Commit(txn);
+  delete txn;
+  for (int32_t id = 1050; id < 1070; id++) {
+    insert(loser, id, false);
+  }
+
+  // The checkpoint lets recovery skip the head of the log, and it knows the loser was running.
+  LogRecord checkpoint;
+  LogRecovery reader(bustub_instance->disk_manager_, bustub_instance->buffer_pool_manager_);
+  ASSERT_TRUE(reader.ReadCheckpoint(&checkpoint));
+  ASSERT_EQ(LogRecordType::END_CHECKPOINT, checkpoint.GetLogRecordType());
+  EXPECT_GT(checkpoint.GetRedoOffset(), 0);
+  EXPECT_TRUE(checkpoint.HasCheckpointTables());
+  auto &active_txns = checkpoint.GetActiveTxns();
+  EXPECT_TRUE(std::any_of(active_txns.begin(), active_txns.end(),
+                          [&](const auto &entry) { return entry.first == loser->GetTransactionId(); }));
+
+  LOG_INFO("System crash with a running transaction");
+  delete test_table;
+  delete bustub_instance;
+  delete loser;
+
+  bustub_instance = new BustubInstance("test.db");
+  LogRecovery log_recovery(bustub_instance->disk_manager_, bustub_instance->buffer_pool_manager_);
+  log_recovery.Redo();
+  log_recovery.Undo();
+
+  txn = bustub_instance->transaction_manager_->Begin();
+  test_table = new TableHeap(bustub_instance->buffer_pool_manager_, bustub_instance->lock_manager_,
+                             bustub_instance->log_manager_, first_page_id);
+  Tuple tuple;
+  for (auto &[rid, id] : committed) {
+    ASSERT_TRUE(test_table->GetTuple(rid, &tuple, txn));
+    EXPECT_EQ(id, tuple.GetValue(&schema, 0).GetAs<int32_t>());
+  }
+  for (auto &rid : uncommitted) {
+    EXPECT_FALSE(test_table->GetTuple(rid, &tuple, txn));
+  }
+  bustub_instance->transaction_manager_->Commit(txn);
+
+  delete txn;
+  delete test_table;
+  delete bustub_instance;
+}
+
+// NOLINTNEXTLINE
+TEST_F(RecoveryTest, CompressedDeltaUpdateTest) {
+  const int num_tuples = 200;
+  log_compression = true;
+  BustubInstance *bustub_instance = new BustubInstance("test.db");
+  bustub_instance->log_manager_->RunFlushThread();
+
+  Transaction *txn = bustub_instance->transaction_manager_->Begin();
+  auto *test_table = new TableHeap(bustub_instance->buffer_pool_manager_, bustub_instance->lock_manager_,
+                                   bustub_instance->log_manager_, txn);
+  page_id_t first_page_id = test_table->GetFirstPageId();
+  Schema schema{std::vector<Column>{
+      {"id", TypeId::INTEGER}, {"balance", TypeId::INTEGER}, {"payload", TypeId::VARCHAR, 100}}};
+  auto make_tuple = [&](int32_t id, int32_t balance, char fill) {
+    return Tuple({ValueFactory::GetIntegerValue(id), ValueFactory::GetIntegerValue(balance),
+                  ValueFactory::GetVarcharValue(std::string(100, fill))},
+                 &schema);
+  };
+  std::vector<RID> rids(num_tuples);
+  for (int32_t id = 0; id < num_tuples; id++) {
+    ASSERT_TRUE(test_table->InsertTuple(make_tuple(id, id, 'x'), &rids[id], txn));
+  }
+  bustub_instance->transaction_manager_->Commit(txn);
+  delete txn;
+
+  // Scenario: a committed transaction changes one column of the even tuples, which logs only the changed bytes, and a
+  // shorter payload for tuple 0, which logs both tuples in full. A loser changes the odd tuples.
+  txn = bustub_instance->transaction_manager_->Begin();
+  for (int32_t id = 0; id < num_tuples; id += 2) {
+    ASSERT_TRUE(test_table->UpdateTuple(make_tuple(id, id * 10, 'x'), rids[id], txn));
+  }
+  Tuple short_tuple({ValueFactory::GetIntegerValue(0), ValueFactory::GetIntegerValue(0),
+                     ValueFactory::GetVarcharValue(std::string(10, 'z'))},
+                    &schema);
+  ASSERT_TRUE(test_table->UpdateTuple(short_tuple, rids[0], txn));
+  bustub_instance->transaction_manager_->Commit(txn);
+  delete txn;
+  Transaction *loser = bustub_instance->transaction_manager_->Begin();
+  for (int32_t id = 1; id < num_tuples; id += 2) {
+    ASSERT_TRUE(test_table->UpdateTuple(make_tuple(id, -1, 'x'), rids[id], loser));
+  }
+  bustub_instance->log_manager_->Flush(loser->GetPrevLSN());
+
+  // The repetitive log buffers are written as compressed blocks.
+  char header[LogCompression::LOG_BLOCK_HEADER_SIZE];
+  ASSERT_TRUE(bustub_instance->disk_manager_->ReadLog(header, sizeof(header), 0));
+  EXPECT_TRUE(LogCompression::IsBlock(header, sizeof(header)));
+
+  LOG_INFO("System crash with a running transaction");
+  delete test_table;
+  delete bustub_instance;
+  delete loser;
+
+  bustub_instance = new BustubInstance("test.db");
+  LogRecovery log_recovery(bustub_instance->disk_manager_, bustub_instance->buffer_pool_manager_);
+  log_recovery.Redo();
+  log_recovery.Undo();
+
+  txn = bustub_instance->transaction_manager_->Begin();
+  test_table = new TableHeap(bustub_instance->buffer_pool_manager_, bustub_instance->lock_manager_,
+                             bustub_instance->log_manager_, first_page_id);
+  Tuple tuple;
+  for (int32_t id = 0; id < num_tuples; id++) {
+    ASSERT_TRUE(test_table->GetTuple(rids[id], &tuple, txn));
+    EXPECT_EQ(id, tuple.GetValue(&schema, 0).GetAs<int32_t>());
+    EXPECT_EQ(id % 2 == 0 ? id * 10 : id, tuple.GetValue(&schema, 1).GetAs<int32_t>());
+  }
+  ASSERT_TRUE(test_table->GetTuple(rids[0], &tuple, txn));
+  EXPECT_EQ(std::string(10, 'z'), tuple.GetValue(&schema, 2).ToString());
+  bustub_instance->transaction_manager_->Commit(txn);
+
+  delete txn;
+  delete test_table;
+  delete bustub_instance;
+}
+
+// NOLINTNEXTLINE
+TEST_F(RecoveryTest, LogSegmentRecyclingTest) {
+  const int64_t segment_size = 16 * 1024;
+  BustubInstance *bustub_instance = new BustubInstance("test.db", segment_size);
+  bustub_instance->log_manager_->RunFlushThread();
+
+  Transaction *txn = bustub_instance->transaction_manager_->Begin();
+  auto *test_table = new TableHeap(bustub_instance->buffer_pool_manager_, bustub_instance->lock_manager_,
+                                   bustub_instance->log_manager_, txn);
+  page_id_t first_page_id = test_table->GetFirstPageId();
+  bustub_instance->transaction_manager_->Commit(txn);
+  delete txn;
+
+  // Scenario: checkpoints between rounds of committed inserts let the head of the log be recycled.
+  Schema schema{std::vector<Column>{{"id", TypeId::INTEGER}, {"payload", TypeId::VARCHAR, 40}}};
+  std::vector<std::pair<RID, int32_t>> committed;
+  for (int32_t round = 0; round < 8; round++) {
+    txn = bustub_instance->transaction_manager_->Begin();
+    for (int32_t id = round * 100; id < (round + 1) * 100; id++) {
+      Tuple tuple({ValueFactory::GetIntegerValue(id), ValueFactory::GetVarcharValue(std::string(40, 'x'))}, &schema);
+      RID rid;
+      ASSERT_TRUE(test_table->InsertTuple(tuple, &rid, txn));
+      committed.emplace_back(rid, id);
+    }
+    bustub_instance->transaction_manager_->Commit(txn);
+    delete txn;
+    bustub_instance->checkpoint_manager_->BeginCheckpoint();
+    bustub_instance->checkpoint_manager_->EndCheckpoint();
+  }
+  EXPECT_GT(bustub_instance->disk_manager_->GetLogStart(), 0);
+  EXPECT_GT(bustub_instance->disk_manager_->GetLogSize(), 4 * segment_size);
+
+  // Scenario: a loser transaction is running at the crash.
+  Transaction *loser = bustub_instance->transaction_manager_->Begin();
+  std::vector<RID> uncommitted;
+  for (int32_t id = 10000; id < 10050; id++) {
+    Tuple tuple({ValueFactory::GetIntegerValue(id), ValueFactory::GetVarcharValue(std::string(40, 'y'))}, &schema);
+    RID rid;
+    ASSERT_TRUE(test_table->InsertTuple(tuple, &rid, loser));
+    uncommitted.push_back(rid);
+  }
+  bustub_instance->log_manager_->Flush(loser->GetPrevLSN());
+
+  LOG_INFO("System crash with a running transaction");
+  delete test_table;
+  delete bustub_instance;
+  delete loser;
+
+  bustub_instance = new BustubInstance("test.db");
+  LogRecovery log_recovery(bustub_instance->disk_manager_, bustub_instance->buffer_pool_manager_);
+  log_recovery.Redo();
+  log_recovery.Undo();
+
+  txn = bustub_instance->transaction_manager_->Begin();
+  test_table = new TableHeap(bustub_instance->buffer_pool_manager_, bustub_instance->lock_manager_,
+                             bustub_instance->log_manager_, first_page_id);
+  Tuple tuple;
+  for (auto &[rid, id] : committed) {
+    ASSERT_TRUE(test_table->GetTuple(rid, &tuple, txn));
+    EXPECT_EQ(id, tuple.GetValue(&schema, 0).GetAs<int32_t>());
+  }
+  for (auto &rid : uncommitted) {
+    EXPECT_FALSE(test_table->GetTuple(rid, &tuple, txn));
+  }
+  bustub_instance->transaction_manager_->Commit(txn);
+
+  delete txn;
+  delete test_table;
+  delete bustub_instance;
+}
+
 }  // namespace bustub
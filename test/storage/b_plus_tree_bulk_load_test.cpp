@@ -0,0 +1,235 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// b_plus_tree_bulk_load_test.cpp
+//
+// Identification: test/storage/b_plus_tree_bulk_load_test.cpp
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <cstdio>
+#include <utility>
+#include <vector>
+
+#include "buffer/buffer_pool_manager_instance.h"
+#include "common/exception.h"
+#include "gtest/gtest.h"
+#include "storage/index/b_plus_tree.h"
+#include "storage/page/header_page.h"
+#include "test_util.h"  // NOLINT
+
+namespace bustub {
+
+using BulkLoadTree = BPlusTree<GenericKey<8>, RID, GenericComparator<8>>;
+using BulkLoadLeafPage = BPlusTreeLeafPage<GenericKey<8>, RID, GenericComparator<8>>;
+using BulkLoadInternalPage = BPlusTreeInternalPage<GenericKey<8>, page_id_t, GenericComparator<8>>;
+
+/** Check the page sizes, parent links and key order below page_id. @return the number of keys below it */
+static int CheckSubtree(BufferPoolManager *bpm, page_id_t page_id, page_id_t parent_id, int64_t *last_key) {
+  Page *page = bpm->FetchPage(page_id);
+  auto *node = reinterpret_cast<BPlusTreePage *>(page->GetData());
+  EXPECT_EQ(parent_id, node->GetParentPageId());
+  if (parent_id != INVALID_PAGE_ID) {
+    EXPECT_GE(node->GetSize(), node->GetMinSize());
+  }
+  int keys = 0;
+  if (node->IsLeafPage()) {
+    auto *leaf = reinterpret_cast<BulkLoadLeafPage *>(node);
+    EXPECT_LT(leaf->GetSize(), leaf->GetMaxSize());
+    for (int i = 0; i < leaf->GetSize(); i++) {
+      int64_t key = leaf->KeyAt(i).ToString();
+      EXPECT_GT(key, *last_key);
+      *last_key = key;
+    }
+    keys = leaf->GetSize();
+  } else {
+    auto *internal = reinterpret_cast<BulkLoadInternalPage *>(node);
+    EXPECT_LE(internal->GetSize(), internal->GetMaxSize());
+    EXPECT_GE(internal->GetSize(), 2);
+    for (int i = 0; i < internal->GetSize(); i++) {
+      if (i > 0) {
+        EXPECT_GT(internal->KeyAt(i).ToString(), *last_key);
+      }
+      keys += CheckSubtree(bpm, internal->ValueAt(i), page_id, last_key);
+    }
+  }
+  bpm->UnpinPage(page_id, false);
+  return keys;
+}
+
+/** Bulk load the even keys below 2 * size, one of them twice. */
+static bool BulkLoadEvenKeys(BulkLoadTree *tree, int64_t size, double fill_factor) {
+  std::vector<int64_t> keys;
+  for (int64_t i = 0; i < size; i++) {
+    keys.push_back(2 * i);
+    if (i == size / 2) {
+      keys.push_back(2 * i);
+    }
+  }
+  size_t next = 0;
+  return tree->BulkLoad(
+      [&](GenericKey<8> *key, RID *rid) {
+        if (next == keys.size()) {
+          return false;
+        }
+        key->SetFromInteger(keys[next]);
+        *rid = RID(keys[next++]);
+        return true;
+      },
+      fill_factor);
+}
+
+TEST(BPlusTreeTests, BulkLoadTest) {
+  auto key_schema = ParseCreateStatement("a bigint");
+  GenericComparator<8> comparator(key_schema.get());
+
+  for (auto [leaf_max_size, internal_max_size] : std::vector<std::pair<int, int>>{{2, 3}, {3, 4}, {5, 5}, {16, 9}}) {
+    for (int64_t size : {1, 2, 3, 4, 7, 30, 400}) {
+      for (double fill_factor : {0.5, 0.8, 1.0}) {
+        SCOPED_TRACE(testing::Message() << "leaf max " << leaf_max_size << ", internal max " << internal_max_size
+                                        << ", " << size << " keys, fill " << fill_factor);
+        auto *disk_manager = new DiskManager("test.db");
+        BufferPoolManager *bpm = new BufferPoolManagerInstance(50, disk_manager);
+        page_id_t page_id;
+        bpm->NewPage(&page_id);
+        BulkLoadTree tree("foo_pk", bpm, comparator, leaf_max_size, internal_max_size);
+
+        // Scenario: the loaded tree is well formed and holds every key once.
+        ASSERT_TRUE(BulkLoadEvenKeys(&tree, size, fill_factor));
+        auto *header_page = reinterpret_cast<HeaderPage *>(bpm->FetchPage(HEADER_PAGE_ID));
+        page_id_t root_page_id;
+        ASSERT_TRUE(header_page->GetRootId("foo_pk", &root_page_id));
+        bpm->UnpinPage(HEADER_PAGE_ID, false);
+        int64_t last_key = -1;
+        EXPECT_EQ(size, CheckSubtree(bpm, root_page_id, INVALID_PAGE_ID, &last_key));
+        int64_t current_key = 0;
+        for (auto iterator = tree.Begin(); iterator != tree.End(); ++iterator) {
+          EXPECT_EQ(current_key, (*iterator).second.Get());
+          current_key += 2;
+        }
+        EXPECT_EQ(2 * size, current_key);
+
+        // Scenario: the loaded tree takes inserts and removes like any other.
+        GenericKey<8> index_key;
+        for (int64_t key = 1; key < 2 * size; key += 2) {
+          index_key.SetFromInteger(key);
+          EXPECT_TRUE(tree.Insert(index_key, RID(key)));
+        }
+        std::vector<RID> rids;
+        for (int64_t key = 0; key < 2 * size; key++) {
+          rids.clear();
+          index_key.SetFromInteger(key);
+          ASSERT_TRUE(tree.GetValue(index_key, &rids)) << key;
+          EXPECT_EQ(key, rids[0].Get());
+        }
+        for (int64_t key = 0; key < 2 * size; key++) {
+          index_key.SetFromInteger(key);
+          tree.Remove(index_key);
+        }
+        EXPECT_TRUE(tree.IsEmpty());
+
+        bpm->UnpinPage(HEADER_PAGE_ID, true);
+        delete bpm;
+        delete disk_manager;
+        remove("test.db");
+        remove("test.log");
+      }
+    }
+  }
+}
+
+TEST(BPlusTreeTests, BulkLoadRejectTest) {
+  auto key_schema = ParseCreateStatement("a bigint");
+  GenericComparator<8> comparator(key_schema.get());
+  auto *disk_manager = new DiskManager("test.db");
+  BufferPoolManager *bpm = new BufferPoolManagerInstance(50, disk_manager);
+  page_id_t page_id;
+  bpm->NewPage(&page_id);
+  BulkLoadTree tree("foo_pk", bpm, comparator, 3, 3);
+
+  // Scenario: input out of order is rejected, and leaves the tree empty and no page pinned.
+  std::vector<int64_t> keys = {1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 0};
+  size_t next = 0;
+  auto produce = [&](GenericKey<8> *key, RID *rid) {
+    if (next == keys.size()) {
+      return false;
+    }
+    key->SetFromInteger(keys[next]);
+    *rid = RID(keys[next++]);
+    return true;
+  };
+  EXPECT_THROW(tree.BulkLoad(produce), Exception);
+  EXPECT_TRUE(tree.IsEmpty());
+  for (int i = 1; i < 50; i++) {
+    ASSERT_NE(nullptr, bpm->NewPage(&page_id));
+  }
+
+  bpm->UnpinPage(HEADER_PAGE_ID, true);
+  delete bpm;
+  delete disk_manager;
+  remove("test.db");
+  remove("test.log");
+}
+
+TEST(BPlusTreeTests, BulkLoadOutOfMemoryTest) {
+  auto key_schema = ParseCreateStatement("a bigint");
+  GenericComparator<8> comparator(key_schema.get());
+  auto *disk_manager = new DiskManager("test.db");
+  BufferPoolManager *bpm = new BufferPoolManagerInstance(50, disk_manager);
+  page_id_t page_id;
+  bpm->NewPage(&page_id);
+  BulkLoadTree tree("foo_pk", bpm, comparator, 3, 3);
+
+  // Scenario: a bulk load that runs out of frames throws, and leaves the tree empty and no page of its own pinned.
+  std::vector<page_id_t> held;
+  for (int i = 0; i < 44; i++) {
+    ASSERT_NE(nullptr, bpm->NewPage(&page_id));
+    held.push_back(page_id);
+  }
+  EXPECT_THROW(BulkLoadEvenKeys(&tree, 1000, 1.0), Exception);
+  EXPECT_TRUE(tree.IsEmpty());
+  for (auto held_page_id : held) {
+    bpm->UnpinPage(held_page_id, false);
+  }
+  for (int i = 1; i < 50; i++) {
+    ASSERT_NE(nullptr, bpm->NewPage(&page_id));
+  }
+
+  bpm->UnpinPage(HEADER_PAGE_ID, true);
+  delete bpm;
+  delete disk_manager;
+  remove("test.db");
+  remove("test.log");
+}
+
+TEST(BPlusTreeTests, BulkLoadNonEmptyTest) {
+  auto key_schema = ParseCreateStatement("a bigint");
+  GenericComparator<8> comparator(key_schema.get());
+  auto *disk_manager = new DiskManager("test.db");
+  BufferPoolManager *bpm = new BufferPoolManagerInstance(50, disk_manager);
+  page_id_t page_id;
+  bpm->NewPage(&page_id);
+  BulkLoadTree tree("foo_pk", bpm, comparator, 3, 3);
+
+  // Scenario: a tree that already has keys is not bulk loaded.
+  GenericKey<8> index_key;
+  index_key.SetFromInteger(1);
+  tree.Insert(index_key, RID(1));
+  EXPECT_FALSE(BulkLoadEvenKeys(&tree, 10, 1.0));
+  int count = 0;
+  for (auto iterator = tree.Begin(); iterator != tree.End(); ++iterator) {
+    count++;
+  }
+  EXPECT_EQ(1, count);
+
+  bpm->UnpinPage(HEADER_PAGE_ID, true);
+  delete bpm;
+  delete disk_manager;
+  remove("test.db");
+  remove("test.log");
+}
+
+}  // namespace bustub
@@ -10,9 +10,11 @@
 //
 //===----------------------------------------------------------------------===//
 
+#include <atomic>
 #include <chrono>  // NOLINT
 #include <cstdio>
 #include <functional>
+#include <memory>
 #include <thread>  // NOLINT
 
 #include "buffer/buffer_pool_manager_instance.h"
@@ -100,7 +102,7 @@ void DeleteHelperSplit(BPlusTree<GenericKey<8>, RID, GenericComparator<8>> *tree
   delete transaction;
 }
 
-TEST(BPlusTreeConcurrentTest, DISABLED_InsertTest1) {
+TEST(BPlusTreeConcurrentTest, InsertTest1) {
   // create KeyComparator and index schema
   auto key_schema = ParseCreateStatement("a bigint");
   GenericComparator<8> comparator(key_schema.get());
@@ -146,13 +148,13 @@ TEST(BPlusTreeConcurrentTest, DISABLED_InsertTest1) {
   EXPECT_EQ(current_key, keys.size() + 1);
 
   bpm->UnpinPage(HEADER_PAGE_ID, true);
-  delete disk_manager;
   delete bpm;
+  delete disk_manager;
   remove("test.db");
   remove("test.log");
 }
 
-TEST(BPlusTreeConcurrentTest, DISABLED_InsertTest2) {
+TEST(BPlusTreeConcurrentTest, InsertTest2) {
   // create KeyComparator and index schema
   auto key_schema = ParseCreateStatement("a bigint");
   GenericComparator<8> comparator(key_schema.get());
@@ -197,13 +199,13 @@ TEST(BPlusTreeConcurrentTest, DISABLED_InsertTest2) {
   EXPECT_EQ(current_key, keys.size() + 1);
 
   bpm->UnpinPage(HEADER_PAGE_ID, true);
-  delete disk_manager;
   delete bpm;
+  delete disk_manager;
   remove("test.db");
   remove("test.log");
 }
 
-TEST(BPlusTreeConcurrentTest, DISABLED_DeleteTest1) {
+TEST(BPlusTreeConcurrentTest, DeleteTest1) {
   // create KeyComparator and index schema
   auto key_schema = ParseCreateStatement("a bigint");
   GenericComparator<8> comparator(key_schema.get());
@@ -239,13 +241,13 @@ TEST(BPlusTreeConcurrentTest, DISABLED_DeleteTest1) {
   EXPECT_EQ(size, 1);
 
   bpm->UnpinPage(HEADER_PAGE_ID, true);
-  delete disk_manager;
   delete bpm;
+  delete disk_manager;
   remove("test.db");
   remove("test.log");
 }
 
-TEST(BPlusTreeConcurrentTest, DISABLED_DeleteTest2) {
+TEST(BPlusTreeConcurrentTest, DeleteTest2) {
   // create KeyComparator and index schema
   auto key_schema = ParseCreateStatement("a bigint");
   GenericComparator<8> comparator(key_schema.get());
@@ -282,13 +284,13 @@ TEST(BPlusTreeConcurrentTest, DISABLED_DeleteTest2) {
   EXPECT_EQ(size, 4);
 
   bpm->UnpinPage(HEADER_PAGE_ID, true);
-  delete disk_manager;
   delete bpm;
+  delete disk_manager;
   remove("test.db");
   remove("test.log");
 }
 
-TEST(BPlusTreeConcurrentTest, DISABLED_MixTest) {
+TEST(BPlusTreeConcurrentTest, MixTest) {
   // create KeyComparator and index schema
   auto key_schema = ParseCreateStatement("a bigint");
   GenericComparator<8> comparator(key_schema.get());
@@ -327,10 +329,137 @@ TEST(BPlusTreeConcurrentTest, DISABLED_MixTest) {
   EXPECT_EQ(size, 5);
 
   bpm->UnpinPage(HEADER_PAGE_ID, true);
+  delete bpm;
   delete disk_manager;
+  remove("test.db");
+  remove("test.log");
+}
+
+TEST(BPlusTreeConcurrentTest, OptimisticLookupTest) {
+  // create KeyComparator and index schema
+  auto key_schema = ParseCreateStatement("a bigint");
+  GenericComparator<8> comparator(key_schema.get());
+
+  DiskManager *disk_manager = new DiskManager("test.db");
+  BufferPoolManager *bpm = new BufferPoolManagerInstance(50, disk_manager);
+  // small pages, so that the writers keep splitting and merging under the readers
+  BPlusTree<GenericKey<8>, RID, GenericComparator<8>> tree("foo_pk", bpm, comparator, 4, 5);
+
+  // create and fetch header_page
+  page_id_t page_id;
+  auto header_page = bpm->NewPage(&page_id);
+  (void)header_page;
+
+  // Scenario: the even keys stay in the tree while the odd keys around them are inserted and removed.
+  const int64_t scale = 1000;
+  std::vector<int64_t> even_keys;
+  std::vector<int64_t> odd_keys;
+  for (int64_t key = 0; key < 2 * scale; key++) {
+    (key % 2 == 0 ? even_keys : odd_keys).push_back(key);
+  }
+  InsertHelper(&tree, even_keys);
+
+  std::atomic<bool> done{false};
+  std::atomic<int> missing{0};
+  std::atomic<int> misordered{0};
+  std::vector<std::thread> readers;
+  for (int i = 0; i < 2; i++) {
+    readers.emplace_back([&, i] {
+      GenericKey<8> index_key;
+      std::vector<RID> rids;
+      while (!done) {
+        for (size_t j = i; j < even_keys.size(); j += 7) {
+          rids.clear();
+          index_key.SetFromInteger(even_keys[j]);
+          if (!tree.GetValue(index_key, &rids) || rids.size() != 1 || rids[0].GetSlotNum() != even_keys[j]) {
+            missing++;
+          }
+        }
+      }
+    });
+  }
+  readers.emplace_back([&] {
+    while (!done) {
+      int64_t previous = -1;
+      int64_t even_seen = 0;
+      for (auto iterator = tree.Begin(); iterator != tree.End(); ++iterator) {
+        int64_t key = (*iterator).first.ToString();
+        if (key <= previous) {
+          misordered++;
+        }
+        even_seen += key % 2 == 0 ? 1 : 0;
+        previous = key;
+      }
+      if (even_seen != scale) {
+        missing++;
+      }
+    }
+  });
+  readers.emplace_back([&] {
+    while (!done) {
+      int64_t previous = 2 * scale;
+      int64_t even_seen = 0;
+      for (auto iterator = tree.RBegin(); !iterator.IsEnd(); --iterator) {
+        int64_t key = (*iterator).first.ToString();
+        if (key >= previous) {
+          misordered++;
+        }
+        even_seen += key % 2 == 0 ? 1 : 0;
+        previous = key;
+      }
+      if (even_seen != scale) {
+        missing++;
+      }
+    }
+  });
+
+  for (int round = 0; round < 3; round++) {
+    LaunchParallelTest(2, InsertHelperSplit, &tree, odd_keys, 2);
+    LaunchParallelTest(2, DeleteHelperSplit, &tree, odd_keys, 2);
+  }
+  done = true;
+  for (auto &reader : readers) {
+    reader.join();
+  }
+  EXPECT_EQ(0, missing);
+  EXPECT_EQ(0, misordered);
+
+  std::vector<RID> rids;
+  GenericKey<8> index_key;
+  for (auto key : odd_keys) {
+    rids.clear();
+    index_key.SetFromInteger(key);
+    EXPECT_FALSE(tree.GetValue(index_key, &rids));
+  }
+
+  bpm->UnpinPage(HEADER_PAGE_ID, true);
   delete bpm;
+  delete disk_manager;
   remove("test.db");
   remove("test.log");
 }
 
+TEST(BPlusTreeConcurrentTest, TornInternalPageLookupTest) {
+  auto key_schema = ParseCreateStatement("a bigint");
+  GenericComparator<8> comparator(key_schema.get());
+  using InternalPage = BPlusTreeInternalPage<GenericKey<8>, page_id_t, GenericComparator<8>>;
+
+  // An optimistic reader may see any size on a page that is being rewritten. Lookup stays within the page and
+  // returns one of its child pointers anyway; the reader finds out from the version that it has to retry.
+  auto data = std::make_unique<char[]>(PAGE_SIZE);
+  auto *page = reinterpret_cast<InternalPage *>(data.get());
+  page->Init(1);
+  GenericKey<8> index_key;
+  index_key.SetFromInteger(10);
+  page->PopulateNewRoot(2, index_key, 3);
+  for (int size : {-1, 0, PAGE_SIZE, 1 << 30}) {
+    page->SetSize(size);
+    for (int64_t key : {0, 10, 20}) {
+      index_key.SetFromInteger(key);
+      page_id_t child = page->Lookup(index_key, comparator);
+      EXPECT_TRUE(child == 2 || child == 3 || child == 0) << "size " << size << " key " << key;
+    }
+  }
+}
+
 }  // namespace bustub
@@ -12,6 +12,7 @@
 
 #include <algorithm>
 #include <cstdio>
+#include <random>
 
 #include "buffer/buffer_pool_manager_instance.h"
 #include "gtest/gtest.h"
@@ -20,7 +21,7 @@
 
 namespace bustub {
 
-TEST(BPlusTreeTests, DISABLED_DeleteTest1) {
+TEST(BPlusTreeTests, DeleteTest1) {
   // create KeyComparator and index schema
   auto key_schema = ParseCreateStatement("a bigint");
   GenericComparator<8> comparator(key_schema.get());
@@ -92,13 +93,13 @@ TEST(BPlusTreeTests, DISABLED_DeleteTest1) {
 
   bpm->UnpinPage(HEADER_PAGE_ID, true);
   delete transaction;
-  delete disk_manager;
   delete bpm;
+  delete disk_manager;
   remove("test.db");
   remove("test.log");
 }
 
-TEST(BPlusTreeTests, DISABLED_DeleteTest2) {
+TEST(BPlusTreeTests, DeleteTest2) {
   // create KeyComparator and index schema
   auto key_schema = ParseCreateStatement("a bigint");
   GenericComparator<8> comparator(key_schema.get());
@@ -170,8 +171,161 @@ TEST(BPlusTreeTests, DISABLED_DeleteTest2) {
 
   bpm->UnpinPage(HEADER_PAGE_ID, true);
   delete transaction;
+  delete bpm;
   delete disk_manager;
+  remove("test.db");
+  remove("test.log");
+}
+
+TEST(BPlusTreeTests, ReverseIteratorTest) {
+  // create KeyComparator and index schema
+  auto key_schema = ParseCreateStatement("a bigint");
+  GenericComparator<8> comparator(key_schema.get());
+
+  DiskManager *disk_manager = new DiskManager("test.db");
+  BufferPoolManager *bpm = new BufferPoolManagerInstance(50, disk_manager);
+  // small pages, so that the keys span many leaves that split and merge
+  BPlusTree<GenericKey<8>, RID, GenericComparator<8>> tree("foo_pk", bpm, comparator, 3, 4);
+  GenericKey<8> index_key;
+  RID rid;
+  // create transaction
+  Transaction *transaction = new Transaction(0);
+
+  // create and fetch header_page
+  page_id_t page_id;
+  auto header_page = bpm->NewPage(&page_id);
+  (void)header_page;
+
+  // the even keys from 0 to 198, inserted in shuffled order
+  std::vector<int64_t> keys;
+  for (int64_t key = 0; key < 200; key += 2) {
+    keys.push_back(key);
+  }
+  std::shuffle(keys.begin(), keys.end(), std::mt19937(7));
+  for (auto key : keys) {
+    rid.Set(0, key);
+    index_key.SetFromInteger(key);
+    tree.Insert(index_key, rid, transaction);
+  }
+  std::sort(keys.begin(), keys.end());
+
+  auto check_backward_from = [&](auto iterator, std::vector<int64_t>::const_reverse_iterator expected) {
+    for (; !iterator.IsEnd(); --iterator, ++expected) {
+      ASSERT_NE(expected, keys.crend());
+      EXPECT_EQ((*iterator).second.GetSlotNum(), *expected);
+    }
+    EXPECT_EQ(expected, keys.crend());
+  };
+  check_backward_from(tree.RBegin(), keys.crbegin());
+
+  // RBegin(key) starts at the last key not greater than key
+  for (int64_t key = -1; key < 201; key++) {
+    index_key.SetFromInteger(key);
+    auto expected = std::find_if(keys.crbegin(), keys.crend(), [&](int64_t k) { return k <= key; });
+    check_backward_from(tree.RBegin(index_key), expected);
+  }
+
+  // remove all but every third key, merging most of the leaves
+  std::vector<int64_t> remaining;
+  for (size_t i = 0; i < keys.size(); i++) {
+    if (i % 3 == 0) {
+      remaining.push_back(keys[i]);
+      continue;
+    }
+    index_key.SetFromInteger(keys[i]);
+    tree.Remove(index_key, transaction);
+  }
+  keys = remaining;
+  check_backward_from(tree.RBegin(), keys.crbegin());
+
+  // change direction halfway through
+  index_key.SetFromInteger(keys[keys.size() / 2]);
+  auto iterator = tree.Begin(index_key);
+  for (size_t i = keys.size() / 2; i + 1 < keys.size(); i++) {
+    ++iterator;
+  }
+  EXPECT_EQ((*iterator).second.GetSlotNum(), keys.back());
+  for (size_t i = keys.size() - 1; i > 0; i--) {
+    --iterator;
+    EXPECT_EQ((*iterator).second.GetSlotNum(), keys[i - 1]);
+  }
+  ++iterator;
+  EXPECT_EQ((*iterator).second.GetSlotNum(), keys[1]);
+  --iterator;
+  --iterator;
+  EXPECT_TRUE(iterator.IsEnd());
+
+  bpm->UnpinPage(HEADER_PAGE_ID, true);
+  delete transaction;
   delete bpm;
+  delete disk_manager;
+  remove("test.db");
+  remove("test.log");
+}
+
+TEST(BPlusTreeTests, DeletePagesTest) {
+  // create KeyComparator and index schema
+  auto key_schema = ParseCreateStatement("a bigint");
+  GenericComparator<8> comparator(key_schema.get());
+
+  DiskManager *disk_manager = new DiskManager("test.db");
+  // large enough that no page of the tree is evicted
+  auto *bpm = new BufferPoolManagerInstance(200, disk_manager);
+  BPlusTree<GenericKey<8>, RID, GenericComparator<8>> tree("foo_pk", bpm, comparator, 3, 4);
+  GenericKey<8> index_key;
+  RID rid;
+  // create transaction
+  Transaction *transaction = new Transaction(0);
+
+  // create and fetch header_page
+  page_id_t page_id;
+  auto header_page = bpm->NewPage(&page_id);
+  (void)header_page;
+
+  auto count_tree_pages = [&] {
+    int count = 0;
+    for (size_t i = 0; i < bpm->GetPoolSize(); i++) {
+      page_id_t resident_page_id = bpm->GetPages()[i].GetPageId();
+      count += static_cast<int>(resident_page_id != INVALID_PAGE_ID && resident_page_id != HEADER_PAGE_ID);
+    }
+    return count;
+  };
+
+  const int64_t scale = 60;
+  for (int64_t key = 1; key <= scale; key++) {
+    rid.Set(0, key);
+    index_key.SetFromInteger(key);
+    tree.Insert(index_key, rid, transaction);
+  }
+  int pages_before = count_tree_pages();
+  auto iterator = tree.Begin();
+
+  // Scenario: merged pages are deleted, while an iterator that was on the tree before still finds its way.
+  for (int64_t key = 2; key < scale; key++) {
+    index_key.SetFromInteger(key);
+    tree.Remove(index_key, transaction);
+  }
+  EXPECT_LT(count_tree_pages(), pages_before / 4);
+  int64_t previous = 0;
+  for (; !iterator.IsEnd(); ++iterator) {
+    int64_t key = (*iterator).second.GetSlotNum();
+    EXPECT_LT(previous, key);
+    previous = key;
+  }
+  EXPECT_EQ(scale, previous);
+
+  // Scenario: the last page goes with the last key.
+  for (int64_t key : {int64_t{1}, scale}) {
+    index_key.SetFromInteger(key);
+    tree.Remove(index_key, transaction);
+  }
+  EXPECT_TRUE(tree.IsEmpty());
+  EXPECT_EQ(0, count_tree_pages());
+
+  bpm->UnpinPage(HEADER_PAGE_ID, true);
+  delete transaction;
+  delete bpm;
+  delete disk_manager;
   remove("test.db");
   remove("test.log");
 }
@@ -12,15 +12,19 @@
 
 #include <algorithm>
 #include <cstdio>
+#include <string>
+#include <utility>
+#include <vector>
 
 #include "buffer/buffer_pool_manager_instance.h"
 #include "gtest/gtest.h"
 #include "storage/index/b_plus_tree.h"
 #include "test_util.h"  // NOLINT
+#include "type/value_factory.h"
 
 namespace bustub {
 
-TEST(BPlusTreeTests, DISABLED_InsertTest1) {
+TEST(BPlusTreeTests, InsertTest1) {
   // create KeyComparator and index schema
   auto key_schema = ParseCreateStatement("a bigint");
   GenericComparator<8> comparator(key_schema.get());
@@ -72,13 +76,13 @@ TEST(BPlusTreeTests, DISABLED_InsertTest1) {
 
   bpm->UnpinPage(HEADER_PAGE_ID, true);
   delete transaction;
-  delete disk_manager;
   delete bpm;
+  delete disk_manager;
   remove("test.db");
   remove("test.log");
 }
 
-TEST(BPlusTreeTests, DISABLED_InsertTest2) {
+TEST(BPlusTreeTests, InsertTest2) {
   // create KeyComparator and index schema
   auto key_schema = ParseCreateStatement("a bigint");
   GenericComparator<8> comparator(key_schema.get());
@@ -140,8 +144,119 @@ TEST(BPlusTreeTests, DISABLED_InsertTest2) {
 
   bpm->UnpinPage(HEADER_PAGE_ID, true);
   delete transaction;
+  delete bpm;
   delete disk_manager;
+  remove("test.db");
+  remove("test.log");
+}
+
+TEST(BPlusTreeTests, InsertTest3) {
+  // keys whose heads tie: negative and positive integers, and strings that share their first bytes
+  auto key_schema = ParseCreateStatement("a integer,b varchar(16)");
+  GenericComparator<32> comparator(key_schema.get());
+
+  DiskManager *disk_manager = new DiskManager("test.db");
+  BufferPoolManager *bpm = new BufferPoolManagerInstance(50, disk_manager);
+  BPlusTree<GenericKey<32>, RID, GenericComparator<32>> tree("foo_pk", bpm, comparator, 4, 5);
+  GenericKey<32> index_key;
+  Transaction *transaction = new Transaction(0);
+
+  page_id_t page_id;
+  auto header_page = bpm->NewPage(&page_id);
+  (void)header_page;
+
+  std::vector<int32_t> numbers = {-70000, -2, -1, 0, 1, 65536};
+  std::vector<std::string> strings = {"", "a", "ab", "abcd", "abcdefgh", "abcdefghi", "abcdefghj", "b"};
+  std::vector<std::pair<int32_t, std::string>> keys;
+  for (auto number : numbers) {
+    for (const auto &string : strings) {
+      keys.emplace_back(number, string);
+    }
+  }
+  auto set_key = [&](const std::pair<int32_t, std::string> &key) {
+    Tuple tuple({ValueFactory::GetIntegerValue(key.first), ValueFactory::GetVarcharValue(key.second)},
+                key_schema.get());
+    index_key.SetFromKey(tuple, key_schema.get());
+  };
+
+  // insert in an order unrelated to the key order
+  for (size_t i = 0; i < keys.size(); i++) {
+    size_t j = (i * 7) % keys.size();
+    set_key(keys[j]);
+    EXPECT_TRUE(tree.Insert(index_key, RID(0, j), transaction));
+  }
+
+  std::vector<RID> rids;
+  for (size_t i = 0; i < keys.size(); i++) {
+    rids.clear();
+    set_key(keys[i]);
+    EXPECT_TRUE(tree.GetValue(index_key, &rids));
+    ASSERT_EQ(rids.size(), 1);
+    EXPECT_EQ(rids[0].GetSlotNum(), i);
+  }
+
+  // keys was built in ascending order
+  uint32_t current = 0;
+  for (auto iterator = tree.Begin(); iterator != tree.End(); ++iterator) {
+    EXPECT_EQ((*iterator).second.GetSlotNum(), current);
+    current++;
+  }
+  EXPECT_EQ(current, keys.size());
+
+  bpm->UnpinPage(HEADER_PAGE_ID, true);
+  delete transaction;
+  delete bpm;
+  delete disk_manager;
+  remove("test.db");
+  remove("test.log");
+}
+
+TEST(BPlusTreeTests, InsertDefaultSizeTest) {
+  // with the default page sizes, so that internal pages fill up to the last entry a page can hold
+  auto key_schema = ParseCreateStatement("a bigint");
+  GenericComparator<8> comparator(key_schema.get());
+
+  DiskManager *disk_manager = new DiskManager("test.db");
+  BufferPoolManager *bpm = new BufferPoolManagerInstance(50, disk_manager);
+  BPlusTree<GenericKey<8>, RID, GenericComparator<8>> tree("foo_pk", bpm, comparator);
+  GenericKey<8> index_key;
+  Transaction *transaction = new Transaction(0);
+
+  page_id_t page_id;
+  auto header_page = bpm->NewPage(&page_id);
+  (void)header_page;
+
+  // ascending inserts leave the leaves half full, so this takes three levels
+  const int64_t scale = 100000;
+  for (int64_t key = 0; key < scale; key++) {
+    index_key.SetFromInteger(key);
+    EXPECT_TRUE(tree.Insert(index_key, RID(0, key), transaction));
+  }
+
+  std::vector<RID> rids;
+  for (int64_t key = 0; key < scale; key++) {
+    rids.clear();
+    index_key.SetFromInteger(key);
+    EXPECT_TRUE(tree.GetValue(index_key, &rids));
+    ASSERT_EQ(rids.size(), 1) << key;
+    EXPECT_EQ(rids[0].GetSlotNum(), key);
+  }
+
+  for (int64_t key = 0; key < scale; key += 2) {
+    index_key.SetFromInteger(key);
+    tree.Remove(index_key, transaction);
+  }
+  int64_t current = 1;
+  for (auto iterator = tree.Begin(); iterator != tree.End(); ++iterator) {
+    EXPECT_EQ((*iterator).second.GetSlotNum(), current);
+    current += 2;
+  }
+  EXPECT_EQ(current, scale + 1);
+
+  bpm->UnpinPage(HEADER_PAGE_ID, true);
+  delete transaction;
   delete bpm;
+  delete disk_manager;
   remove("test.db");
   remove("test.log");
 }
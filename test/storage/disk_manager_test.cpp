@@ -10,7 +10,15 @@
 //
 //===----------------------------------------------------------------------===//
 
+#include <dirent.h>
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
 #include <cstring>
+#include <string>
+#include <thread>  // NOLINT
+#include <vector>
 
 #include "common/exception.h"
 #include "gtest/gtest.h"
@@ -18,6 +26,20 @@
 
 namespace bustub {
 
+/** @return the names of the segment files of test.log, including recycled ones */
+static std::vector<std::string> GetLogSegmentFiles() {
+  std::vector<std::string> names;
+  DIR *dir = opendir(".");
+  for (dirent *entry = readdir(dir); entry != nullptr; entry = readdir(dir)) {
+    std::string name = entry->d_name;
+    if (name.compare(0, 9, "test.log.") == 0) {
+      names.push_back(name);
+    }
+  }
+  closedir(dir);
+  return names;
+}
+
 class DiskManagerTest : public ::testing::Test {
  protected:
   // This function is called before every test.
@@ -30,6 +52,9 @@ class DiskManagerTest : public ::testing::Test {
   void TearDown() override {
     remove("test.db");
     remove("test.log");
+    for (const auto &name : GetLogSegmentFiles()) {
+      remove(name.c_str());
+    }
   };
 };
 
@@ -55,6 +80,59 @@ TEST_F(DiskManagerTest, ReadWritePageTest) {
   dm.ShutDown();
 }
 
+// NOLINTNEXTLINE
+TEST_F(DiskManagerTest, ChecksumTest) {
+  char data[4][PAGE_SIZE];
+  char buf[PAGE_SIZE];
+  for (auto backend_type : {DiskBackendType::STREAM, DiskBackendType::POSIX, DiskBackendType::IO_URING}) {
+    remove("test.db");
+    {
+      DiskManager dm("test.db", backend_type);
+      for (int i = 0; i < 4; i++) {
+        std::memset(data[i], 'a' + i, PAGE_SIZE);
+      }
+      // Page 2 is skipped and reads as zeros.
+      dm.WritePage(0, data[0]);
+      dm.WritePage(1, data[1]);
+      dm.WritePage(3, data[3]);
+      dm.ShutDown();
+    }
+
+    // Scenario: a flipped bit in page 1, and page 0 written over page 3, as a misdirected write would.
+    FILE *file = fopen("test.db", "r+b");
+    ASSERT_NE(nullptr, file);
+    fseek(file, PAGE_SIZE + 100, SEEK_SET);
+    fputc('a' ^ 1, file);
+    fseek(file, 3 * PAGE_SIZE, SEEK_SET);
+    fwrite(data[0], 1, PAGE_SIZE, file);
+    fclose(file);
+
+    DiskManager dm("test.db", backend_type);
+    dm.ReadPage(0, buf);
+    EXPECT_EQ(0, std::memcmp(buf, data[0], PAGE_SIZE));
+    dm.ReadPage(2, buf);
+    EXPECT_EQ(0, buf[0]);
+    try {
+      dm.ReadPage(1, buf);
+      FAIL() << "expected a corrupted page";
+    } catch (const CorruptedPageException &e) {
+      EXPECT_EQ(1, e.GetPageId());
+      EXPECT_EQ(ExceptionType::CORRUPTED_PAGE, e.GetType());
+    }
+    EXPECT_THROW(dm.ReadPage(3, buf), CorruptedPageException);
+
+    // Scenario: the corruption is caught by vectored reads too, and not when verification is skipped.
+    char *pages_data[4] = {data[0], data[1], data[2], data[3]};
+    EXPECT_THROW(dm.ReadPages(0, pages_data, 4), CorruptedPageException);
+    dm.ReadPages(0, pages_data, 4, false);
+    dm.ReadPage(1, buf, false);
+    EXPECT_EQ('a' ^ 1, buf[100]);
+    EXPECT_TRUE(DiskManager::VerifyPage(0, data[0]));
+    EXPECT_FALSE(DiskManager::VerifyPage(3, data[3]));
+    dm.ShutDown();
+  }
+}
+
 // NOLINTNEXTLINE
 TEST_F(DiskManagerTest, ReadWriteLogTest) {
   char buf[16] = {0};
@@ -73,6 +151,216 @@ TEST_F(DiskManagerTest, ReadWriteLogTest) {
 }
 
 // NOLINTNEXTLINE
-TEST_F(DiskManagerTest, ThrowBadFileTest) { EXPECT_THROW(DiskManager("dev/null\\/foo/bar/baz/test.db"), Exception); }
+TEST_F(DiskManagerTest, BackendTest) {
+  const size_t num_pages = 64;
+  std::vector<std::vector<char>> data(num_pages, std::vector<char>(PAGE_SIZE));
+  std::vector<std::vector<char>> buf(num_pages, std::vector<char>(PAGE_SIZE));
+  for (size_t i = 0; i < num_pages; i++) {
+    snprintf(data[i].data(), PAGE_SIZE, "page %zu", i);
+  }
+
+  for (auto backend_type : {DiskBackendType::STREAM, DiskBackendType::POSIX, DiskBackendType::IO_URING}) {
+    remove("test.db");
+    DiskManager dm("test.db", backend_type);
+
+    // Scenario: asynchronous writes of two runs, then asynchronous reads of single pages. Every callback runs once.
+    std::atomic<size_t> completed{0};
+    std::vector<DiskRequest> requests;
+    for (size_t begin = 0; begin < num_pages; begin += num_pages / 2) {
+      DiskRequest request{true, static_cast<page_id_t>(begin), {}, [&] { completed++; }};
+      for (size_t i = begin; i < begin + num_pages / 2; i++) {
+        request.pages_data_.push_back(data[i].data());
+      }
+      requests.push_back(std::move(request));
+    }
+    dm.SubmitRequests(&requests);
+    while (completed != 2) {
+      std::this_thread::yield();
+    }
+    dm.SyncPages();
+    EXPECT_EQ(num_pages, dm.GetNumPages());
+
+    requests.clear();
+    for (size_t i = 0; i < num_pages; i++) {
+      requests.push_back({false, static_cast<page_id_t>(i), {buf[i].data()}, [&] { completed++; }});
+    }
+    dm.SubmitRequests(&requests);
+    while (completed != num_pages + 2) {
+      std::this_thread::yield();
+    }
+    for (size_t i = 0; i < num_pages; i++) {
+      EXPECT_EQ(0, std::memcmp(buf[i].data(), data[i].data(), PAGE_SIZE));
+    }
+
+    // Scenario: synchronous vectored reads see the same data.
+    std::vector<char *> pages_data;
+    for (auto &page : buf) {
+      std::memset(page.data(), 0, PAGE_SIZE);
+      pages_data.push_back(page.data());
+    }
+    dm.ReadPages(0, pages_data.data(), num_pages);
+    for (size_t i = 0; i < num_pages; i++) {
+      EXPECT_EQ(0, std::memcmp(buf[i].data(), data[i].data(), PAGE_SIZE));
+    }
+    EXPECT_EQ(num_pages, dm.GetNumWrites());
+    EXPECT_EQ(2 * num_pages, dm.GetNumReads());
+
+    dm.ShutDown();
+  }
+}
+
+// NOLINTNEXTLINE
+TEST_F(DiskManagerTest, DirectIOTest) {
+  const size_t num_pages = 8;
+  auto *aligned = static_cast<char *>(aligned_alloc(PAGE_SIZE, num_pages * PAGE_SIZE));
+  // One byte past an aligned page: O_DIRECT rejects such buffers, so the backend must bounce them.
+  auto *unaligned_storage = static_cast<char *>(aligned_alloc(PAGE_SIZE, 2 * PAGE_SIZE));
+  char *unaligned = unaligned_storage + 1;
+  char buf[PAGE_SIZE];
+
+  for (auto backend_type : {DiskBackendType::POSIX, DiskBackendType::IO_URING}) {
+    remove("test.db");
+    DiskManager dm("test.db", backend_type, true);
+
+    // Scenario: an aligned vectored write and an unaligned single page write land where they should.
+    std::vector<char *> pages_data;
+    for (size_t i = 0; i < num_pages; i++) {
+      snprintf(aligned + i * PAGE_SIZE, PAGE_SIZE, "page %zu", i);
+      pages_data.push_back(aligned + i * PAGE_SIZE);
+    }
+    dm.WritePages(0, pages_data.data(), num_pages);
+    snprintf(unaligned, PAGE_SIZE, "unaligned page");
+    dm.WritePage(num_pages, unaligned);
+    dm.SyncPages();
+    EXPECT_EQ(num_pages + 1, dm.GetNumPages());
+
+    // Scenario: unaligned synchronous reads, and an asynchronous read into an unaligned buffer.
+    for (size_t i = 0; i < num_pages; i++) {
+      std::memset(buf, 0, PAGE_SIZE);
+      dm.ReadPage(i, buf);
+      EXPECT_EQ(0, std::memcmp(buf, aligned + i * PAGE_SIZE, PAGE_SIZE));
+    }
+    std::memset(aligned, 0, PAGE_SIZE);
+    dm.ReadPage(num_pages, aligned);
+    EXPECT_EQ(0, std::strcmp(aligned, "unaligned page"));
+
+    std::atomic<bool> done{false};
+    std::memset(unaligned, 0, PAGE_SIZE);
+    std::vector<DiskRequest> requests;
+    requests.push_back({false, 1, {unaligned}, [&] { done = true; }});
+    dm.SubmitRequests(&requests);
+    while (!done) {
+      std::this_thread::yield();
+    }
+    EXPECT_EQ(0, std::strcmp(unaligned, "page 1"));
+
+    dm.ShutDown();
+  }
+  free(unaligned_storage);
+  free(aligned);
+}
+
+// NOLINTNEXTLINE
+TEST_F(DiskManagerTest, ThrowBadFileTest) {
+  for (auto backend_type : {DiskBackendType::STREAM, DiskBackendType::POSIX, DiskBackendType::IO_URING}) {
+    EXPECT_THROW(DiskManager("dev/null\\/foo/bar/baz/test.db", backend_type), Exception);
+  }
+}
+
+// NOLINTNEXTLINE
+TEST_F(DiskManagerTest, LogSegmentTest) {
+  const int64_t segment_size = 4096;
+  const int write_size = 1000;
+  const int num_writes = 40;
+  const int64_t log_size = write_size * num_writes;
+  std::vector<char> data(write_size * 2 * num_writes);
+  for (size_t i = 0; i < data.size(); i++) {
+    data[i] = static_cast<char>(i * 7 + i / 251);
+  }
+  std::vector<char> buf(log_size);
+  auto *dm = new DiskManager("test.db", DiskBackendType::IO_URING, false, segment_size);
+
+  // Scenario: writes that cross segment boundaries read back as one stream.
+  std::vector<char> write_buffers[2] = {std::vector<char>(write_size), std::vector<char>(write_size)};
+  for (int i = 0; i < num_writes; i++) {
+    // The log manager alternates between two buffers, and so must this test.
+    auto &write_buffer = write_buffers[i % 2];
+    memcpy(write_buffer.data(), data.data() + i * write_size, write_size);
+    dm->WriteLog(write_buffer.data(), write_size);
+  }
+  EXPECT_EQ(log_size, dm->GetLogSize());
+  ASSERT_TRUE(dm->ReadLog(buf.data(), log_size, 0));
+  EXPECT_EQ(0, memcmp(buf.data(), data.data(), log_size));
+  EXPECT_FALSE(dm->ReadLog(buf.data(), 1, log_size));
+
+  // Scenario: a reopened log ends where the last write did, although its segments are preallocated.
+  dm->ShutDown();
+  delete dm;
+  dm = new DiskManager("test.db");
+  EXPECT_EQ(log_size, dm->GetLogSize());
+  ASSERT_TRUE(dm->ReadLog(buf.data(), write_size, segment_size - 10));
+  EXPECT_EQ(0, memcmp(buf.data(), data.data() + segment_size - 10, write_size));
+
+  // Scenario: recycled segments cannot be read any more and are reused for new ones, so the number of segment files
+  // stays bounded while the log keeps growing.
+  dm->RecycleLogSegments(log_size / 2);
+  EXPECT_EQ(log_size / 2 / segment_size * segment_size, dm->GetLogStart());
+  EXPECT_FALSE(dm->ReadLog(buf.data(), write_size, 0));
+  ASSERT_TRUE(dm->ReadLog(buf.data(), write_size, log_size / 2));
+  EXPECT_EQ(0, memcmp(buf.data(), data.data() + log_size / 2, write_size));
+  size_t max_files = log_size / segment_size + 2;
+  EXPECT_LE(GetLogSegmentFiles().size(), max_files);
+  for (int i = num_writes; i < 2 * num_writes; i++) {
+    auto &write_buffer = write_buffers[i % 2];
+    memcpy(write_buffer.data(), data.data() + i * write_size, write_size);
+    dm->WriteLog(write_buffer.data(), write_size);
+    dm->RecycleLogSegments(dm->GetLogSize() - log_size / 2);
+  }
+  EXPECT_EQ(2 * log_size, dm->GetLogSize());
+  EXPECT_LE(GetLogSegmentFiles().size(), max_files);
+  ASSERT_TRUE(dm->ReadLog(buf.data(), log_size / 2, log_size * 3 / 2));
+  EXPECT_EQ(0, memcmp(buf.data(), data.data() + log_size * 3 / 2, log_size / 2));
+
+  dm->ShutDown();
+  delete dm;
+}
+
+// NOLINTNEXTLINE
+TEST_F(DiskManagerTest, LogSegmentNamesTest) {
+  auto touch = [](const std::string &name) { fclose(fopen(name.c_str(), "w")); };
+  auto file_exists = [](const std::string &name) {
+    auto names = GetLogSegmentFiles();
+    return std::find(names.begin(), names.end(), name) != names.end();
+  };
+  const std::vector<std::string> other_files = {"test.log.backup", "test.log.0000000001.bak", "test.log.spare",
+                                                "test.log.spare1x", "test.log.tmp", "test.log.12a"};
+
+  // Scenario: without a control file, the segments, spares and half-prepared segments of the old log are deleted,
+  // but files that only share its prefix are not.
+  for (const auto &name : other_files) {
+    touch(name);
+  }
+  touch("test.log.0000000001");
+  touch("test.log.spare3");
+  touch("test.log.0000000002.tmp");
+  auto *dm = new DiskManager("test.db");
+  EXPECT_FALSE(file_exists("test.log.0000000001"));
+  EXPECT_FALSE(file_exists("test.log.spare3"));
+  EXPECT_FALSE(file_exists("test.log.0000000002.tmp"));
+  for (const auto &name : other_files) {
+    EXPECT_TRUE(file_exists(name)) << name;
+  }
+  dm->ShutDown();
+  delete dm;
+
+  // Scenario: with a control file, they are neither deleted nor taken for segments or spares of the log.
+  dm = new DiskManager("test.db");
+  EXPECT_EQ(0, dm->GetLogSize());
+  for (const auto &name : other_files) {
+    EXPECT_TRUE(file_exists(name)) << name;
+  }
+  dm->ShutDown();
+  delete dm;
+}
 
 }  // namespace bustub
@@ -0,0 +1,156 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// generic_key_test.cpp
+//
+// Identification: test/storage/generic_key_test.cpp
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "storage/index/generic_key.h"
+#include "type/value_factory.h"
+
+namespace bustub {
+
+namespace {
+
+int Sign(int order) { return (order > 0) - (order < 0); }
+
+/** @return the order of two values as their type compares them */
+int ValueOrder(const Value &lhs, const Value &rhs) {
+  if (lhs.CompareLessThan(rhs) == CmpBool::CmpTrue) {
+    return -1;
+  }
+  return lhs.CompareGreaterThan(rhs) == CmpBool::CmpTrue ? 1 : 0;
+}
+
+}  // namespace
+
+// NOLINTNEXTLINE
+TEST(GenericKeyTest, RoundTripTest) {
+  Schema key_schema({Column("a", TypeId::BOOLEAN), Column("b", TypeId::SMALLINT), Column("c", TypeId::INTEGER),
+                     Column("d", TypeId::VARCHAR, 16), Column("e", TypeId::BIGINT), Column("f", TypeId::DECIMAL)});
+  std::vector<Value> values = {ValueFactory::GetBooleanValue(true),
+                               ValueFactory::GetSmallIntValue(-300),
+                               ValueFactory::GetIntegerValue(123456),
+                               ValueFactory::GetVarcharValue(std::string("a\0b", 3)),
+                               ValueFactory::GetBigIntValue(-5),
+                               ValueFactory::GetDecimalValue(-2.5)};
+  GenericKey<64> key;
+  key.SetFromKey(Tuple(values, &key_schema), &key_schema);
+  for (uint32_t i = 0; i < values.size(); i++) {
+    EXPECT_EQ(key.ToValue(&key_schema, i).CompareEquals(values[i]), CmpBool::CmpTrue) << "column " << i;
+  }
+}
+
+// NOLINTNEXTLINE
+TEST(GenericKeyTest, OrderTest) {
+  std::vector<std::pair<TypeId, std::vector<Value>>> columns = {
+      {TypeId::TINYINT,
+       {ValueFactory::GetTinyIntValue(-128 + 1), ValueFactory::GetTinyIntValue(-1), ValueFactory::GetTinyIntValue(0),
+        ValueFactory::GetTinyIntValue(127)}},
+      {TypeId::INTEGER,
+       {ValueFactory::GetIntegerValue(-70000), ValueFactory::GetIntegerValue(-1), ValueFactory::GetIntegerValue(0),
+        ValueFactory::GetIntegerValue(256), ValueFactory::GetIntegerValue(70000)}},
+      {TypeId::BIGINT,
+       {ValueFactory::GetBigIntValue(-(int64_t{1} << 40)), ValueFactory::GetBigIntValue(-1),
+        ValueFactory::GetBigIntValue(1), ValueFactory::GetBigIntValue(int64_t{1} << 40)}},
+      {TypeId::DECIMAL,
+       {ValueFactory::GetDecimalValue(-1e10), ValueFactory::GetDecimalValue(-0.5), ValueFactory::GetDecimalValue(-0.0),
+        ValueFactory::GetDecimalValue(0.0), ValueFactory::GetDecimalValue(0.25), ValueFactory::GetDecimalValue(3e8)}},
+      {TypeId::VARCHAR,
+       {ValueFactory::GetVarcharValue(""), ValueFactory::GetVarcharValue(std::string("\0", 1)),
+        ValueFactory::GetVarcharValue(std::string("a\0", 2)), ValueFactory::GetVarcharValue("a"),
+        ValueFactory::GetVarcharValue("ab"), ValueFactory::GetVarcharValue("b"),
+        ValueFactory::GetVarcharValue("\xff")}},
+  };
+  for (const auto &[type, values] : columns) {
+    // a second column checks that the first one ends where it should
+    Schema key_schema(
+        {type == TypeId::VARCHAR ? Column("a", type, 16) : Column("a", type), Column("b", TypeId::INTEGER)});
+    GenericComparator<32> comparator(&key_schema);
+    for (const auto &lhs : values) {
+      for (const auto &rhs : values) {
+        for (int32_t lhs_second : {-1, 1}) {
+          GenericKey<32> lhs_key;
+          GenericKey<32> rhs_key;
+          lhs_key.SetFromKey(Tuple({lhs, ValueFactory::GetIntegerValue(lhs_second)}, &key_schema), &key_schema);
+          rhs_key.SetFromKey(Tuple({rhs, ValueFactory::GetIntegerValue(1)}, &key_schema), &key_schema);
+          int expected = ValueOrder(lhs, rhs);
+          if (expected == 0) {
+            expected = lhs_second < 1 ? -1 : 0;
+          }
+          EXPECT_EQ(Sign(comparator(lhs_key, rhs_key)), expected) << lhs.ToString() << " vs " << rhs.ToString();
+          if (comparator.Head(lhs_key) != comparator.Head(rhs_key)) {
+            EXPECT_EQ(comparator.Head(lhs_key) < comparator.Head(rhs_key), expected < 0);
+          }
+        }
+      }
+    }
+  }
+}
+
+// NOLINTNEXTLINE
+TEST(GenericKeyTest, PrefixTest) {
+  Schema key_schema({Column("a", TypeId::INTEGER), Column("b", TypeId::VARCHAR, 8)});
+  GenericComparator<16> comparator(&key_schema);
+  for (int32_t prefix = 1; prefix <= 3; prefix++) {
+    GenericKey<16> lower;
+    GenericKey<16> upper;
+    lower.SetFromPrefix({ValueFactory::GetIntegerValue(prefix)}, &key_schema, 0);
+    upper.SetFromPrefix({ValueFactory::GetIntegerValue(prefix)}, &key_schema, 0xFF);
+    for (int32_t a = 0; a <= 4; a++) {
+      for (const char *b : {"", "x", "\xff\xff\xff"}) {
+        GenericKey<16> key;
+        key.SetFromKey(Tuple({ValueFactory::GetIntegerValue(a), ValueFactory::GetVarcharValue(b)}, &key_schema),
+                       &key_schema);
+        EXPECT_EQ(comparator(lower, key) <= 0, a >= prefix) << a << " " << b;
+        EXPECT_EQ(comparator(key, upper) <= 0, a <= prefix) << a << " " << b;
+      }
+    }
+  }
+}
+
+// NOLINTNEXTLINE
+TEST(GenericKeyTest, CompleteTest) {
+  Schema key_schema({Column("a", TypeId::SMALLINT), Column("b", TypeId::VARCHAR, 16)});
+  // the varchar fits in 8 bytes with the smallint only if it encodes into at most 3 bytes plus its terminator
+  std::vector<std::pair<std::string, bool>> cases = {{"", true},
+                                                     {"abc", true},
+                                                     {"abcd", false},
+                                                     {std::string("\0", 1), true},
+                                                     {std::string("ab\0", 3), false},
+                                                     {"abcdefgh", false}};
+  for (const auto &[chars, complete] : cases) {
+    // a bound is cut short where a key would be rejected
+    GenericKey<8> bound;
+    bound.SetFromPrefix({ValueFactory::GetSmallIntValue(7), ValueFactory::GetVarcharValue(chars)}, &key_schema, 0);
+    EXPECT_EQ(bound.IsComplete(&key_schema), complete) << chars.size();
+    GenericKey<8> key;
+    Tuple tuple({ValueFactory::GetSmallIntValue(7), ValueFactory::GetVarcharValue(chars)}, &key_schema);
+    if (complete) {
+      key.SetFromKey(tuple, &key_schema);
+      EXPECT_TRUE(key.IsComplete(&key_schema));
+      EXPECT_EQ(key.ToValue(&key_schema, 1).CompareEquals(ValueFactory::GetVarcharValue(chars)), CmpBool::CmpTrue);
+    } else {
+      EXPECT_THROW(key.SetFromKey(tuple, &key_schema), Exception) << chars.size();
+    }
+  }
+  Schema wide_schema({Column("a", TypeId::INTEGER), Column("b", TypeId::INTEGER)});
+  GenericKey<4> key;
+  EXPECT_THROW(key.SetFromKey(Tuple({ValueFactory::GetIntegerValue(1), ValueFactory::GetIntegerValue(2)}, &wide_schema),
+                              &wide_schema),
+               Exception);
+  key.SetFromPrefix({ValueFactory::GetIntegerValue(1), ValueFactory::GetIntegerValue(2)}, &wide_schema, 0);
+  EXPECT_FALSE(key.IsComplete(&wide_schema));
+}
+
+}  // namespace bustub
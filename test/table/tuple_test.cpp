@@ -21,6 +21,7 @@
 #include "logging/common.h"
 #include "storage/table/table_heap.h"
 #include "storage/table/tuple.h"
+#include "type/value_factory.h"
 
 namespace bustub {
 // NOLINTNEXTLINE
@@ -71,4 +72,50 @@ TEST(TupleTest, DISABLED_TableHeapTest) {
   delete disk_manager;
 }
 
+// NOLINTNEXTLINE
+TEST(TupleTest, TableHeapTupleSizeTest) {
+  Column col{"a", TypeId::VARCHAR, PAGE_SIZE};
+  Schema schema{std::vector<Column>{col}};
+  auto make_tuple = [&](uint32_t size) {
+    // what a tuple holds besides the characters of its string
+    const uint32_t overhead = Tuple(std::vector<Value>{ValueFactory::GetVarcharValue("")}, &schema).GetLength();
+    std::vector<Value> values{ValueFactory::GetVarcharValue(std::string(size - overhead, 'x'))};
+    Tuple tuple(values, &schema);
+    EXPECT_EQ(size, tuple.GetLength());
+    return tuple;
+  };
+
+  auto *disk_manager = new DiskManager("test.db");
+  auto *buffer_pool_manager = new BufferPoolManagerInstance(10, disk_manager);
+  auto *lock_manager = new LockManager();
+  auto *log_manager = new LogManager(disk_manager);
+  Transaction transaction(0);
+  auto *table = new TableHeap(buffer_pool_manager, lock_manager, log_manager, &transaction);
+
+  // the largest tuple that fits next to the table page header, one slot and the page checksum
+  const uint32_t max_size = PAGE_SIZE - PAGE_CHECKSUM_SIZE - 32;
+  RID rid;
+  EXPECT_TRUE(table->InsertTuple(make_tuple(max_size), &rid, &transaction));
+  EXPECT_EQ(TransactionState::GROWING, transaction.GetState());
+  Tuple result;
+  EXPECT_TRUE(table->GetTuple(rid, &result, &transaction));
+  EXPECT_EQ(max_size, result.GetLength());
+
+  // anything larger is refused up front instead of being tried on one new page after another
+  for (uint32_t size = max_size + 1; size <= max_size + PAGE_CHECKSUM_SIZE; size++) {
+    Transaction txn(1);
+    EXPECT_FALSE(table->InsertTuple(make_tuple(size), &rid, &txn));
+    EXPECT_EQ(TransactionState::ABORTED, txn.GetState());
+  }
+
+  disk_manager->ShutDown();
+  remove("test.db");
+  remove("test.log");
+  delete table;
+  delete log_manager;
+  delete lock_manager;
+  delete buffer_pool_manager;
+  delete disk_manager;
+}
+
 }  // namespace bustub
@@ -0,0 +1,161 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// b_plus_tree_bench.cpp
+//
+// Identification: tools/b_plus_tree_bench/b_plus_tree_bench.cpp
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>  // NOLINT
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <thread>  // NOLINT
+#include <vector>
+
+#include "buffer/buffer_pool_manager_instance.h"
+#include "catalog/schema.h"
+#include "storage/disk/disk_manager.h"
+#include "storage/index/b_plus_tree.h"
+
+/**
+ * Measures how B+ tree point lookups scale with the number of threads.
+ *
+ * The tree is loaded with keys and fits in the buffer pool, so lookups only contend in memory. Each thread count
+ * runs uniformly random lookups for a fixed time, once alone and once next to a thread that keeps inserting and
+ * removing keys between the loaded ones.
+ *
+ * Usage: b_plus_tree_bench [number of keys, default 1000000] [max threads, default the number of cores]
+ */
+namespace {
+
+using Tree = bustub::BPlusTree<bustub::GenericKey<8>, bustub::RID, bustub::GenericComparator<8>>;
+
+constexpr size_t POOL_SIZE = 32768;
+constexpr double SECONDS_PER_RUN = 1.0;
+constexpr const char *DB_NAME = "b_plus_tree_bench.db";
+constexpr const char *LOG_NAME = "b_plus_tree_bench.log";
+
+/** The loaded keys are the even numbers below 2 * num_keys; the writer uses the odd ones. */
+void RunLookups(Tree *tree, int64_t num_keys, uint64_t seed, const std::atomic<bool> &done, int64_t *lookups) {
+  std::mt19937_64 rng(seed);
+  std::uniform_int_distribution<int64_t> dist(0, num_keys - 1);
+  bustub::GenericKey<8> key;
+  std::vector<bustub::RID> result;
+  int64_t count = 0;
+  while (!done) {
+    for (int i = 0; i < 1024; i++) {
+      key.SetFromInteger(2 * dist(rng));
+      result.clear();
+      if (!tree->GetValue(key, &result)) {
+        fprintf(stderr, "lookup missed a loaded key\n");
+        std::abort();
+      }
+    }
+    count += 1024;
+  }
+  *lookups = count;
+}
+
+void RunWrites(Tree *tree, int64_t num_keys, const std::atomic<bool> &done) {
+  std::mt19937_64 rng(0);
+  std::uniform_int_distribution<int64_t> dist(0, num_keys - 1);
+  bustub::GenericKey<8> key;
+  while (!done) {
+    int64_t value = 2 * dist(rng) + 1;
+    key.SetFromInteger(value);
+    tree->Insert(key, bustub::RID(value));
+    key.SetFromInteger(2 * dist(rng) + 1);
+    tree->Remove(key);
+  }
+}
+
+/** @return lookups per second over all lookup threads */
+double Run(Tree *tree, int64_t num_keys, int threads, bool with_writer) {
+  std::atomic<bool> done{false};
+  std::vector<int64_t> lookups(threads);
+  std::vector<std::thread> workers;
+  for (int i = 0; i < threads; i++) {
+    workers.emplace_back(RunLookups, tree, num_keys, i + 1, std::cref(done), &lookups[i]);
+  }
+  std::thread writer;
+  if (with_writer) {
+    writer = std::thread(RunWrites, tree, num_keys, std::cref(done));
+  }
+  auto start = std::chrono::steady_clock::now();
+  std::this_thread::sleep_for(std::chrono::duration<double>(SECONDS_PER_RUN));
+  done = true;
+  for (auto &worker : workers) {
+    worker.join();
+  }
+  double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+  if (with_writer) {
+    writer.join();
+  }
+  int64_t total = 0;
+  for (int64_t count : lookups) {
+    total += count;
+  }
+  return total / elapsed;
+}
+
+}  // namespace
+
+int main(int argc, char **argv) {
+  int64_t num_keys = argc > 1 ? std::strtoll(argv[1], nullptr, 10) : 1000000;
+  int max_threads = argc > 2 ? std::atoi(argv[2]) : static_cast<int>(std::thread::hardware_concurrency());
+  max_threads = std::max(max_threads, 1);
+
+  remove(DB_NAME);
+  auto *disk_manager = new bustub::DiskManager(DB_NAME);
+  auto *bpm = new bustub::BufferPoolManagerInstance(POOL_SIZE, disk_manager);
+  bustub::page_id_t header_page_id;
+  bpm->NewPage(&header_page_id);
+
+  bustub::Schema key_schema({bustub::Column("a", bustub::TypeId::BIGINT)});
+  bustub::GenericComparator<8> comparator(&key_schema);
+  auto *tree = new Tree("bench_pk", bpm, comparator);
+  std::vector<int64_t> keys(num_keys);
+  for (int64_t i = 0; i < num_keys; i++) {
+    keys[i] = 2 * i;
+  }
+  std::shuffle(keys.begin(), keys.end(), std::mt19937_64(42));
+  bustub::GenericKey<8> key;
+  for (int64_t value : keys) {
+    key.SetFromInteger(value);
+    tree->Insert(key, bustub::RID(value));
+  }
+
+  printf("%ld keys, %u cores\n", num_keys, std::thread::hardware_concurrency());
+  printf("threads  lookups/s   speedup  | with a writer: lookups/s   speedup\n");
+  double base = 0;
+  double base_with_writer = 0;
+  for (int threads = 1;; threads = std::min(threads * 2, max_threads)) {
+    double rate = Run(tree, num_keys, threads, false);
+    double rate_with_writer = Run(tree, num_keys, threads, true);
+    if (threads == 1) {
+      base = rate;
+      base_with_writer = rate_with_writer;
+    }
+    printf("%7d  %10.0f  %7.2fx  |                %10.0f  %7.2fx\n", threads, rate, rate / base, rate_with_writer,
+           rate_with_writer / base_with_writer);
+    if (threads == max_threads) {
+      break;
+    }
+  }
+
+  delete tree;
+  bpm->UnpinPage(header_page_id, true);
+  delete bpm;
+  disk_manager->ShutDown();
+  delete disk_manager;
+  remove(DB_NAME);
+  remove(LOG_NAME);
+  return 0;
+}
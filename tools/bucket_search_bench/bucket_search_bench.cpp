@@ -0,0 +1,127 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// bucket_search_bench.cpp
+//
+// Identification: tools/bucket_search_bench/bucket_search_bench.cpp
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <chrono>  // NOLINT
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <random>
+#include <vector>
+
+#include "catalog/schema.h"
+#include "common/rid.h"
+#include "storage/index/generic_key.h"
+#include "storage/page/hash_table_bucket_page.h"
+
+/**
+ * Measures point lookups within one full extendible hash bucket page, for every key size the table is instantiated
+ * with.
+ *
+ * Each lookup is made twice: through HashTableBucketPage::GetValue, which matches the fingerprints of the slots first,
+ * and through a scan that calls the comparator on every readable slot, as bucket pages did before they kept
+ * fingerprints. Half the keys looked up are in the page.
+ *
+ * Usage: bucket_search_bench [number of lookups per key size, default 1000000]
+ */
+namespace {
+
+using bustub::GenericComparator;
+using bustub::GenericKey;
+using bustub::RID;
+
+double Seconds(std::chrono::steady_clock::time_point start) {
+  return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+/** The scan over every readable slot that the fingerprints replace. */
+template <size_t KeySize>
+bool FullScanLookup(bustub::HashTableBucketPage<GenericKey<KeySize>, RID, GenericComparator<KeySize>> *bucket,
+                    uint32_t size, const GenericKey<KeySize> &key, const GenericComparator<KeySize> &comparator,
+                    std::vector<RID> *result) {
+  for (uint32_t i = 0; i < size; i++) {
+    if (!bucket->IsReadable(i)) {
+      if (!bucket->IsOccupied(i)) {
+        break;
+      }
+      continue;
+    }
+    if (comparator(key, bucket->KeyAt(i)) == 0) {
+      result->emplace_back(bucket->ValueAt(i));
+    }
+  }
+  return !result->empty();
+}
+
+template <size_t KeySize>
+void Run(int64_t lookups) {
+  using BucketPage = bustub::HashTableBucketPage<GenericKey<KeySize>, RID, GenericComparator<KeySize>>;
+  bustub::Schema key_schema(
+      {bustub::Column("a", KeySize < sizeof(int64_t) ? bustub::TypeId::INTEGER : bustub::TypeId::BIGINT)});
+  GenericComparator<KeySize> comparator(&key_schema);
+
+  auto page = std::make_unique<char[]>(bustub::PAGE_SIZE);
+  auto *bucket = reinterpret_cast<BucketPage *>(page.get());
+  // The page holds the even numbers; the odd ones miss.
+  std::vector<GenericKey<KeySize>> keys(4096);
+  for (size_t i = 0; i < keys.size(); i++) {
+    keys[i].SetFromInteger(static_cast<int64_t>(i));
+  }
+  uint32_t size = 0;
+  while (bucket->Insert(keys[2 * size], RID(size), comparator)) {
+    size++;
+  }
+  std::vector<GenericKey<KeySize>> probes(4096);
+  std::mt19937_64 rng(42);
+  std::uniform_int_distribution<size_t> dist(0, 2 * size - 1);
+  for (auto &probe : probes) {
+    probe = keys[dist(rng)];
+  }
+
+  std::vector<RID> result;
+  int64_t found = 0;
+  auto start = std::chrono::steady_clock::now();
+  for (int64_t i = 0; i < lookups; i++) {
+    result.clear();
+    found += static_cast<int64_t>(bucket->GetValue(probes[i % probes.size()], comparator, &result));
+  }
+  double fingerprints = Seconds(start);
+  int64_t found_full = 0;
+  start = std::chrono::steady_clock::now();
+  for (int64_t i = 0; i < lookups; i++) {
+    result.clear();
+    found_full += static_cast<int64_t>(FullScanLookup(bucket, size, probes[i % probes.size()], comparator, &result));
+  }
+  double full = Seconds(start);
+  if (found != found_full) {
+    fprintf(stderr, "the two searches disagree\n");
+    std::abort();
+  }
+  printf("%8zu  %11u  %19.1f  %15.1f  %7.2fx\n", KeySize, size, fingerprints * 1e9 / lookups, full * 1e9 / lookups,
+         full / fingerprints);
+}
+
+}  // namespace
+
+int main(int argc, char **argv) {
+  int64_t lookups = argc > 1 ? std::strtoll(argv[1], nullptr, 10) : 1000000;
+#ifdef __AVX2__
+  printf("fingerprints matched with AVX2\n");
+#else
+  printf("fingerprints matched one at a time\n");
+#endif
+  printf("key size  bucket keys  fingerprints ns/op  full scan ns/op  speedup\n");
+  Run<8>(lookups);
+  Run<16>(lookups);
+  Run<32>(lookups);
+  Run<64>(lookups);
+  return 0;
+}
@@ -0,0 +1,105 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// checksum_bench.cpp
+//
+// Identification: tools/checksum_bench/checksum_bench.cpp
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <algorithm>
+#include <chrono>  // NOLINT
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+#include "common/util/crc32c.h"
+#include "storage/disk/disk_manager.h"
+
+/**
+ * Measures what page checksums cost a sequential scan.
+ *
+ * The database file is written once and then read back in runs of pages from the OS page cache, which leaves the
+ * checksum as large a share of the scan as it can be, with and without verification. The cost of CRC-32C alone over
+ * pages in memory is reported too.
+ *
+ * Usage: checksum_bench [file size in MB, default 1024]
+ */
+namespace {
+
+constexpr size_t RUN_PAGES = 64;
+constexpr int SCANS = 3;
+constexpr const char *DB_NAME = "checksum_bench.db";
+constexpr const char *LOG_NAME = "checksum_bench.log";
+constexpr double GB = 1 << 30;
+
+double Seconds(std::chrono::steady_clock::time_point start) {
+  return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+/** @return the best time of SCANS scans of the file */
+double Scan(bustub::DiskManager *disk_manager, size_t file_pages, char *const *run, bool verify) {
+  double best = 0;
+  for (int i = 0; i < SCANS; i++) {
+    auto start = std::chrono::steady_clock::now();
+    for (size_t page_id = 0; page_id < file_pages; page_id += RUN_PAGES) {
+      disk_manager->ReadPages(static_cast<bustub::page_id_t>(page_id), run, RUN_PAGES, verify);
+    }
+    double elapsed = Seconds(start);
+    best = i == 0 ? elapsed : std::min(best, elapsed);
+  }
+  return best;
+}
+
+}  // namespace
+
+int main(int argc, char **argv) {
+  size_t file_mb = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 1024;
+  size_t file_pages = file_mb * (1 << 20) / bustub::PAGE_SIZE / RUN_PAGES * RUN_PAGES;
+  double file_gb = static_cast<double>(file_pages) * bustub::PAGE_SIZE / GB;
+
+  std::vector<char> buffer(RUN_PAGES * bustub::PAGE_SIZE);
+  std::vector<char *> run;
+  for (size_t i = 0; i < RUN_PAGES; i++) {
+    run.push_back(buffer.data() + i * bustub::PAGE_SIZE);
+    for (int j = 0; j < bustub::PAGE_SIZE; j++) {
+      run[i][j] = static_cast<char>(rand());  // NOLINT
+    }
+  }
+
+  remove(DB_NAME);
+  auto *disk_manager = new bustub::DiskManager(DB_NAME, bustub::DiskBackendType::POSIX);
+  for (size_t page_id = 0; page_id < file_pages; page_id += RUN_PAGES) {
+    disk_manager->WritePages(static_cast<bustub::page_id_t>(page_id), run.data(), RUN_PAGES);
+  }
+  disk_manager->SyncPages();
+  printf("file %zu MB (%zu pages), crc32c %s\n", file_mb, file_pages,
+         bustub::Crc32c::IsHardwareAccelerated() ? "sse4.2" : "table");
+
+  // Scenario: CRC-32C over pages already in memory.
+  auto start = std::chrono::steady_clock::now();
+  uint32_t checksum = 0;
+  for (size_t page = 0; page < file_pages; page++) {
+    checksum += bustub::Crc32c::Value(run[page % RUN_PAGES], bustub::PAGE_SIZE - bustub::PAGE_CHECKSUM_SIZE);
+  }
+  double crc_time = Seconds(start);
+  printf("crc32c only       %7.3f s/GB  %6.2f GB/s  (checksum %08x)\n", crc_time / file_gb, file_gb / crc_time,
+         checksum);
+
+  // Scenario: scanning the cached file, without and then with verification.
+  Scan(disk_manager, file_pages, run.data(), false);
+  double plain_time = Scan(disk_manager, file_pages, run.data(), false);
+  double verify_time = Scan(disk_manager, file_pages, run.data(), true);
+  printf("scan, no verify   %7.3f s/GB  %6.2f GB/s\n", plain_time / file_gb, file_gb / plain_time);
+  printf("scan, verify      %7.3f s/GB  %6.2f GB/s  (+%.1f ms/GB, %+.1f%%)\n", verify_time / file_gb,
+         file_gb / verify_time, (verify_time - plain_time) / file_gb * 1000, (verify_time / plain_time - 1) * 100);
+
+  disk_manager->ShutDown();
+  delete disk_manager;
+  remove(DB_NAME);
+  remove(LOG_NAME);
+  return 0;
+}
@@ -0,0 +1,133 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// leaf_search_bench.cpp
+//
+// Identification: tools/leaf_search_bench/leaf_search_bench.cpp
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <chrono>  // NOLINT
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <random>
+#include <vector>
+
+#include "catalog/schema.h"
+#include "storage/index/generic_key.h"
+#include "storage/page/b_plus_tree_leaf_page.h"
+#include "storage/table/tuple.h"
+#include "type/value_factory.h"
+
+/**
+ * Measures key lookups within one full B+ tree leaf page, for every key size the tree is instantiated with.
+ *
+ * Each lookup is made twice: through BPlusTreeLeafPage::Lookup, which scans the heads of the keys first, and through
+ * a binary search that compares full keys only, as leaf pages did before they kept heads. Half the keys looked up
+ * are in the page.
+ *
+ * Usage: leaf_search_bench [number of lookups per key size, default 10000000]
+ */
+namespace {
+
+using bustub::GenericComparator;
+using bustub::GenericKey;
+using bustub::RID;
+
+double Seconds(std::chrono::steady_clock::time_point start) {
+  return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+template <size_t KeySize>
+void SetKey(GenericKey<KeySize> *key, const bustub::Schema *key_schema, int64_t value) {
+  if constexpr (KeySize < sizeof(int64_t)) {
+    key->SetFromKey(bustub::Tuple({bustub::ValueFactory::GetIntegerValue(static_cast<int32_t>(value))}, key_schema),
+                    key_schema);
+  } else {
+    key->SetFromInteger(value);
+  }
+}
+
+/** The binary search over full keys that the heads replace. */
+template <size_t KeySize>
+bool FullKeyLookup(bustub::BPlusTreeLeafPage<GenericKey<KeySize>, RID, GenericComparator<KeySize>> *leaf,
+                   const GenericKey<KeySize> &key, const GenericComparator<KeySize> &comparator) {
+  int low = 0;
+  int high = leaf->GetSize();
+  while (low < high) {
+    int mid = low + (high - low) / 2;
+    if (comparator(leaf->KeyAt(mid), key) < 0) {
+      low = mid + 1;
+    } else {
+      high = mid;
+    }
+  }
+  return low < leaf->GetSize() && comparator(leaf->KeyAt(low), key) == 0;
+}
+
+template <size_t KeySize>
+void Run(int64_t lookups) {
+  using LeafPage = bustub::BPlusTreeLeafPage<GenericKey<KeySize>, RID, GenericComparator<KeySize>>;
+  bustub::Schema key_schema(
+      {bustub::Column("a", KeySize < sizeof(int64_t) ? bustub::TypeId::INTEGER : bustub::TypeId::BIGINT)});
+  GenericComparator<KeySize> comparator(&key_schema);
+
+  auto page = std::make_unique<char[]>(bustub::PAGE_SIZE);
+  auto *leaf = reinterpret_cast<LeafPage *>(page.get());
+  leaf->Init(0);
+  GenericKey<KeySize> key;
+  // The page holds the even numbers; the odd ones miss.
+  int size = leaf->GetMaxSize() - 1;
+  for (int i = 0; i < size; i++) {
+    SetKey(&key, &key_schema, 2 * i);
+    leaf->Insert(key, RID(i), comparator);
+  }
+  std::vector<GenericKey<KeySize>> probes(4096);
+  std::mt19937_64 rng(42);
+  std::uniform_int_distribution<int64_t> dist(0, 2 * size - 1);
+  for (auto &probe : probes) {
+    SetKey(&probe, &key_schema, dist(rng));
+  }
+
+  RID rid;
+  int64_t found = 0;
+  auto start = std::chrono::steady_clock::now();
+  for (int64_t i = 0; i < lookups; i++) {
+    found += static_cast<int64_t>(leaf->Lookup(probes[i % probes.size()], &rid, comparator));
+  }
+  double heads = Seconds(start);
+  int64_t found_full = 0;
+  start = std::chrono::steady_clock::now();
+  for (int64_t i = 0; i < lookups; i++) {
+    found_full += static_cast<int64_t>(FullKeyLookup(leaf, probes[i % probes.size()], comparator));
+  }
+  double full = Seconds(start);
+  if (found != found_full) {
+    fprintf(stderr, "the two searches disagree\n");
+    std::abort();
+  }
+  printf("%8zu  %9d  %12.1f  %15.1f  %7.2fx\n", KeySize, size, heads * 1e9 / lookups, full * 1e9 / lookups,
+         full / heads);
+}
+
+}  // namespace
+
+int main(int argc, char **argv) {
+  int64_t lookups = argc > 1 ? std::strtoll(argv[1], nullptr, 10) : 10000000;
+#ifdef __AVX2__
+  printf("heads scanned with AVX2\n");
+#else
+  printf("heads scanned one at a time\n");
+#endif
+  printf("key size  leaf keys  heads ns/op  full keys ns/op  speedup\n");
+  Run<4>(lookups);
+  Run<8>(lookups);
+  Run<16>(lookups);
+  Run<32>(lookups);
+  Run<64>(lookups);
+  return 0;
+}
@@ -0,0 +1,103 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// log_bench.cpp
+//
+// Identification: tools/log_bench/log_bench.cpp
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <atomic>
+#include <chrono>  // NOLINT
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <thread>  // NOLINT
+#include <vector>
+
+#include "catalog/schema.h"
+#include "concurrency/transaction_manager.h"
+#include "recovery/log_manager.h"
+#include "storage/table/tuple.h"
+#include "type/value_factory.h"
+
+/**
+ * Measures group commit: how many commits share one log fsync as the number of clients grows.
+ *
+ * Every client runs small transactions back to back. Each transaction logs one insert of a 100 byte tuple and commits,
+ * and Commit returns only once its commit record is on disk. With compress, log buffers are written as compressed
+ * blocks whenever that makes them smaller, and the log bytes per commit show the difference.
+ *
+ * Usage: log_bench [seconds per client count, default 2] [compress]
+ */
+namespace {
+
+constexpr const char *DB_NAME = "log_bench.db";
+constexpr const char *LOG_NAME = "log_bench.log";
+
+void RunClients(int num_clients, double seconds, const bustub::Tuple &tuple) {
+  remove(DB_NAME);
+  remove(LOG_NAME);
+  auto *disk_manager = new bustub::DiskManager(DB_NAME);
+  auto *log_manager = new bustub::LogManager(disk_manager);
+  bustub::TransactionManager txn_manager(nullptr, log_manager);
+  log_manager->RunFlushThread();
+
+  std::atomic<bool> stop{false};
+  std::atomic<int64_t> commits{0};
+  std::vector<std::thread> clients;
+  auto start = std::chrono::steady_clock::now();
+  for (int i = 0; i < num_clients; i++) {
+    clients.emplace_back([&] {
+      int64_t local_commits = 0;
+      bustub::RID rid;
+      while (!stop) {
+        bustub::Transaction *txn = txn_manager.Begin();
+        bustub::LogRecord log_record(txn->GetTransactionId(), txn->GetPrevLSN(), bustub::LogRecordType::INSERT, rid,
+                                     tuple);
+        txn->SetPrevLSN(log_manager->AppendLogRecord(&log_record));
+        txn_manager.Commit(txn);
+        delete txn;
+        local_commits++;
+      }
+      commits += local_commits;
+    });
+  }
+  std::this_thread::sleep_for(std::chrono::duration<double>(seconds));
+  stop = true;
+  for (auto &client : clients) {
+    client.join();
+  }
+  auto elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+  log_manager->StopFlushThread();
+  int flushes = disk_manager->GetNumFlushes();
+  double log_bytes = disk_manager->GetLogSize();
+
+  printf("clients %3d  %9.0f commits/s  %8d fsyncs  %7.1f commits/fsync  %6.1f log bytes/commit\n", num_clients,
+         commits / elapsed, flushes, flushes == 0 ? 0.0 : static_cast<double>(commits) / flushes,
+         commits == 0 ? 0.0 : log_bytes / commits);
+  disk_manager->ShutDown();
+  delete log_manager;
+  delete disk_manager;
+}
+
+}  // namespace
+
+int main(int argc, char **argv) {
+  double seconds = argc > 1 ? std::strtod(argv[1], nullptr) : 2;
+  bustub::log_compression = argc > 2 && std::string(argv[2]) == "compress";
+  bustub::Schema schema({bustub::Column("payload", bustub::TypeId::VARCHAR, 100)});
+  std::vector<bustub::Value> values{bustub::ValueFactory::GetVarcharValue(std::string(100, 'x'))};
+  bustub::Tuple tuple(values, &schema);
+
+  for (int num_clients : {1, 2, 4, 8, 16, 32, 64}) {
+    RunClients(num_clients, seconds, tuple);
+  }
+
+  remove(DB_NAME);
+  remove(LOG_NAME);
+  return 0;
+}
@@ -0,0 +1,139 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// replacer_bench.cpp
+//
+// Identification: tools/replacer_bench/replacer_bench.cpp
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>  // NOLINT
+#include <cmath>
+#include <cstdio>
+#include <random>
+#include <thread>  // NOLINT
+#include <vector>
+
+#include "buffer/buffer_pool_manager_instance.h"
+#include "storage/disk/disk_manager.h"
+
+/**
+ * Measures how well each replacement policy protects a hot working set from a concurrent sequential scan.
+ *
+ * Lookup threads fetch pages from a hot region following a Zipfian distribution while one thread repeatedly scans a
+ * cold region that is much larger than the pool. Every scan fetch misses under any policy, so the lookup hit ratio
+ * is derived from the disk reads that the scan did not account for.
+ */
+namespace {
+
+constexpr size_t POOL_SIZE = 1024;
+constexpr int HOT_PAGES = 2048;
+constexpr int SCAN_PAGES = 8192;
+constexpr int LOOKUP_THREADS = 2;
+constexpr int LOOKUPS_PER_THREAD = 200000;
+constexpr double ZIPF_THETA = 0.99;
+constexpr const char *DB_NAME = "replacer_bench.db";
+constexpr const char *LOG_NAME = "replacer_bench.log";
+
+/** Samples ranks in [0, n) following a Zipfian distribution with a precomputed CDF. */
+class ZipfianGenerator {
+ public:
+  ZipfianGenerator(int n, double theta, uint64_t seed) : cdf_(n), rng_(seed) {
+    double sum = 0;
+    for (int i = 0; i < n; i++) {
+      sum += 1.0 / std::pow(i + 1, theta);
+      cdf_[i] = sum;
+    }
+    for (auto &value : cdf_) {
+      value /= sum;
+    }
+  }
+
+  int Next() {
+    double u = dist_(rng_);
+    return static_cast<int>(std::lower_bound(cdf_.begin(), cdf_.end(), u) - cdf_.begin());
+  }
+
+ private:
+  std::vector<double> cdf_;
+  std::mt19937_64 rng_;
+  std::uniform_real_distribution<double> dist_{0.0, 1.0};
+};
+
+void RunLookups(bustub::BufferPoolManager *bpm, int thread_id, int count) {
+  ZipfianGenerator zipf(HOT_PAGES, ZIPF_THETA, thread_id + 1);
+  for (int i = 0; i < count; i++) {
+    bustub::page_id_t page_id = zipf.Next();
+    if (bpm->FetchPage(page_id) != nullptr) {
+      bpm->UnpinPage(page_id, false);
+    }
+  }
+}
+
+void RunPolicy(const char *name, bustub::ReplacerType type) {
+  remove(DB_NAME);
+  auto *disk_manager = new bustub::DiskManager(DB_NAME);
+  auto *bpm = new bustub::BufferPoolManagerInstance(POOL_SIZE, disk_manager, nullptr, type);
+
+  // Hot pages get ids [0, HOT_PAGES), the scanned table the ids after them.
+  bustub::page_id_t page_id;
+  for (int i = 0; i < HOT_PAGES + SCAN_PAGES; i++) {
+    bpm->NewPage(&page_id);
+    bpm->UnpinPage(page_id, true);
+  }
+  RunLookups(bpm, 0, LOOKUPS_PER_THREAD);
+
+  int reads_before = disk_manager->GetNumReads();
+  std::atomic<bool> done{false};
+  std::atomic<int64_t> scan_fetches{0};
+  std::thread scanner([&] {
+    while (!done) {
+      for (bustub::page_id_t scan_page = HOT_PAGES; scan_page < HOT_PAGES + SCAN_PAGES && !done; scan_page++) {
+        if (bpm->FetchPage(scan_page) != nullptr) {
+          bpm->UnpinPage(scan_page, false);
+          scan_fetches++;
+        }
+      }
+    }
+  });
+
+  auto start = std::chrono::steady_clock::now();
+  std::vector<std::thread> lookups;
+  for (int tid = 0; tid < LOOKUP_THREADS; tid++) {
+    lookups.emplace_back(RunLookups, bpm, tid + 1, LOOKUPS_PER_THREAD);
+  }
+  for (auto &thread : lookups) {
+    thread.join();
+  }
+  auto elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+  done = true;
+  scanner.join();
+
+  int64_t total_lookups = static_cast<int64_t>(LOOKUP_THREADS) * LOOKUPS_PER_THREAD;
+  int64_t lookup_misses = std::max<int64_t>(0, disk_manager->GetNumReads() - reads_before - scan_fetches);
+  printf("%-10s lookup hit ratio %.4f  lookups/s %.0f  scanned pages %ld\n", name,
+         1.0 - static_cast<double>(lookup_misses) / total_lookups, total_lookups / elapsed,
+         static_cast<int64_t>(scan_fetches));
+
+  disk_manager->ShutDown();
+  delete bpm;
+  delete disk_manager;
+  remove(DB_NAME);
+  remove(LOG_NAME);
+}
+
+}  // namespace
+
+int main(int argc, char **argv) {
+  printf("pool %zu pages, hot set %d pages (zipf %.2f), scan %d pages, %d lookup threads\n", POOL_SIZE, HOT_PAGES,
+         ZIPF_THETA, SCAN_PAGES, LOOKUP_THREADS);
+  RunPolicy("lru", bustub::ReplacerType::LRU);
+  RunPolicy("2q", bustub::ReplacerType::TWO_QUEUE);
+  RunPolicy("lru-k", bustub::ReplacerType::LRU_K);
+  return 0;
+}
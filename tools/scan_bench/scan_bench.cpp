@@ -0,0 +1,135 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// scan_bench.cpp
+//
+// Identification: tools/scan_bench/scan_bench.cpp
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <fcntl.h>
+#include <unistd.h>
+#include <chrono>  // NOLINT
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+#include "buffer/buffer_pool_manager_instance.h"
+#include "catalog/schema.h"
+#include "concurrency/transaction.h"
+#include "storage/disk/disk_manager.h"
+#include "storage/page/table_page.h"
+#include "storage/table/table_heap.h"
+#include "type/value_factory.h"
+
+/**
+ * Measures sequential scan throughput over a cold table with and without read-ahead.
+ *
+ * The table is written once, then for every prefetch window the OS page cache is dropped for the database file and
+ * the table is scanned through a fresh buffer pool that is much smaller than the table.
+ *
+ * Usage: scan_bench [table size in MB, default 1024]
+ */
+namespace {
+
+constexpr size_t POOL_SIZE = 4096;
+constexpr uint32_t PAYLOAD_SIZE = 400;
+constexpr const char *DB_NAME = "scan_bench.db";
+constexpr const char *LOG_NAME = "scan_bench.log";
+
+/** Drop the OS page cache for the database file, so the next scan reads from the device. */
+void DropCache() {
+  int fd = open(DB_NAME, O_RDONLY);
+  if (fd < 0) {
+    return;
+  }
+  fdatasync(fd);
+  posix_fadvise(fd, 0, 0, POSIX_FADV_DONTNEED);
+  close(fd);
+}
+
+/**
+ * Fill table pages directly. TableHeap::InsertTuple starts its search for free space at the first page, which would
+ * make loading a large table quadratic.
+ */
+bustub::page_id_t BuildTable(bustub::DiskManager *disk_manager, const bustub::Schema &schema, size_t table_pages) {
+  auto *bpm = new bustub::BufferPoolManagerInstance(POOL_SIZE, disk_manager);
+  bustub::Transaction txn(0);
+  std::string payload(PAYLOAD_SIZE, 'x');
+  std::vector<bustub::Value> values{bustub::ValueFactory::GetIntegerValue(0),
+                                    bustub::ValueFactory::GetVarcharValue(payload)};
+  bustub::page_id_t first_page_id;
+  auto *page = static_cast<bustub::TablePage *>(bpm->NewPage(&first_page_id));
+  page->Init(first_page_id, bustub::PAGE_SIZE - bustub::PAGE_CHECKSUM_SIZE, bustub::INVALID_PAGE_ID, nullptr, &txn);
+  bustub::RID rid;
+  int32_t id = 0;
+  for (size_t i = 1; i < table_pages;) {
+    values[0] = bustub::ValueFactory::GetIntegerValue(id);
+    if (page->InsertTuple(bustub::Tuple(values, &schema), &rid, &txn, nullptr, nullptr)) {
+      id++;
+      continue;
+    }
+    bustub::page_id_t next_page_id;
+    auto *next_page = static_cast<bustub::TablePage *>(bpm->NewPage(&next_page_id));
+    next_page->Init(next_page_id, bustub::PAGE_SIZE - bustub::PAGE_CHECKSUM_SIZE, page->GetTablePageId(), nullptr,
+                    &txn);
+    page->SetNextPageId(next_page_id);
+    bpm->UnpinPage(page->GetTablePageId(), true);
+    page = next_page;
+    i++;
+  }
+  bpm->UnpinPage(page->GetTablePageId(), true);
+  bpm->FlushAllPages();
+  delete bpm;
+  return first_page_id;
+}
+
+void RunScan(bustub::DiskManager *disk_manager, bustub::page_id_t first_page_id, size_t window) {
+  bustub::table_scan_prefetch_window = window;
+  DropCache();
+  auto *bpm = new bustub::BufferPoolManagerInstance(POOL_SIZE, disk_manager);
+  auto *table = new bustub::TableHeap(bpm, nullptr, nullptr, first_page_id);
+  bustub::Transaction txn(0);
+
+  int reads_before = disk_manager->GetNumReads();
+  auto start = std::chrono::steady_clock::now();
+  int64_t tuples = 0;
+  for (auto iter = table->Begin(&txn); iter != table->End(); ++iter) {
+    tuples++;
+  }
+  auto elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+  int pages = disk_manager->GetNumReads() - reads_before;
+
+  printf("window %3zu  %.2f s  %8.1f MB/s  %9.0f tuples/s  pages read %d  prefetched %lu\n", window, elapsed,
+         static_cast<double>(pages) * bustub::PAGE_SIZE / (1 << 20) / elapsed, tuples / elapsed, pages,
+         bpm->GetNumPrefetchedPages());
+  delete table;
+  delete bpm;
+}
+
+}  // namespace
+
+int main(int argc, char **argv) {
+  size_t table_mb = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 1024;
+  size_t table_pages = table_mb * (1 << 20) / bustub::PAGE_SIZE;
+  bustub::Schema schema({bustub::Column("id", bustub::TypeId::INTEGER),
+                         bustub::Column("payload", bustub::TypeId::VARCHAR, PAYLOAD_SIZE)});
+
+  remove(DB_NAME);
+  auto *disk_manager = new bustub::DiskManager(DB_NAME);
+  bustub::page_id_t first_page_id = BuildTable(disk_manager, schema, table_pages);
+  printf("table %zu MB (%zu pages), pool %zu pages\n", table_mb, table_pages, POOL_SIZE);
+  for (size_t window : {0, 8, 32, 128}) {
+    RunScan(disk_manager, first_page_id, window);
+  }
+
+  disk_manager->ShutDown();
+  delete disk_manager;
+  remove(DB_NAME);
+  remove(LOG_NAME);
+  return 0;
+}